@@ -0,0 +1,212 @@
+// Telegram processing microbenchmarks (host only, [env:native_bench]).
+//
+// Every benchmark runs over each telegram in dsmr_corpus.h and prints one
+// JSON object per line on stdout, so runs from different commits can be
+// compared with bench/compare.py. A readable table goes to stderr.
+//
+//   BENCH_MIN_MS   minimum measuring time per benchmark (default 300)
+//   BENCH_COMMIT   label stored in every result (e.g. `git rev-parse --short HEAD`)
+//   BENCH_FILTER   only run benchmarks whose name contains this string
+
+#include <Arduino.h>
+#include <time.h>
+#include "config.h"
+#include "crc16.h"
+#include "p1_parser.h"
+#include "p1_handler.h"
+#include "p1_aggregator.h"
+#include "p1_binary.h"
+#include "custom_log.h"
+#include "heap_telemetry.h"
+#include "stats.h"
+#include "web/http_server.h"
+#include "web/p1_web_handler.h"
+#include "web/api_web_handler.h"
+#include "dsmr_corpus.h"
+
+// Benchmarks. Each run processes `iterations` telegrams and returns the
+// number of telegrams that produced a result, which also keeps the work
+// from being optimized away.
+
+typedef uint32_t (*BenchFunction)(const DsmrCorpusEntry& entry, size_t length, uint32_t iterations);
+
+static volatile uint32_t benchSink = 0;
+
+static uint32_t benchCRC(const DsmrCorpusEntry& entry, size_t length, uint32_t iterations) {
+	// The CRC covers '/' up to and including '!'
+	const char* end = strchr(entry.telegram, P1_END_CHAR);
+	size_t covered = end ? (size_t)(end - entry.telegram) + 1 : length;
+	uint32_t done = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		benchSink += crc16Update(0, (const uint8_t*)entry.telegram, covered);
+		done++;
+	}
+	return done;
+}
+
+static uint32_t benchParse(const DsmrCorpusEntry& entry, size_t length, uint32_t iterations) {
+	uint32_t done = 0;
+	P1Reading reading;
+	for (uint32_t i = 0; i < iterations; i++) {
+		if (parseP1Telegram(entry.telegram, length, reading)) {
+			done++;
+		}
+		benchSink += reading.fields;
+	}
+	return done;
+}
+
+static uint32_t benchPipeline(const DsmrCorpusEntry& entry, size_t length, uint32_t iterations) {
+	// Same path as readP1Data(): UART-sized chunks into the framer, which
+	// forwards, decodes and aggregates each complete telegram
+	unsigned long before = getStat(STAT_P1_TELEGRAMS);
+	for (uint32_t i = 0; i < iterations; i++) {
+		for (size_t offset = 0; offset < length; offset += P1_CAPTURE_CHUNK_SIZE) {
+			size_t chunk = min(length - offset, (size_t)P1_CAPTURE_CHUNK_SIZE);
+			processP1Bytes((const uint8_t*)entry.telegram + offset, chunk);
+		}
+	}
+	return (uint32_t)(getStat(STAT_P1_TELEGRAMS) - before);
+}
+
+static uint32_t benchJSON(const DsmrCorpusEntry& entry, size_t length, uint32_t iterations) {
+	// The /p1/stream event JSON embeds the last telegram, escaped
+	p1Buffer = entry.telegram;
+	p1MessageComplete = true;
+	uint32_t done = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		StringBuilder& json = beginHTTPPage();
+		buildCurrentP1DataJSON(json);
+		benchSink += json.length();
+		done++;
+	}
+	p1Buffer = "";
+	p1MessageComplete = false;
+	return done;
+}
+
+static uint32_t benchReadingJSON(const DsmrCorpusEntry& entry, size_t length, uint32_t iterations) {
+	// The /api/v1/reading body, serialized from the decoded telegram; done
+	// once per telegram, so this is its whole cost however many clients ask
+	P1Reading reading;
+	if (!parseP1Telegram(entry.telegram, length, reading)) return 0;
+	uint32_t done = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		StringBuilder& json = beginHTTPPage();
+		appendP1ReadingJSON(json, reading);
+		benchSink += json.length();
+		done++;
+	}
+	return done;
+}
+
+static uint32_t benchBinaryFrame(const DsmrCorpusEntry& entry, size_t length, uint32_t iterations) {
+	// What a binary P1 client costs per telegram: the items and one delta
+	// frame, encoded once however many clients are in binary mode
+	P1Reading reading;
+	if (!parseP1Telegram(entry.telegram, length, reading)) return 0;
+	P1BinaryItems previous;
+	P1BinaryItems items;
+	getP1BinaryItems(reading, previous);
+	uint8_t frame[P1_BINARY_FRAME_MAX];
+	uint32_t done = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		reading.powerDeliveredW = (int32_t)(i & 0xFFF);
+		getP1BinaryItems(reading, items);
+		benchSink += encodeP1BinaryFrame(items, &previous, frame);
+		done++;
+	}
+	return done;
+}
+
+struct Benchmark {
+	const char* name;
+	BenchFunction function;
+};
+
+static const Benchmark benchmarks[] = {
+	{"crc16",    benchCRC},
+	{"parse",    benchParse},
+	{"pipeline", benchPipeline},
+	{"json",     benchJSON},
+	{"reading_json", benchReadingJSON},
+	{"binary_frame", benchBinaryFrame},
+};
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static uint64_t nowNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void runBenchmark(const Benchmark& benchmark, const DsmrCorpusEntry& entry, uint64_t minNs, const char* commit) {
+	size_t length = strlen(entry.telegram);
+
+	// Warm up, then grow the batch until one batch takes at least minNs
+	benchmark.function(entry, length, 16);
+	uint32_t iterations = 64;
+	uint64_t elapsed = 0;
+	uint32_t completed = 0;
+	uint64_t allocs = 0;
+	uint64_t bytes = 0;
+	for (;;) {
+		// Allocations are counted by the heap telemetry hooks
+		HeapTagStats before;
+		HeapTagStats after;
+		getHeapAllocationTotals(before);
+		uint64_t start = nowNs();
+		completed = benchmark.function(entry, length, iterations);
+		elapsed = nowNs() - start;
+		getHeapAllocationTotals(after);
+		allocs = after.allocations - before.allocations;
+		bytes = after.bytes - before.bytes;
+		if (elapsed >= minNs || iterations >= (1U << 30)) {
+			break;
+		}
+		uint64_t next = elapsed > 0 ? iterations * (minNs + minNs / 4) / elapsed : iterations * 16ULL;
+		next = max(next, (uint64_t)iterations * 2);
+		iterations = (uint32_t)min(next, (uint64_t)iterations * 16);
+	}
+
+	double nsPerTelegram = (double)elapsed / iterations;
+	double bytesPerSecond = (double)length * iterations * 1e9 / elapsed;
+
+	printf("{\"commit\":\"%s\",\"bench\":\"%s\",\"corpus\":\"%s\",\"bytes\":%u,\"iterations\":%u,"
+		   "\"completed\":%u,\"ns_per_telegram\":%.1f,\"bytes_per_s\":%.0f,"
+		   "\"allocs_per_telegram\":%.2f,\"alloc_bytes_per_telegram\":%.1f}\n",
+		   commit, benchmark.name, entry.name, (unsigned)length, iterations,
+		   completed, nsPerTelegram, bytesPerSecond,
+		   (double)allocs / iterations, (double)bytes / iterations);
+	fprintf(stderr, "%-12s %-20s %5u B %12.1f ns %10.2f MB/s %8.2f allocs %9.1f B%s\n",
+			benchmark.name, entry.name, (unsigned)length, nsPerTelegram, bytesPerSecond / 1e6,
+			(double)allocs / iterations, (double)bytes / iterations,
+			completed == iterations ? "" : "  (incomplete)");
+}
+
+int main(int argc, char** argv) {
+	(void)argc;
+	(void)argv;
+	halBegin();
+
+	const char* minMs = getenv("BENCH_MIN_MS");
+	const char* commit = getenv("BENCH_COMMIT");
+	const char* filter = getenv("BENCH_FILTER");
+	uint64_t minNs = (minMs ? strtoull(minMs, nullptr, 10) : 300) * 1000000ULL;
+	if (!commit) commit = "unknown";
+
+	// Keep stdout to the results; debug messages are still built, as on the device
+	LOG_SET_LEVEL(DebugLogLevel::LVL_WARN);
+
+	// Only the pieces the measured paths touch
+	initializeAggregator();
+
+	for (size_t b = 0; b < BENCHMARK_COUNT; b++) {
+		if (filter && !strstr(benchmarks[b].name, filter)) continue;
+		for (size_t c = 0; c < DSMR_CORPUS_COUNT; c++) {
+			runBenchmark(benchmarks[b], dsmrCorpus[c], minNs, commit);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""
+Compare two benchmark runs (JSON lines from the native_bench program).
+
+Usage: python bench/compare.py base.jsonl new.jsonl [--threshold PERCENT]
+
+Prints the change in ns/telegram and allocations per benchmark/telegram and
+exits with status 1 when any benchmark got slower than the threshold.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{"):
+                continue
+            result = json.loads(line)
+            results[(result["bench"], result["corpus"])] = result
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two native_bench runs")
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent slowdown reported as a regression (default 10)")
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+    regressions = 0
+
+    print(f"{'bench':<9} {'corpus':<20} {'base ns':>10} {'new ns':>10} {'change':>8} {'allocs':>12}")
+    for key in sorted(new):
+        if key not in base:
+            continue
+        b, n = base[key], new[key]
+        change = (n["ns_per_telegram"] - b["ns_per_telegram"]) * 100.0 / b["ns_per_telegram"]
+        allocs = f"{b['allocs_per_telegram']:.0f} -> {n['allocs_per_telegram']:.0f}"
+        flag = ""
+        if change > args.threshold:
+            flag = "  SLOWER"
+            regressions += 1
+        print(f"{key[0]:<9} {key[1]:<20} {b['ns_per_telegram']:>10.1f} {n['ns_per_telegram']:>10.1f} {change:>+7.1f}% {allocs:>12}{flag}")
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
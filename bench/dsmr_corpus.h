@@ -0,0 +1,147 @@
+#ifndef DSMR_CORPUS_H
+#define DSMR_CORPUS_H
+
+// Reference telegrams for the benchmarks. The DSMR 4.x/5.0 telegrams carry a
+// valid CRC-16; DSMR 2.2 has none.
+
+struct DsmrCorpusEntry {
+	const char* name;
+	const char* description;
+	const char* telegram;
+};
+
+static const DsmrCorpusEntry dsmrCorpus[] = {
+	{"dsmr22_single", "DSMR 2.2, single phase, gas on the line after 0-1:24.3.0",
+		"/ISk5\\2ME382-1003\r\n"
+		"\r\n"
+		"0-0:96.1.1(4B413650303035303639363637343133)\r\n"
+		"1-0:1.8.1(00185.000*kWh)\r\n"
+		"1-0:1.8.2(00084.000*kWh)\r\n"
+		"1-0:2.8.1(00013.000*kWh)\r\n"
+		"1-0:2.8.2(00019.000*kWh)\r\n"
+		"0-0:96.14.0(0001)\r\n"
+		"1-0:1.7.0(0000.98*kW)\r\n"
+		"1-0:2.7.0(0000.00*kW)\r\n"
+		"0-0:17.0.0(999*A)\r\n"
+		"0-0:96.3.10(1)\r\n"
+		"0-0:96.13.1()\r\n"
+		"0-0:96.13.0()\r\n"
+		"0-1:96.1.0(3238303131303031323332313336313132)\r\n"
+		"0-1:24.1.0(03)\r\n"
+		"0-1:24.3.0(121030140000)(00)(60)(1)(0-1:24.2.1)(m3)\r\n"
+		"(00000.000)\r\n"
+		"0-1:24.4.0(1)\r\n"
+		"!\r\n"},
+	{"dsmr42_single", "ESMR 4.2, single phase with gas and an event log",
+		"/KFM5KAIFA-METER\r\n"
+		"\r\n"
+		"1-3:0.2.8(42)\r\n"
+		"0-0:1.0.0(161113205757W)\r\n"
+		"0-0:96.1.1(3960221976967177082151037881335713)\r\n"
+		"1-0:1.8.1(001581.123*kWh)\r\n"
+		"1-0:1.8.2(001435.706*kWh)\r\n"
+		"1-0:2.8.1(000000.000*kWh)\r\n"
+		"1-0:2.8.2(000000.000*kWh)\r\n"
+		"0-0:96.14.0(0002)\r\n"
+		"1-0:1.7.0(02.027*kW)\r\n"
+		"1-0:2.7.0(00.000*kW)\r\n"
+		"0-0:96.7.21(00015)\r\n"
+		"0-0:96.7.9(00007)\r\n"
+		"1-0:99.97.0(3)(0-0:96.7.19)(000104180320W)(0000237126*s)(000101000001W)(2147583646*s)(000102000003W)(2317482647*s)\r\n"
+		"1-0:32.32.0(00000)\r\n"
+		"1-0:32.36.0(00000)\r\n"
+		"0-0:96.13.1()\r\n"
+		"0-0:96.13.0()\r\n"
+		"1-0:31.7.0(008*A)\r\n"
+		"1-0:21.7.0(02.027*kW)\r\n"
+		"1-0:22.7.0(00.000*kW)\r\n"
+		"0-1:24.1.0(003)\r\n"
+		"0-1:96.1.0(4819243993373755377509728609491464)\r\n"
+		"0-1:24.2.1(161129200000W)(00981.443*m3)\r\n"
+		"!0204\r\n"},
+	{"dsmr50_3phase", "DSMR 5.0, three phase with gas and water",
+		"/Ene5\\T210-D ESMR5.0\r\n"
+		"\r\n"
+		"1-3:0.2.8(50)\r\n"
+		"0-0:1.0.0(230115123015W)\r\n"
+		"0-0:96.1.1(4530303632303030303134353532323139)\r\n"
+		"1-0:1.8.1(012345.678*kWh)\r\n"
+		"1-0:1.8.2(023456.789*kWh)\r\n"
+		"1-0:2.8.1(001234.567*kWh)\r\n"
+		"1-0:2.8.2(002345.678*kWh)\r\n"
+		"0-0:96.14.0(0002)\r\n"
+		"1-0:1.7.0(01.193*kW)\r\n"
+		"1-0:2.7.0(00.000*kW)\r\n"
+		"0-0:96.7.21(00004)\r\n"
+		"0-0:96.7.9(00002)\r\n"
+		"1-0:99.97.0(1)(0-0:96.7.19)(190916131230S)(0000000436*s)\r\n"
+		"1-0:32.32.0(00002)\r\n"
+		"1-0:52.32.0(00001)\r\n"
+		"1-0:72.32.0(00001)\r\n"
+		"1-0:32.36.0(00000)\r\n"
+		"1-0:52.36.0(00000)\r\n"
+		"1-0:72.36.0(00000)\r\n"
+		"0-0:96.13.0()\r\n"
+		"1-0:32.7.0(230.1*V)\r\n"
+		"1-0:52.7.0(231.4*V)\r\n"
+		"1-0:72.7.0(229.8*V)\r\n"
+		"1-0:31.7.0(002*A)\r\n"
+		"1-0:51.7.0(001*A)\r\n"
+		"1-0:71.7.0(003*A)\r\n"
+		"1-0:21.7.0(00.402*kW)\r\n"
+		"1-0:41.7.0(00.211*kW)\r\n"
+		"1-0:61.7.0(00.580*kW)\r\n"
+		"1-0:22.7.0(00.000*kW)\r\n"
+		"1-0:42.7.0(00.000*kW)\r\n"
+		"1-0:62.7.0(00.000*kW)\r\n"
+		"0-1:24.1.0(003)\r\n"
+		"0-1:96.1.0(4730303339303031393032323338393139)\r\n"
+		"0-1:24.2.1(230115123000W)(04321.987*m3)\r\n"
+		"0-2:24.1.0(007)\r\n"
+		"0-2:96.1.0(3853414731323334353637383930313233)\r\n"
+		"0-2:24.2.1(230115123000W)(00123.456*m3)\r\n"
+		"!D288\r\n"},
+	{"dsmr50_failure_log", "DSMR 5.0, three phase, full long power failure log and a text message",
+		"/ISK5\\2M550T-1012\r\n"
+		"\r\n"
+		"1-3:0.2.8(50)\r\n"
+		"0-0:1.0.0(230301083000W)\r\n"
+		"0-0:96.1.1(4530303434303037313331363530363138)\r\n"
+		"1-0:1.8.1(004567.890*kWh)\r\n"
+		"1-0:1.8.2(003456.789*kWh)\r\n"
+		"1-0:2.8.1(000123.456*kWh)\r\n"
+		"1-0:2.8.2(000234.567*kWh)\r\n"
+		"0-0:96.14.0(0001)\r\n"
+		"1-0:1.7.0(00.000*kW)\r\n"
+		"1-0:2.7.0(02.345*kW)\r\n"
+		"0-0:96.7.21(00027)\r\n"
+		"0-0:96.7.9(00010)\r\n"
+		"1-0:99.97.0(10)(0-0:96.7.19)(220101030015W)(0000003600*s)(220202030115W)(0000007200*s)(220303030215W)(0000010800*s)(220404030315W)(0000014400*s)(220505030415W)(0000018000*s)(220606030515W)(0000021600*s)(220707030615W)(0000025200*s)(220808030715W)(0000028800*s)(220909030815W)(0000032400*s)(221010030915W)(0000036000*s)\r\n"
+		"1-0:32.32.0(00012)\r\n"
+		"1-0:52.32.0(00009)\r\n"
+		"1-0:72.32.0(00011)\r\n"
+		"1-0:32.36.0(00003)\r\n"
+		"1-0:52.36.0(00001)\r\n"
+		"1-0:72.36.0(00002)\r\n"
+		"0-0:96.13.0(546869732069732061207465737420746578742E546869732069732061207465737420746578742E546869732069732061207465737420746578742E546869732069732061207465737420746578742E)\r\n"
+		"1-0:32.7.0(241.2*V)\r\n"
+		"1-0:52.7.0(240.7*V)\r\n"
+		"1-0:72.7.0(242.0*V)\r\n"
+		"1-0:31.7.0(003*A)\r\n"
+		"1-0:51.7.0(003*A)\r\n"
+		"1-0:71.7.0(004*A)\r\n"
+		"1-0:21.7.0(00.000*kW)\r\n"
+		"1-0:41.7.0(00.000*kW)\r\n"
+		"1-0:61.7.0(00.000*kW)\r\n"
+		"1-0:22.7.0(00.781*kW)\r\n"
+		"1-0:42.7.0(00.772*kW)\r\n"
+		"1-0:62.7.0(00.792*kW)\r\n"
+		"0-1:24.1.0(003)\r\n"
+		"0-1:96.1.0(4730303533303033363639323537323136)\r\n"
+		"0-1:24.2.1(230301083000W)(01234.567*m3)\r\n"
+		"!CA91\r\n"},
+};
+
+#define DSMR_CORPUS_COUNT (sizeof(dsmrCorpus) / sizeof(dsmrCorpus[0]))
+
+#endif // DSMR_CORPUS_H
@@ -0,0 +1,250 @@
+// Serial line fault injector for the telegram framer (host only, [env:native_faults]).
+//
+// Each trial feeds four copies of a corpus telegram into processP1Bytes(),
+// with one fault applied to the second copy:
+//
+//   bitflip        one bit flipped inside the telegram
+//   drop_byte      one byte removed
+//   missing_start  the '/' removed
+//   missing_end    the '!' removed
+//   lost_crlf      the CR/LF after the checksum removed
+//   truncated      the telegram cut off at a random point
+//   garbage        1-64 random bytes (no '/') between two telegrams
+//   baud_glitch    a run of 8-64 bytes replaced by random bytes
+//
+// and counts, per fault, the intact telegrams that did not come out of the
+// framer, corrupted telegrams that did, the bytes that were not part of a
+// delivered telegram, and how far after the fault the next delivered telegram
+// started. One JSON object per fault type and telegram goes to stdout.
+//
+//   FAULT_TRIALS   trials per fault type (default 1000)
+//   BENCH_COMMIT   label stored in every result
+
+#include <Arduino.h>
+#include <vector>
+#include <string>
+#include "config.h"
+#include "p1_handler.h"
+#include "p1_aggregator.h"
+#include "custom_log.h"
+#include "dsmr_corpus.h"
+
+#define FAULT_COPIES    4       // telegrams per trial
+#define FAULT_COPY      1       // the copy that gets the fault
+
+enum FaultType {
+	FAULT_BITFLIP,
+	FAULT_DROP_BYTE,
+	FAULT_MISSING_START,
+	FAULT_MISSING_END,
+	FAULT_LOST_CRLF,
+	FAULT_TRUNCATED,
+	FAULT_GARBAGE,
+	FAULT_BAUD_GLITCH,
+	FAULT_TYPE_COUNT
+};
+
+static const char* faultNames[FAULT_TYPE_COUNT] = {
+	"bitflip", "drop_byte", "missing_start", "missing_end",
+	"lost_crlf", "truncated", "garbage", "baud_glitch"
+};
+
+// Reproducible runs
+static uint32_t randomState = 0x12345678;
+
+static uint32_t nextRandom() {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static uint32_t randomBelow(uint32_t limit) {
+	return nextRandom() % limit;
+}
+
+static uint8_t randomByte(bool allowStart) {
+	uint8_t b;
+	do {
+		b = (uint8_t)nextRandom();
+	} while (!allowStart && b == P1_START_CHAR);
+	return b;
+}
+
+// One contiguous piece of the fed stream
+struct Segment {
+	size_t start;
+	size_t end;
+	bool intact;                // an unmodified copy of the telegram
+};
+
+static std::string cleanTelegram;
+static std::vector<Segment> segments;
+static size_t feedOffset = 0;
+static uint32_t intactDelivered = 0;
+static uint32_t corruptDelivered = 0;
+static size_t faultSegment = 0;
+static long firstDeliveredStart = -1;   // start of the first intact telegram delivered from the fault on
+
+static void onTelegram(const String& telegram, const P1Reading* reading) {
+	(void)reading;
+	if (telegram.length() != cleanTelegram.length() || memcmp(telegram.c_str(), cleanTelegram.data(), cleanTelegram.length()) != 0) {
+		corruptDelivered++;
+		return;
+	}
+	intactDelivered++;
+
+	// The byte just fed finished this telegram; find the segment it started in
+	for (size_t i = 0; i < segments.size(); i++) {
+		if (feedOffset > segments[i].start && feedOffset <= segments[i].end) {
+			if (i >= faultSegment && firstDeliveredStart < 0) {
+				firstDeliveredStart = (long)segments[i].start;
+			}
+			break;
+		}
+	}
+}
+
+static std::string applyFault(FaultType fault, const std::string& telegram, std::string& prefix) {
+	std::string out = telegram;
+	size_t bang = telegram.find(P1_END_CHAR);
+	// Anywhere after the '/' up to the last checksum character
+	size_t position = 1 + randomBelow(min(telegram.size() - 2, bang + 5) - 1);
+	switch (fault) {
+		case FAULT_BITFLIP:
+			out[position] ^= (char)(1 << randomBelow(8));
+			break;
+		case FAULT_DROP_BYTE:
+			out.erase(position, 1);
+			break;
+		case FAULT_MISSING_START:
+			out.erase(0, 1);
+			break;
+		case FAULT_MISSING_END:
+			out.erase(bang, 1);
+			break;
+		case FAULT_LOST_CRLF:
+			out.erase(out.size() - 2);
+			break;
+		case FAULT_TRUNCATED:
+			out.erase(1 + randomBelow(out.size() - 2));
+			break;
+		case FAULT_GARBAGE:
+			for (uint32_t n = 1 + randomBelow(64); n > 0; n--) {
+				prefix += (char)randomByte(false);
+			}
+			break;
+		case FAULT_BAUD_GLITCH: {
+			size_t length = 8 + randomBelow(57);
+			size_t start = randomBelow(out.size() - length);
+			for (size_t i = 0; i < length; i++) {
+				out[start + i] = (char)randomByte(true);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+	return out;
+}
+
+static void feed(const std::string& data) {
+	for (size_t i = 0; i < data.size(); i++) {
+		feedOffset++;
+		processP1Bytes((const uint8_t*)data.data() + i, 1);
+	}
+}
+
+static void runFault(FaultType fault, const DsmrCorpusEntry& entry, uint32_t trials, const char* commit) {
+	cleanTelegram = entry.telegram;
+
+	uint64_t lostTelegrams = 0;
+	uint64_t lostBytes = 0;
+	uint64_t corrupt = 0;
+	uint64_t resyncBytes = 0;
+	uint32_t resyncTrials = 0;
+	P1FramerStats before;
+	getP1FramerStats(before);
+
+	for (uint32_t trial = 0; trial < trials; trial++) {
+		// Build the trial stream
+		std::string stream;
+		segments.clear();
+		size_t faultOffset = 0;
+		for (int copy = 0; copy < FAULT_COPIES; copy++) {
+			std::string prefix;
+			std::string telegram = cleanTelegram;
+			if (copy == FAULT_COPY) {
+				telegram = applyFault(fault, cleanTelegram, prefix);
+				faultOffset = feedOffset + stream.size();
+				faultSegment = segments.size();
+				if (!prefix.empty()) {
+					segments.push_back({feedOffset + stream.size(), feedOffset + stream.size() + prefix.size(), false});
+					stream += prefix;
+				}
+			}
+			segments.push_back({feedOffset + stream.size(), feedOffset + stream.size() + telegram.size(), telegram == cleanTelegram});
+			stream += telegram;
+		}
+
+		intactDelivered = 0;
+		corruptDelivered = 0;
+		firstDeliveredStart = -1;
+		size_t streamBytes = stream.size();
+		feed(stream);
+
+		// Intact telegrams in the trial that should have come through
+		uint32_t expected = 0;
+		for (size_t i = 0; i < segments.size(); i++) {
+			if (segments[i].intact) expected++;
+		}
+		// A lost CR/LF leaves the telegram itself intact
+		if (fault == FAULT_LOST_CRLF) expected++;
+
+		lostTelegrams += expected > intactDelivered ? expected - intactDelivered : 0;
+		corrupt += corruptDelivered;
+		size_t deliveredBytes = (size_t)intactDelivered * cleanTelegram.size();
+		lostBytes += streamBytes > deliveredBytes ? streamBytes - deliveredBytes : 0;
+		if (firstDeliveredStart >= 0) {
+			resyncBytes += (size_t)firstDeliveredStart - faultOffset;
+			resyncTrials++;
+		}
+	}
+
+	P1FramerStats after;
+	getP1FramerStats(after);
+
+	double resync = resyncTrials ? (double)resyncBytes / resyncTrials : -1;
+	double resyncMs = resync >= 0 ? resync * 10000.0 / P1_BAUD_RATE : -1;
+	printf("{\"commit\":\"%s\",\"bench\":\"fault\",\"fault\":\"%s\",\"corpus\":\"%s\",\"trials\":%u,"
+		   "\"telegrams_lost_per_fault\":%.3f,\"corrupt_delivered_per_fault\":%.3f,\"bytes_lost_per_fault\":%.1f,"
+		   "\"resync_bytes\":%.1f,\"resync_ms\":%.2f,\"crc_errors\":%u,\"abandoned\":%u}\n",
+		   commit, faultNames[fault], entry.name, trials,
+		   (double)lostTelegrams / trials, (double)corrupt / trials, (double)lostBytes / trials,
+		   resync, resyncMs, after.crcErrors - before.crcErrors, after.abandoned - before.abandoned);
+	fprintf(stderr, "%-14s %-20s lost %6.3f telegrams %8.1f bytes, corrupt passed %6.3f, resync %7.1f bytes (%6.2f ms)\n",
+			faultNames[fault], entry.name, (double)lostTelegrams / trials, (double)lostBytes / trials,
+			(double)corrupt / trials, resync, resyncMs);
+}
+
+int main(int argc, char** argv) {
+	(void)argc;
+	(void)argv;
+	halBegin();
+
+	const char* trialsEnv = getenv("FAULT_TRIALS");
+	const char* commit = getenv("BENCH_COMMIT");
+	uint32_t trials = trialsEnv ? (uint32_t)strtoul(trialsEnv, nullptr, 10) : 1000;
+	if (!commit) commit = "unknown";
+
+	LOG_SET_LEVEL(DebugLogLevel::LVL_ERROR);
+	initializeAggregator();
+	addP1TelegramCallback(onTelegram);
+
+	for (size_t c = 0; c < DSMR_CORPUS_COUNT; c++) {
+		for (int fault = 0; fault < FAULT_TYPE_COUNT; fault++) {
+			runFault((FaultType)fault, dsmrCorpus[c], trials, commit);
+		}
+	}
+	return 0;
+}
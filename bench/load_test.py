@@ -0,0 +1,471 @@
+#!/usr/bin/env python3
+"""
+End-to-end load and latency test for the native build of the bridge.
+
+Starts the native program with its UART fed over TCP (P1_SERIAL=tcp:PORT),
+plays a virtual meter into it and opens P1, HTTP and log clients against it,
+all on localhost. Every telegram carries a sequence number in its text message
+(0-0:96.13.0), so each P1 client can measure serial-to-socket latency and spot
+missing telegrams.
+
+Usage:
+    pio run -e native
+    python bench/load_test.py --duration 60 --rate 1 --p1-clients 2 --slow-clients 1
+
+The report (stdout, or --report FILE) is JSON. The exit status is 1 when a
+gate fails (--max-p99-ms, --max-drop-rate, --max-http-error-rate), so the
+script can gate a release.
+"""
+
+import argparse
+import json
+import os
+import random
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+SERVER_PORT = 2000
+LOG_SERVER_PORT = 2001
+HTTP_INFO_PORT = 80
+
+
+def crc16(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def percentile(values, p):
+    if not values:
+        return None
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+class Meter:
+    """Virtual DSMR 5.0 meter writing telegrams into the bridge UART feed."""
+
+    def __init__(self, port, rate, baud, noise, duration):
+        self.port = port
+        self.interval = 1.0 / rate
+        self.baud = baud
+        self.noise = noise
+        self.duration = duration
+        self.sent = {}          # sequence -> monotonic time its checksum chunk was written
+        self.faulted = set()    # sequences deliberately corrupted
+        self.bytes_sent = 0
+        self.started = None
+        self.done = threading.Event()
+
+    def telegram(self, seq):
+        now = time.gmtime()
+        text = ("seq=%d" % seq).encode().hex().upper()
+        power = 500 + (seq * 37) % 3000
+        lines = [
+            "/SIM5\\2SIMULATED-METER", "",
+            "1-3:0.2.8(50)",
+            time.strftime("0-0:1.0.0(%y%m%d%H%M%SW)", now),
+            "1-0:1.8.1(%010.3f*kWh)" % (1000 + seq * 0.001),
+            "1-0:1.8.2(%010.3f*kWh)" % 2000,
+            "1-0:2.8.1(%010.3f*kWh)" % 100,
+            "1-0:2.8.2(%010.3f*kWh)" % 200,
+            "0-0:96.14.0(0002)",
+            "1-0:1.7.0(%06.3f*kW)" % (power / 1000.0),
+            "1-0:2.7.0(00.000*kW)",
+            "0-0:96.13.0(%s)" % text,
+            "1-0:32.7.0(230.1*V)", "1-0:52.7.0(231.0*V)", "1-0:72.7.0(229.5*V)",
+            "1-0:31.7.0(002*A)", "1-0:51.7.0(001*A)", "1-0:71.7.0(003*A)",
+            "0-1:24.1.0(003)",
+            "0-1:24.2.1(%s)(%09.3f*m3)" % (time.strftime("%y%m%d%H%M%SW", now), 1234 + seq * 0.001),
+        ]
+        body = ("\r\n".join(lines) + "\r\n!").encode()
+        return body + ("%04X\r\n" % crc16(body)).encode()
+
+    def corrupt(self, data):
+        data = bytearray(data)
+        fault = random.choice(["flip", "drop", "garbage"])
+        if fault == "flip":
+            data[random.randrange(1, len(data) - 8)] ^= 1 << random.randrange(8)
+        elif fault == "drop":
+            del data[random.randrange(1, len(data) - 8)]
+        else:
+            data = bytearray(os.urandom(random.randrange(1, 32)).replace(b"/", b"?")) + data
+        return bytes(data)
+
+    def run(self):
+        # The feed port only opens once the bridge starts its UART, and it
+        # accepts a single connection, so retry instead of probing it
+        deadline = time.monotonic() + 30
+        while True:
+            try:
+                sock = socket.create_connection(("127.0.0.1", self.port))
+                break
+            except OSError:
+                if time.monotonic() > deadline:
+                    self.done.set()
+                    raise
+                time.sleep(0.2)
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        seconds_per_byte = 10.0 / self.baud if self.baud > 0 else 0
+        start = self.started = time.monotonic()
+        seq = 0
+        try:
+            while time.monotonic() - start < self.duration:
+                due = start + seq * self.interval
+                delay = due - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+                data = self.telegram(seq)
+                if self.noise > 0 and random.random() < self.noise:
+                    data = self.corrupt(data)
+                    self.faulted.add(seq)
+                # Pace the bytes like the UART would. The framer completes a
+                # telegram at its last checksum character, so latency counts
+                # from the moment the chunk holding it is handed over.
+                complete = data.rfind(b"!") + 4
+                for offset in range(0, len(data), 64):
+                    chunk = data[offset:offset + 64]
+                    if seq not in self.sent and offset + 64 > complete:
+                        self.sent[seq] = time.monotonic()
+                    sock.sendall(chunk)
+                    if self.baud > 0:
+                        time.sleep(len(chunk) * seconds_per_byte)
+                self.bytes_sent += len(data)
+                seq += 1
+        finally:
+            self.done.set()
+            sock.close()
+
+
+class P1Client:
+    """TCP client on the P1 port. A slow client reads a few bytes at a time."""
+
+    def __init__(self, name, port, meter, slow=False):
+        self.name = name
+        self.port = port
+        self.meter = meter
+        self.slow = slow
+        self.latencies = []
+        self.received = set()
+        self.corrupted = 0      # telegrams forwarded with a wrong checksum
+        self.unexpected = 0     # sequences the meter had not finished sending
+        self.bytes = 0
+        self.kicked = False
+        self.closed = False
+
+    def run(self):
+        sock = socket.create_connection(("127.0.0.1", self.port))
+        if self.slow:
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1024)
+        sock.settimeout(0.5)
+        buffer = b""
+        while not self.meter.done.is_set():
+            try:
+                data = sock.recv(64 if self.slow else 65536)
+            except socket.timeout:
+                continue
+            except OSError:
+                self.closed = True
+                break
+            if not data:
+                self.closed = True
+                break
+            now = time.monotonic()
+            self.bytes += len(data)
+            buffer += data
+            if b"Connection terminated" in buffer:
+                self.kicked = True
+            buffer = self.consume(buffer, now)
+            if self.slow:
+                time.sleep(0.25)
+        sock.close()
+
+    def consume(self, buffer, now):
+        while True:
+            start = buffer.find(b"/")
+            if start < 0:
+                return b""
+            end = buffer.find(b"!", start)
+            if end < 0 or len(buffer) < end + 7:
+                return buffer[start:]
+            telegram = buffer[start:end + 7]
+            buffer = buffer[end + 7:]
+            try:
+                valid = int(telegram[end - start + 1:end - start + 5], 16) == crc16(telegram[:end - start + 1])
+            except ValueError:
+                valid = False
+            if not valid:
+                self.corrupted += 1
+                continue
+            marker = telegram.find(b"0-0:96.13.0(")
+            if marker < 0:
+                continue
+            text = telegram[marker + 12:telegram.find(b")", marker)]
+            try:
+                seq = int(bytes.fromhex(text.decode()).decode().split("=")[1])
+            except (ValueError, IndexError, UnicodeDecodeError):
+                continue
+            if seq not in self.meter.sent:
+                self.unexpected += 1
+            elif seq not in self.received:
+                self.received.add(seq)
+                self.latencies.append((now - self.meter.sent[seq]) * 1000.0)
+
+
+class HTTPClient:
+    """Polls a page with a fresh connection per request, like a browser would."""
+
+    def __init__(self, name, port, path, interval, meter):
+        self.name = name
+        self.port = port
+        self.path = path
+        self.interval = interval
+        self.meter = meter
+        self.latencies = []
+        self.errors = 0
+        self.bytes = 0
+
+    def run(self):
+        while not self.meter.done.is_set():
+            start = time.monotonic()
+            try:
+                sock = socket.create_connection(("127.0.0.1", self.port), timeout=5)
+                sock.sendall(("GET %s HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n" % self.path).encode())
+                response = b""
+                while True:
+                    data = sock.recv(65536)
+                    if not data:
+                        break
+                    response += data
+                sock.close()
+                if response.startswith(b"HTTP/1.1 200"):
+                    self.latencies.append((time.monotonic() - start) * 1000.0)
+                    self.bytes += len(response)
+                else:
+                    self.errors += 1
+            except OSError:
+                self.errors += 1
+            time.sleep(self.interval)
+
+
+class LogClient:
+    def __init__(self, name, port, meter):
+        self.name = name
+        self.port = port
+        self.meter = meter
+        self.bytes = 0
+        self.lines = 0
+        self.closed = False
+
+    def run(self):
+        sock = socket.create_connection(("127.0.0.1", self.port))
+        sock.settimeout(0.5)
+        while not self.meter.done.is_set():
+            try:
+                data = sock.recv(65536)
+            except socket.timeout:
+                continue
+            except OSError:
+                self.closed = True
+                break
+            if not data:
+                self.closed = True
+                break
+            self.bytes += len(data)
+            self.lines += data.count(b"\n")
+        sock.close()
+
+
+def wait_for_port(port, timeout):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        try:
+            socket.create_connection(("127.0.0.1", port), timeout=1).close()
+            return True
+        except OSError:
+            time.sleep(0.2)
+    return False
+
+
+def latency_summary(values):
+    return {
+        "count": len(values),
+        "p50_ms": percentile(values, 50),
+        "p90_ms": percentile(values, 90),
+        "p99_ms": percentile(values, 99),
+        "max_ms": max(values) if values else None,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Load and latency test against the native bridge")
+    parser.add_argument("--bridge", default=".pio/build/native/program", help="native program to start")
+    parser.add_argument("--attach", action="store_true", help="use a bridge that is already running")
+    parser.add_argument("--port-offset", type=int, default=8000, help="P1_PORT_OFFSET for the bridge")
+    parser.add_argument("--feed-port", type=int, default=9100, help="TCP port feeding the bridge UART")
+    parser.add_argument("--duration", type=float, default=30, help="seconds of meter traffic")
+    parser.add_argument("--rate", type=float, default=1, help="telegrams per second")
+    parser.add_argument("--baud", type=int, default=115200, help="UART pacing, 0 for no pacing")
+    parser.add_argument("--noise", type=float, default=0, help="fraction of telegrams to corrupt")
+    parser.add_argument("--p1-clients", type=int, default=2)
+    parser.add_argument("--slow-clients", type=int, default=0)
+    parser.add_argument("--http-clients", type=int, default=1)
+    parser.add_argument("--http-path", default="/api/aggregates")
+    parser.add_argument("--http-interval", type=float, default=0.5)
+    parser.add_argument("--log-clients", type=int, default=1)
+    parser.add_argument("--report", help="write the JSON report to this file")
+    parser.add_argument("--max-p99-ms", type=float, help="gate: P1 latency p99")
+    parser.add_argument("--max-drop-rate", type=float, default=0,
+                        help="gate: fraction of clean telegrams lost (default: 0, any drop fails)")
+    parser.add_argument("--max-http-error-rate", type=float, help="gate: fraction of failed HTTP requests")
+    args = parser.parse_args()
+
+    p1_port = SERVER_PORT + args.port_offset
+    log_port = LOG_SERVER_PORT + args.port_offset
+    http_port = HTTP_INFO_PORT + args.port_offset
+
+    bridge = None
+    if not args.attach:
+        env = dict(os.environ,
+                   P1_SERIAL="tcp:%d" % args.feed_port,
+                   P1_PORT_OFFSET=str(args.port_offset),
+                   P1_NATIVE_FS=tempfile.mkdtemp(prefix="p1_load_"))
+        bridge = subprocess.Popen([args.bridge], env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        if not wait_for_port(http_port, 30):
+            print("bridge did not start listening on port %d" % http_port, file=sys.stderr)
+            return 2
+
+        meter = Meter(args.feed_port, args.rate, args.baud, args.noise, args.duration)
+        p1_clients = [P1Client("p1-%d" % i, p1_port, meter) for i in range(args.p1_clients)]
+        p1_clients += [P1Client("slow-%d" % i, p1_port, meter, slow=True) for i in range(args.slow_clients)]
+        http_clients = [HTTPClient("http-%d" % i, http_port, args.http_path, args.http_interval, meter)
+                        for i in range(args.http_clients)]
+        log_clients = [LogClient("log-%d" % i, log_port, meter) for i in range(args.log_clients)]
+
+        threads = []
+        for client in p1_clients + log_clients:
+            threads.append(threading.Thread(target=client.run, daemon=True))
+            threads[-1].start()
+            time.sleep(0.1)     # connect in order, so kicks hit the oldest client
+        for client in http_clients:
+            threads.append(threading.Thread(target=client.run, daemon=True))
+            threads[-1].start()
+
+        meter.run()
+        elapsed = time.monotonic() - meter.started
+        time.sleep(1)           # let the last telegram arrive
+        for thread in threads:
+            thread.join(timeout=5)
+    finally:
+        if bridge:
+            bridge.terminate()
+            bridge.wait()
+
+    clean = [seq for seq in meter.sent if seq not in meter.faulted]
+    report = {
+        "config": vars(args),
+        "meter": {"telegrams": len(meter.sent), "faulted": len(meter.faulted), "bytes": meter.bytes_sent,
+                  "seconds": round(elapsed, 2)},
+        "p1_clients": [],
+        "http_clients": [],
+        "log_clients": [],
+    }
+
+    all_latencies = []
+    lost = 0
+    expected = 0
+    corrupted = 0
+    unexpected = 0
+    for client in p1_clients:
+        missing = [seq for seq in clean if seq not in client.received]
+        report["p1_clients"].append({
+            "name": client.name,
+            "received": len(client.received),
+            "missing": len(missing),
+            "corrupted": client.corrupted,
+            "unexpected": client.unexpected,
+            "bytes": client.bytes,
+            "throughput_bps": round(client.bytes / elapsed),
+            "kicked": client.kicked,
+            "closed": client.closed,
+            "latency": latency_summary(client.latencies),
+        })
+        if not client.slow:
+            all_latencies += client.latencies
+            lost += len(missing)
+            expected += len(clean)
+        corrupted += client.corrupted
+        unexpected += client.unexpected
+
+    http_requests = 0
+    http_errors = 0
+    for client in http_clients:
+        report["http_clients"].append({
+            "name": client.name,
+            "requests": len(client.latencies) + client.errors,
+            "errors": client.errors,
+            "bytes": client.bytes,
+            "latency": latency_summary(client.latencies),
+        })
+        http_requests += len(client.latencies) + client.errors
+        http_errors += client.errors
+
+    for client in log_clients:
+        report["log_clients"].append({"name": client.name, "bytes": client.bytes, "lines": client.lines,
+                                      "closed": client.closed})
+
+    drop_rate = lost / expected if expected else 0.0
+    http_error_rate = http_errors / http_requests if http_requests else 0.0
+    p99 = percentile(all_latencies, 99)
+    report["summary"] = {
+        "latency": latency_summary(all_latencies),
+        "drop_rate": drop_rate,
+        "corrupted": corrupted,
+        "unexpected": unexpected,
+        "kicks": sum(1 for client in p1_clients if client.kicked),
+        "http_error_rate": http_error_rate,
+        "http_requests_per_s": round(http_requests / elapsed, 1),
+    }
+
+    failures = []
+    if args.max_p99_ms is not None and (p99 is None or p99 > args.max_p99_ms):
+        failures.append("p99 latency %s ms > %s ms" % (p99, args.max_p99_ms))
+    if drop_rate > args.max_drop_rate:
+        failures.append("drop rate %.4f > %s" % (drop_rate, args.max_drop_rate))
+    # Corrupted telegrams must not get past the CRC check, and a telegram
+    # that arrives before the meter sent it means the matching is broken
+    if corrupted:
+        failures.append("%d corrupted telegrams forwarded" % corrupted)
+    if unexpected:
+        failures.append("%d telegrams not matched to a send" % unexpected)
+    if args.max_http_error_rate is not None and http_error_rate > args.max_http_error_rate:
+        failures.append("HTTP error rate %.4f > %s" % (http_error_rate, args.max_http_error_rate))
+    report["gates"] = {"passed": not failures, "failures": failures}
+
+    output = json.dumps(report, indent=2)
+    if args.report:
+        with open(args.report, "w") as f:
+            f.write(output + "\n")
+    else:
+        print(output)
+
+    summary = report["summary"]["latency"]
+    print("telegrams %d, p50 %s ms, p99 %s ms, drop rate %.4f, kicks %d, HTTP errors %d/%d (%.1f req/s): %s" % (
+        len(meter.sent), summary["p50_ms"] and round(summary["p50_ms"], 2),
+        p99 and round(p99, 2), drop_rate, report["summary"]["kicks"], http_errors, http_requests,
+        report["summary"]["http_requests_per_s"],
+        "PASS" if not failures else "FAIL (" + "; ".join(failures) + ")"), file=sys.stderr)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+"""
+P1 Bridge Binary Client
+
+Connects to the P1 port of the bridge, switches the connection to binary
+frames (see include/p1_binary.h) and prints the decoded values of every
+telegram together with the bytes it took on the wire. With --compare a second,
+plain connection receives the same telegrams as text, so both sizes can be
+compared side by side.
+"""
+
+import argparse
+import socket
+import sys
+import threading
+from datetime import datetime, timedelta
+
+# Configuration
+BRIDGE_IP = "192.168.1.100"  # Default - replace with actual DHCP assigned IP
+BRIDGE_PORT = 2000
+
+HELLO = b"P1B\x01"
+COMMAND = b"binary\n"
+
+# Items in frame order: the values of src/p1_values.cpp, then the meter time
+VALUES = [
+    ("dsmr_version", 0), ("tariff", 0),
+    ("energy_delivered_t1_kwh", 3), ("energy_delivered_t2_kwh", 3),
+    ("energy_returned_t1_kwh", 3), ("energy_returned_t2_kwh", 3),
+    ("power_delivered_w", 0), ("power_returned_w", 0),
+    ("power_failures", 0), ("long_power_failures", 0),
+    ("voltage_l1_v", 1), ("voltage_l2_v", 1), ("voltage_l3_v", 1),
+    ("current_l1_a", 3), ("current_l2_a", 3), ("current_l3_a", 3),
+    ("power_delivered_l1_w", 0), ("power_delivered_l2_w", 0), ("power_delivered_l3_w", 0),
+    ("power_returned_l1_w", 0), ("power_returned_l2_w", 0), ("power_returned_l3_w", 0),
+    ("gas_m3", 3), ("water_m3", 3),
+]
+ITEM_TIME = len(VALUES)
+ITEM_COUNT = ITEM_TIME + 1
+METER_EPOCH = datetime(2020, 1, 1)
+
+
+class FrameError(Exception):
+    pass
+
+
+def read_varint(data, offset):
+    """Unsigned LEB128 varint at offset; returns (value, next offset)"""
+    value = 0
+    shift = 0
+    while True:
+        if offset >= len(data) or shift > 28:
+            raise FrameError("truncated varint")
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, offset
+        shift += 7
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def to_int32(value):
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+class BinaryDecoder:
+    """Keeps the items of the last frame, which the next delta applies to"""
+
+    def __init__(self):
+        self.items = None
+
+    def decode(self, frame_type, body):
+        mask, offset = read_varint(body, 0)
+        if frame_type == ord('K'):
+            items = [None] * ITEM_COUNT
+        elif frame_type == ord('D'):
+            if self.items is None:
+                raise FrameError("delta before the first keyframe")
+            items = list(self.items)
+        else:
+            raise FrameError(f"unknown frame type {frame_type:#x}")
+
+        for i in range(ITEM_COUNT):
+            if not mask & (1 << i):
+                continue
+            raw, offset = read_varint(body, offset)
+            value = unzigzag(raw)
+            if frame_type == ord('D'):
+                if items[i] is None:
+                    raise FrameError(f"delta for missing item {i}")
+                value = to_int32(items[i] + value)
+            items[i] = value
+        if offset != len(body):
+            raise FrameError("trailing bytes in frame")
+        self.items = items
+        return items
+
+
+def format_items(items):
+    """The values in their units, as name=value pairs"""
+    parts = []
+    if items[ITEM_TIME] is not None:
+        seconds, summer = divmod(items[ITEM_TIME], 2)
+        meter_time = METER_EPOCH + timedelta(seconds=seconds)
+        parts.append(f"meter_time={meter_time:%Y-%m-%d %H:%M:%S}{'S' if summer else 'W'}")
+    for (name, decimals), value in zip(VALUES, items):
+        if value is None:
+            continue
+        parts.append(f"{name}={value / 10 ** decimals:.{decimals}f}" if decimals else f"{name}={value}")
+    return " ".join(parts)
+
+
+class RawCounter(threading.Thread):
+    """Counts the bytes of the plain text telegrams on a second connection"""
+
+    def __init__(self, host, port):
+        super().__init__(daemon=True)
+        self.sock = socket.create_connection((host, port), timeout=10)
+        self.bytes = 0
+        self.telegrams = 0
+        self.lock = threading.Lock()
+
+    def run(self):
+        seen_start = False
+        while True:
+            try:
+                data = self.sock.recv(4096)
+            except OSError:
+                return
+            if not data:
+                return
+            # Bytes before the first '/' are telnet negotiation
+            if not seen_start:
+                start = data.find(b'/')
+                if start < 0:
+                    continue
+                data = data[start:]
+                seen_start = True
+            with self.lock:
+                self.bytes += len(data)
+                self.telegrams += data.count(b'!')
+
+    def average(self):
+        with self.lock:
+            return self.bytes / self.telegrams if self.telegrams else 0
+
+
+class BinaryClient:
+    def __init__(self, host, port, quiet):
+        self.host = host
+        self.port = port
+        self.quiet = quiet
+        self.decoder = BinaryDecoder()
+        self.frames = 0
+        self.keyframes = 0
+        self.frame_bytes = 0
+
+    def receive(self, sock, buffer, count):
+        while len(buffer) < count:
+            data = sock.recv(4096)
+            if not data:
+                raise ConnectionError("connection closed by the bridge")
+            buffer += data
+        return buffer
+
+    def run(self, raw_counter=None, limit=0):
+        sock = socket.create_connection((self.host, self.port), timeout=30)
+        sock.sendall(COMMAND)
+        print(f"Connected to {self.host}:{self.port}, waiting for binary frames")
+
+        # Telnet negotiation and a telegram sent before the switch come first
+        buffer = b""
+        while True:
+            buffer = self.receive(sock, buffer, len(buffer) + 1)
+            if HELLO in buffer:
+                break
+            buffer = buffer[-(len(HELLO) - 1):]
+        buffer = buffer[buffer.index(HELLO) + len(HELLO):]
+
+        while not limit or self.frames < limit:
+            buffer = self.receive(sock, buffer, 2)
+            length = buffer[1]
+            buffer = self.receive(sock, buffer, 2 + length)
+            frame_type, body = buffer[0], buffer[2:2 + length]
+            buffer = buffer[2 + length:]
+
+            items = self.decoder.decode(frame_type, body)
+            self.frames += 1
+            self.frame_bytes += 2 + length
+            if frame_type == ord('K'):
+                self.keyframes += 1
+            if not self.quiet:
+                kind = "key" if frame_type == ord('K') else "delta"
+                print(f"{datetime.now():%H:%M:%S} {kind:5} {2 + length:3} B  {format_items(items)}")
+        sock.close()
+        self.report(raw_counter)
+
+    def report(self, raw_counter):
+        if not self.frames:
+            return
+        average = self.frame_bytes / self.frames
+        print(f"\n{self.frames} frames ({self.keyframes} keyframes), {average:.1f} bytes per telegram")
+        if raw_counter and raw_counter.average():
+            raw = raw_counter.average()
+            print(f"as text: {raw:.1f} bytes per telegram, {raw / average:.1f}x the binary size")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the binary frames of the P1 bridge")
+    parser.add_argument("host", nargs="?", default=BRIDGE_IP)
+    parser.add_argument("port", nargs="?", type=int, default=BRIDGE_PORT)
+    parser.add_argument("--compare", action="store_true",
+                        help="also receive the text telegrams on a second connection and compare sizes")
+    parser.add_argument("--count", type=int, default=0, help="stop after this many frames (default: run until Ctrl+C)")
+    parser.add_argument("--quiet", action="store_true", help="only print the size report")
+    args = parser.parse_args()
+
+    raw_counter = None
+    if args.compare:
+        raw_counter = RawCounter(args.host, args.port)
+        raw_counter.start()
+
+    client = BinaryClient(args.host, args.port, args.quiet)
+    try:
+        client.run(raw_counter, args.count)
+    except KeyboardInterrupt:
+        client.report(raw_counter)
+    except (OSError, ConnectionError, FrameError) as e:
+        print(f"Error: {e}")
+        client.report(raw_counter)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
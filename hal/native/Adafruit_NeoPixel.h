@@ -0,0 +1,27 @@
+#ifndef HAL_NATIVE_ADAFRUIT_NEOPIXEL_H
+#define HAL_NATIVE_ADAFRUIT_NEOPIXEL_H
+
+// Native stand-in for the status LED: keeps the last colour, draws nothing.
+
+#include <Arduino.h>
+
+#define NEO_GRB    0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+	Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type) { (void)n; (void)pin; (void)type; }
+	void begin() {}
+	void show() {}
+	void setBrightness(uint8_t brightness) { (void)brightness; }
+	void setPixelColor(uint16_t n, uint32_t c) { (void)n; color = c; }
+	uint32_t getPixelColor(uint16_t n) const { (void)n; return color; }
+	static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+		return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+	}
+
+private:
+	uint32_t color = 0;
+};
+
+#endif // HAL_NATIVE_ADAFRUIT_NEOPIXEL_H
@@ -0,0 +1,106 @@
+#ifndef HAL_NATIVE_ARDUINO_H
+#define HAL_NATIVE_ARDUINO_H
+
+// Native (Linux) implementation of the Arduino core subset used by the bridge.
+// Only compiled in [env:native]; the RP2040 build uses the real framework.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <ctype.h>
+
+// Lets shared code pick host replacements for hardware-only features
+#define HAL_NATIVE 1
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT         0x0
+#define OUTPUT        0x1
+#define INPUT_PULLUP  0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define SERIAL_8N1 0x06
+
+#define PIN_NEOPIXEL 16
+
+#define PROGMEM
+#define PGM_P const char*
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define F(str) (str)
+
+#define digitalPinToInterrupt(p) (p)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*callback)(), int mode);
+void noInterrupts();
+void interrupts();
+
+long random(long max);
+long random(long min, long max);
+
+inline uint16_t word(uint8_t high, uint8_t low) {
+	return (uint16_t)((high << 8) | low);
+}
+
+#ifdef __cplusplus
+template <class T, class L>
+auto min(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+	return (b < a) ? b : a;
+}
+
+template <class T, class L>
+auto max(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+	return (a < b) ? b : a;
+}
+#endif
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+
+// Stand-in for the arduino-pico `rp2040` helper object
+class RP2040 {
+public:
+	void reboot();
+	int getFreeHeap();
+	int getUsedHeap();
+	int getTotalHeap();
+	int cpuid() { return 0; }
+};
+
+extern RP2040 rp2040;
+
+// Entry points provided by the sketch (src/main.cpp)
+void setup();
+void loop();
+
+// Start the HAL clock. main() does this before setup(); programs built with
+// HAL_NATIVE_NO_MAIN (benchmarks, load tools) call it themselves.
+void halBegin();
+
+#endif // HAL_NATIVE_ARDUINO_H
@@ -0,0 +1,48 @@
+#ifndef HAL_NATIVE_DEBUGLOG_H
+#define HAL_NATIVE_DEBUGLOG_H
+
+// Native stand-in for hideakitai/DebugLog: same macros, printed to stdout.
+
+#include <Arduino.h>
+
+enum class DebugLogLevel {
+	LVL_NONE = 0,
+	LVL_ERROR = 1,
+	LVL_WARN = 2,
+	LVL_INFO = 3,
+	LVL_DEBUG = 4,
+	LVL_TRACE = 5
+};
+
+namespace halDebugLog {
+	extern DebugLogLevel level;
+
+	inline void printArgs() {}
+
+	template <typename T, typename... Rest>
+	void printArgs(const T& first, const Rest&... rest) {
+		Serial.print(first);
+		if (sizeof...(rest) > 0) Serial.print(" ");
+		printArgs(rest...);
+	}
+
+	template <typename... Args>
+	void log(DebugLogLevel lvl, const char* tag, const Args&... args) {
+		if ((int)lvl > (int)level) return;
+		Serial.print("[");
+		Serial.print(tag);
+		Serial.print("] ");
+		printArgs(args...);
+		Serial.println();
+	}
+}
+
+#define LOG_SET_LEVEL(lvl) (halDebugLog::level = (lvl))
+#define LOG_GET_LEVEL() (halDebugLog::level)
+#define LOG_ERROR(...) halDebugLog::log(DebugLogLevel::LVL_ERROR, "ERROR", __VA_ARGS__)
+#define LOG_WARN(...)  halDebugLog::log(DebugLogLevel::LVL_WARN, "WARN", __VA_ARGS__)
+#define LOG_INFO(...)  halDebugLog::log(DebugLogLevel::LVL_INFO, "INFO", __VA_ARGS__)
+#define LOG_DEBUG(...) halDebugLog::log(DebugLogLevel::LVL_DEBUG, "DEBUG", __VA_ARGS__)
+#define LOG_TRACE(...) halDebugLog::log(DebugLogLevel::LVL_TRACE, "TRACE", __VA_ARGS__)
+
+#endif // HAL_NATIVE_DEBUGLOG_H
@@ -0,0 +1,459 @@
+#include "Ethernet.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/sockios.h>
+
+// Emulated W5500 per-socket TX buffer (2 KB with 8 sockets)
+#define HAL_SOCKET_TX_SIZE 2048
+
+enum HalSocketState {
+	HAL_SOCK_CLOSED,
+	HAL_SOCK_LISTEN,
+	HAL_SOCK_ESTABLISHED,
+	HAL_SOCK_UDP
+};
+
+struct HalSocket {
+	int fd;
+	uint8_t state;
+	uint32_t generation;
+};
+
+static HalSocket halSockets[MAX_SOCK_NUM] = {};
+static int halListenFds[16];
+static int halListenFdCount = 0;
+
+EthernetClass Ethernet;
+
+static uint8_t halSocketAllocate(uint8_t state, int fd) {
+	for (uint8_t i = 0; i < MAX_SOCK_NUM; i++) {
+		if (halSockets[i].state == HAL_SOCK_CLOSED) {
+			halSockets[i].state = state;
+			halSockets[i].fd = fd;
+			halSockets[i].generation++;
+			return i;
+		}
+	}
+	return MAX_SOCK_NUM;
+}
+
+static void halSocketRelease(uint8_t s) {
+	if (s >= MAX_SOCK_NUM) return;
+	if (halSockets[s].fd >= 0 && halSockets[s].state != HAL_SOCK_LISTEN) {
+		close(halSockets[s].fd);
+	}
+	halSockets[s].fd = -1;
+	halSockets[s].state = HAL_SOCK_CLOSED;
+	halSockets[s].generation++;
+}
+
+static void halSetNonBlocking(int fd) {
+	int flags = fcntl(fd, F_GETFL, 0);
+	fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static bool halResolve(const char* host, IPAddress& out) {
+	if (out.fromString(host)) return true;
+	struct addrinfo hints = {};
+	struct addrinfo* result = nullptr;
+	hints.ai_family = AF_INET;
+	if (getaddrinfo(host, nullptr, &hints, &result) != 0 || !result) return false;
+	struct sockaddr_in* addr = (struct sockaddr_in*)result->ai_addr;
+	out = IPAddress((uint32_t)addr->sin_addr.s_addr);
+	freeaddrinfo(result);
+	return true;
+}
+
+int halSocketPollFds(int* fds, int maxFds) {
+	int n = 0;
+	for (int i = 0; i < MAX_SOCK_NUM && n < maxFds; i++) {
+		if (halSockets[i].state == HAL_SOCK_ESTABLISHED || halSockets[i].state == HAL_SOCK_UDP) {
+			fds[n++] = halSockets[i].fd;
+		}
+	}
+	for (int i = 0; i < halListenFdCount && n < maxFds; i++) {
+		fds[n++] = halListenFds[i];
+	}
+	return n;
+}
+
+// EthernetClass
+
+int EthernetClass::begin(uint8_t* macAddress, unsigned long timeout, unsigned long responseTimeout) {
+	(void)timeout;
+	(void)responseTimeout;
+	memcpy(mac, macAddress, 6);
+	for (int i = 0; i < MAX_SOCK_NUM; i++) {
+		if (halSockets[i].state == HAL_SOCK_CLOSED) halSockets[i].fd = -1;
+	}
+	return 1;
+}
+
+void EthernetClass::MACAddress(uint8_t* macAddress) {
+	memcpy(macAddress, mac, 6);
+}
+
+IPAddress EthernetClass::localIP() {
+	return IPAddress(127, 0, 0, 1);
+}
+
+uint8_t EthernetClass::socketsInUse() {
+	uint8_t count = 0;
+	for (int i = 0; i < MAX_SOCK_NUM; i++) {
+		if (halSockets[i].state != HAL_SOCK_CLOSED) count++;
+	}
+	return count;
+}
+
+// EthernetClient
+
+EthernetClient::EthernetClient(uint8_t s) : sockindex(s), generation(0), _timeout(1000) {
+	if (s < MAX_SOCK_NUM) generation = halSockets[s].generation;
+}
+
+int EthernetClient::fd() {
+	if (sockindex >= MAX_SOCK_NUM) return -1;
+	HalSocket& sock = halSockets[sockindex];
+	if (sock.generation != generation || sock.state != HAL_SOCK_ESTABLISHED) return -1;
+	return sock.fd;
+}
+
+uint8_t EthernetClient::status() {
+	return fd() >= 0 ? 0x17 : 0x00; // SnSR::ESTABLISHED / SnSR::CLOSED
+}
+
+int EthernetClient::connect(IPAddress ip, uint16_t port) {
+	if (sockindex < MAX_SOCK_NUM) stop();
+
+	int s = socket(AF_INET, SOCK_STREAM, 0);
+	if (s < 0) return 0;
+	uint8_t slot = halSocketAllocate(HAL_SOCK_ESTABLISHED, s);
+	if (slot >= MAX_SOCK_NUM) {
+		close(s);
+		return 0;
+	}
+	halSetNonBlocking(s);
+
+	struct sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = (uint32_t)ip;
+	int rc = ::connect(s, (struct sockaddr*)&addr, sizeof(addr));
+	if (rc < 0 && errno == EINPROGRESS) {
+		struct pollfd pfd = {s, POLLOUT, 0};
+		rc = poll(&pfd, 1, _timeout) == 1 ? 0 : -1;
+		int err = 0;
+		socklen_t errLen = sizeof(err);
+		if (rc == 0 && (getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &errLen) < 0 || err != 0)) rc = -1;
+	}
+	if (rc < 0) {
+		halSocketRelease(slot);
+		return 0;
+	}
+
+	int one = 1;
+	setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	sockindex = slot;
+	generation = halSockets[slot].generation;
+	return 1;
+}
+
+int EthernetClient::connect(const char* host, uint16_t port) {
+	IPAddress ip;
+	if (!halResolve(host, ip)) return 0;
+	return connect(ip, port);
+}
+
+int EthernetClient::availableForWrite() {
+	int s = fd();
+	if (s < 0) return 0;
+	int queued = 0;
+	if (ioctl(s, SIOCOUTQ, &queued) < 0) return 0;
+	return queued >= HAL_SOCKET_TX_SIZE ? 0 : HAL_SOCKET_TX_SIZE - queued;
+}
+
+size_t EthernetClient::write(uint8_t b) {
+	return write(&b, 1);
+}
+
+size_t EthernetClient::write(const uint8_t* buf, size_t size) {
+	// Like the W5500 driver, block until the data fits or the peer goes away
+	size_t sent = 0;
+	while (sent < size) {
+		int s = fd();
+		if (s < 0) break;
+		ssize_t n = send(s, buf + sent, size - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (n > 0) {
+			sent += (size_t)n;
+		} else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			struct pollfd pfd = {s, POLLOUT, 0};
+			poll(&pfd, 1, 10);
+		} else {
+			halSocketRelease(sockindex);
+			break;
+		}
+	}
+	return sent;
+}
+
+int EthernetClient::available() {
+	int s = fd();
+	if (s < 0) return 0;
+	int pending = 0;
+	if (ioctl(s, FIONREAD, &pending) < 0) return 0;
+	return pending;
+}
+
+int EthernetClient::read() {
+	uint8_t b;
+	return read(&b, 1) == 1 ? b : -1;
+}
+
+int EthernetClient::read(uint8_t* buf, size_t size) {
+	int s = fd();
+	if (s < 0) return -1;
+	ssize_t n = recv(s, buf, size, MSG_DONTWAIT);
+	if (n > 0) return (int)n;
+	return -1;
+}
+
+int EthernetClient::peek() {
+	int s = fd();
+	if (s < 0) return -1;
+	uint8_t b;
+	return recv(s, &b, 1, MSG_DONTWAIT | MSG_PEEK) == 1 ? b : -1;
+}
+
+void EthernetClient::stop() {
+	if (fd() >= 0) halSocketRelease(sockindex);
+	sockindex = MAX_SOCK_NUM;
+}
+
+uint8_t EthernetClient::connected() {
+	int s = fd();
+	if (s < 0) return 0;
+	uint8_t b;
+	ssize_t n = recv(s, &b, 1, MSG_DONTWAIT | MSG_PEEK);
+	if (n > 0) return 1;
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+	// Peer closed (CLOSE_WAIT with nothing left to read) or reset
+	return 0;
+}
+
+EthernetClient::operator bool() {
+	return fd() >= 0;
+}
+
+bool EthernetClient::operator==(const EthernetClient& rhs) const {
+	return sockindex == rhs.sockindex && generation == rhs.generation;
+}
+
+uint16_t EthernetClient::localPort() {
+	struct sockaddr_in addr = {};
+	socklen_t addrLen = sizeof(addr);
+	int s = fd();
+	if (s < 0 || getsockname(s, (struct sockaddr*)&addr, &addrLen) < 0) return 0;
+	return ntohs(addr.sin_port);
+}
+
+IPAddress EthernetClient::remoteIP() {
+	struct sockaddr_in addr = {};
+	socklen_t addrLen = sizeof(addr);
+	int s = fd();
+	if (s < 0 || getpeername(s, (struct sockaddr*)&addr, &addrLen) < 0) return IPAddress();
+	return IPAddress((uint32_t)addr.sin_addr.s_addr);
+}
+
+uint16_t EthernetClient::remotePort() {
+	struct sockaddr_in addr = {};
+	socklen_t addrLen = sizeof(addr);
+	int s = fd();
+	if (s < 0 || getpeername(s, (struct sockaddr*)&addr, &addrLen) < 0) return 0;
+	return ntohs(addr.sin_port);
+}
+
+// EthernetServer
+//
+// P1_PORT_OFFSET is added to every listening port so the bridge can run
+// without root (e.g. 8000: HTTP on 8080, P1 on 10000, logs on 10001).
+
+void EthernetServer::begin() {
+	if (listenFd < 0) {
+		const char* offset = getenv("P1_PORT_OFFSET");
+		unsigned port = _port + (offset ? atoi(offset) : 0);
+		listenFd = socket(AF_INET, SOCK_STREAM, 0);
+		int one = 1;
+		setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		struct sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 8) < 0) {
+			fprintf(stderr, "[hal] cannot listen on port %u: %s\n", port, strerror(errno));
+			close(listenFd);
+			listenFd = -1;
+			return;
+		}
+		halSetNonBlocking(listenFd);
+		if (halListenFdCount < (int)(sizeof(halListenFds) / sizeof(halListenFds[0]))) {
+			halListenFds[halListenFdCount++] = listenFd;
+		}
+	}
+	if (listenSlot >= MAX_SOCK_NUM) {
+		listenSlot = halSocketAllocate(HAL_SOCK_LISTEN, listenFd);
+	}
+}
+
+EthernetClient EthernetServer::accept() {
+	if (listenFd < 0) return EthernetClient();
+
+	// A W5500 server needs a free hardware socket to listen on
+	if (listenSlot >= MAX_SOCK_NUM || halSockets[listenSlot].state != HAL_SOCK_LISTEN) {
+		listenSlot = halSocketAllocate(HAL_SOCK_LISTEN, listenFd);
+		if (listenSlot >= MAX_SOCK_NUM) return EthernetClient();
+	}
+
+	int s = ::accept(listenFd, nullptr, nullptr);
+	if (s < 0) return EthernetClient();
+	halSetNonBlocking(s);
+	int one = 1;
+	setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	// The listening socket becomes the connection; listen again on a new one
+	uint8_t slot = listenSlot;
+	halSockets[slot].fd = s;
+	halSockets[slot].state = HAL_SOCK_ESTABLISHED;
+	halSockets[slot].generation++;
+	listenSlot = halSocketAllocate(HAL_SOCK_LISTEN, listenFd);
+	return EthernetClient(slot);
+}
+
+EthernetClient EthernetServer::available() {
+	return accept();
+}
+
+size_t EthernetServer::write(const uint8_t* buf, size_t size) {
+	(void)buf;
+	return size;
+}
+
+// EthernetUDP
+
+int EthernetUDP::fd() {
+	if (sockindex >= MAX_SOCK_NUM) return -1;
+	HalSocket& sock = halSockets[sockindex];
+	if (sock.generation != generation || sock.state != HAL_SOCK_UDP) return -1;
+	return sock.fd;
+}
+
+uint8_t EthernetUDP::begin(uint16_t port) {
+	if (sockindex < MAX_SOCK_NUM) stop();
+	int s = socket(AF_INET, SOCK_DGRAM, 0);
+	if (s < 0) return 0;
+	struct sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	int one = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		close(s);
+		return 0;
+	}
+	halSetNonBlocking(s);
+	uint8_t slot = halSocketAllocate(HAL_SOCK_UDP, s);
+	if (slot >= MAX_SOCK_NUM) {
+		close(s);
+		return 0;
+	}
+	sockindex = slot;
+	generation = halSockets[slot].generation;
+	return 1;
+}
+
+void EthernetUDP::stop() {
+	if (fd() >= 0) halSocketRelease(sockindex);
+	sockindex = MAX_SOCK_NUM;
+}
+
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port) {
+	_destIP = ip;
+	_destPort = port;
+	txLength = 0;
+	return fd() >= 0 ? 1 : 0;
+}
+
+int EthernetUDP::beginPacket(const char* host, uint16_t port) {
+	IPAddress ip;
+	if (!halResolve(host, ip)) return 0;
+	return beginPacket(ip, port);
+}
+
+int EthernetUDP::endPacket() {
+	int s = fd();
+	if (s < 0) return 0;
+	struct sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(_destPort);
+	addr.sin_addr.s_addr = (uint32_t)_destIP;
+	ssize_t n = sendto(s, txBuffer, txLength, 0, (struct sockaddr*)&addr, sizeof(addr));
+	txLength = 0;
+	return n >= 0 ? 1 : 0;
+}
+
+size_t EthernetUDP::write(uint8_t b) {
+	return write(&b, 1);
+}
+
+size_t EthernetUDP::write(const uint8_t* buffer, size_t size) {
+	size_t room = sizeof(txBuffer) - txLength;
+	if (size > room) size = room;
+	memcpy(txBuffer + txLength, buffer, size);
+	txLength += size;
+	return size;
+}
+
+int EthernetUDP::parsePacket() {
+	int s = fd();
+	if (s < 0) return 0;
+	struct sockaddr_in addr = {};
+	socklen_t addrLen = sizeof(addr);
+	ssize_t n = recvfrom(s, rxBuffer, sizeof(rxBuffer), MSG_DONTWAIT, (struct sockaddr*)&addr, &addrLen);
+	if (n <= 0) {
+		rxLength = rxPos = 0;
+		return 0;
+	}
+	rxLength = (size_t)n;
+	rxPos = 0;
+	_remoteIP = IPAddress((uint32_t)addr.sin_addr.s_addr);
+	_remotePort = ntohs(addr.sin_port);
+	return (int)n;
+}
+
+int EthernetUDP::available() {
+	return (int)(rxLength - rxPos);
+}
+
+int EthernetUDP::read() {
+	return rxPos < rxLength ? rxBuffer[rxPos++] : -1;
+}
+
+int EthernetUDP::read(unsigned char* buffer, size_t len) {
+	size_t n = rxLength - rxPos;
+	if (n > len) n = len;
+	memcpy(buffer, rxBuffer + rxPos, n);
+	rxPos += n;
+	return (int)n;
+}
+
+int EthernetUDP::peek() {
+	return rxPos < rxLength ? rxBuffer[rxPos] : -1;
+}
@@ -0,0 +1,150 @@
+#ifndef HAL_NATIVE_ETHERNET_H
+#define HAL_NATIVE_ETHERNET_H
+
+// Native stand-in for the Arduino Ethernet library, backed by BSD sockets.
+// A fixed table of MAX_SOCK_NUM slots mirrors the W5500's hardware sockets
+// so the firmware's socket budget behaves the same on the host.
+
+#include <Arduino.h>
+
+#define MAX_SOCK_NUM 8
+
+enum EthernetLinkStatus {
+	Unknown,
+	LinkON,
+	LinkOFF
+};
+
+enum EthernetHardwareStatus {
+	EthernetNoHardware,
+	EthernetW5100,
+	EthernetW5200,
+	EthernetW5500
+};
+
+class EthernetClass {
+public:
+	int begin(uint8_t* mac, unsigned long timeout = 60000, unsigned long responseTimeout = 4000);
+	void init(uint8_t csPin) { (void)csPin; }
+	int maintain() { return 0; }
+	EthernetLinkStatus linkStatus() { return LinkON; }
+	EthernetHardwareStatus hardwareStatus() { return EthernetW5500; }
+	void MACAddress(uint8_t* macAddress);
+	IPAddress localIP();
+	IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+	IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+	IPAddress dnsServerIP() { return IPAddress(127, 0, 0, 1); }
+	uint8_t socketsInUse();
+
+private:
+	uint8_t mac[6] = {0, 0, 0, 0, 0, 0};
+};
+
+extern EthernetClass Ethernet;
+
+class Client : public Stream {
+public:
+	virtual int connect(IPAddress ip, uint16_t port) = 0;
+	virtual int connect(const char* host, uint16_t port) = 0;
+	virtual uint8_t connected() = 0;
+	virtual void stop() = 0;
+	virtual int read(uint8_t* buf, size_t size) = 0;
+	using Stream::read;
+};
+
+class EthernetClient : public Client {
+public:
+	EthernetClient() : sockindex(MAX_SOCK_NUM), generation(0), _timeout(1000) {}
+	EthernetClient(uint8_t s);
+
+	uint8_t status();
+	int connect(IPAddress ip, uint16_t port) override;
+	int connect(const char* host, uint16_t port) override;
+	int availableForWrite() override;
+	size_t write(uint8_t b) override;
+	size_t write(const uint8_t* buf, size_t size) override;
+	int available() override;
+	int read() override;
+	int read(uint8_t* buf, size_t size) override;
+	int peek() override;
+	void flush() override {}
+	void stop() override;
+	uint8_t connected() override;
+	operator bool();
+	bool operator==(const EthernetClient& rhs) const;
+	bool operator!=(const EthernetClient& rhs) const { return !(*this == rhs); }
+	uint8_t getSocketNumber() const { return sockindex; }
+	uint16_t localPort();
+	IPAddress remoteIP();
+	uint16_t remotePort();
+	void setConnectionTimeout(uint16_t timeout) { _timeout = timeout; }
+
+	using Print::write;
+
+private:
+	uint8_t sockindex;
+	uint32_t generation;
+	uint16_t _timeout;
+
+	int fd();
+};
+
+class EthernetServer {
+public:
+	EthernetServer(uint16_t port) : _port(port) {}
+	void begin();
+	EthernetClient accept();
+	EthernetClient available();
+	size_t write(const uint8_t* buf, size_t size);
+	explicit operator bool() { return listenFd >= 0; }
+
+private:
+	uint16_t _port;
+	int listenFd = -1;
+	uint8_t listenSlot = MAX_SOCK_NUM;
+};
+
+class UDP : public Stream {
+};
+
+class EthernetUDP : public UDP {
+public:
+	uint8_t begin(uint16_t port);
+	void stop();
+	int beginPacket(IPAddress ip, uint16_t port);
+	int beginPacket(const char* host, uint16_t port);
+	int endPacket();
+	size_t write(uint8_t b) override;
+	size_t write(const uint8_t* buffer, size_t size) override;
+	int parsePacket();
+	int available() override;
+	int read() override;
+	int read(unsigned char* buffer, size_t len);
+	int read(char* buffer, size_t len) { return read((unsigned char*)buffer, len); }
+	int peek() override;
+	void flush() override {}
+	IPAddress remoteIP() { return _remoteIP; }
+	uint16_t remotePort() { return _remotePort; }
+
+	using Print::write;
+
+private:
+	uint8_t sockindex = MAX_SOCK_NUM;
+	uint32_t generation = 0;
+	IPAddress _destIP;
+	uint16_t _destPort = 0;
+	IPAddress _remoteIP;
+	uint16_t _remotePort = 0;
+	uint8_t txBuffer[1472];
+	size_t txLength = 0;
+	uint8_t rxBuffer[1472];
+	size_t rxLength = 0;
+	size_t rxPos = 0;
+
+	int fd();
+};
+
+// Socket table helpers used by the native HAL (hal_native.cpp)
+int halSocketPollFds(int* fds, int maxFds);
+
+#endif // HAL_NATIVE_ETHERNET_H
@@ -0,0 +1,6 @@
+#ifndef HAL_NATIVE_ETHERNET_UDP_H
+#define HAL_NATIVE_ETHERNET_UDP_H
+
+#include "Ethernet.h"
+
+#endif // HAL_NATIVE_ETHERNET_UDP_H
@@ -0,0 +1,55 @@
+#ifndef HAL_NATIVE_HARDWARESERIAL_H
+#define HAL_NATIVE_HARDWARESERIAL_H
+
+#include "Stream.h"
+
+// Debug console (Serial): writes to stdout.
+class HalConsole : public Stream {
+public:
+	void begin(unsigned long baud) { (void)baud; }
+	int available() override { return 0; }
+	int read() override { return -1; }
+	int peek() override { return -1; }
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* buffer, size_t size) override;
+	int availableForWrite() override { return 4096; }
+	void flush() override;
+	operator bool() const { return true; }
+	using Print::write;
+};
+
+// P1 UART (Serial1). Backed by a pty, a device/file path or a TCP feed,
+// selected with the P1_SERIAL environment variable (see hal_native.cpp).
+class HalUart : public Stream {
+public:
+	void begin(unsigned long baud, uint16_t config = SERIAL_8N1);
+	void end();
+	// The kernel buffers the feed, so there is no FIFO to size
+	bool setFIFOSize(size_t size) { (void)size; return true; }
+	int available() override;
+	int read() override;
+	int peek() override;
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* buffer, size_t size) override;
+	int availableForWrite() override { return 32; }
+	operator bool() const { return fd >= 0; }
+	using Print::write;
+
+	int pollFd() const { return fd >= 0 ? fd : listenFd; }
+	void service();
+
+private:
+	int fd = -1;
+	int listenFd = -1;
+	int peeked = -1;
+	uint8_t rxBuffer[256];
+	size_t rxHead = 0;
+	size_t rxTail = 0;
+
+	bool fill();
+};
+
+extern HalConsole Serial;
+extern HalUart Serial1;
+
+#endif // HAL_NATIVE_HARDWARESERIAL_H
@@ -0,0 +1,29 @@
+#include "Arduino.h"
+
+bool IPAddress::fromString(const char* address) {
+	unsigned int parts[4];
+	char tail;
+	if (sscanf(address, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) {
+		return false;
+	}
+	for (int i = 0; i < 4; i++) {
+		if (parts[i] > 255) return false;
+		bytes[i] = (uint8_t)parts[i];
+	}
+	return true;
+}
+
+String IPAddress::toString() const {
+	char buf[16];
+	snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+	return String(buf);
+}
+
+size_t IPAddress::printTo(Print& p) const {
+	size_t n = 0;
+	for (int i = 0; i < 4; i++) {
+		if (i > 0) n += p.print('.');
+		n += p.print(bytes[i], 10);
+	}
+	return n;
+}
@@ -0,0 +1,35 @@
+#ifndef HAL_NATIVE_IPADDRESS_H
+#define HAL_NATIVE_IPADDRESS_H
+
+#include <stdint.h>
+#include "WString.h"
+#include "Print.h"
+
+class IPAddress : public Printable {
+public:
+	IPAddress() : bytes{0, 0, 0, 0} {}
+	IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+	IPAddress(uint32_t address) { memcpy(bytes, &address, 4); }
+	IPAddress(const uint8_t* address) { memcpy(bytes, address, 4); }
+
+	bool fromString(const char* address);
+	bool fromString(const String& address) { return fromString(address.c_str()); }
+
+	operator uint32_t() const {
+		uint32_t address;
+		memcpy(&address, bytes, 4);
+		return address;
+	}
+	bool operator==(const IPAddress& other) const { return memcmp(bytes, other.bytes, 4) == 0; }
+	bool operator!=(const IPAddress& other) const { return !(*this == other); }
+	uint8_t operator[](int index) const { return bytes[index]; }
+	uint8_t& operator[](int index) { return bytes[index]; }
+
+	String toString() const;
+	size_t printTo(Print& p) const override;
+
+private:
+	uint8_t bytes[4];
+};
+
+#endif // HAL_NATIVE_IPADDRESS_H
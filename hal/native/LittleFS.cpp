@@ -0,0 +1,272 @@
+#include "LittleFS.h"
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+FS LittleFS;
+
+struct HalFileHandle {
+	FILE* fp;
+	String path;
+	String name;
+
+	~HalFileHandle() {
+		if (fp) fclose(fp);
+	}
+};
+
+static String halFsRoot() {
+	const char* root = getenv("P1_NATIVE_FS");
+	return String(root && *root ? root : "native_fs");
+}
+
+String FS::hostPath(const char* path) const {
+	String result = halFsRoot();
+	if (path[0] != '/') result += "/";
+	result += path;
+	return result;
+}
+
+bool FS::begin() {
+	::mkdir(halFsRoot().c_str(), 0755);
+	struct stat st;
+	return stat(halFsRoot().c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static void halRemoveTree(const String& path) {
+	DIR* dir = opendir(path.c_str());
+	if (!dir) return;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != nullptr) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+		String child = path + "/" + entry->d_name;
+		struct stat st;
+		if (stat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+			halRemoveTree(child);
+			::rmdir(child.c_str());
+		} else {
+			unlink(child.c_str());
+		}
+	}
+	closedir(dir);
+}
+
+bool FS::format() {
+	halRemoveTree(halFsRoot());
+	return true;
+}
+
+static size_t halUsedBytes(const String& path, size_t blockSize) {
+	size_t used = 0;
+	DIR* dir = opendir(path.c_str());
+	if (!dir) return 0;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != nullptr) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+		String child = path + "/" + entry->d_name;
+		struct stat st;
+		if (stat(child.c_str(), &st) != 0) continue;
+		if (S_ISDIR(st.st_mode)) {
+			used += blockSize + halUsedBytes(child, blockSize);
+		} else {
+			used += ((st.st_size + blockSize - 1) / blockSize) * blockSize + blockSize;
+		}
+	}
+	closedir(dir);
+	return used;
+}
+
+bool FS::info(FSInfo& info) {
+	info.blockSize = 4096;
+	info.pageSize = 256;
+	info.maxOpenFiles = 5;
+	info.maxPathLength = 32;
+	info.totalBytes = HAL_NATIVE_FS_SIZE;
+	info.usedBytes = 2 * info.blockSize + halUsedBytes(halFsRoot(), info.blockSize);
+	return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+	String host = hostPath(path);
+	const char* hostMode = "rb";
+	if (strcmp(mode, "w") == 0) hostMode = "wb";
+	else if (strcmp(mode, "a") == 0) hostMode = "ab";
+	else if (strcmp(mode, "r+") == 0) hostMode = "r+b";
+	else if (strcmp(mode, "w+") == 0) hostMode = "w+b";
+	else if (strcmp(mode, "a+") == 0) hostMode = "a+b";
+	FILE* fp = fopen(host.c_str(), hostMode);
+	if (!fp) return File();
+	auto handle = std::make_shared<HalFileHandle>();
+	handle->fp = fp;
+	handle->path = String(path);
+	int slash = handle->path.lastIndexOf('/');
+	handle->name = slash >= 0 ? handle->path.substring(slash + 1) : handle->path;
+	return File(handle);
+}
+
+bool FS::exists(const char* path) {
+	struct stat st;
+	return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+Dir FS::openDir(const char* path) {
+	return Dir(String(path));
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+	return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::remove(const char* path) {
+	return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+	return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char* path) {
+	return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+// File
+
+size_t File::write(uint8_t c) {
+	return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+	if (!handle) return 0;
+	return fwrite(buf, 1, size, handle->fp);
+}
+
+int File::available() {
+	if (!handle) return 0;
+	return (int)(size() - position());
+}
+
+int File::read() {
+	uint8_t b;
+	return read(&b, 1) == 1 ? b : -1;
+}
+
+int File::peek() {
+	if (!handle) return -1;
+	int c = fgetc(handle->fp);
+	if (c != EOF) ungetc(c, handle->fp);
+	return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+	if (handle) fflush(handle->fp);
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+	if (!handle) return 0;
+	return fread(buf, 1, size, handle->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+	if (!handle) return false;
+	int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+	return fseek(handle->fp, (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+	if (!handle) return 0;
+	long pos = ftell(handle->fp);
+	return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+	if (!handle) return 0;
+	fflush(handle->fp);
+	struct stat st;
+	if (fstat(fileno(handle->fp), &st) != 0) return 0;
+	return (size_t)st.st_size;
+}
+
+bool File::truncate(uint32_t newSize) {
+	if (!handle) return false;
+	fflush(handle->fp);
+	return ftruncate(fileno(handle->fp), newSize) == 0;
+}
+
+void File::close() {
+	handle.reset();
+}
+
+File::operator bool() const {
+	return (bool)handle;
+}
+
+const char* File::name() const {
+	return handle ? handle->name.c_str() : "";
+}
+
+const char* File::fullName() const {
+	return handle ? handle->path.c_str() : "";
+}
+
+// Dir
+
+static std::vector<std::string> halListDir(const String& hostDir) {
+	std::vector<std::string> names;
+	DIR* dir = opendir(hostDir.c_str());
+	if (!dir) return names;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != nullptr) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+		names.push_back(entry->d_name);
+	}
+	closedir(dir);
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+bool Dir::next() {
+	std::vector<std::string> names = halListDir(LittleFS.hostPath(path.c_str()));
+	index++;
+	if (index >= (long)names.size()) {
+		current = "";
+		return false;
+	}
+	current = String(names[index].c_str());
+	return true;
+}
+
+static String halDirChild(const String& dir, const String& name) {
+	String child = dir;
+	if (!child.endsWith("/")) child += "/";
+	child += name;
+	return child;
+}
+
+size_t Dir::fileSize() const {
+	struct stat st;
+	if (stat(LittleFS.hostPath(halDirChild(path, current).c_str()).c_str(), &st) != 0) return 0;
+	return (size_t)st.st_size;
+}
+
+bool Dir::isFile() const {
+	struct stat st;
+	return stat(LittleFS.hostPath(halDirChild(path, current).c_str()).c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+bool Dir::isDirectory() const {
+	struct stat st;
+	return stat(LittleFS.hostPath(halDirChild(path, current).c_str()).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+File Dir::openFile(const char* mode) {
+	return LittleFS.open(halDirChild(path, current), mode);
+}
+
+bool Dir::rewind() {
+	index = -1;
+	return true;
+}
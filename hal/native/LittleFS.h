@@ -0,0 +1,105 @@
+#ifndef HAL_NATIVE_LITTLEFS_H
+#define HAL_NATIVE_LITTLEFS_H
+
+// Native stand-in for the arduino-pico LittleFS object. Files live in a
+// host directory (P1_NATIVE_FS, default ./native_fs) and the reported
+// capacity matches board_build.filesystem_size.
+
+#include <Arduino.h>
+#include <memory>
+
+#ifndef HAL_NATIVE_FS_SIZE
+#define HAL_NATIVE_FS_SIZE (512 * 1024)
+#endif
+
+enum SeekMode {
+	SeekSet = 0,
+	SeekCur = 1,
+	SeekEnd = 2
+};
+
+struct FSInfo {
+	size_t totalBytes;
+	size_t usedBytes;
+	size_t blockSize;
+	size_t pageSize;
+	size_t maxOpenFiles;
+	size_t maxPathLength;
+};
+
+struct HalFileHandle;
+
+class File : public Stream {
+public:
+	File() {}
+	explicit File(std::shared_ptr<HalFileHandle> handle) : handle(handle) {}
+
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* buf, size_t size) override;
+	int availableForWrite() override { return 4096; }
+	int available() override;
+	int read() override;
+	int peek() override;
+	void flush() override;
+	size_t read(uint8_t* buf, size_t size);
+	size_t readBytes(char* buffer, size_t length) override { return read((uint8_t*)buffer, length); }
+	bool seek(uint32_t pos, SeekMode mode = SeekSet);
+	size_t position() const;
+	size_t size() const;
+	bool truncate(uint32_t size);
+	void close();
+	operator bool() const;
+	const char* name() const;
+	const char* fullName() const;
+	bool isFile() const { return (bool)handle; }
+	bool isDirectory() const { return false; }
+
+	using Print::write;
+
+private:
+	std::shared_ptr<HalFileHandle> handle;
+};
+
+class Dir {
+public:
+	Dir() {}
+	explicit Dir(const String& path) : path(path) {}
+
+	bool next();
+	String fileName() const { return current; }
+	size_t fileSize() const;
+	bool isFile() const;
+	bool isDirectory() const;
+	File openFile(const char* mode);
+	bool rewind();
+
+private:
+	String path;
+	String current;
+	long index = -1;
+};
+
+class FS {
+public:
+	bool begin();
+	void end() {}
+	bool format();
+	bool info(FSInfo& info);
+	File open(const char* path, const char* mode);
+	File open(const String& path, const char* mode) { return open(path.c_str(), mode); }
+	bool exists(const char* path);
+	bool exists(const String& path) { return exists(path.c_str()); }
+	Dir openDir(const char* path);
+	Dir openDir(const String& path) { return openDir(path.c_str()); }
+	bool rename(const char* pathFrom, const char* pathTo);
+	bool remove(const char* path);
+	bool remove(const String& path) { return remove(path.c_str()); }
+	bool mkdir(const char* path);
+	bool rmdir(const char* path);
+
+	String hostPath(const char* path) const;
+};
+
+extern FS LittleFS;
+
+#endif // HAL_NATIVE_LITTLEFS_H
@@ -0,0 +1,86 @@
+#include "Arduino.h"
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+	size_t n = 0;
+	while (size--) {
+		if (!write(*buffer++)) break;
+		n++;
+	}
+	return n;
+}
+
+size_t Print::print(const String& s) {
+	return write((const uint8_t*)s.c_str(), s.length());
+}
+
+size_t Print::print(const char* s) {
+	return write(s);
+}
+
+size_t Print::print(char c) {
+	return write((uint8_t)c);
+}
+
+// Numbers are formatted on the stack, as the Arduino cores do
+static size_t printNumber(Print& out, unsigned long long value, bool negative, int base) {
+	char buf[8 * sizeof(value) + 2];
+	char* p = buf + sizeof(buf);
+	if (base < 2) base = 10;
+	do {
+		int digit = (int)(value % base);
+		*--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+		value /= base;
+	} while (value);
+	if (negative) *--p = '-';
+	return out.write((const uint8_t*)p, buf + sizeof(buf) - p);
+}
+
+static size_t printSigned(Print& out, long long value, int base) {
+	// Like the cores, only base 10 prints a sign; other bases show the raw bits
+	if (base == 10 && value < 0) {
+		return printNumber(out, 0ULL - (unsigned long long)value, true, base);
+	}
+	return printNumber(out, (unsigned long long)value, false, base);
+}
+
+size_t Print::print(unsigned char value, int base) {
+	return printNumber(*this, value, false, base);
+}
+
+size_t Print::print(int value, int base) {
+	return base == 10 ? printSigned(*this, value, base) : printNumber(*this, (unsigned int)value, false, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+	return printNumber(*this, value, false, base);
+}
+
+size_t Print::print(long value, int base) {
+	return base == 10 ? printSigned(*this, value, base) : printNumber(*this, (unsigned long)value, false, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+	return printNumber(*this, value, false, base);
+}
+
+size_t Print::print(long long value, int base) {
+	return printSigned(*this, value, base);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+	return printNumber(*this, value, false, base);
+}
+
+size_t Print::print(double value, int digits) {
+	char buf[64];
+	int n = snprintf(buf, sizeof(buf), "%.*f", digits, value);
+	return write((const uint8_t*)buf, n < (int)sizeof(buf) ? n : sizeof(buf) - 1);
+}
+
+size_t Print::print(const Printable& p) {
+	return p.printTo(*this);
+}
+
+size_t Print::println() {
+	return write((const uint8_t*)"\r\n", 2);
+}
@@ -0,0 +1,53 @@
+#ifndef HAL_NATIVE_PRINT_H
+#define HAL_NATIVE_PRINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+class Printable;
+
+class Print {
+public:
+	virtual ~Print() {}
+
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t* buffer, size_t size);
+	size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+	size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+	virtual int availableForWrite() { return 0; }
+	virtual void flush() {}
+
+	size_t print(const String& s);
+	size_t print(const char* s);
+	size_t print(char c);
+	size_t print(unsigned char value, int base = 10);
+	size_t print(int value, int base = 10);
+	size_t print(unsigned int value, int base = 10);
+	size_t print(long value, int base = 10);
+	size_t print(unsigned long value, int base = 10);
+	size_t print(long long value, int base = 10);
+	size_t print(unsigned long long value, int base = 10);
+	size_t print(double value, int digits = 2);
+	size_t print(const Printable& p);
+
+	size_t println();
+	template <typename T>
+	size_t println(const T& value) {
+		size_t n = print(value);
+		return n + println();
+	}
+	template <typename T>
+	size_t println(const T& value, int format) {
+		size_t n = print(value, format);
+		return n + println();
+	}
+};
+
+class Printable {
+public:
+	virtual ~Printable() {}
+	virtual size_t printTo(Print& p) const = 0;
+};
+
+#endif // HAL_NATIVE_PRINT_H
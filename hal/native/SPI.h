@@ -0,0 +1,14 @@
+#ifndef HAL_NATIVE_SPI_H
+#define HAL_NATIVE_SPI_H
+
+#include <Arduino.h>
+
+class SPIClass {
+public:
+	void begin() {}
+	void end() {}
+};
+
+extern SPIClass SPI;
+
+#endif // HAL_NATIVE_SPI_H
@@ -0,0 +1,34 @@
+#ifndef HAL_NATIVE_UPDATER_H
+#define HAL_NATIVE_UPDATER_H
+
+// Native stand-in for the arduino-pico Updater: the uploaded image is
+// written to firmware.bin in the native filesystem directory.
+
+#include <Arduino.h>
+#include "LittleFS.h"
+
+#define U_FLASH 0
+#define U_FS    100
+
+#define UPDATE_ERROR_OK    0
+#define UPDATE_ERROR_WRITE 1
+#define UPDATE_ERROR_SIZE  4
+
+class UpdaterClass {
+public:
+	bool begin(size_t size, int command = U_FLASH);
+	size_t write(uint8_t* data, size_t len);
+	bool end(bool evenIfRemaining = false);
+	uint8_t getError() { return error; }
+	bool hasError() { return error != UPDATE_ERROR_OK; }
+
+private:
+	File image;
+	size_t expected = 0;
+	size_t written = 0;
+	uint8_t error = UPDATE_ERROR_OK;
+};
+
+extern UpdaterClass Update;
+
+#endif // HAL_NATIVE_UPDATER_H
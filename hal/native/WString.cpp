@@ -0,0 +1,378 @@
+#include "Arduino.h"
+#include <ctype.h>
+
+static void formatInteger(char* out, size_t outSize, unsigned long long value, bool negative, unsigned char base) {
+	char tmp[66];
+	int pos = 0;
+	if (base < 2 || base > 36) base = 10;
+	do {
+		int digit = (int)(value % base);
+		tmp[pos++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+		value /= base;
+	} while (value > 0 && pos < (int)sizeof(tmp) - 1);
+	size_t o = 0;
+	if (negative && o + 1 < outSize) out[o++] = '-';
+	while (pos > 0 && o + 1 < outSize) out[o++] = tmp[--pos];
+	out[o] = '\0';
+}
+
+static void formatSigned(char* out, size_t outSize, long long value, unsigned char base) {
+	if (base == 10 && value < 0) {
+		formatInteger(out, outSize, (unsigned long long)(-(value + 1)) + 1, true, base);
+	} else {
+		formatInteger(out, outSize, (unsigned long long)value, false, base);
+	}
+}
+
+String::String(const char* cstr) : buffer(nullptr), capacity(0), len(0) {
+	if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, unsigned int length) : buffer(nullptr), capacity(0), len(0) {
+	if (cstr) copy(cstr, length);
+}
+
+String::String(const String& other) : buffer(nullptr), capacity(0), len(0) {
+	*this = other;
+}
+
+String::String(String&& other) : buffer(nullptr), capacity(0), len(0) {
+	move(other);
+}
+
+String::String(char c) : buffer(nullptr), capacity(0), len(0) {
+	char buf[2] = {c, '\0'};
+	copy(buf, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long long)value, base) {}
+String::String(int value, unsigned char base) : String((long long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long long)value, base) {}
+String::String(long value, unsigned char base) : String((long long)value, base) {}
+String::String(unsigned long value, unsigned char base) : String((unsigned long long)value, base) {}
+
+String::String(long long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+	char buf[68];
+	formatSigned(buf, sizeof(buf), value, base);
+	copy(buf, strlen(buf));
+}
+
+String::String(unsigned long long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+	char buf[68];
+	formatInteger(buf, sizeof(buf), value, false, base);
+	copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned char decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned char decimalPlaces) : buffer(nullptr), capacity(0), len(0) {
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+	copy(buf, strlen(buf));
+}
+
+String::~String() {
+	free(buffer);
+}
+
+void String::invalidate() {
+	free(buffer);
+	buffer = nullptr;
+	capacity = len = 0;
+}
+
+bool String::reserve(unsigned int size) {
+	if (buffer && capacity >= size) return true;
+	if (changeBuffer(size)) {
+		if (len == 0) buffer[0] = '\0';
+		return true;
+	}
+	return false;
+}
+
+bool String::changeBuffer(unsigned int maxStrLen) {
+	char* newBuffer = (char*)realloc(buffer, maxStrLen + 1);
+	if (!newBuffer) return false;
+	buffer = newBuffer;
+	capacity = maxStrLen;
+	return true;
+}
+
+String& String::copy(const char* cstr, unsigned int length) {
+	if (!reserve(length)) {
+		invalidate();
+		return *this;
+	}
+	len = length;
+	memmove(buffer, cstr, length);
+	buffer[len] = '\0';
+	return *this;
+}
+
+void String::move(String& rhs) {
+	free(buffer);
+	buffer = rhs.buffer;
+	capacity = rhs.capacity;
+	len = rhs.len;
+	rhs.buffer = nullptr;
+	rhs.capacity = rhs.len = 0;
+}
+
+String& String::operator=(const String& rhs) {
+	if (this == &rhs) return *this;
+	if (rhs.buffer) copy(rhs.buffer, rhs.len);
+	else invalidate();
+	return *this;
+}
+
+String& String::operator=(String&& rhs) {
+	if (this != &rhs) move(rhs);
+	return *this;
+}
+
+String& String::operator=(const char* cstr) {
+	if (cstr) copy(cstr, strlen(cstr));
+	else invalidate();
+	return *this;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+	unsigned int newLen = len + length;
+	if (!cstr) return false;
+	if (length == 0) return true;
+	if (!reserve(newLen)) return false;
+	memmove(buffer + len, cstr, length);
+	len = newLen;
+	buffer[len] = '\0';
+	return true;
+}
+
+bool String::concat(const String& str) { return concat(str.c_str(), str.len); }
+bool String::concat(const char* cstr) { return cstr ? concat(cstr, strlen(cstr)) : false; }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(unsigned char value) { return concat(String(value)); }
+bool String::concat(int value) { return concat(String(value)); }
+bool String::concat(unsigned int value) { return concat(String(value)); }
+bool String::concat(long value) { return concat(String(value)); }
+bool String::concat(unsigned long value) { return concat(String(value)); }
+bool String::concat(long long value) { return concat(String(value)); }
+bool String::concat(unsigned long long value) { return concat(String(value)); }
+bool String::concat(float value) { return concat(String(value)); }
+bool String::concat(double value) { return concat(String(value)); }
+
+int String::compareTo(const String& s) const {
+	return strcmp(c_str(), s.c_str());
+}
+
+bool String::equals(const String& s) const {
+	return len == s.len && compareTo(s) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+	return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+	return len == s.len && strcasecmp(c_str(), s.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+	return prefix.len <= len && startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+	if (offset > len || prefix.len > len - offset) return false;
+	return strncmp(c_str() + offset, prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+	if (suffix.len > len) return false;
+	return strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+	return operator[](index);
+}
+
+void String::setCharAt(unsigned int index, char c) {
+	if (index < len) buffer[index] = c;
+}
+
+char String::operator[](unsigned int index) const {
+	if (index >= len || !buffer) return 0;
+	return buffer[index];
+}
+
+char& String::operator[](unsigned int index) {
+	static char dummy;
+	if (index >= len || !buffer) {
+		dummy = 0;
+		return dummy;
+	}
+	return buffer[index];
+}
+
+int String::indexOf(char ch) const {
+	return indexOf(ch, 0);
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+	if (fromIndex >= len) return -1;
+	const char* found = (const char*)memchr(buffer + fromIndex, ch, len - fromIndex);
+	return found ? (int)(found - buffer) : -1;
+}
+
+int String::indexOf(const String& str) const {
+	return indexOf(str, 0);
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+	if (fromIndex >= len) return -1;
+	const char* found = strstr(buffer + fromIndex, str.c_str());
+	return found ? (int)(found - buffer) : -1;
+}
+
+int String::lastIndexOf(char ch) const {
+	for (int i = (int)len - 1; i >= 0; i--) {
+		if (buffer[i] == ch) return i;
+	}
+	return -1;
+}
+
+int String::lastIndexOf(const String& str) const {
+	if (str.len == 0 || str.len > len) return -1;
+	for (int i = (int)(len - str.len); i >= 0; i--) {
+		if (strncmp(buffer + i, str.c_str(), str.len) == 0) return i;
+	}
+	return -1;
+}
+
+String String::substring(unsigned int beginIndex) const {
+	return substring(beginIndex, len);
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+	if (left > right) {
+		unsigned int tmp = left;
+		left = right;
+		right = tmp;
+	}
+	if (left >= len) return String();
+	if (right > len) right = len;
+	return String(buffer + left, right - left);
+}
+
+void String::replace(char find, char replace) {
+	for (unsigned int i = 0; i < len; i++) {
+		if (buffer[i] == find) buffer[i] = replace;
+	}
+}
+
+void String::replace(const String& find, const String& replace) {
+	if (len == 0 || find.len == 0) return;
+	String result;
+	unsigned int pos = 0;
+	while (pos < len) {
+		const char* found = strstr(buffer + pos, find.c_str());
+		if (!found) {
+			result.concat(buffer + pos, len - pos);
+			break;
+		}
+		unsigned int at = (unsigned int)(found - buffer);
+		result.concat(buffer + pos, at - pos);
+		result.concat(replace);
+		pos = at + find.len;
+	}
+	*this = static_cast<String&&>(result);
+}
+
+void String::remove(unsigned int index) {
+	remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+	if (index >= len) return;
+	if (count > len - index) count = len - index;
+	memmove(buffer + index, buffer + index + count, len - index - count);
+	len -= count;
+	buffer[len] = '\0';
+}
+
+void String::toLowerCase() {
+	for (unsigned int i = 0; i < len; i++) buffer[i] = (char)tolower((unsigned char)buffer[i]);
+}
+
+void String::toUpperCase() {
+	for (unsigned int i = 0; i < len; i++) buffer[i] = (char)toupper((unsigned char)buffer[i]);
+}
+
+void String::trim() {
+	if (!buffer || len == 0) return;
+	char* begin = buffer;
+	while (isspace((unsigned char)*begin)) begin++;
+	char* end = buffer + len - 1;
+	while (end >= begin && isspace((unsigned char)*end)) end--;
+	len = (unsigned int)(end + 1 - begin);
+	if (begin > buffer) memmove(buffer, begin, len);
+	buffer[len] = '\0';
+}
+
+long String::toInt() const {
+	return buffer ? atol(buffer) : 0;
+}
+
+float String::toFloat() const {
+	return (float)toDouble();
+}
+
+double String::toDouble() const {
+	return buffer ? atof(buffer) : 0;
+}
+
+String operator+(const String& lhs, const String& rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, char rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, int rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, unsigned int rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, long rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, unsigned long rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
@@ -0,0 +1,118 @@
+#ifndef HAL_NATIVE_WSTRING_H
+#define HAL_NATIVE_WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Heap-backed string with the same growth behaviour as the Arduino core
+// (malloc/realloc on every append that exceeds capacity), so allocation
+// counts measured on the host are representative of the device.
+class String {
+public:
+	String(const char* cstr = "");
+	String(const char* cstr, unsigned int length);
+	String(const String& other);
+	String(String&& other);
+	explicit String(char c);
+	explicit String(unsigned char value, unsigned char base = 10);
+	explicit String(int value, unsigned char base = 10);
+	explicit String(unsigned int value, unsigned char base = 10);
+	explicit String(long value, unsigned char base = 10);
+	explicit String(unsigned long value, unsigned char base = 10);
+	explicit String(long long value, unsigned char base = 10);
+	explicit String(unsigned long long value, unsigned char base = 10);
+	explicit String(float value, unsigned char decimalPlaces = 2);
+	explicit String(double value, unsigned char decimalPlaces = 2);
+	~String();
+
+	String& operator=(const String& rhs);
+	String& operator=(String&& rhs);
+	String& operator=(const char* cstr);
+
+	bool reserve(unsigned int size);
+	unsigned int length() const { return len; }
+	bool isEmpty() const { return len == 0; }
+	const char* c_str() const { return buffer ? buffer : ""; }
+
+	bool concat(const String& str);
+	bool concat(const char* cstr);
+	bool concat(const char* cstr, unsigned int length);
+	bool concat(char c);
+	bool concat(unsigned char value);
+	bool concat(int value);
+	bool concat(unsigned int value);
+	bool concat(long value);
+	bool concat(unsigned long value);
+	bool concat(long long value);
+	bool concat(unsigned long long value);
+	bool concat(float value);
+	bool concat(double value);
+
+	template <typename T>
+	String& operator+=(const T& rhs) {
+		concat(rhs);
+		return *this;
+	}
+
+	int compareTo(const String& s) const;
+	bool equals(const String& s) const;
+	bool equals(const char* cstr) const;
+	bool equalsIgnoreCase(const String& s) const;
+	bool operator==(const String& rhs) const { return equals(rhs); }
+	bool operator==(const char* cstr) const { return equals(cstr); }
+	bool operator!=(const String& rhs) const { return !equals(rhs); }
+	bool operator!=(const char* cstr) const { return !equals(cstr); }
+	bool operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+
+	bool startsWith(const String& prefix) const;
+	bool startsWith(const String& prefix, unsigned int offset) const;
+	bool endsWith(const String& suffix) const;
+
+	char charAt(unsigned int index) const;
+	void setCharAt(unsigned int index, char c);
+	char operator[](unsigned int index) const;
+	char& operator[](unsigned int index);
+
+	int indexOf(char ch) const;
+	int indexOf(char ch, unsigned int fromIndex) const;
+	int indexOf(const String& str) const;
+	int indexOf(const String& str, unsigned int fromIndex) const;
+	int lastIndexOf(char ch) const;
+	int lastIndexOf(const String& str) const;
+
+	String substring(unsigned int beginIndex) const;
+	String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+	void replace(char find, char replace);
+	void replace(const String& find, const String& replace);
+	void remove(unsigned int index);
+	void remove(unsigned int index, unsigned int count);
+	void toLowerCase();
+	void toUpperCase();
+	void trim();
+
+	long toInt() const;
+	float toFloat() const;
+	double toDouble() const;
+
+private:
+	char* buffer;
+	unsigned int capacity;
+	unsigned int len;
+
+	void invalidate();
+	bool changeBuffer(unsigned int maxStrLen);
+	String& copy(const char* cstr, unsigned int length);
+	void move(String& rhs);
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(const String& lhs, int rhs);
+String operator+(const String& lhs, unsigned int rhs);
+String operator+(const String& lhs, long rhs);
+String operator+(const String& lhs, unsigned long rhs);
+
+#endif // HAL_NATIVE_WSTRING_H
@@ -0,0 +1,14 @@
+#ifndef HAL_NATIVE_BASE64_H
+#define HAL_NATIVE_BASE64_H
+
+#include <Arduino.h>
+
+class base64 {
+public:
+	static String encode(const uint8_t* data, size_t length, bool doNewLines = false);
+	static String encode(const String& text, bool doNewLines = false) {
+		return encode((const uint8_t*)text.c_str(), text.length(), doNewLines);
+	}
+};
+
+#endif // HAL_NATIVE_BASE64_H
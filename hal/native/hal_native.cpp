@@ -0,0 +1,347 @@
+// Native (Linux) HAL: clock, GPIO, W5500 interrupt emulation, UART and the
+// process entry point. Everything else the bridge touches lives in the
+// Ethernet/LittleFS/String stand-ins next to this file.
+
+#include "Arduino.h"
+#include "Ethernet.h"
+#include "Updater.h"
+#include "SPI.h"
+#include "base64.h"
+#include "DebugLog.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#ifndef HAL_NATIVE_HEAP_SIZE
+#define HAL_NATIVE_HEAP_SIZE (256 * 1024)   // RP2040 SRAM available to the heap
+#endif
+
+HalConsole Serial;
+HalUart Serial1;
+RP2040 rp2040;
+SPIClass SPI;
+UpdaterClass Update;
+DebugLogLevel halDebugLog::level = DebugLogLevel::LVL_INFO;
+
+static struct timespec halStartTime;
+static void (*halInterruptHandler)() = nullptr;
+
+// Clock
+
+static uint64_t halElapsedMicros() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t elapsedNs = (int64_t)(now.tv_sec - halStartTime.tv_sec) * 1000000000LL +
+						(int64_t)(now.tv_nsec - halStartTime.tv_nsec);
+	return (uint64_t)(elapsedNs / 1000);
+}
+
+// The RP2040 counters are 32 bits wide; keep the same wrap-around behaviour
+unsigned long millis() {
+	return (uint32_t)(halElapsedMicros() / 1000);
+}
+
+unsigned long micros() {
+	return (uint32_t)halElapsedMicros();
+}
+
+// delay() is where the W5500 INT line is emulated: wait on every open
+// socket and raise the registered interrupt handler when one has data.
+void delay(unsigned long ms) {
+	uint64_t deadline = halElapsedMicros() + (uint64_t)ms * 1000;
+	bool raised = false;
+	for (;;) {
+		struct pollfd pfds[MAX_SOCK_NUM + 17];
+		int fds[MAX_SOCK_NUM + 16];
+		int n = halSocketPollFds(fds, MAX_SOCK_NUM + 16);
+		for (int i = 0; i < n; i++) {
+			pfds[i].fd = fds[i];
+			pfds[i].events = POLLIN;
+			pfds[i].revents = 0;
+		}
+		int serialFd = Serial1.pollFd();
+		int total = n;
+		if (serialFd >= 0) {
+			pfds[total].fd = serialFd;
+			pfds[total].events = POLLIN;
+			pfds[total].revents = 0;
+			total++;
+		}
+
+		uint64_t now = halElapsedMicros();
+		int timeoutMs = now >= deadline ? 0 : (int)((deadline - now + 999) / 1000);
+		int ready = poll(pfds, total, raised ? 0 : timeoutMs);
+		if (ready > 0 && !raised) {
+			for (int i = 0; i < n; i++) {
+				if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+					if (halInterruptHandler) halInterruptHandler();
+					raised = true;
+					break;
+				}
+			}
+		}
+		Serial1.service();
+		now = halElapsedMicros();
+		if (now >= deadline) break;
+		if (raised) {
+			usleep((useconds_t)(deadline - now));
+			break;
+		}
+	}
+}
+
+void delayMicroseconds(unsigned int us) {
+	usleep(us);
+}
+
+void yield() {
+}
+
+// GPIO
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	(void)pin;
+	(void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+	(void)pin;
+	(void)value;
+}
+
+int digitalRead(uint8_t pin) {
+	(void)pin;
+	return HIGH;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*callback)(), int mode) {
+	(void)interrupt;
+	(void)mode;
+	halInterruptHandler = callback;
+}
+
+void noInterrupts() {
+}
+
+void interrupts() {
+}
+
+long random(long max) {
+	return max > 0 ? (long)(::random() % max) : 0;
+}
+
+long random(long min, long max) {
+	return max > min ? min + random(max - min) : min;
+}
+
+// Console
+
+size_t HalConsole::write(uint8_t c) {
+	return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HalConsole::write(const uint8_t* buffer, size_t size) {
+	return fwrite(buffer, 1, size, stdout);
+}
+
+void HalConsole::flush() {
+	fflush(stdout);
+}
+
+// UART
+//
+// P1_SERIAL selects what feeds Serial1:
+//   unset / "pty"  create a pseudo-terminal and print the slave path
+//   "tcp:PORT"     accept one meter feed connection on localhost:PORT
+//   any other      open that path (existing pty slave, FIFO or capture file)
+
+void HalUart::begin(unsigned long baud, uint16_t config) {
+	(void)baud;
+	(void)config;
+	if (fd >= 0 || listenFd >= 0) return;
+
+	const char* source = getenv("P1_SERIAL");
+	if (!source || !*source || strcmp(source, "pty") == 0) {
+		int master, slave;
+		char name[64];
+		if (openpty(&master, &slave, name, nullptr, nullptr) == 0) {
+			fd = master;
+			fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+			fprintf(stderr, "[hal] P1 serial pty: %s\n", name);
+		}
+	} else if (strncmp(source, "tcp:", 4) == 0) {
+		listenFd = socket(AF_INET, SOCK_STREAM, 0);
+		int one = 1;
+		setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		struct sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons((uint16_t)atoi(source + 4));
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 1) < 0) {
+			fprintf(stderr, "[hal] cannot open P1 serial feed %s: %s\n", source, strerror(errno));
+			close(listenFd);
+			listenFd = -1;
+			return;
+		}
+		fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+		fprintf(stderr, "[hal] P1 serial feed on tcp port %s\n", source + 4);
+	} else {
+		fd = open(source, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		if (fd < 0) fd = open(source, O_RDONLY | O_NONBLOCK);
+		if (fd < 0) fprintf(stderr, "[hal] cannot open P1 serial %s: %s\n", source, strerror(errno));
+	}
+}
+
+void HalUart::end() {
+	if (fd >= 0) close(fd);
+	fd = -1;
+}
+
+void HalUart::service() {
+	if (fd < 0 && listenFd >= 0) {
+		int s = accept(listenFd, nullptr, nullptr);
+		if (s >= 0) {
+			fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+			fd = s;
+		}
+	}
+}
+
+bool HalUart::fill() {
+	service();
+	if (rxHead != rxTail) return true;
+	if (fd < 0) return false;
+	ssize_t n = ::read(fd, rxBuffer, sizeof(rxBuffer));
+	if (n > 0) {
+		rxHead = 0;
+		rxTail = (size_t)n;
+		return true;
+	}
+	if (n == 0 && listenFd >= 0) {
+		// Feed disconnected: wait for the next one
+		close(fd);
+		fd = -1;
+	}
+	return false;
+}
+
+int HalUart::available() {
+	return fill() ? (int)(rxTail - rxHead) : 0;
+}
+
+int HalUart::read() {
+	if (!fill()) return -1;
+	return rxBuffer[rxHead++];
+}
+
+int HalUart::peek() {
+	if (!fill()) return -1;
+	return rxBuffer[rxHead];
+}
+
+size_t HalUart::write(uint8_t c) {
+	return write(&c, 1);
+}
+
+size_t HalUart::write(const uint8_t* buffer, size_t size) {
+	if (fd < 0) return 0;
+	ssize_t n = ::write(fd, buffer, size);
+	return n > 0 ? (size_t)n : 0;
+}
+
+// RP2040 helpers
+
+void RP2040::reboot() {
+	fprintf(stderr, "[hal] reboot requested, exiting\n");
+	fflush(stdout);
+	exit(0);
+}
+
+int RP2040::getUsedHeap() {
+	struct mallinfo2 info = mallinfo2();
+	return (int)info.uordblks;
+}
+
+int RP2040::getTotalHeap() {
+	return HAL_NATIVE_HEAP_SIZE;
+}
+
+int RP2040::getFreeHeap() {
+	int freeHeap = getTotalHeap() - getUsedHeap();
+	return freeHeap > 0 ? freeHeap : 0;
+}
+
+// Updater
+
+bool UpdaterClass::begin(size_t size, int command) {
+	(void)command;
+	expected = size;
+	written = 0;
+	error = UPDATE_ERROR_OK;
+	image = LittleFS.open("/firmware.bin", "w");
+	if (!image) error = UPDATE_ERROR_WRITE;
+	return !hasError();
+}
+
+size_t UpdaterClass::write(uint8_t* data, size_t len) {
+	if (hasError() || !image) return 0;
+	size_t n = image.write(data, len);
+	written += n;
+	if (n != len) error = UPDATE_ERROR_WRITE;
+	return n;
+}
+
+bool UpdaterClass::end(bool evenIfRemaining) {
+	image.close();
+	if (!evenIfRemaining && expected > 0 && written < expected) error = UPDATE_ERROR_SIZE;
+	return !hasError();
+}
+
+// base64
+
+String base64::encode(const uint8_t* data, size_t length, bool doNewLines) {
+	static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	(void)doNewLines;
+	String out;
+	out.reserve((unsigned int)(((length + 2) / 3) * 4));
+	for (size_t i = 0; i < length; i += 3) {
+		uint32_t chunk = (uint32_t)data[i] << 16;
+		if (i + 1 < length) chunk |= (uint32_t)data[i + 1] << 8;
+		if (i + 2 < length) chunk |= data[i + 2];
+		out += alphabet[(chunk >> 18) & 0x3F];
+		out += alphabet[(chunk >> 12) & 0x3F];
+		out += i + 1 < length ? alphabet[(chunk >> 6) & 0x3F] : '=';
+		out += i + 2 < length ? alphabet[chunk & 0x3F] : '=';
+	}
+	return out;
+}
+
+// Entry point
+
+void halBegin() {
+	clock_gettime(CLOCK_MONOTONIC, &halStartTime);
+	signal(SIGPIPE, SIG_IGN);
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+}
+
+#ifndef HAL_NATIVE_NO_MAIN
+int main(int argc, char** argv) {
+	(void)argc;
+	(void)argv;
+	halBegin();
+
+	setup();
+	for (;;) {
+		loop();
+	}
+	return 0;
+}
+#endif
@@ -10,9 +10,8 @@ extern EthernetServer server;
 extern EthernetClient clients[MAX_CONNECTIONS];
 extern unsigned long clientLastActivity[MAX_CONNECTIONS];
 extern bool clientConnected[MAX_CONNECTIONS];
-
-// Statistics
-extern unsigned long totalBytesSent;
+extern unsigned long clientBytesSent[MAX_CONNECTIONS];    // since the slot's client connected
+extern bool clientBinary[MAX_CONNECTIONS];                // binary frames instead of telegrams (p1_binary.h)
 
 // Function declarations
 void initializeClients();
@@ -57,6 +57,8 @@
 // Note: Serial1 uses predefined pins on RP2040 (GPIO0=TX, GPIO1=RX)
 // For Waveshare RP2040 Zero: Serial1 RX=GPIO1, TX=GPIO0
 #define P1_BAUD_RATE    115200
+#define P1_SERIAL_FIFO_SIZE  4096  // Serial1 RX FIFO (the core's default is 32 bytes): holds
+								 // the bytes that arrive while loop() waits on an MQTT or InfluxDB connect
 #define P1_DATA_REQUEST_PIN  29  // Optional: GPIO to control P1 data request (Pin 2)
 								 // Set to -1 if not used (most meters transmit continuously)
 
@@ -67,18 +69,29 @@
 // W5500 Socket Allocation Strategy (8 total sockets, 7 usable):
 // - P1 Server (port 2000): 1 server + 3 clients = 4 sockets
 // - Log Server (port 2001): 1 server + 1 client = 2 sockets  
-// - HTTP/OTA Server (port 80): 1 server socket = 1 socket (OTA integrated)
+// - HTTP/OTA Server (port 80): 1 socket guaranteed (OTA integrated); up to
+//   MAX_HTTP_CONNECTIONS while P1/log slots are free (checked at accept time).
+//   Event streams never borrow a P1/log slot, so only the guaranteed socket
+//   can be held open by one (/p1/stream and /ws answer 503 beyond that)
 // - NTP Client: 0 sockets (uses temporary socket when needed)
+// - MQTT/InfluxDB Publishers: 1 client socket each when enabled (InfluxDB over
+//   HTTP only), taken from the P1 clients (PUBLISHER_SOCKETS)
+// - Modbus TCP Server (port 502): 1 server + 1 client when enabled, taken from
+//   the P1 clients (MODBUS_SOCKETS)
 // - DHCP/Network: 1 socket reserved by W5500 (not user-controllable)
 // Total: 7 usable sockets + 1 reserved = 8 hardware sockets (optimized allocation)
+#define W5500_SOCKETS       8
+#define W5500_RESERVED_SOCKETS 1        // DHCP renewals and NTP queries
+#define W5500_SOCKET_TX_SIZE 2048       // TX buffer per socket with 8 sockets
 #define SERVER_PORT     2000
-#define MAX_CONNECTIONS 3       // P1 data clients (2 services + 1 debug)
+#define MAX_CONNECTIONS (3 - PUBLISHER_SOCKETS - MODBUS_SOCKETS)   // P1 data clients (2 services + 1 debug; a publisher replaces one)
 #define CLIENT_TIMEOUT  30000   // 30 seconds in milliseconds
 
 // Log Server Configuration  
 #define LOG_SERVER_PORT     2001
 #define MAX_LOG_CONNECTIONS 1   // Log clients (reduced to fit socket limit)
 #define LOG_CLIENT_TIMEOUT  60000  // 60 seconds in milliseconds (longer for log clients)
+#define LOG_MESSAGE_SIZE    256    // One formatted log line; longer lines are cut off
 
 // OTA (Over-The-Air) Update Configuration
 // Note: OTA is now integrated into HTTP server on port 80 (no separate port needed)
@@ -93,11 +106,181 @@
 #define HTTP_INFO_ENABLED   true            // Enable HTTP info page
 #define HTTP_INFO_PORT      80              // Standard HTTP port
 #define HTTP_INFO_TITLE     "P1 Serial-to-Network Bridge" // Page title
+#define HTTP_STREAM_TIMEOUT 30000           // drop a download that makes no progress (ms)
+#define HTTP_PAGE_BUFFER_SIZE 8192          // Static buffer every page and JSON response is built in
+#define HTTP_REQUEST_ARENA_SIZE 1536        // Per-request scratch for the method, path, headers kept, query values and body
+#define HTTP_REQUEST_LINE_MAX 512           // Longest request line or header line (414/431 beyond)
+#define HTTP_REQUEST_HEADERS_MAX 4096       // Most header bytes in one request (431 beyond)
+#define HTTP_REQUEST_BODY_MAX 512           // Largest body kept in the arena (413 beyond)
+#define HTTP_REQUEST_TIMEOUT 5000           // A request must arrive completely within this (ms)
+#define HTTP_PARSE_BUDGET   512             // Most request bytes parsed per loop() pass
+#define MAX_HTTP_CONNECTIONS 2              // HTTP connections served side by side, each with its own page buffer
+#define HTTP_DRAIN_TIMEOUT  2000            // Longest wait for a response to leave the socket before closing (ms)
+#define HTTP_KEEPALIVE_TIMEOUT 5000         // Close a persistent connection idle this long (ms)
+#define HTTP_KEEPALIVE_MAX_REQUESTS 100     // Requests served on one connection before it is closed
+#define HTTP_STREAM_CHUNK_SIZE 1536         // Largest piece of a generated page, written once the socket has room for it
+#define MAX_P1_EVENT_CLIENTS 2              // Browsers subscribed to /p1/stream; each holds a socket while open, see W5500_SOCKETS
+#define P1_EVENT_BUFFER_SIZE 3072           // One telegram event (JSON with the escaped telegram); two are kept
+#define P1_EVENT_STALL_TIMEOUT 5000         // Drop a subscriber that takes no event bytes this long (ms)
+#define P1_EVENT_KEEPALIVE 15000            // Comment line sent to an idle subscriber this often (ms)
+#define MAX_WEBSOCKET_CLIENTS 2             // /ws dashboards; each holds a socket while open, see W5500_SOCKETS
+#define WEBSOCKET_MESSAGE_MAX 128           // Largest message a client may send (closed with 1009 beyond)
+#define WEBSOCKET_PING_INTERVAL 20000       // Ping a client that sent nothing this long (ms)
+#define WEBSOCKET_PONG_TIMEOUT 10000        // Close when a ping is not answered within this (ms)
+#define WEBSOCKET_STALL_TIMEOUT 5000        // Close a client that takes no bytes of a message this long (ms)
+
+// MQTT Publisher Configuration
+// Decoded values are published as <MQTT_TOPIC_PREFIX>/<name> (QoS 0, retained),
+// each only when it differs from what was last published on that topic.
+// The broker settings can be overridden from build_flags, e.g.
+// -DMQTT_ENABLED=true -DMQTT_BROKER=\"192.168.1.10\"
+#ifndef MQTT_ENABLED
+#define MQTT_ENABLED        false           // takes a W5500 socket, see MAX_CONNECTIONS
+#endif
+#ifndef MQTT_BROKER
+#define MQTT_BROKER         "192.168.1.10"  // host name or IP; an IP skips the DNS lookup, which also blocks loop()
+#endif
+#ifndef MQTT_PORT
+#define MQTT_PORT           1883
+#endif
+#ifndef MQTT_CLIENT_ID
+#define MQTT_CLIENT_ID      "p1-bridge"
+#endif
+#ifndef MQTT_USERNAME
+#define MQTT_USERNAME       ""              // empty: connect without credentials
+#endif
+#ifndef MQTT_PASSWORD
+#define MQTT_PASSWORD       ""
+#endif
+#ifndef MQTT_TOPIC_PREFIX
+#define MQTT_TOPIC_PREFIX   "p1"            // <prefix>/status is "online", or "offline" as the will
+#endif
+#define MQTT_KEEPALIVE      60              // seconds, sent in CONNECT; pinged at half of it when idle
+#define MQTT_CONNECT_TIMEOUT 250            // TCP connect blocks loop() up to this long (ms), see P1_SERIAL_FIFO_SIZE
+#define MQTT_CONNACK_TIMEOUT 5000           // Give up on a broker that does not answer CONNECT (ms)
+#define MQTT_BACKOFF_MIN    1000            // First retry after a failed connect (ms), doubled per failure
+#define MQTT_BACKOFF_MAX    60000           // Longest wait between connect attempts (ms)
+#define MQTT_BATCH_SIZE     1024            // PUBLISH packets collected for one socket write
+#define MQTT_STALL_TIMEOUT  10000           // Reconnect when the socket takes no batch this long (ms)
+
+// InfluxDB Line Protocol Configuration
+// Every decoded telegram becomes a point, <measurement>,<tags> <values> <ns>,
+// timestamped with its arrival on the NTP clock (points before the first sync
+// are dropped). Points collect in a buffer that is sent when the next point
+// does not fit or INFLUX_FLUSH_INTERVAL after its first point. Overridable
+// from build_flags like the MQTT settings.
+#define INFLUX_UDP          1               // one datagram per buffer, on a socket opened for the send (like NTP)
+#define INFLUX_HTTP         2               // POST per buffer; keeps a socket, see MAX_CONNECTIONS
+#ifndef INFLUX_ENABLED
+#define INFLUX_ENABLED      false
+#endif
+#ifndef INFLUX_TRANSPORT
+#define INFLUX_TRANSPORT    INFLUX_UDP
+#endif
+#ifndef INFLUX_HOST
+#define INFLUX_HOST         "192.168.1.10"  // host name or IP; an IP skips the DNS lookup, which also blocks loop()
+#endif
+#ifndef INFLUX_PORT
+#define INFLUX_PORT         8089            // InfluxDB 1.x UDP listener; 8086 for HTTP
+#endif
+#ifndef INFLUX_HTTP_PATH
+#define INFLUX_HTTP_PATH    "/write?db=p1&precision=ns"     // 2.x: /api/v2/write?org=..&bucket=..&precision=ns
+#endif
+#ifndef INFLUX_HTTP_AUTH
+#define INFLUX_HTTP_AUTH    ""              // Authorization header, e.g. "Token ..." for 2.x; empty for none
+#endif
+#ifndef INFLUX_MEASUREMENT
+#define INFLUX_MEASUREMENT  "p1"
+#endif
+#ifndef INFLUX_TAGS
+#define INFLUX_TAGS         "device=p1-bridge"  // tag set, line protocol escaped; empty for none
+#endif
+#define INFLUX_BUFFER_SIZE  (INFLUX_TRANSPORT == INFLUX_UDP ? 1400 : 4096)  // per buffer, two are kept; UDP stays under the MTU
+#define INFLUX_FLUSH_INTERVAL 10000         // Send a buffer this long after its first point (ms)
+#define INFLUX_CONNECT_TIMEOUT 250          // HTTP: TCP connect blocks loop() up to this long (ms), see P1_SERIAL_FIFO_SIZE
+#define INFLUX_RESPONSE_TIMEOUT 5000        // HTTP: a POST must be sent and answered within this (ms)
+#define INFLUX_RETRY_INTERVAL 60000         // HTTP: after a failed connect, buffers are dropped this long (ms)
+
+// Modbus TCP Server Configuration
+// Function codes 3 and 4 read the same register image of the latest decoded
+// telegram, rebuilt when it arrives (layout in modbus_server.h)
+#ifndef MODBUS_ENABLED
+#define MODBUS_ENABLED      false           // takes 1 + MAX_MODBUS_CONNECTIONS sockets, see MAX_CONNECTIONS
+#endif
+#ifndef MODBUS_PORT
+#define MODBUS_PORT         502
+#endif
+#define MAX_MODBUS_CONNECTIONS 1            // A new connection replaces the oldest (a PLC that reconnects)
+#define MODBUS_CLIENT_TIMEOUT 60000         // Close a client that sent no request this long (ms)
+#define MODBUS_REQUESTS_PER_PASS 4          // Pipelined requests answered per client per loop() pass
+
+// Connections the publishers keep open, each taken from the P1 clients
+#define PUBLISHER_SOCKETS   ((MQTT_ENABLED ? 1 : 0) + (INFLUX_ENABLED && INFLUX_TRANSPORT == INFLUX_HTTP ? 1 : 0))
+#define MODBUS_SOCKETS      (MODBUS_ENABLED ? 1 + MAX_MODBUS_CONNECTIONS : 0)
+
+static_assert(HTTP_STREAM_CHUNK_SIZE + 16 <= W5500_SOCKET_TX_SIZE && HTTP_STREAM_CHUNK_SIZE <= HTTP_PAGE_BUFFER_SIZE,
+			  "a generated page chunk, with its framing, must fit the socket TX buffer and the page buffer");
+
+static_assert(MQTT_BATCH_SIZE <= W5500_SOCKET_TX_SIZE, "an MQTT batch must fit the socket TX buffer");
+static_assert(!MQTT_ENABLED || P1_SERIAL_FIFO_SIZE >= P1_BAUD_RATE / 10 * MQTT_CONNECT_TIMEOUT / 1000,
+			  "the P1 UART FIFO must hold the bytes that arrive during an MQTT connect");
+static_assert(!INFLUX_ENABLED || INFLUX_TRANSPORT != INFLUX_HTTP || P1_SERIAL_FIFO_SIZE >= P1_BAUD_RATE / 10 * INFLUX_CONNECT_TIMEOUT / 1000,
+			  "the P1 UART FIFO must hold the bytes that arrive during an InfluxDB connect");
+
+// Full P1, log and Modbus servers (and the publisher connections) must still
+// leave a socket for one HTTP connection
+static_assert(MAX_CONNECTIONS >= 1, "socket budget: the publishers and Modbus leave no P1 client slot");
+static_assert((1 + MAX_CONNECTIONS) + (1 + MAX_LOG_CONNECTIONS) + 1 + PUBLISHER_SOCKETS + MODBUS_SOCKETS + W5500_RESERVED_SOCKETS <= W5500_SOCKETS,
+			  "socket budget: P1, log, HTTP and Modbus servers and the publishers do not fit the W5500");
+static_assert(INFLUX_TRANSPORT != INFLUX_UDP || INFLUX_BUFFER_SIZE <= W5500_SOCKET_TX_SIZE, "an InfluxDB datagram must fit the socket TX buffer");
 
 // Buffer Configuration
 #define P1_BUFFER_SIZE  2048   // Maximum P1 message size
 #define ETHERNET_BUFFER_SIZE 1024
 
+// Aggregation Configuration
+// Parsed telegrams are folded into min/max/avg/last buckets kept in RAM rings
+// (~210 bytes per bucket, ~37KB for the defaults below)
+#define AGG_MINUTE_SLOTS        60      // 1-minute buckets (last hour)
+#define AGG_QUARTER_HOUR_SLOTS  96      // 15-minute buckets (last day)
+#define AGG_HOUR_SLOTS          24      // 1-hour buckets (last day)
+
+// History Store Configuration
+// Closed 1-minute buckets are appended to segment files on LittleFS, about
+// 4-5 bytes per minute (net power plus energy/gas/water deltas as varints).
+// OTA uploads are staged on the same partition, so the budget leaves room
+// for a firmware image; the oldest segments are dropped if an upload needs more.
+#define HISTORY_ENABLED         true
+#define HISTORY_DIR             "/history"
+#define HISTORY_MAX_BYTES       (288 * 1024)    // ~7 weeks of 1-minute records
+#define HISTORY_SEGMENT_SIZE    (16 * 1024)     // start a new segment file at this size
+#define HISTORY_INDEX_STRIDE    1024            // one time index entry per KB of segment
+#define HISTORY_BATCH_RECORDS   30              // records per flash append (minutes of data at risk on power loss)
+#define HISTORY_OTA_RESERVE     (192 * 1024)    // free space needed to stage a firmware upload
+#define HISTORY_STREAM_CHUNK_SIZE   1024        // /api/history bytes written per loop() pass
+#define HISTORY_STREAM_RECORDS_PER_PASS 64      // /api/history records read per loop() pass; a long step spans passes
+
+// Serial Capture Configuration
+// Raw UART bytes can be recorded with micros() timestamps and replayed into
+// the framer (see /capture on the HTTP server)
+#define P1_CAPTURE_CHUNK_SIZE   64              // max UART bytes per read / capture record
+#define P1_CAPTURE_RAM_SIZE     (16 * 1024)     // RAM ring, keeps the most recent records
+#define P1_CAPTURE_FILE_PATH    "/capture.p1c"
+#define P1_CAPTURE_FILE_MAX     (128 * 1024)    // file capture stops at this size
+#define P1_REPLAY_SLICE_US      10000           // max framer time per loop() pass at full replay speed
+
+// Heap/Stack Telemetry Configuration
+// Free heap, largest free block, stack high-water marks and allocation counts
+// are sampled into a RAM ring (shown on /status); each sample is ~28 bytes
+#define HEAP_SAMPLE_INTERVAL    60000           // ms between samples
+#define HEAP_SAMPLE_COUNT       60              // samples kept (last hour)
+
+// Statistics Configuration
+// Bridge counters live in one registry (stats.h), each with a rate that is an
+// exponentially weighted moving average over roughly STATS_RATE_WINDOW
+#define STATS_RATE_INTERVAL     1000            // ms between rate updates
+#define STATS_RATE_WINDOW       60000           // EWMA time constant (ms)
+
 // Debug Configuration
 #define DEBUG_SERIAL    true
 #define STATUS_LED_PIN  PIN_NEOPIXEL    // GPIO16 - WS2812 NeoPixel LED (onboard)
@@ -120,5 +303,8 @@
 #define P1_START_CHAR   '/'
 #define P1_END_CHAR     '!'
 #define P1_CHECKSUM_LEN 4
+#define P1_VALIDATE_CRC true    // drop telegrams whose CRC-16 does not match (DSMR 4+)
+#define P1_FRAME_TIMEOUT 500    // abandon a telegram after this long without bytes (ms)
+#define P1_TELEGRAM_CALLBACKS 8 // consumers of every telegram (event stream, binary clients, publishers, ...)
 
 #endif // CONFIG_H
@@ -0,0 +1,10 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <Arduino.h>
+
+// CRC-16/ARC (polynomial 0xA001 reflected, initial value 0), the checksum
+// DSMR meters put after the '!' of every telegram
+uint16_t crc16Update(uint16_t crc, const uint8_t* data, size_t length);
+
+#endif // CRC16_H
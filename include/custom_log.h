@@ -4,23 +4,39 @@
 #include <Arduino.h>
 #define DEBUGLOG_DEFAULT_LOG_LEVEL_INFO
 #include <DebugLog.h>
+#include "config.h"
+#include "string_builder.h"
 
-// Helper function to build log messages
-void sendRemoteLog(const char* level, const String& message);
+// True when a log client is connected; remote messages are only formatted then
+bool isRemoteLogActive();
 
-// Macros that use the original DebugLog and also send to remote clients
-#define REMOTE_LOG_INFO(...) do { LOG_INFO(__VA_ARGS__); sendRemoteLog("INFO", buildLogMessage(__VA_ARGS__)); } while(0)
-#define REMOTE_LOG_DEBUG(...) do { LOG_DEBUG(__VA_ARGS__); sendRemoteLog("DEBUG", buildLogMessage(__VA_ARGS__)); } while(0)
-#define REMOTE_LOG_WARN(...) do { LOG_WARN(__VA_ARGS__); sendRemoteLog("WARN", buildLogMessage(__VA_ARGS__)); } while(0)
-#define REMOTE_LOG_ERROR(...) do { LOG_ERROR(__VA_ARGS__); sendRemoteLog("ERROR", buildLogMessage(__VA_ARGS__)); } while(0)
+// Helper function to send a built log message to remote clients
+void sendRemoteLog(const char* level, const StringBuilder& message);
 
-// Helper function to build log messages from multiple parameters
-String buildLogMessage(const char* msg);
-String buildLogMessage(const char* msg, int value);
-String buildLogMessage(const char* msg, unsigned long value);
-String buildLogMessage(const char* msg, const String& value);
-String buildLogMessage(const char* msg, IPAddress ip);
-String buildLogMessage(const char* msg, int v1, const char* msg2, IPAddress ip, const char* msg3);
-String buildLogMessage(const char* msg, unsigned long v1, const char* msg2, unsigned int v2, const char* msg3);
+// Macros that use the original DebugLog and also send to remote clients.
+// The remote copy is formatted on the stack, never on the heap.
+#define REMOTE_LOG_SEND(level, ...) do { \
+		if (isRemoteLogActive()) { \
+			FixedString<LOG_MESSAGE_SIZE> remoteLogMessage; \
+			buildLogMessage(remoteLogMessage, __VA_ARGS__); \
+			sendRemoteLog(level, remoteLogMessage); \
+		} \
+	} while(0)
+#define REMOTE_LOG_INFO(...) do { LOG_INFO(__VA_ARGS__); REMOTE_LOG_SEND("INFO", __VA_ARGS__); } while(0)
+#define REMOTE_LOG_DEBUG(...) do { LOG_DEBUG(__VA_ARGS__); REMOTE_LOG_SEND("DEBUG", __VA_ARGS__); } while(0)
+#define REMOTE_LOG_WARN(...) do { LOG_WARN(__VA_ARGS__); REMOTE_LOG_SEND("WARN", __VA_ARGS__); } while(0)
+#define REMOTE_LOG_ERROR(...) do { LOG_ERROR(__VA_ARGS__); REMOTE_LOG_SEND("ERROR", __VA_ARGS__); } while(0)
+
+// Helper functions to build log messages from multiple parameters
+void buildLogMessage(StringBuilder& out, const char* msg);
+void buildLogMessage(StringBuilder& out, const char* msg, int value);
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long value);
+void buildLogMessage(StringBuilder& out, const char* msg, const char* value);
+void buildLogMessage(StringBuilder& out, const char* msg, const String& value);
+void buildLogMessage(StringBuilder& out, const char* msg, IPAddress ip);
+void buildLogMessage(StringBuilder& out, const char* msg, int v1, const char* msg2, IPAddress ip, const char* msg3);
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long v1, const char* msg2, unsigned int v2, const char* msg3);
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long v1, const char* msg2, unsigned long v2);
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long v1, const char* msg2, unsigned long v2, const char* msg3, unsigned long v3);
 
 #endif // CUSTOM_LOG_H
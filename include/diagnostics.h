@@ -4,7 +4,20 @@
 #include <Arduino.h>
 #include "config.h"
 
+// Work time of each loop() pass (without its closing delay), as a histogram
+#define LOOP_TIME_BUCKET_COUNT 7
+extern const uint32_t loopTimeBucketsUs[LOOP_TIME_BUCKET_COUNT];
+
+struct LoopTimeStats {
+	uint32_t passes;
+	uint64_t totalUs;
+	uint32_t maxUs;                             // slowest pass since boot
+	uint32_t buckets[LOOP_TIME_BUCKET_COUNT];   // passes of at most loopTimeBucketsUs[i] (cumulative)
+};
+
 // Function declarations
 void printStatus();
+void recordLoopTime(uint32_t us);
+void getLoopTimeStats(LoopTimeStats& stats);
 
 #endif // DIAGNOSTICS_H
@@ -0,0 +1,67 @@
+#ifndef HEAP_TELEMETRY_H
+#define HEAP_TELEMETRY_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Subsystems allocations are charged to. The tag is set by HEAP_TAG_SCOPE at
+// the entry point of each subsystem; anything else counts as HEAP_TAG_OTHER.
+enum HeapTag {
+	HEAP_TAG_OTHER,
+	HEAP_TAG_P1,            // framer, parser, aggregator
+	HEAP_TAG_CLIENTS,       // P1 TCP clients
+	HEAP_TAG_LOG,           // remote log server and messages
+	HEAP_TAG_HTTP,          // web pages and API
+	HEAP_TAG_NTP,
+	HEAP_TAG_HISTORY,       // flash history store and downloads
+	HEAP_TAG_CAPTURE,       // serial capture and replay
+	HEAP_TAG_COUNT
+};
+
+struct HeapTagStats {
+	uint32_t allocations;       // malloc/calloc/realloc calls
+	uint32_t bytes;             // bytes requested by those calls
+};
+
+struct HeapSample {
+	uint32_t uptime;            // seconds
+	uint32_t freeHeap;
+	uint32_t largestFreeBlock;
+	uint16_t stackUsed[2];      // high-water mark per core, bytes
+	uint32_t allocations;       // total since boot
+	uint32_t allocationsPerMinute;
+};
+
+struct HeapTelemetryStats {
+	uint32_t totalHeap;
+	uint32_t minFreeHeap;           // lowest free heap seen in a sample
+	uint32_t minLargestFreeBlock;   // lowest largest free block seen in a sample
+	uint16_t stackSize[2];          // 0 when not measured (core not running, host build)
+	uint16_t sampleCount;           // samples held in the ring
+};
+
+// Sets the allocation tag until the end of the enclosing block
+class HeapTagScope {
+public:
+	explicit HeapTagScope(HeapTag tag);
+	~HeapTagScope();
+
+private:
+	uint8_t previous;
+};
+
+#define HEAP_TAG_SCOPE(tag) HeapTagScope heapTagScope(tag)
+
+// Function declarations
+void initializeHeapTelemetry();
+void handleHeapTelemetry();
+// Take a sample now without adding it to the ring (updates the low-water marks)
+void sampleHeapTelemetry(HeapSample& sample);
+bool getHeapSample(uint16_t age, HeapSample& sample);   // age 0 = newest
+void getHeapTelemetryStats(HeapTelemetryStats& stats);
+void getHeapTagStats(HeapTag tag, HeapTagStats& stats);
+void getHeapAllocationTotals(HeapTagStats& stats);
+const char* getHeapTagName(HeapTag tag);
+uint32_t getLargestFreeBlock();
+
+#endif // HEAP_TELEMETRY_H
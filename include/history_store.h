@@ -0,0 +1,91 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "p1_aggregator.h"
+#include "varint.h"
+
+// On-flash history of closed 1-minute buckets.
+//
+// Layout: HISTORY_DIR holds segment files named after an increasing sequence
+// number (00000001.seg, ...). A segment is append-only:
+//
+//   header   magic, version, sequence, absolute registers after the first record
+//   blocks   one per batch of records: marker, count, length, first record
+//            time, varint-packed records, CRC-16
+//   footer   (sealed segments only) time index, one entry per
+//            HISTORY_INDEX_STRIDE bytes, followed by count/CRC/magic
+//
+// Records are batched in RAM and appended one block at a time. A block that
+// was cut short by a reset fails its CRC and is truncated at the next mount.
+
+#define HISTORY_RECORD_POWER    0x01    // powerW is valid
+
+#define HISTORY_MAX_RECORD_SIZE     (1 + (2 + AGG_COUNTER_COUNT) * VARINT_MAX_SIZE)
+#define HISTORY_BATCH_BUFFER_SIZE   (HISTORY_BATCH_RECORDS * 8 + HISTORY_MAX_RECORD_SIZE)
+
+struct HistoryRecord {
+	uint32_t time;                          // bucket start (NTP epoch)
+	uint8_t flags;                          // HISTORY_RECORD_* flags
+	uint8_t counterMask;                    // bit per AggCounterId with a non-zero delta
+	int32_t powerW;                         // average net power (delivered - returned)
+	uint32_t counters[AGG_COUNTER_COUNT];   // register deltas (Wh, dm3)
+};
+
+struct HistoryStats {
+	bool mounted;
+	uint16_t segments;
+	uint32_t storedBytes;           // size of all segment files
+	uint32_t oldestTime;            // first stored record, 0 when empty
+	uint32_t newestTime;            // last record (on flash or pending)
+	uint16_t pendingRecords;        // records waiting in RAM for the next block
+	uint32_t recordsAppended;
+	uint32_t recordsSkipped;        // buckets without NTP time or out of order
+	uint32_t blocksWritten;
+	uint32_t recordBytes;           // encoded record bytes
+	uint32_t flashBytesWritten;     // estimated bytes programmed, including LittleFS tail copies
+	uint32_t flashBlocksErased;     // estimated erase operations
+	uint32_t segmentsCreated;
+	uint32_t segmentsDeleted;
+	uint32_t recoveredBytes;        // torn tail bytes truncated at mount
+	uint32_t writeErrors;
+	uint32_t writeAmplificationX100;
+	uint32_t flashBytesPerDay;
+	uint32_t flashErasesPerDay;
+	uint32_t flashBlockCount;
+	uint32_t flashLifetimeYears;    // at the current erase rate, 0 when unknown
+};
+
+// Read position for a time range query. It holds one decoded block and
+// survives appends and segment rotation between calls, so a reader can be
+// advanced a few records at a time from loop().
+struct HistoryCursor {
+	uint32_t from;
+	uint32_t to;
+	uint32_t lastTime;          // newest record returned so far
+	uint32_t sequence;          // segment being read, 0 when past the last one
+	uint32_t offset;            // next block in that segment
+	uint8_t block[HISTORY_BATCH_BUFFER_SIZE];
+	uint16_t blockLength;
+	uint16_t blockPosition;
+	uint8_t blockRecords;
+	uint8_t blockRecord;
+	uint32_t blockTime;
+	bool pendingRead;           // records still in RAM have been copied
+	bool done;
+};
+
+// Function declarations
+void initializeHistory();
+void flushHistory();
+// Drop the oldest segments until LittleFS has at least the given number of free bytes
+bool releaseHistorySpace(size_t bytes);
+void getHistoryStats(HistoryStats& stats);
+
+// Records with from <= time <= to, oldest first. The start is located with
+// the segment time indexes, so no earlier blocks are read.
+void openHistoryCursor(HistoryCursor& cursor, uint32_t from, uint32_t to);
+bool readHistoryRecord(HistoryCursor& cursor, HistoryRecord& record);
+
+#endif // HISTORY_STORE_H
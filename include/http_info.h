@@ -6,5 +6,9 @@
 #include "web/p1_web_handler.h"
 #include "web/logs_web_handler.h"
 #include "web/status_web_handler.h"
+#include "web/api_web_handler.h"
+#include "web/capture_web_handler.h"
+#include "web/websocket_handler.h"
+#include "web/metrics_web_handler.h"
 
 #endif // HTTP_INFO_H
@@ -0,0 +1,19 @@
+#ifndef INFLUX_CLIENT_H
+#define INFLUX_CLIENT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// InfluxDB line protocol output (INFLUX_ENABLED). Each decoded telegram is
+// one point with a field per value, named as the MQTT topics (see p1_values.h)
+// and with a nanosecond timestamp from its arrival:
+//   p1,device=p1-bridge tariff=2i,energy_delivered_t1_kwh=1234.567,power_delivered_w=512i 1760000000123000000
+// Values with decimals are floats, the others integers. Points are collected
+// in one of two fixed buffers and sent over UDP or HTTP POST once the next
+// point does not fit or INFLUX_FLUSH_INTERVAL has passed since the first.
+
+// Function declarations
+void initializeInflux();
+void handleInflux();
+
+#endif // INFLUX_CLIENT_H
@@ -11,14 +11,10 @@ extern EthernetClient logClients[MAX_LOG_CONNECTIONS];
 extern unsigned long logClientLastActivity[MAX_LOG_CONNECTIONS];
 extern bool logClientConnected[MAX_LOG_CONNECTIONS];
 
-// Log statistics
-extern unsigned long totalLogMessages;
-extern unsigned long totalLogBytesSent;
-
 // Function declarations
 void initializeLogServer();
 void handleNewLogConnections();
-void sendToAllLogClients(const String& logMessage);
+void sendToAllLogClients(const char* logMessage);
 void handleLogClientCommunication();
 void cleanupLogClients();
 int getConnectedLogClientCount();
@@ -0,0 +1,29 @@
+#ifndef MODBUS_SERVER_H
+#define MODBUS_SERVER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "p1_values.h"
+
+// Modbus TCP server for building controllers (MODBUS_ENABLED). Function codes
+// 3 (holding) and 4 (input registers) read the same fixed layout, any unit id:
+//   0       layout version (1)
+//   1       seconds since the reading, 65535 before the first one
+//   2-3     readings decoded since boot
+//   4-5     values present, bit n for value n
+//   10+2n   value n of p1_values.h as a signed 32-bit scaled integer, the
+//           unit of its name times 10^decimals (e.g. energy in Wh, voltage in
+//           0.1 V); 0x80000000 when the telegram does not have it
+// 32-bit quantities are big endian, high word first. The registers are
+// written into a wire-order image when a telegram is decoded, so a request is
+// answered with one copy out of it.
+#define MODBUS_VALUE_BASE       10
+#define MODBUS_REGISTER_COUNT   (MODBUS_VALUE_BASE + 2 * P1_VALUE_COUNT)
+
+// Function declarations
+void initializeModbus();
+void handleNewModbusConnections();
+void handleModbusClients();
+int getConnectedModbusClientCount();
+
+#endif // MODBUS_SERVER_H
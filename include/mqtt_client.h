@@ -0,0 +1,21 @@
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// MQTT 3.1.1 publisher for the decoded telegram (MQTT_ENABLED). Every value
+// goes to its own topic, <MQTT_TOPIC_PREFIX>/<name>, as a plain number in the
+// unit at the end of the name (e.g. p1/power_delivered_w = 1234). A topic is
+// only published when its value changed since it was last published in this
+// session; all changed topics of a telegram go out as one socket write.
+// Publishes are QoS 0 and retained, so a new subscriber gets the latest value
+// of a topic that rarely changes. A lost connection is retried with backoff,
+// from MQTT_BACKOFF_MIN doubling up to MQTT_BACKOFF_MAX.
+
+// Function declarations
+void initializeMQTT();
+void handleMQTT();
+bool isMQTTConnected();
+
+#endif // MQTT_CLIENT_H
@@ -13,8 +13,12 @@
 // NTP packet structure
 #define NTP_PACKET_SIZE 48
 
+// Room for a formatted date and time plus terminator
+#define NTP_TIME_STRING_SIZE 24
+
 struct NTPTime {
     unsigned long epoch;        // Unix timestamp (seconds since 1970)
+    uint16_t fractionMs;        // milliseconds past epoch at lastUpdate
     unsigned long lastUpdate;   // millis() when time was last updated
     bool valid;                 // Whether time is valid
 };
@@ -23,6 +27,9 @@ struct NTPTime {
 void initializeNTP();
 bool updateNTPTime();
 unsigned long getCurrentEpoch();
+uint64_t getEpochMillis(unsigned long at);                            // Unix time in ms at a millis() value, 0 if not synced
+void printFormattedTime(Print& out, unsigned long epoch = 0);         // HH:MM:SS
+void printFormattedDateTime(Print& out, unsigned long epoch = 0);     // YYYY-MM-DD HH:MM:SS
 String getFormattedTime(unsigned long epoch = 0);
 String getFormattedDateTime(unsigned long epoch = 0);
 bool isNTPTimeValid();
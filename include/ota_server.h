@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <Ethernet.h>
 #include "config.h"
+#include "string_builder.h"
 
 // OTA server state
 enum OTAState {
@@ -21,21 +22,11 @@ extern unsigned long otaStartTime;
 extern unsigned long otaBytesReceived;
 extern unsigned long otaTotalBytes;
 
-// Statistics
-extern unsigned long totalOTAAttempts;
-extern unsigned long successfulOTAUpdates;
-extern unsigned long lastOTAUpdate;
-
 // Function declarations
 void handleOTAUpload(EthernetClient& client);
-bool verifyOTACredentials(const String& authHeader);
+bool verifyOTACredentials(const char* authHeader);
 void sendOTAResponse(EthernetClient& client, int statusCode, const String& message);
-String getOTAStatus();
+void buildOTAStatus(StringBuilder& status);
 void resetOTAState();
 
-// Statistics functions for diagnostics
-unsigned long getOTARequestCount();
-unsigned long getOTAUpdateCount();  
-unsigned long getLastOTATimestamp();
-
 #endif // OTA_SERVER_H
@@ -0,0 +1,86 @@
+#ifndef P1_AGGREGATOR_H
+#define P1_AGGREGATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "p1_parser.h"
+
+// Aggregation resolutions, each backed by its own fixed-size ring
+enum AggResolution {
+	AGG_MINUTE,
+	AGG_QUARTER_HOUR,
+	AGG_HOUR,
+	AGG_RESOLUTION_COUNT
+};
+
+// Instantaneous values tracked with min/max/avg/last per bucket
+enum AggChannelId {
+	AGG_POWER_DELIVERED,
+	AGG_POWER_RETURNED,
+	AGG_VOLTAGE_L1,
+	AGG_VOLTAGE_L2,
+	AGG_VOLTAGE_L3,
+	AGG_CURRENT_L1,
+	AGG_CURRENT_L2,
+	AGG_CURRENT_L3,
+	AGG_POWER_L1,          // net (delivered - returned) per phase
+	AGG_POWER_L2,
+	AGG_POWER_L3,
+	AGG_CHANNEL_COUNT
+};
+
+// Registers tracked as deltas per bucket
+enum AggCounterId {
+	AGG_ENERGY_DELIVERED_T1,
+	AGG_ENERGY_DELIVERED_T2,
+	AGG_ENERGY_RETURNED_T1,
+	AGG_ENERGY_RETURNED_T2,
+	AGG_GAS,
+	AGG_WATER,
+	AGG_COUNTER_COUNT
+};
+
+#define AGG_BUCKET_TIME_SYNCED  0x01    // start is an NTP epoch (otherwise uptime seconds)
+
+struct AggChannel {
+	int32_t min;
+	int32_t max;
+	int32_t avg;
+	int32_t last;
+};
+
+struct AggBucket {
+	uint32_t start;                             // bucket start (aligned to the period)
+	uint16_t samples;                           // telegrams aggregated into this bucket
+	uint16_t channelMask;                       // bit per AggChannelId that has samples
+	uint8_t flags;                              // AGG_BUCKET_* flags
+	uint8_t counterMask;                        // bit per AggCounterId that has a delta
+	AggChannel channels[AGG_CHANNEL_COUNT];     // same units as P1Reading
+	uint32_t counters[AGG_COUNTER_COUNT];       // register deltas (Wh, dm3)
+};
+
+// Called with every bucket that has just been closed
+typedef void (*AggBucketClosedCallback)(AggResolution resolution, const AggBucket& bucket);
+
+// Function declarations
+void initializeAggregator();
+void aggregateP1Reading(const P1Reading& reading, uint32_t timestamp, bool timeSynced);
+void setAggregateClosedCallback(AggBucketClosedCallback callback);
+// Absolute register value behind an AggCounterId (false when not in the telegram)
+bool readAggregateCounter(const P1Reading& reading, AggCounterId counter, uint32_t& value);
+// Register as of the last telegram aggregated; in the closed callback, the
+// last telegram of the closed bucket
+bool getAggregateRegister(AggCounterId counter, uint32_t& value);
+
+// Closed buckets, age 0 = most recent
+uint16_t getAggregateCount(AggResolution resolution);
+bool getAggregate(AggResolution resolution, uint16_t age, AggBucket& bucket);
+// Bucket still being filled, with the average computed so far
+bool getOpenAggregate(AggResolution resolution, AggBucket& bucket);
+
+uint32_t getAggregatePeriod(AggResolution resolution);
+const char* getAggregateResolutionName(AggResolution resolution);
+const char* getAggregateChannelName(AggChannelId channel);
+const char* getAggregateCounterName(AggCounterId counter);
+
+#endif // P1_AGGREGATOR_H
@@ -0,0 +1,36 @@
+#ifndef P1_BINARY_H
+#define P1_BINARY_H
+
+#include <Arduino.h>
+#include "p1_parser.h"
+#include "p1_values.h"
+
+// Compact binary encoding of the decoded telegram, for P1 clients on metered
+// links. A client that sends the line "binary" gets P1_BINARY_HELLO and from
+// then on one frame per decoded telegram instead of the raw text:
+//   type    1 byte, 'K' keyframe or 'D' delta against the frame before it
+//   length  1 byte, the bytes that follow
+//   mask    varint; keyframe: items present, delta: items changed
+//   items   zigzag varint per bit set, lowest first; keyframe: the value,
+//           delta: the difference to the previous frame
+// Items 0-23 are the values of p1_values.h as scaled integers, item 24 the
+// meter time as (seconds since 2020-01-01 meter time) * 2 + 1 in summer time.
+// A keyframe is sent first, when the set of items changes, and after a frame
+// was skipped because the client's socket was full.
+#define P1_BINARY_ITEM_COUNT    (P1_VALUE_COUNT + 1)
+#define P1_BINARY_ITEM_TIME     P1_VALUE_COUNT
+#define P1_BINARY_FRAME_MAX     (2 + 5 + P1_BINARY_ITEM_COUNT * 5)
+#define P1_BINARY_HELLO         "P1B\x01"   // magic and format version
+#define P1_BINARY_COMMAND       "binary"
+
+struct P1BinaryItems {
+	uint32_t present;                   // bit per item
+	int32_t values[P1_BINARY_ITEM_COUNT];
+};
+
+void getP1BinaryItems(const P1Reading& reading, P1BinaryItems& items);
+// A delta against previous when it has the same items, otherwise (or when
+// previous is nullptr) a keyframe. Returns the frame size.
+size_t encodeP1BinaryFrame(const P1BinaryItems& items, const P1BinaryItems* previous, uint8_t* out);
+
+#endif // P1_BINARY_H
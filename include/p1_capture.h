@@ -0,0 +1,71 @@
+#ifndef P1_CAPTURE_H
+#define P1_CAPTURE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Raw UART capture and replay.
+//
+// Capture format (also what /capture/download returns):
+//   header   "P1CP", version, source, reserved (2), baud rate (4), start epoch (4)
+//   records  varint microseconds since the previous record, varint length, bytes
+//
+// A record holds the bytes drained from the UART in one read, stamped with
+// micros() at that moment. The RAM ring keeps the most recent records; the
+// file capture stops when P1_CAPTURE_FILE_MAX is reached.
+
+enum P1CaptureMode {
+	P1_CAPTURE_OFF,
+	P1_CAPTURE_RAM,
+	P1_CAPTURE_FILE
+};
+
+enum P1ReplaySpeed {
+	P1_REPLAY_RECORDED,     // honor the recorded inter-arrival times
+	P1_REPLAY_MAX           // as fast as the framer takes it
+};
+
+#define P1_CAPTURE_HEADER_SIZE  16
+
+struct P1CaptureStats {
+	P1CaptureMode mode;
+	uint32_t capturedBytes;         // UART bytes in the current/last capture
+	uint32_t capturedRecords;
+	uint32_t droppedBytes;          // RAM ring overwrites or file write failures
+	uint32_t ramBytes;              // records held in the RAM ring
+	uint32_t fileBytes;             // size of the capture file
+	bool replayActive;
+	P1ReplaySpeed replaySpeed;
+	uint32_t replayBytes;
+	uint32_t replayTelegrams;
+	uint32_t replayElapsedUs;       // wall time since the replay started
+	uint32_t replayBusyUs;          // time spent inside the framer/parser/fan-out
+};
+
+// Sequential reader over a capture in the download format
+struct P1CaptureReader {
+	P1CaptureMode source;
+	uint32_t position;              // logical offset, header included
+	uint32_t size;
+};
+
+// Function declarations
+void initializeP1Capture();
+bool startP1Capture(P1CaptureMode mode);
+void stopP1Capture();
+P1CaptureMode getP1CaptureMode();
+void captureP1Bytes(const uint8_t* data, size_t length);
+
+// The capture has to be stopped before it is downloaded or replayed
+bool openP1CaptureReader(P1CaptureReader& reader, P1CaptureMode source);
+size_t readP1Capture(P1CaptureReader& reader, uint8_t* buffer, size_t size);
+
+bool startP1Replay(P1CaptureMode source, P1ReplaySpeed speed, uint16_t repeat);
+void stopP1Replay();
+bool isP1ReplayActive();
+void handleP1Replay();
+
+void getP1CaptureStats(P1CaptureStats& stats);
+const char* getP1CaptureModeName(P1CaptureMode mode);
+
+#endif // P1_CAPTURE_H
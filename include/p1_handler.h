@@ -3,18 +3,37 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "p1_parser.h"
 
 // P1 message buffer and state
 extern String p1Buffer;
 extern bool p1MessageComplete;
 
-// Statistics
-extern unsigned long totalP1Messages;
-extern unsigned long totalBytesReceived;
-extern unsigned long lastP1DataReceived;
+// Latest decoded telegram
+extern P1Reading latestP1Reading;
+
+// Framer counters, see processP1Bytes()
+struct P1FramerStats {
+	uint32_t telegrams;         // complete telegrams passed on
+	uint32_t unchecked;         // of which without a checksum (DSMR 2.2)
+	uint32_t crcErrors;         // complete telegrams dropped for a CRC mismatch
+	uint32_t abandoned;         // partial telegrams dropped (restart, overflow, bad checksum, timeout)
+	uint32_t discardedBytes;    // bytes outside a telegram or in a dropped one
+};
+
+// Called for every telegram passed on, after it was forwarded to the TCP
+// clients; reading is null when it could not be decoded
+typedef void (*P1TelegramCallback)(const String& telegram, const P1Reading* reading);
 
 // Function declarations
 void initializeP1();
 void readP1Data();
+// Feed raw bytes into the telegram framer (UART or capture replay)
+void processP1Bytes(const uint8_t* data, size_t length);
+// Up to P1_TELEGRAM_CALLBACKS, called in the order added. A liveOnly callback
+// is skipped for telegrams of a capture replay: publishers would pass the old
+// readings off as current ones.
+bool addP1TelegramCallback(P1TelegramCallback callback, bool liveOnly = false);
+void getP1FramerStats(P1FramerStats& stats);
 
 #endif // P1_HANDLER_H
@@ -0,0 +1,62 @@
+#ifndef P1_PARSER_H
+#define P1_PARSER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Bits in P1Reading::fields, set for every value found in the telegram
+#define P1_FIELD_TIMESTAMP              (1UL << 0)
+#define P1_FIELD_VERSION                (1UL << 1)
+#define P1_FIELD_TARIFF                 (1UL << 2)
+#define P1_FIELD_ENERGY_DELIVERED_T1    (1UL << 3)
+#define P1_FIELD_ENERGY_DELIVERED_T2    (1UL << 4)
+#define P1_FIELD_ENERGY_RETURNED_T1     (1UL << 5)
+#define P1_FIELD_ENERGY_RETURNED_T2     (1UL << 6)
+#define P1_FIELD_POWER_DELIVERED        (1UL << 7)
+#define P1_FIELD_POWER_RETURNED         (1UL << 8)
+#define P1_FIELD_POWER_FAILURES         (1UL << 9)
+#define P1_FIELD_LONG_POWER_FAILURES    (1UL << 10)
+#define P1_FIELD_VOLTAGE_L1             (1UL << 11)
+#define P1_FIELD_VOLTAGE_L2             (1UL << 12)
+#define P1_FIELD_VOLTAGE_L3             (1UL << 13)
+#define P1_FIELD_CURRENT_L1             (1UL << 14)
+#define P1_FIELD_CURRENT_L2             (1UL << 15)
+#define P1_FIELD_CURRENT_L3             (1UL << 16)
+#define P1_FIELD_POWER_DELIVERED_L1     (1UL << 17)
+#define P1_FIELD_POWER_DELIVERED_L2     (1UL << 18)
+#define P1_FIELD_POWER_DELIVERED_L3     (1UL << 19)
+#define P1_FIELD_POWER_RETURNED_L1      (1UL << 20)
+#define P1_FIELD_POWER_RETURNED_L2      (1UL << 21)
+#define P1_FIELD_POWER_RETURNED_L3      (1UL << 22)
+#define P1_FIELD_GAS                    (1UL << 23)
+#define P1_FIELD_WATER                  (1UL << 24)
+#define P1_FIELD_EMUCS_VERSION          (1UL << 25)
+
+// Decoded DSMR telegram. Values are stored as fixed-point integers so the
+// rest of the firmware never has to touch floats:
+//   energy in Wh, power in W, voltage in 0.1 V, current in mA, gas/water in dm3 (liters)
+struct P1Reading {
+	uint32_t fields;                    // P1_FIELD_* bitmask
+	uint32_t version;                   // 1-3:0.2.8 (e.g. 42, 50), 0 for DSMR 2.2
+	uint32_t emucsVersion;              // 0-0:96.1.4, Belgian eMUCs meters (e.g. 50217)
+	uint32_t tariff;                    // 0-0:96.14.0
+	char timestamp[14];                 // 0-0:1.0.0 YYMMDDhhmmssX
+	uint32_t energyDeliveredWh[2];      // 1-0:1.8.1, 1-0:1.8.2
+	uint32_t energyReturnedWh[2];       // 1-0:2.8.1, 1-0:2.8.2
+	int32_t powerDeliveredW;            // 1-0:1.7.0
+	int32_t powerReturnedW;             // 1-0:2.7.0
+	uint32_t powerFailures;             // 0-0:96.7.21
+	uint32_t longPowerFailures;         // 0-0:96.7.9
+	int32_t voltageDv[3];               // 1-0:32.7.0, 52.7.0, 72.7.0
+	int32_t currentMa[3];               // 1-0:31.7.0, 51.7.0, 71.7.0
+	int32_t phasePowerDeliveredW[3];    // 1-0:21.7.0, 41.7.0, 61.7.0
+	int32_t phasePowerReturnedW[3];     // 1-0:22.7.0, 42.7.0, 62.7.0
+	uint32_t gasDm3;                    // M-Bus device type 003 (0-n:24.2.1 / DSMR 2.2 0-n:24.3.0)
+	uint32_t waterDm3;                  // M-Bus device type 007
+};
+
+// Parse a complete telegram ('/' ... '!XXXX'). Returns false when the data does
+// not look like a telegram or contains no known values.
+bool parseP1Telegram(const char* telegram, size_t length, P1Reading& reading);
+
+#endif // P1_PARSER_H
@@ -0,0 +1,17 @@
+#ifndef P1_VALUES_H
+#define P1_VALUES_H
+
+#include <Arduino.h>
+#include "p1_parser.h"
+
+// The numbers in a P1Reading as a flat list, for publishers that send one
+// named value at a time (MQTT topics, InfluxDB fields). Each name ends in the
+// unit of value / 10^decimals, e.g. "power_delivered_w" or "gas_m3".
+#define P1_VALUE_COUNT 24
+
+const char* getP1ValueName(uint8_t value);
+uint8_t getP1ValueDecimals(uint8_t value);
+// The scaled integer; false when the reading does not have it
+bool readP1Value(const P1Reading& reading, uint8_t value, long& result);
+
+#endif // P1_VALUES_H
@@ -0,0 +1,21 @@
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <Arduino.h>
+
+#define SHA1_DIGEST_SIZE 20
+
+// SHA-1, only for the WebSocket handshake (RFC 6455 Sec-WebSocket-Accept);
+// not for anything that needs collision resistance
+struct Sha1Context {
+	uint32_t state[5];
+	uint64_t length;            // bytes hashed so far
+	uint8_t block[64];
+	uint8_t used;               // bytes in block
+};
+
+void sha1Init(Sha1Context& context);
+void sha1Update(Sha1Context& context, const uint8_t* data, size_t length);
+void sha1Final(Sha1Context& context, uint8_t digest[SHA1_DIGEST_SIZE]);
+
+#endif // SHA1_H
@@ -0,0 +1,59 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Bridge statistics in one registry. Counters are kept per core: a core
+// only ever stores to its own copy (an aligned 32-bit store, which is atomic),
+// so both cores can count without a lock even though the M0+ has no atomic
+// read-modify-write; readers add the copies up. Each gauge has one writer.
+// Nothing is counted from an interrupt handler, which would race its core.
+enum StatCounter {
+	STAT_P1_TELEGRAMS,          // telegrams passed on (also the telegram number)
+	STAT_P1_BYTES_RECEIVED,     // bytes of those telegrams
+	STAT_P1_BYTES_SENT,         // telegram (or binary frame) bytes written to P1 TCP clients
+	STAT_P1_BINARY_FRAMES,      // binary frames written to P1 clients in binary mode
+	STAT_LOG_MESSAGES,
+	STAT_LOG_BYTES_SENT,
+	STAT_HTTP_REQUESTS,
+	STAT_HTTP_CONNECTIONS,
+	STAT_OTA_ATTEMPTS,          // uploads started
+	STAT_OTA_UPDATES,           // uploads flashed
+	STAT_MQTT_CONNECTS,         // broker sessions established
+	STAT_MQTT_PUBLISHES,        // PUBLISH packets sent
+	STAT_MQTT_WRITES,           // socket writes carrying them (batches)
+	STAT_MQTT_BYTES_SENT,
+	STAT_INFLUX_POINTS,         // points added to a buffer
+	STAT_INFLUX_POINTS_DROPPED, // not sent: no NTP time yet, no buffer room, or the send failed
+	STAT_INFLUX_BATCHES,        // buffers delivered (datagrams sent, POSTs answered 2xx)
+	STAT_INFLUX_ERRORS,         // buffers that could not be delivered
+	STAT_INFLUX_BYTES_SENT,
+	STAT_MODBUS_REQUESTS,       // Modbus TCP requests answered, exceptions included
+	STAT_MODBUS_EXCEPTIONS,     // answered with an exception (unknown function, bad address or count)
+	STAT_COUNTER_COUNT
+};
+
+enum StatGauge {
+	STAT_P1_LAST_TELEGRAM,      // millis() of the last telegram, 0 before the first
+	STAT_OTA_LAST_UPDATE,       // millis() of the last successful update, 0 for none
+	STAT_GAUGE_COUNT
+};
+
+struct StatsSnapshot {
+	uint32_t counters[STAT_COUNTER_COUNT];
+	uint32_t gauges[STAT_GAUGE_COUNT];
+	uint32_t rates[STAT_COUNTER_COUNT];     // EWMA per second, in thousandths
+};
+
+// Function declarations
+void addStat(StatCounter counter, uint32_t amount = 1);
+void setStat(StatGauge gauge, uint32_t value);
+uint32_t getStat(StatCounter counter);
+uint32_t getStat(StatGauge gauge);
+void getStatsSnapshot(StatsSnapshot& snapshot);
+// Update the rates every STATS_RATE_INTERVAL (from loop())
+void handleStats();
+const char* getStatName(StatCounter counter);
+
+#endif // STATS_H
@@ -0,0 +1,64 @@
+#ifndef STRING_BUILDER_H
+#define STRING_BUILDER_H
+
+#include <Arduino.h>
+
+// Bounded text builder over a caller-owned buffer, used instead of String
+// concatenation for pages, JSON and log lines. It never allocates: text that
+// does not fit is cut off and overflowed() turns true. The buffer is always
+// NUL terminated.
+//
+// Being a Print, anything Print can format (integers, IPAddress, Printable)
+// can be appended; append() does the same and returns the builder so calls
+// can be chained.
+class StringBuilder : public Print {
+public:
+	StringBuilder(char* buffer, size_t capacity);
+
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* data, size_t length) override;
+	using Print::write;
+
+	template <typename T>
+	StringBuilder& append(const T& value) {
+		print(value);
+		return *this;
+	}
+	StringBuilder& append(const char* text, size_t length);
+	// printf-style; keep to integer and string conversions (%f may allocate on newlib)
+	StringBuilder& appendf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+	// Text inside a JSON string: quotes, backslashes and control characters escaped
+	StringBuilder& appendJSONEscaped(const char* text, size_t length);
+	StringBuilder& appendJSONEscaped(const char* text);
+	// Text inside HTML: &, <, > and quotes escaped
+	StringBuilder& appendHTMLEscaped(const char* text, size_t length);
+	// value / 10^decimals with a fixed number of decimals, e.g. 1234, 2 -> "12.34"
+	StringBuilder& appendFixedPoint(long value, uint8_t decimals);
+
+	const char* c_str() const { return data; }
+	size_t length() const { return used; }
+	size_t capacity() const { return size - 1; }
+	size_t remaining() const { return size - 1 - used; }
+	bool overflowed() const { return overflow; }
+	void clear();
+
+private:
+	char* data;
+	size_t size;
+	size_t used;
+	bool overflow;
+};
+
+// StringBuilder with its own storage, for short-lived buffers on the stack
+template <size_t N>
+class FixedString : public StringBuilder {
+public:
+	FixedString() : StringBuilder(storage, N) {}
+	FixedString(const FixedString&) = delete;
+	FixedString& operator=(const FixedString&) = delete;
+
+private:
+	char storage[N];
+};
+
+#endif // STRING_BUILDER_H
@@ -0,0 +1,14 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <Arduino.h>
+
+#define VARINT_MAX_SIZE 5   // bytes needed for a 32-bit value
+
+// Unsigned LEB128 varints (7 bits per byte, low bits first) used by the
+// history and capture file formats
+uint8_t writeVarint(uint8_t* p, uint32_t value);
+// Advances p; false when the data ends inside a varint
+bool readVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value);
+
+#endif // VARINT_H
@@ -0,0 +1,28 @@
+#ifndef API_WEB_HANDLER_H
+#define API_WEB_HANDLER_H
+
+#include "config.h"
+#include <Ethernet.h>
+#include "string_builder.h"
+#include "p1_parser.h"
+
+// A decoded telegram as a JSON object, only the values the meter sent, in the
+// fixed-point units of P1Reading
+#define P1_READING_JSON_MAX 768
+void appendP1ReadingJSON(StringBuilder& json, const P1Reading& reading);
+
+// JSON API functions
+void sendAggregatesJSON(EthernetClient& client, const char* path);
+
+// /api/v1/reading: the latest decoded telegram, serialized once when it
+// arrives; every request is answered from that copy
+void initializeReadingAPI();
+void sendReadingJSON(EthernetClient& client);
+
+// /api/history is written a chunk at a time from handleHistoryStream(), so a
+// long download never holds up P1 forwarding
+bool startHistoryStream(EthernetClient& client, const char* path);
+void handleHistoryStream();
+bool isHistoryStreamActive();
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CAPTURE_WEB_HANDLER_H
+#define CAPTURE_WEB_HANDLER_H
+
+#include "config.h"
+#include <Ethernet.h>
+
+// Serial capture control: /capture, /capture/start, /capture/stop,
+// /capture/replay, /capture/replay/stop
+void handleCaptureRequest(EthernetClient& client, const char* path);
+
+// /capture/download is written a chunk per loop() pass
+bool startCaptureDownload(EthernetClient& client, const char* path);
+void handleCaptureDownload();
+bool isCaptureDownloadActive();
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef HTTP_REQUEST_H
+#define HTTP_REQUEST_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Scratch memory for one HTTP request. Whatever is kept from the request
+// (method, path, some header values, query values, the body) is copied into
+// it, and all of it is given back at once with reset() when the request is
+// done, so serving requests never touches the heap.
+class HTTPArena {
+public:
+	HTTPArena(char* buffer, size_t capacity);
+
+	// size bytes, or nullptr once the arena is used up
+	char* allocate(size_t size);
+	// NUL-terminated copy of text[0..length), or nullptr once the arena is used up
+	const char* copy(const char* text, size_t length);
+	void reset();
+
+	size_t used() const { return top; }
+	size_t capacity() const { return size; }
+	size_t peak() const { return highWater; }
+	bool exhausted() const { return failed; }
+
+private:
+	char* data;
+	size_t size;
+	size_t top;
+	size_t highWater;
+	bool failed;
+};
+
+// HTTPArena with its own storage
+template <size_t N>
+class FixedArena : public HTTPArena {
+public:
+	FixedArena() : HTTPArena(storage, N) {}
+	FixedArena(const FixedArena&) = delete;
+	FixedArena& operator=(const FixedArena&) = delete;
+
+private:
+	char storage[N];
+};
+
+// The parts of a request the handlers need; the strings live in the arena
+struct HTTPRequest {
+	const char* method;
+	const char* path;           // including the query string
+	const char* authorization;  // Authorization header value, nullptr if not sent
+	const char* ifNoneMatch;    // If-None-Match header value, nullptr if not sent
+	unsigned long lastEventId;  // Last-Event-ID of a reconnecting event stream, 0 if not sent
+	const char* webSocketKey;   // Sec-WebSocket-Key, nullptr if not sent
+	bool webSocketUpgrade;      // Upgrade: websocket
+	bool webSocketVersion13;    // Sec-WebSocket-Version: 13
+	bool authorized;            // valid OTA credentials were sent (set by the server)
+	bool http11;                // HTTP/1.1 or later (chunked responses allowed)
+	bool keepAlive;             // the client wants the connection kept open
+	bool chunked;               // Transfer-Encoding: chunked
+	unsigned long contentLength;
+	const char* body;           // NUL terminated, nullptr without a body
+	size_t bodyLength;
+};
+
+enum HTTPParseState {
+	HTTP_PARSE_REQUEST_LINE,
+	HTTP_PARSE_HEADER,
+	HTTP_PARSE_BODY,            // Content-Length bytes
+	HTTP_PARSE_CHUNK_SIZE,
+	HTTP_PARSE_CHUNK_DATA,
+	HTTP_PARSE_CHUNK_DATA_END,  // the CRLF after a chunk
+	HTTP_PARSE_TRAILER,
+	HTTP_PARSE_COMPLETE,
+	HTTP_PARSE_ERROR
+};
+
+// Resumable HTTP/1.1 request parser. Bytes are fed as they arrive, in any
+// split, and the parser never waits for more: the caller keeps feeding until
+// complete() or failed(), so a slow client only costs its own connection.
+// Every line, the header section and the body are bounded by the
+// HTTP_REQUEST_* limits; going over one fails the request with the status
+// code to answer (400, 413, 414, 431).
+class HTTPRequestParser {
+public:
+	explicit HTTPRequestParser(HTTPArena& arena);
+
+	void reset();
+	// One byte of the request; returns the state after it
+	HTTPParseState feed(uint8_t c);
+
+	// Nothing of a request has arrived yet
+	bool idle() const { return state == HTTP_PARSE_REQUEST_LINE && lineLength == 0; }
+	// The blank line after the headers has been seen; the body may still follow
+	bool headersComplete() const { return state > HTTP_PARSE_HEADER; }
+	bool complete() const { return state == HTTP_PARSE_COMPLETE; }
+	bool failed() const { return state == HTTP_PARSE_ERROR; }
+	int errorStatus() const { return error; }
+	HTTPRequest& request() { return parsed; }
+
+private:
+	HTTPParseState fail(int status);
+	HTTPParseState endLine();
+	HTTPParseState parseRequestLine();
+	HTTPParseState parseHeader();
+	HTTPParseState parseChunkSize();
+	HTTPParseState startBody();
+	HTTPParseState storeBody(uint8_t c);
+
+	HTTPArena& arena;
+	HTTPRequest parsed;
+	HTTPParseState state;
+	int error;
+	char line[HTTP_REQUEST_LINE_MAX];
+	size_t lineLength;
+	size_t headerBytes;
+	unsigned long remaining;    // body or chunk bytes still to come
+	char* bodyBuffer;
+};
+
+#endif
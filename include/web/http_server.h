@@ -3,25 +3,62 @@
 
 #include "config.h"
 #include <Ethernet.h>
+#include "string_builder.h"
+#include "web/http_request.h"
+#include "web/web_assets.h"
 
 // Global variables declaration
 extern EthernetServer httpInfoServer;
-extern unsigned long totalHTTPRequests;
 
 // Core HTTP server functions
 void initializeHTTPInfoServer();
+// Accept new connections (on W5500 interrupts)
 void handleHTTPInfoConnections();
-void handleHTTPRequest(EthernetClient& client);
+// Advance every open connection one step (every loop() pass)
+void handleHTTPInfoClients();
+// Route a parsed request; returns true when a background download took over the connection
+bool handleHTTPRequest(EthernetClient& client, HTTPRequest& request);
 
 // HTTP utilities
-void sendHTTPResponse(EthernetClient& client, int statusCode, const String& contentType, const String& content);
-void sendUnauthorizedResponse(EthernetClient& client, const String& realm);
-String getHTTPHeaders(int statusCode, const String& contentType, int contentLength);
+// Cleared shared buffer (HTTP_PAGE_BUFFER_SIZE) to build a response body in
+StringBuilder& beginHTTPPage();
+void sendHTTPResponse(EthernetClient& client, int statusCode, const char* contentType, const StringBuilder& content);
+// A page produced a piece at a time: each call appends the next part (at most
+// HTTP_STREAM_CHUNK_SIZE) and advances part, and returns false after the last
+typedef bool (*HTTPPageGenerator)(StringBuilder& out, uint16_t& part);
+// Sent chunked, a part whenever the socket has room for one, so the page is
+// never in RAM as a whole and a slow client only holds up its own connection
+void sendHTTPGenerated(EthernetClient& client, int statusCode, const char* contentType, HTTPPageGenerator generator);
+// A gzipped page from web/, or 304 when the client already has this version
+void sendHTTPAsset(EthernetClient& client, const HTTPRequest& request, const WebAsset& asset);
+void sendUnauthorizedResponse(EthernetClient& client, const char* realm);
+// contentLength for a body whose length is not known up front
+#define HTTP_LENGTH_UNKNOWN ((unsigned long)-1)     // ends when the connection closes
+#define HTTP_LENGTH_CHUNKED ((unsigned long)-2)     // sent with writeHTTPChunk()/endHTTPChunks()
+
+// Status line and the common headers, without the blank line, so more can be
+// added. Decides whether the connection is kept open: only for framed bodies
+// (a length, or chunked for HTTP/1.1 clients) when the client wants it.
+void beginHTTPHeaders(StringBuilder& headers, int statusCode, const char* contentType, unsigned long contentLength);
+// Status line and headers only
+void sendHTTPHeaders(EthernetClient& client, int statusCode, const char* contentType, unsigned long contentLength);
+// Part of an HTTP_LENGTH_CHUNKED body (plain bytes when the client got HTTP_LENGTH_UNKNOWN instead)
+void writeHTTPChunk(EthernetClient& client, const char* data, size_t length);
+void endHTTPChunks(EthernetClient& client);
+// True when path is route, with or without a query string
+bool matchHTTPPath(const char* path, const char* route);
+// Value of ?name=... copied into the request arena, "" when absent; valid until the request is answered
+const char* getQueryParameter(const char* path, const char* name);
+
+// True when a connection may be kept open as an event stream or WebSocket:
+// those only use sockets the P1, log and Modbus servers never need
+bool httpStreamSocketAvailable();
 
 // Statistics
-unsigned long getHTTPRequestCount();
+int getActiveHTTPConnectionCount();
+size_t getHTTPArenaPeak();          // most request arena bytes ever used
 
 // OTA page generation
-String generateOTAUploadPage();
+void buildOTAUploadPage(StringBuilder& uploadPage);
 
 #endif
\ No newline at end of file
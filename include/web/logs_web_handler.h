@@ -3,10 +3,10 @@
 
 #include "config.h"
 #include <Ethernet.h>
+#include "string_builder.h"
 
-// Logs page functions
-void sendLogsPage(EthernetClient& client);
+// Logs page functions; the page itself is web/logs.html
 void sendLogsDataStream(EthernetClient& client);
-String getCurrentLogsDataJSON();
+void buildCurrentLogsDataJSON(StringBuilder& json);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef METRICS_WEB_HANDLER_H
+#define METRICS_WEB_HANDLER_H
+
+#include "config.h"
+#include <Ethernet.h>
+
+// /metrics in the Prometheus text format (0.0.4): bridge counters, P1
+// clients per slot, loop() time, heap and the latest meter values. Rendered
+// from a descriptor table a few families at a time, as the socket takes them.
+void sendMetrics(EthernetClient& client);
+
+#endif
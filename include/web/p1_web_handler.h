@@ -3,10 +3,18 @@
 
 #include "config.h"
 #include <Ethernet.h>
+#include "string_builder.h"
+#include "web/http_request.h"
 
-// P1 page functions
-void sendP1DataPage(EthernetClient& client);
-void sendP1DataStream(EthernetClient& client);
-String getCurrentP1DataJSON();
+// P1 page functions; the page itself is web/p1.html
+
+// /p1/stream: a long-lived event stream with an event per telegram
+void initializeP1EventStream();
+bool startP1EventStream(EthernetClient& client, const HTTPRequest& request);
+void handleP1EventStreams();
+uint8_t getP1EventSubscriberCount();
+unsigned long getSkippedP1EventCount();
+
+void buildCurrentP1DataJSON(StringBuilder& json);
 
 #endif
\ No newline at end of file
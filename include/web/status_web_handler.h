@@ -3,11 +3,15 @@
 
 #include "config.h"
 #include <Ethernet.h>
+#include "string_builder.h"
 
 // Status and info page functions
 void sendInfoPage(EthernetClient& client);
 void handleStatusPage(EthernetClient& client);
-void sendRedirect(EthernetClient& client, const String& location);
-String getDeviceInfoHTML();
+void sendRedirect(EthernetClient& client, const char* location);
+// The info page, a section per call (an HTTPPageGenerator)
+bool generateDeviceInfoHTML(StringBuilder& html, uint16_t& part);
+// Heap, stack and allocation telemetry as plain text (also sampled now)
+void appendHeapTelemetryText(StringBuilder& out);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+// Static pages from web/, gzipped at build time by scripts/build_web_assets.py
+// into src/web/web_assets.cpp. The data stays in flash and is written to the
+// socket from there.
+struct WebAsset {
+	const char* path;           // "/p1.html", "/assets/main.css"
+	const char* contentType;
+	const char* etag;           // hash of the uncompressed file, without quotes
+	bool immutable;             // under /assets/: referred to with ?v=<etag>, cached for good
+	const uint8_t* data;        // gzip
+	size_t length;
+	size_t originalLength;
+};
+
+extern const WebAsset webAssets[];
+extern const size_t webAssetCount;
+
+// The asset served at path (a query string is ignored), nullptr if none
+const WebAsset* findWebAsset(const char* path);
+// The etag of an /assets/ file, for its ?v= in links
+const char* getWebAssetVersion(const char* path);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef WEBSOCKET_HANDLER_H
+#define WEBSOCKET_HANDLER_H
+
+#include "config.h"
+#include <Ethernet.h>
+#include "web/http_request.h"
+
+// /ws: RFC 6455 WebSocket for dashboards. A client subscribes to topics
+// and gets a message for each telegram and/or log line:
+//   telegram   the raw telegram as a text message (starts with '/')
+//   reading    {"type":"reading","id":N,...} decoded values
+//   log        {"type":"log","line":"..."}
+// Commands are text messages: "subscribe reading,log", "unsubscribe log",
+// "topics". Each is answered with {"type":"topics","topics":[...]}. The
+// initial topics come from ?subscribe=, the default is "reading".
+void initializeWebSockets();
+bool startWebSocket(EthernetClient& client, const HTTPRequest& request);
+void handleWebSocketClients();
+uint8_t getWebSocketClientCount();
+unsigned long getSkippedWebSocketMessageCount();
+
+// Log lines for the "log" topic (from the log server)
+bool hasWebSocketLogSubscribers();
+void sendWebSocketLog(const char* line, size_t length);
+
+#endif
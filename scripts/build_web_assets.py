@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""
+Compress the static web pages in web/ into src/web/web_assets.cpp.
+
+Every file under web/ becomes a gzip blob in flash, served as is with
+Content-Encoding: gzip and an ETag taken from its contents. web/p1.html is
+served at /p1.html, web/assets/main.css at /assets/main.css, and so on.
+Files under web/assets/ are cached for a year, so pages must refer to them
+with ?v=<etag> (see getWebAssetVersion()); everything else is revalidated.
+
+Runs before every PlatformIO build (extra_scripts) and only rewrites the
+output when a file in web/ changed. Can also be run by hand:
+
+Usage: python scripts/build_web_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+}
+
+HEADER = """\
+// Generated by scripts/build_web_assets.py from web/, do not edit.
+// Rebuilt before every PlatformIO build when a file in web/ changes.
+
+#include "web/web_assets.h"
+"""
+
+
+def collect(root):
+    assets = []
+    for directory, _, files in os.walk(root):
+        for name in sorted(files):
+            source = os.path.join(directory, name)
+            path = "/" + os.path.relpath(source, root).replace(os.sep, "/")
+            extension = os.path.splitext(name)[1].lower()
+            if extension not in CONTENT_TYPES:
+                sys.exit("build_web_assets: no content type for " + source)
+            assets.append((path, source, CONTENT_TYPES[extension]))
+    return sorted(assets)
+
+
+def generate(root, output):
+    lines = [HEADER]
+    table = []
+    for index, (path, source, content_type) in enumerate(collect(root)):
+        with open(source, "rb") as f:
+            data = f.read()
+        # mtime=0 keeps the output, and so the ETag, the same for the same input
+        compressed = gzip.compress(data, 9, mtime=0)
+        etag = hashlib.sha1(data).hexdigest()[:16]
+        immutable = path.startswith("/assets/")
+
+        lines.append("// %s: %d bytes, %d gzipped" % (path, len(data), len(compressed)))
+        lines.append("static const uint8_t webAsset%d[] = {" % index)
+        for offset in range(0, len(compressed), 16):
+            row = compressed[offset:offset + 16]
+            lines.append("\t" + ", ".join("0x%02x" % b for b in row) + ",")
+        lines.append("};")
+        lines.append("")
+        table.append('\t{"%s", "%s", "%s", %s, webAsset%d, sizeof(webAsset%d), %d},'
+                     % (path, content_type, etag, "true" if immutable else "false", index, index, len(data)))
+
+    lines.append("const WebAsset webAssets[] = {")
+    lines.extend(table)
+    lines.append("};")
+    lines.append("")
+    lines.append("const size_t webAssetCount = sizeof(webAssets) / sizeof(webAssets[0]);")
+    lines.append("")
+    text = "\n".join(lines)
+
+    if os.path.exists(output):
+        with open(output) as f:
+            if f.read() == text:
+                return False
+    with open(output, "w") as f:
+        f.write(text)
+    return True
+
+
+def main(project):
+    root = os.path.join(project, "web")
+    output = os.path.join(project, "src", "web", "web_assets.cpp")
+    if generate(root, output):
+        print("build_web_assets: wrote " + os.path.relpath(output, project))
+
+
+if __name__ == "__main__":
+    main(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+else:
+    # PlatformIO extra_scripts
+    Import("env")  # noqa: F821
+    main(env["PROJECT_DIR"])  # noqa: F821
@@ -1,21 +1,50 @@
 #include "clients.h"
 #include "custom_log.h"
+#include "heap_telemetry.h"
+#include "stats.h"
+#include "p1_handler.h"
+#include "p1_binary.h"
+
+#define COMMAND_WATCH_DONE  0xFF
 
 // Global variables
 EthernetServer server(SERVER_PORT);
 EthernetClient clients[MAX_CONNECTIONS];
 unsigned long clientLastActivity[MAX_CONNECTIONS];
 bool clientConnected[MAX_CONNECTIONS];
-
-// Statistics
-unsigned long totalBytesSent = 0;
+unsigned long clientBytesSent[MAX_CONNECTIONS];
+bool clientBinary[MAX_CONNECTIONS];
+static uint8_t clientCommandLength[MAX_CONNECTIONS];    // bytes of P1_BINARY_COMMAND matched so far
+static bool clientNeedsKeyframe[MAX_CONNECTIONS];
+
+// Items of the last decoded telegram, which every binary client that was
+// sent its frame has; the next frame is a delta against them
+static P1BinaryItems binaryItems[2];
+static uint8_t binaryCurrent = 0;
+static bool binaryHavePrevious = false;
+static uint8_t binaryKeyframe[P1_BINARY_FRAME_MAX];
+static uint8_t binaryDelta[P1_BINARY_FRAME_MAX];
+
+static void sendBinaryFrames(const String& telegram, const P1Reading* reading);
+
+// A new client in a slot starts out with telegrams
+static void resetClientSlot(int slot) {
+	clientConnected[slot] = true;
+	clientLastActivity[slot] = millis();
+	clientBytesSent[slot] = 0;
+	clientBinary[slot] = false;
+	clientCommandLength[slot] = 0;
+}
 
 void initializeClients() {
 	// Initialize client arrays
 	for (int i = 0; i < MAX_CONNECTIONS; i++) {
 		clientConnected[i] = false;
 		clientLastActivity[i] = 0;
+		clientBytesSent[i] = 0;
+		clientBinary[i] = false;
 	}
+	addP1TelegramCallback(sendBinaryFrames);
 
 	// Start the server
 	server.begin();
@@ -23,6 +52,7 @@ void initializeClients() {
 }
 
 void handleNewConnections() {
+	HEAP_TAG_SCOPE(HEAP_TAG_CLIENTS);
 	EthernetClient newClient = server.accept();
 	if (newClient) {
 		REMOTE_LOG_DEBUG("New client attempting to connect");
@@ -39,8 +69,7 @@ void handleNewConnections() {
 		if (availableSlot >= 0) {
 			// Accept the connection
 			clients[availableSlot] = newClient;
-			clientConnected[availableSlot] = true;
-			clientLastActivity[availableSlot] = millis();
+			resetClientSlot(availableSlot);
 
 			REMOTE_LOG_DEBUG("Client connected on slot:", availableSlot);
 			REMOTE_LOG_DEBUG("Client IP:", newClient.remoteIP());
@@ -77,8 +106,7 @@ void handleNewConnections() {
 
 			// Accept new client in the freed slot
 			clients[oldestSlot] = newClient;
-			clientConnected[oldestSlot] = true;
-			clientLastActivity[oldestSlot] = millis();
+			resetClientSlot(oldestSlot);
 
 			REMOTE_LOG_INFO("New client connected on slot:", oldestSlot);
 		}
@@ -86,16 +114,81 @@ void handleNewConnections() {
 }
 
 void sendToAllClients(const String& data) {
+	HEAP_TAG_SCOPE(HEAP_TAG_CLIENTS);
 	for (int i = 0; i < MAX_CONNECTIONS; i++) {
-		if (clientConnected[i] && clients[i].connected()) {
+		if (clientConnected[i] && !clientBinary[i] && clients[i].connected()) {
 			clients[i].print(data);
 			clientLastActivity[i] = millis();
-			totalBytesSent += data.length();
+			addStat(STAT_P1_BYTES_SENT, data.length());
+			clientBytesSent[i] += data.length();
+		}
+	}
+}
+
+// One frame per binary client: the delta when it has the previous frame, a
+// keyframe otherwise. A frame that does not fit the socket is skipped rather
+// than written in part, and the client gets a keyframe next.
+static void sendBinaryFrames(const String& telegram, const P1Reading* reading) {
+	if (!reading) return;
+	HEAP_TAG_SCOPE(HEAP_TAG_CLIENTS);
+	P1BinaryItems& items = binaryItems[binaryCurrent];
+	const P1BinaryItems* previous = binaryHavePrevious ? &binaryItems[binaryCurrent ^ 1] : nullptr;
+	getP1BinaryItems(*reading, items);
+
+	size_t keyframeSize = 0;
+	size_t deltaSize = 0;
+	for (int i = 0; i < MAX_CONNECTIONS; i++) {
+		if (!clientConnected[i] || !clientBinary[i] || !clients[i].connected()) continue;
+		bool keyframe = clientNeedsKeyframe[i] || !previous;
+		// Encoded once per telegram, for all clients that need the form
+		if (keyframe && keyframeSize == 0) keyframeSize = encodeP1BinaryFrame(items, nullptr, binaryKeyframe);
+		if (!keyframe && deltaSize == 0) deltaSize = encodeP1BinaryFrame(items, previous, binaryDelta);
+		const uint8_t* frame = keyframe ? binaryKeyframe : binaryDelta;
+		size_t size = keyframe ? keyframeSize : deltaSize;
+		if (clients[i].availableForWrite() < (int)size) {
+			clientNeedsKeyframe[i] = true;
+			continue;
 		}
+		clients[i].write(frame, size);
+		clientNeedsKeyframe[i] = false;
+		clientLastActivity[i] = millis();
+		clientBytesSent[i] += size;
+		addStat(STAT_P1_BYTES_SENT, size);
+		addStat(STAT_P1_BINARY_FRAMES);
+	}
+	binaryCurrent ^= 1;
+	binaryHavePrevious = true;
+}
+
+// A client whose first bytes are the line P1_BINARY_COMMAND is switched to
+// binary frames. Anything else ends the watch and goes to the meter as
+// before; the bytes held back so far are the command's prefix.
+static bool watchClientCommand(int slot, char c) {
+	uint8_t& matched = clientCommandLength[slot];
+	if (matched == COMMAND_WATCH_DONE) return false;
+	const uint8_t commandLength = sizeof(P1_BINARY_COMMAND) - 1;
+	if (matched < commandLength && c == P1_BINARY_COMMAND[matched]) {
+		matched++;
+		return true;
+	}
+	if (matched == commandLength && c == '\r') return true;
+	if (matched == commandLength && c == '\n') {
+		matched = COMMAND_WATCH_DONE;
+		clientBinary[slot] = true;
+		clientNeedsKeyframe[slot] = true;
+		clients[slot].print(P1_BINARY_HELLO);
+		REMOTE_LOG_DEBUG("Client switched to binary frames on slot:", slot);
+		return true;
+	}
+	for (uint8_t k = 0; k < matched; k++) {
+		Serial1.write(P1_BINARY_COMMAND[k]);
 	}
+	matched = COMMAND_WATCH_DONE;
+	return false;
 }
 
 void handleClientCommunication() {
+	HEAP_TAG_SCOPE(HEAP_TAG_CLIENTS);
 	for (int i = 0; i < MAX_CONNECTIONS; i++) {
 		if (clientConnected[i] && clients[i].connected()) {
 			// Check for client data (commands sent to P1 meter)
@@ -105,6 +198,7 @@ void handleClientCommunication() {
 				// Read data from client and forward to P1 serial
 				while (clients[i].available()) {
 					char c = clients[i].read();
+					if (watchClientCommand(i, c)) continue;
 					Serial1.write(c);
 				}
 			}
@@ -120,6 +214,7 @@ void handleClientCommunication() {
 }
 
 void cleanupClients() {
+	HEAP_TAG_SCOPE(HEAP_TAG_CLIENTS);
 	for (int i = 0; i < MAX_CONNECTIONS; i++) {
 		if (clientConnected[i] && !clients[i].connected()) {
 			REMOTE_LOG_DEBUG("Client disconnected from slot:", i);
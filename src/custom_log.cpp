@@ -1,41 +1,61 @@
 #include "custom_log.h"
 #include "log_server.h"
+#include "heap_telemetry.h"
+#include "web/websocket_handler.h"
 #define DEBUGLOG_DEFAULT_LOG_LEVEL_INFO
 #include <DebugLog.h>
 
+bool isRemoteLogActive() {
+	return getConnectedLogClientCount() > 0 || hasWebSocketLogSubscribers();
+}
+
 // Send log message to remote clients
-void sendRemoteLog(const char* level, const String& message) {
-	if (getConnectedLogClientCount() > 0) {
-		String formattedMessage = String("[") + level + "] " + message;
+void sendRemoteLog(const char* level, const StringBuilder& message) {
+	HEAP_TAG_SCOPE(HEAP_TAG_LOG);
+	if (isRemoteLogActive()) {
+		FixedString<LOG_MESSAGE_SIZE> formattedMessage;
+		formattedMessage.append('[').append(level).append("] ").append(message.c_str(), message.length());
 		logToRemoteClients(formattedMessage.c_str());
 	}
 }
 
 // Helper functions to build log messages from multiple parameters
-String buildLogMessage(const char* msg) {
-	return String(msg);
+void buildLogMessage(StringBuilder& out, const char* msg) {
+	out.append(msg);
+}
+
+void buildLogMessage(StringBuilder& out, const char* msg, int value) {
+	out.append(msg).append(' ').append(value);
+}
+
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long value) {
+	out.append(msg).append(' ').append(value);
+}
+
+void buildLogMessage(StringBuilder& out, const char* msg, const char* value) {
+	out.append(msg).append(' ').append(value);
 }
 
-String buildLogMessage(const char* msg, int value) {
-	return String(msg) + " " + String(value);
+void buildLogMessage(StringBuilder& out, const char* msg, const String& value) {
+	out.append(msg).append(' ').append(value.c_str(), value.length());
 }
 
-String buildLogMessage(const char* msg, unsigned long value) {
-	return String(msg) + " " + String(value);
+void buildLogMessage(StringBuilder& out, const char* msg, IPAddress ip) {
+	out.append(msg).append(' ').append(ip);
 }
 
-String buildLogMessage(const char* msg, const String& value) {
-	return String(msg) + " " + value;
+void buildLogMessage(StringBuilder& out, const char* msg, int v1, const char* msg2, IPAddress ip, const char* msg3) {
+	out.append(msg).append(v1).append(msg2).append(ip).append(msg3);
 }
 
-String buildLogMessage(const char* msg, IPAddress ip) {
-	return String(msg) + " " + ip.toString();
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long v1, const char* msg2, unsigned int v2, const char* msg3) {
+	out.append(msg).append(v1).append(msg2).append(v2).append(msg3);
 }
 
-String buildLogMessage(const char* msg, int v1, const char* msg2, IPAddress ip, const char* msg3) {
-	return String(msg) + String(v1) + String(msg2) + ip.toString() + String(msg3);
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long v1, const char* msg2, unsigned long v2) {
+	out.append(msg).append(' ').append(v1).append(msg2).append(v2);
 }
 
-String buildLogMessage(const char* msg, unsigned long v1, const char* msg2, unsigned int v2, const char* msg3) {
-	return String(msg) + String(v1) + String(msg2) + String(v2) + String(msg3);
+void buildLogMessage(StringBuilder& out, const char* msg, unsigned long v1, const char* msg2, unsigned long v2, const char* msg3, unsigned long v3) {
+	out.append(msg).append(' ').append(v1).append(msg2).append(v2).append(msg3).append(v3);
 }
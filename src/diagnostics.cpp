@@ -4,9 +4,42 @@
 #include "log_server.h"
 #include "ota_server.h"
 #include "http_info.h"
+#include "history_store.h"
+#include "heap_telemetry.h"
 #include "custom_log.h"
+#include "stats.h"
 #include <Ethernet.h>
 
+const uint32_t loopTimeBucketsUs[LOOP_TIME_BUCKET_COUNT] = {100, 500, 1000, 5000, 10000, 50000, 100000};
+
+static uint32_t loopPasses = 0;
+static uint64_t loopTotalUs = 0;
+static uint32_t loopMaxUs = 0;
+static uint32_t loopBucketPasses[LOOP_TIME_BUCKET_COUNT];      // per bucket, not cumulative
+
+void recordLoopTime(uint32_t us) {
+	loopPasses++;
+	loopTotalUs += us;
+	if (us > loopMaxUs) loopMaxUs = us;
+	for (int i = 0; i < LOOP_TIME_BUCKET_COUNT; i++) {
+		if (us <= loopTimeBucketsUs[i]) {
+			loopBucketPasses[i]++;
+			break;
+		}
+	}
+}
+
+void getLoopTimeStats(LoopTimeStats& stats) {
+	stats.passes = loopPasses;
+	stats.totalUs = loopTotalUs;
+	stats.maxUs = loopMaxUs;
+	uint32_t cumulative = 0;
+	for (int i = 0; i < LOOP_TIME_BUCKET_COUNT; i++) {
+		cumulative += loopBucketPasses[i];
+		stats.buckets[i] = cumulative;
+	}
+}
+
 void printStatus() {
 	REMOTE_LOG_INFO("=== Bridge Status ===");
 	REMOTE_LOG_INFO("IP Address:", Ethernet.localIP());
@@ -27,15 +60,42 @@ void printStatus() {
 			REMOTE_LOG_INFO(" [", i, ": ", logClients[i].remoteIP(), "]");
 		}
 	}
-	REMOTE_LOG_INFO("P1 Messages:", totalP1Messages);
-	REMOTE_LOG_INFO("P1 Bytes Received:", totalBytesReceived);
-	REMOTE_LOG_INFO("P1 Bytes Sent:", totalBytesSent);
-	REMOTE_LOG_INFO("Log Messages Sent:", totalLogMessages);
-	REMOTE_LOG_INFO("Log Bytes Sent:", totalLogBytesSent);
-	REMOTE_LOG_INFO("HTTP Requests:", getHTTPRequestCount());
-	REMOTE_LOG_INFO("OTA Requests:", getOTARequestCount());
-	REMOTE_LOG_INFO("OTA Updates:", getOTAUpdateCount());
-	REMOTE_LOG_INFO("Last OTA:", getLastOTATimestamp());
+	StatsSnapshot stats;
+	getStatsSnapshot(stats);
+	REMOTE_LOG_INFO("P1 Messages:", (unsigned long)stats.counters[STAT_P1_TELEGRAMS]);
+	REMOTE_LOG_INFO("P1 Messages/Min x10:", (unsigned long)(stats.rates[STAT_P1_TELEGRAMS] * 60 / 100));
+	REMOTE_LOG_INFO("P1 Bytes Received:", (unsigned long)stats.counters[STAT_P1_BYTES_RECEIVED]);
+	REMOTE_LOG_INFO("P1 Bytes Sent:", (unsigned long)stats.counters[STAT_P1_BYTES_SENT]);
+	REMOTE_LOG_INFO("P1 Bytes Sent/s:", (unsigned long)(stats.rates[STAT_P1_BYTES_SENT] / 1000));
+	P1FramerStats framer;
+	getP1FramerStats(framer);
+	REMOTE_LOG_INFO("P1 CRC Errors:", (unsigned long)framer.crcErrors);
+	REMOTE_LOG_INFO("P1 Telegrams Abandoned:", (unsigned long)framer.abandoned);
+	REMOTE_LOG_INFO("P1 Bytes Discarded:", (unsigned long)framer.discardedBytes);
+	REMOTE_LOG_INFO("Log Messages Sent:", (unsigned long)stats.counters[STAT_LOG_MESSAGES]);
+	REMOTE_LOG_INFO("Log Bytes Sent:", (unsigned long)stats.counters[STAT_LOG_BYTES_SENT]);
+	REMOTE_LOG_INFO("HTTP Requests:", (unsigned long)stats.counters[STAT_HTTP_REQUESTS]);
+	REMOTE_LOG_INFO("OTA Requests:", (unsigned long)stats.counters[STAT_OTA_ATTEMPTS]);
+	REMOTE_LOG_INFO("OTA Updates:", (unsigned long)stats.counters[STAT_OTA_UPDATES]);
+	REMOTE_LOG_INFO("Last OTA:", (unsigned long)stats.gauges[STAT_OTA_LAST_UPDATE]);
+	HistoryStats history;
+	getHistoryStats(history);
+	REMOTE_LOG_INFO("History Segments/Bytes:", history.segments, "/", history.storedBytes);
+	REMOTE_LOG_INFO("History Records:", (unsigned long)history.recordsAppended);
+	REMOTE_LOG_INFO("History Write Amplification x100:", (unsigned long)history.writeAmplificationX100);
+	REMOTE_LOG_INFO("History Flash Bytes/Day:", (unsigned long)history.flashBytesPerDay);
+	REMOTE_LOG_INFO("History Flash Erases/Day:", (unsigned long)history.flashErasesPerDay);
+	HeapSample memory;
+	sampleHeapTelemetry(memory);
+	HeapTelemetryStats memoryStats;
+	getHeapTelemetryStats(memoryStats);
+	REMOTE_LOG_INFO("Free Heap/Lowest:", memory.freeHeap, "/", memoryStats.minFreeHeap);
+	REMOTE_LOG_INFO("Largest Free Block/Lowest:", memory.largestFreeBlock, "/", memoryStats.minLargestFreeBlock);
+	REMOTE_LOG_INFO("Stack Used Core 0/1:", memory.stackUsed[0], "/", memory.stackUsed[1]);
+	REMOTE_LOG_INFO("Allocations/Per Minute:", memory.allocations, "/", memory.allocationsPerMinute);
+	LoopTimeStats loopTime;
+	getLoopTimeStats(loopTime);
+	REMOTE_LOG_INFO("Loop Passes/Max us:", loopTime.passes, "/", loopTime.maxUs);
 	REMOTE_LOG_INFO("Uptime:", millis() / 1000);
 	REMOTE_LOG_INFO(" seconds");
 	REMOTE_LOG_INFO("===================");
@@ -0,0 +1,244 @@
+#include "heap_telemetry.h"
+#include "custom_log.h"
+#include "string_builder.h"
+
+static HeapSample heapSamples[HEAP_SAMPLE_COUNT];
+static uint16_t heapSampleHead = 0;     // next slot to write
+static uint16_t heapSampleCount = 0;
+static unsigned long lastHeapSample = 0;
+static uint32_t minFreeHeap = 0xFFFFFFFFUL;
+static uint32_t minLargestFreeBlock = 0xFFFFFFFFUL;
+
+static HeapTagStats heapTagStats[HEAP_TAG_COUNT];
+static volatile uint8_t currentHeapTag = HEAP_TAG_OTHER;
+static volatile bool heapProbeActive = false;
+
+static const char* heapTagNames[HEAP_TAG_COUNT] = {
+	"other", "p1", "clients", "log", "http", "ntp", "history", "capture"
+};
+
+static void recordAllocation(size_t size) {
+	if (heapProbeActive) return;
+	HeapTagStats& stats = heapTagStats[currentHeapTag];
+	stats.allocations++;
+	stats.bytes += size;
+}
+
+// Allocation hooks. On the RP2040 every heap allocation ends up in newlib's
+// _malloc_r, which the linker routes here (-Wl,--wrap=_malloc_r). On the host
+// glibc lets the program replace malloc and still reach the real allocator.
+#if defined(HAL_NATIVE)
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+extern "C" void* malloc(size_t size) {
+	recordAllocation(size);
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+	recordAllocation(count * size);
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+	recordAllocation(size);
+	return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) {
+	__libc_free(ptr);
+}
+
+#else
+
+struct _reent;
+extern "C" void* __real__malloc_r(struct _reent* r, size_t size);
+
+extern "C" void* __wrap__malloc_r(struct _reent* r, size_t size) {
+	recordAllocation(size);
+	return __real__malloc_r(r, size);
+}
+
+#endif
+
+HeapTagScope::HeapTagScope(HeapTag tag) : previous(currentHeapTag) {
+	currentHeapTag = tag;
+}
+
+HeapTagScope::~HeapTagScope() {
+	currentHeapTag = previous;
+}
+
+// Stack high-water marks. Both core stacks are filled with a pattern at boot;
+// the deepest word that no longer holds it marks the most stack ever used.
+// The sketch has no setup1()/loop1(), so core 1 normally stays idle.
+#if defined(ARDUINO_ARCH_RP2040)
+
+#define STACK_PAINT 0xA5A5A5A5UL
+
+extern "C" uint32_t __StackBottom[], __StackTop[];
+extern "C" uint32_t __StackOneBottom[], __StackOneTop[];
+
+static void paintStack(uint32_t* bottom, uint32_t* limit) {
+	for (uint32_t* p = bottom; p < limit; p++) {
+		*p = STACK_PAINT;
+	}
+}
+
+static uint16_t measureStack(const uint32_t* bottom, const uint32_t* top) {
+	const uint32_t* p = bottom;
+	while (p < top && *p == STACK_PAINT) {
+		p++;
+	}
+	return (uint16_t)((top - p) * sizeof(uint32_t));
+}
+
+static void paintStacks() {
+	// Core 0 is running on its stack: stop well short of the current frame
+	uint32_t marker;
+	uint32_t* limit = &marker - 64;
+	if (limit > __StackBottom) {
+		paintStack(__StackBottom, limit);
+	}
+	paintStack(__StackOneBottom, __StackOneTop);
+}
+
+static void getStackSizes(uint16_t sizes[2]) {
+	sizes[0] = (uint16_t)((__StackTop - __StackBottom) * sizeof(uint32_t));
+	sizes[1] = (uint16_t)((__StackOneTop - __StackOneBottom) * sizeof(uint32_t));
+}
+
+static void measureStacks(uint16_t used[2]) {
+	used[0] = measureStack(__StackBottom, __StackTop);
+	used[1] = measureStack(__StackOneBottom, __StackOneTop);
+}
+
+#else
+
+// Host build: thread stacks are the OS's business
+static void paintStacks() {}
+
+static void getStackSizes(uint16_t sizes[2]) {
+	sizes[0] = 0;
+	sizes[1] = 0;
+}
+
+static void measureStacks(uint16_t used[2]) {
+	used[0] = 0;
+	used[1] = 0;
+}
+
+#endif
+
+// The largest block malloc() can hand out, found by trial allocations. Each
+// probe is freed straight away, so the heap ends up as it was.
+uint32_t getLargestFreeBlock() {
+	uint32_t low = 0;
+	uint32_t high = (uint32_t)rp2040.getFreeHeap();
+	heapProbeActive = true;
+	while (low < high) {
+		uint32_t size = low + (high - low + 1) / 2;
+		void* block = malloc(size);
+		if (block) {
+			free(block);
+			low = size;
+		} else {
+			high = size - 1;
+		}
+	}
+	heapProbeActive = false;
+	return low;
+}
+
+void sampleHeapTelemetry(HeapSample& sample) {
+	HeapTagStats totals;
+	getHeapAllocationTotals(totals);
+
+	sample.uptime = millis() / 1000;
+	sample.freeHeap = (uint32_t)rp2040.getFreeHeap();
+	sample.largestFreeBlock = getLargestFreeBlock();
+	measureStacks(sample.stackUsed);
+	sample.allocations = totals.allocations;
+	sample.allocationsPerMinute = 0;
+
+	if (heapSampleCount > 0) {
+		const HeapSample& previous = heapSamples[(heapSampleHead + HEAP_SAMPLE_COUNT - 1) % HEAP_SAMPLE_COUNT];
+		uint32_t seconds = sample.uptime - previous.uptime;
+		if (seconds > 0) {
+			sample.allocationsPerMinute = (uint32_t)((uint64_t)(sample.allocations - previous.allocations) * 60 / seconds);
+		}
+	}
+
+	if (sample.freeHeap < minFreeHeap) minFreeHeap = sample.freeHeap;
+	if (sample.largestFreeBlock < minLargestFreeBlock) minLargestFreeBlock = sample.largestFreeBlock;
+}
+
+static void storeHeapSample(const HeapSample& sample) {
+	heapSamples[heapSampleHead] = sample;
+	heapSampleHead = (heapSampleHead + 1) % HEAP_SAMPLE_COUNT;
+	if (heapSampleCount < HEAP_SAMPLE_COUNT) heapSampleCount++;
+}
+
+void initializeHeapTelemetry() {
+	paintStacks();
+	memset(heapSamples, 0, sizeof(heapSamples));
+	heapSampleHead = 0;
+	heapSampleCount = 0;
+	lastHeapSample = millis();
+
+	HeapSample sample;
+	sampleHeapTelemetry(sample);
+	storeHeapSample(sample);
+	REMOTE_LOG_INFO("Heap telemetry initialized, free heap:", (unsigned long)sample.freeHeap);
+}
+
+void handleHeapTelemetry() {
+	if (millis() - lastHeapSample < HEAP_SAMPLE_INTERVAL) return;
+	lastHeapSample = millis();
+
+	HeapSample sample;
+	sampleHeapTelemetry(sample);
+	storeHeapSample(sample);
+
+	FixedString<LOG_MESSAGE_SIZE> message;
+	message.append("Heap: free ").append(sample.freeHeap);
+	message.append(", largest block ").append(sample.largestFreeBlock);
+	message.append(", stack ").append(sample.stackUsed[0]).append('/').append(sample.stackUsed[1]);
+	message.append(", allocs/min ").append(sample.allocationsPerMinute);
+	REMOTE_LOG_DEBUG(message.c_str());
+}
+
+bool getHeapSample(uint16_t age, HeapSample& sample) {
+	if (age >= heapSampleCount) return false;
+	sample = heapSamples[(heapSampleHead + HEAP_SAMPLE_COUNT - 1 - age) % HEAP_SAMPLE_COUNT];
+	return true;
+}
+
+void getHeapTelemetryStats(HeapTelemetryStats& stats) {
+	stats.totalHeap = (uint32_t)rp2040.getTotalHeap();
+	stats.minFreeHeap = heapSampleCount > 0 ? minFreeHeap : 0;
+	stats.minLargestFreeBlock = heapSampleCount > 0 ? minLargestFreeBlock : 0;
+	getStackSizes(stats.stackSize);
+	stats.sampleCount = heapSampleCount;
+}
+
+void getHeapTagStats(HeapTag tag, HeapTagStats& stats) {
+	stats = heapTagStats[tag];
+}
+
+void getHeapAllocationTotals(HeapTagStats& stats) {
+	stats.allocations = 0;
+	stats.bytes = 0;
+	for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+		stats.allocations += heapTagStats[t].allocations;
+		stats.bytes += heapTagStats[t].bytes;
+	}
+}
+
+const char* getHeapTagName(HeapTag tag) {
+	return tag < HEAP_TAG_COUNT ? heapTagNames[tag] : "unknown";
+}
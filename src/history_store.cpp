@@ -0,0 +1,719 @@
+#include "history_store.h"
+#include "crc16.h"
+#include "varint.h"
+#include "custom_log.h"
+#include "heap_telemetry.h"
+#include <LittleFS.h>
+
+#define HISTORY_SEGMENT_MAGIC       0x53483150UL    // "P1HS"
+#define HISTORY_FOOTER_MAGIC        0x58483150UL    // "P1HX"
+#define HISTORY_FORMAT_VERSION      1
+
+#define HISTORY_HEADER_SIZE         40
+#define HISTORY_BLOCK_MARKER        0xB7
+#define HISTORY_BLOCK_HEADER_SIZE   8       // marker, count, length (2), first record time (4)
+#define HISTORY_BLOCK_OVERHEAD      (HISTORY_BLOCK_HEADER_SIZE + 2)
+#define HISTORY_FOOTER_SIZE         8       // entry count (2), CRC (2), magic (4)
+#define HISTORY_INDEX_ENTRY_SIZE    8       // time (4), offset (4)
+#define HISTORY_INDEX_ENTRIES       (HISTORY_SEGMENT_SIZE / HISTORY_INDEX_STRIDE + 1)
+
+// Tag byte at the start of every record
+#define HISTORY_TAG_COUNTERS        0x3F    // bit per AggCounterId with a non-zero delta
+#define HISTORY_TAG_GAP             0x40    // minutes since the previous record follow (otherwise 1)
+#define HISTORY_TAG_POWER           0x80    // zigzag net power follows
+
+#define HISTORY_MAX_SEGMENTS        (HISTORY_MAX_BYTES / HISTORY_SEGMENT_SIZE + 2)
+
+// Seal a segment once another block plus the largest footer might not fit
+#define HISTORY_SEAL_THRESHOLD      (HISTORY_SEGMENT_SIZE - HISTORY_BATCH_BUFFER_SIZE - HISTORY_BLOCK_OVERHEAD - \
+									 HISTORY_INDEX_ENTRIES * HISTORY_INDEX_ENTRY_SIZE - HISTORY_FOOTER_SIZE)
+
+#define HISTORY_FLASH_ENDURANCE     100000UL    // erase cycles per block (RP2040 QSPI flash)
+
+static_assert(AGG_COUNTER_COUNT <= 6, "record tag has room for six counters");
+static_assert(HISTORY_BATCH_BUFFER_SIZE <= 0xFFFF, "block length is 16 bits");
+
+struct HistorySegment {
+	uint32_t sequence;
+	uint32_t firstTime;     // first record, 0 while the segment is empty
+	uint32_t size;
+	uint32_t dataSize;      // end of the last block (start of the footer once sealed)
+	bool sealed;
+};
+
+struct HistoryIndexEntry {
+	uint32_t time;
+	uint32_t offset;
+};
+
+// Oldest segment first; only the last one can be open for appends
+static HistorySegment segments[HISTORY_MAX_SEGMENTS];
+static uint8_t segmentCount = 0;
+
+// Time index of the open segment, written as its footer when it is sealed
+static HistoryIndexEntry activeIndex[HISTORY_INDEX_ENTRIES];
+static uint8_t activeIndexCount = 0;
+
+// Records waiting for the next block
+static uint8_t batchBuffer[HISTORY_BATCH_BUFFER_SIZE];
+static uint16_t batchLength = 0;
+static uint8_t batchRecords = 0;
+static uint32_t batchFirstTime = 0;
+static uint32_t batchBaseCounters[AGG_COUNTER_COUNT];
+static uint8_t batchBaseMask = 0;
+static uint32_t lastRecordTime = 0;
+
+static bool historyMounted = false;
+static size_t flashBlockSize = 4096;
+static size_t flashPageSize = 256;
+static size_t flashTotalBytes = 0;
+static unsigned long historyStartMillis = 0;
+
+static HistoryStats historyStats;
+
+static void putU16(uint8_t* p, uint16_t value) {
+	p[0] = value & 0xFF;
+	p[1] = value >> 8;
+}
+
+static void putU32(uint8_t* p, uint32_t value) {
+	for (int i = 0; i < 4; i++) p[i] = (value >> (8 * i)) & 0xFF;
+}
+
+static uint16_t getU16(const uint8_t* p) {
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Decode one record; the first record of a block carries no gap and starts at the block time
+static bool decodeHistoryRecord(const uint8_t*& p, const uint8_t* end, bool first, uint32_t& time, HistoryRecord& record) {
+	if (p >= end) return false;
+	uint8_t tag = *p++;
+
+	uint32_t gapMinutes = first ? 0 : 1;
+	if ((tag & HISTORY_TAG_GAP) && !readVarint(p, end, gapMinutes)) return false;
+	time += gapMinutes * 60;
+
+	memset(&record, 0, sizeof(record));
+	record.time = time;
+	if (tag & HISTORY_TAG_POWER) {
+		uint32_t zigzag;
+		if (!readVarint(p, end, zigzag)) return false;
+		record.powerW = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+		record.flags |= HISTORY_RECORD_POWER;
+	}
+	for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+		if (!(tag & (1 << c))) continue;
+		if (!readVarint(p, end, record.counters[c])) return false;
+		record.counterMask |= (1 << c);
+	}
+	return true;
+}
+
+static String getSegmentPath(uint32_t sequence) {
+	char name[32];
+	snprintf(name, sizeof(name), HISTORY_DIR "/%08lx.seg", (unsigned long)sequence);
+	return String(name);
+}
+
+// Rough flash cost of appending to a LittleFS file: the partially filled last
+// block is copied into a fresh block before the new data, plus one metadata commit
+static void accountFlashWrite(uint32_t fileSize, uint32_t length) {
+	uint32_t tail = fileSize % flashBlockSize;
+	historyStats.flashBytesWritten += tail + length + flashPageSize;
+	historyStats.flashBlocksErased += (tail + length + flashBlockSize - 1) / flashBlockSize;
+}
+
+static void deleteOldestSegment() {
+	if (segmentCount == 0) return;
+
+	String path = getSegmentPath(segments[0].sequence);
+	if (!LittleFS.remove(path)) {
+		REMOTE_LOG_WARN("History: could not remove segment", path);
+	}
+	historyStats.segmentsDeleted++;
+	historyStats.flashBytesWritten += flashPageSize;
+
+	memmove(&segments[0], &segments[1], (segmentCount - 1) * sizeof(HistorySegment));
+	segmentCount--;
+	if (segmentCount == 0) activeIndexCount = 0;
+}
+
+static uint32_t getStoredBytes() {
+	uint32_t total = 0;
+	for (uint8_t i = 0; i < segmentCount; i++) total += segments[i].size;
+	return total;
+}
+
+static void enforceHistoryBudget() {
+	while (segmentCount > 1 && getStoredBytes() > HISTORY_MAX_BYTES) {
+		deleteOldestSegment();
+	}
+}
+
+static HistorySegment* createSegment() {
+	if (segmentCount == HISTORY_MAX_SEGMENTS) {
+		deleteOldestSegment();
+	}
+
+	uint32_t sequence = segmentCount > 0 ? segments[segmentCount - 1].sequence + 1 : 1;
+
+	uint8_t header[HISTORY_HEADER_SIZE];
+	memset(header, 0, sizeof(header));
+	putU32(header, HISTORY_SEGMENT_MAGIC);
+	header[4] = HISTORY_FORMAT_VERSION;
+	header[5] = batchBaseMask;
+	putU16(header + 6, HISTORY_HEADER_SIZE);
+	putU32(header + 8, sequence);
+	for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+		putU32(header + 12 + c * 4, batchBaseCounters[c]);
+	}
+	putU16(header + 36, crc16Update(0, header, 36));
+
+	String path = getSegmentPath(sequence);
+	File file = LittleFS.open(path, "w");
+	if (!file) {
+		REMOTE_LOG_ERROR("History: could not create segment", path);
+		return nullptr;
+	}
+	size_t written = file.write(header, sizeof(header));
+	file.close();
+	accountFlashWrite(0, sizeof(header));
+	if (written != sizeof(header)) {
+		REMOTE_LOG_ERROR("History: short write on segment header", path);
+		LittleFS.remove(path);
+		return nullptr;
+	}
+
+	HistorySegment& segment = segments[segmentCount++];
+	segment.sequence = sequence;
+	segment.firstTime = 0;
+	segment.size = sizeof(header);
+	segment.dataSize = sizeof(header);
+	segment.sealed = false;
+	activeIndexCount = 0;
+	historyStats.segmentsCreated++;
+
+	REMOTE_LOG_DEBUG("History: created segment", path);
+	return &segment;
+}
+
+static void resetBatch() {
+	batchLength = 0;
+	batchRecords = 0;
+	batchBaseMask = 0;
+}
+
+void flushHistory() {
+	HEAP_TAG_SCOPE(HEAP_TAG_HISTORY);
+	if (!historyMounted || batchRecords == 0) return;
+
+	HistorySegment* segment = nullptr;
+	if (segmentCount > 0 && !segments[segmentCount - 1].sealed) {
+		segment = &segments[segmentCount - 1];
+	} else {
+		segment = createSegment();
+	}
+	if (!segment) {
+		historyStats.writeErrors++;
+		resetBatch();
+		return;
+	}
+
+	uint8_t blockHeader[HISTORY_BLOCK_HEADER_SIZE];
+	blockHeader[0] = HISTORY_BLOCK_MARKER;
+	blockHeader[1] = batchRecords;
+	putU16(blockHeader + 2, batchLength);
+	putU32(blockHeader + 4, batchFirstTime);
+	uint16_t crc = crc16Update(0, blockHeader, sizeof(blockHeader));
+	crc = crc16Update(crc, batchBuffer, batchLength);
+	uint8_t blockTrailer[2];
+	putU16(blockTrailer, crc);
+
+	uint32_t blockOffset = segment->size;
+	if (activeIndexCount < HISTORY_INDEX_ENTRIES && blockOffset >= (uint32_t)activeIndexCount * HISTORY_INDEX_STRIDE) {
+		activeIndex[activeIndexCount].time = batchFirstTime;
+		activeIndex[activeIndexCount].offset = blockOffset;
+		activeIndexCount++;
+	}
+
+	uint32_t blockLength = HISTORY_BLOCK_OVERHEAD + batchLength;
+	bool seal = blockOffset + blockLength >= HISTORY_SEAL_THRESHOLD;
+
+	// The footer goes out with the last block so sealing costs no extra append
+	uint8_t footer[HISTORY_INDEX_ENTRIES * HISTORY_INDEX_ENTRY_SIZE + HISTORY_FOOTER_SIZE];
+	uint16_t footerLength = 0;
+	if (seal) {
+		for (uint8_t i = 0; i < activeIndexCount; i++) {
+			putU32(footer + footerLength, activeIndex[i].time);
+			putU32(footer + footerLength + 4, activeIndex[i].offset);
+			footerLength += HISTORY_INDEX_ENTRY_SIZE;
+		}
+		putU16(footer + footerLength, activeIndexCount);
+		putU16(footer + footerLength + 2, crc16Update(0, footer, footerLength));
+		putU32(footer + footerLength + 4, HISTORY_FOOTER_MAGIC);
+		footerLength += HISTORY_FOOTER_SIZE;
+	}
+
+	String path = getSegmentPath(segment->sequence);
+	File file = LittleFS.open(path, "a");
+	size_t written = 0;
+	if (file) {
+		written += file.write(blockHeader, sizeof(blockHeader));
+		written += file.write(batchBuffer, batchLength);
+		written += file.write(blockTrailer, sizeof(blockTrailer));
+		if (seal) written += file.write(footer, footerLength);
+		file.close();
+	}
+	accountFlashWrite(blockOffset, written);
+
+	if (written != blockLength + footerLength) {
+		// Whatever made it to flash fails its CRC and is dropped at the next mount
+		REMOTE_LOG_ERROR("History: append failed on", path);
+		historyStats.writeErrors++;
+		if (activeIndexCount > 0 && activeIndex[activeIndexCount - 1].offset == blockOffset) activeIndexCount--;
+		resetBatch();
+		return;
+	}
+
+	if (segment->firstTime == 0) segment->firstTime = batchFirstTime;
+	segment->size += written;
+	segment->dataSize += blockLength;
+	historyStats.blocksWritten++;
+	resetBatch();
+
+	if (seal) {
+		segment->sealed = true;
+		activeIndexCount = 0;
+		REMOTE_LOG_DEBUG("History: sealed segment", path);
+	}
+	enforceHistoryBudget();
+}
+
+static void appendHistoryBucket(AggResolution resolution, const AggBucket& bucket) {
+	HEAP_TAG_SCOPE(HEAP_TAG_HISTORY);
+	if (resolution != AGG_MINUTE) return;
+
+	// Uptime-based buckets cannot be placed on a calendar, and a step back
+	// in NTP time would break the delta encoding
+	if (!(bucket.flags & AGG_BUCKET_TIME_SYNCED) || bucket.start <= lastRecordTime) {
+		historyStats.recordsSkipped++;
+		return;
+	}
+
+	uint8_t record[HISTORY_MAX_RECORD_SIZE];
+	uint8_t length = 1;
+	uint8_t tag = 0;
+
+	if (batchRecords > 0) {
+		uint32_t gapMinutes = (bucket.start - lastRecordTime) / 60;
+		if (gapMinutes != 1) {
+			tag |= HISTORY_TAG_GAP;
+			length += writeVarint(record + length, gapMinutes);
+		}
+	}
+
+	const uint16_t powerMask = (1 << AGG_POWER_DELIVERED) | (1 << AGG_POWER_RETURNED);
+	if (bucket.channelMask & powerMask) {
+		int32_t power = 0;
+		if (bucket.channelMask & (1 << AGG_POWER_DELIVERED)) power += bucket.channels[AGG_POWER_DELIVERED].avg;
+		if (bucket.channelMask & (1 << AGG_POWER_RETURNED)) power -= bucket.channels[AGG_POWER_RETURNED].avg;
+		tag |= HISTORY_TAG_POWER;
+		length += writeVarint(record + length, ((uint32_t)power << 1) ^ (uint32_t)(power >> 31));
+	}
+
+	for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+		if (!(bucket.counterMask & (1 << c)) || bucket.counters[c] == 0) continue;
+		tag |= (1 << c);
+		length += writeVarint(record + length, bucket.counters[c]);
+	}
+	record[0] = tag;
+
+	if (batchRecords == 0) {
+		// Registers at the end of this record (its last telegram), stored in
+		// the header if the block starts a segment
+		batchFirstTime = bucket.start;
+		for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+			batchBaseCounters[c] = 0;
+			if (getAggregateRegister((AggCounterId)c, batchBaseCounters[c])) {
+				batchBaseMask |= (1 << c);
+			}
+		}
+	}
+
+	memcpy(batchBuffer + batchLength, record, length);
+	batchLength += length;
+	batchRecords++;
+	lastRecordTime = bucket.start;
+	historyStats.recordsAppended++;
+	historyStats.recordBytes += length;
+
+	if (batchRecords >= HISTORY_BATCH_RECORDS || batchLength + HISTORY_MAX_RECORD_SIZE > HISTORY_BATCH_BUFFER_SIZE) {
+		flushHistory();
+	}
+}
+
+static bool readSegmentHeader(File& file, uint32_t sequence) {
+	uint8_t header[HISTORY_HEADER_SIZE];
+	if (file.read(header, sizeof(header)) != sizeof(header)) return false;
+	return getU32(header) == HISTORY_SEGMENT_MAGIC &&
+		   header[4] == HISTORY_FORMAT_VERSION &&
+		   getU32(header + 8) == sequence &&
+		   getU16(header + 36) == crc16Update(0, header, 36);
+}
+
+// Returns the footer length (index + trailer) of a sealed segment, 0 when there is none
+static uint32_t getFooterLength(File& file, uint32_t size) {
+	if (size < HISTORY_HEADER_SIZE + HISTORY_FOOTER_SIZE) return 0;
+
+	uint8_t footer[HISTORY_FOOTER_SIZE];
+	file.seek(size - HISTORY_FOOTER_SIZE);
+	if (file.read(footer, sizeof(footer)) != sizeof(footer)) return 0;
+	if (getU32(footer + 4) != HISTORY_FOOTER_MAGIC) return 0;
+
+	uint16_t count = getU16(footer);
+	uint32_t indexLength = (uint32_t)count * HISTORY_INDEX_ENTRY_SIZE;
+	if (count > HISTORY_INDEX_ENTRIES || size < HISTORY_HEADER_SIZE + indexLength + HISTORY_FOOTER_SIZE) return 0;
+
+	uint8_t index[HISTORY_INDEX_ENTRIES * HISTORY_INDEX_ENTRY_SIZE];
+	file.seek(size - HISTORY_FOOTER_SIZE - indexLength);
+	if (file.read(index, indexLength) != indexLength) return 0;
+	if (crc16Update(0, index, indexLength) != getU16(footer + 2)) return 0;
+	return indexLength + HISTORY_FOOTER_SIZE;
+}
+
+// Walk the blocks of the newest segment to find the last record time. An open
+// segment also gets its time index rebuilt and a torn tail truncated.
+static void recoverNewestSegment(HistorySegment& segment) {
+	String path = getSegmentPath(segment.sequence);
+	File file = LittleFS.open(path, "r");
+	if (!file) return;
+
+	uint32_t offset = HISTORY_HEADER_SIZE;
+	activeIndexCount = 0;
+	file.seek(offset);
+
+	while (offset + HISTORY_BLOCK_OVERHEAD <= segment.dataSize) {
+		uint8_t blockHeader[HISTORY_BLOCK_HEADER_SIZE];
+		if (file.read(blockHeader, sizeof(blockHeader)) != sizeof(blockHeader)) break;
+
+		uint8_t count = blockHeader[1];
+		uint16_t length = getU16(blockHeader + 2);
+		uint32_t firstTime = getU32(blockHeader + 4);
+		if (blockHeader[0] != HISTORY_BLOCK_MARKER || count == 0 || length > HISTORY_BATCH_BUFFER_SIZE ||
+			offset + HISTORY_BLOCK_OVERHEAD + length > segment.dataSize) break;
+
+		uint8_t trailer[2];
+		if (file.read(batchBuffer, length) != length || file.read(trailer, sizeof(trailer)) != sizeof(trailer)) break;
+		uint16_t crc = crc16Update(crc16Update(0, blockHeader, sizeof(blockHeader)), batchBuffer, length);
+		if (crc != getU16(trailer)) break;
+
+		if (activeIndexCount < HISTORY_INDEX_ENTRIES && offset >= (uint32_t)activeIndexCount * HISTORY_INDEX_STRIDE) {
+			activeIndex[activeIndexCount].time = firstTime;
+			activeIndex[activeIndexCount].offset = offset;
+			activeIndexCount++;
+		}
+		if (segment.firstTime == 0) segment.firstTime = firstTime;
+
+		// The newest record time keeps new appends in order
+		const uint8_t* p = batchBuffer;
+		uint32_t time = firstTime;
+		HistoryRecord record;
+		for (uint8_t i = 0; i < count; i++) {
+			if (!decodeHistoryRecord(p, batchBuffer + length, i == 0, time, record)) break;
+		}
+		lastRecordTime = time;
+
+		offset += HISTORY_BLOCK_OVERHEAD + length;
+	}
+	file.close();
+
+	if (!segment.sealed && offset < segment.size) {
+		REMOTE_LOG_WARN("History: truncating torn segment tail, bytes:", (int)(segment.size - offset));
+		historyStats.recoveredBytes += segment.size - offset;
+		file = LittleFS.open(path, "r+");
+		if (!file || !file.truncate(offset)) {
+			REMOTE_LOG_ERROR("History: could not truncate", path);
+			historyStats.writeErrors++;
+		}
+		if (file) file.close();
+		segment.size = offset;
+		segment.dataSize = offset;
+	}
+}
+
+// Load the segment table from HISTORY_DIR, oldest first
+static void mountSegments() {
+	segmentCount = 0;
+	Dir dir = LittleFS.openDir(HISTORY_DIR);
+	while (dir.next()) {
+		String name = dir.fileName();
+		int slash = name.lastIndexOf('/');
+		if (slash >= 0) name = name.substring(slash + 1);
+		if (!name.endsWith(".seg")) continue;
+
+		uint32_t sequence = strtoul(name.c_str(), nullptr, 16);
+		if (sequence == 0) continue;
+
+		// Keep the newest segments if there are more files than slots
+		if (segmentCount == HISTORY_MAX_SEGMENTS) {
+			if (sequence < segments[0].sequence) {
+				LittleFS.remove(getSegmentPath(sequence));
+				continue;
+			}
+			deleteOldestSegment();
+		}
+
+		uint8_t i = segmentCount++;
+		while (i > 0 && segments[i - 1].sequence > sequence) {
+			segments[i] = segments[i - 1];
+			i--;
+		}
+		segments[i].sequence = sequence;
+		segments[i].size = dir.fileSize();
+		segments[i].dataSize = segments[i].size;
+		segments[i].firstTime = 0;
+		segments[i].sealed = false;
+	}
+
+	for (uint8_t i = 0; i < segmentCount; ) {
+		HistorySegment& segment = segments[i];
+		String path = getSegmentPath(segment.sequence);
+		File file = LittleFS.open(path, "r");
+		if (!file || !readSegmentHeader(file, segment.sequence)) {
+			if (file) file.close();
+			REMOTE_LOG_WARN("History: removing segment with a bad header", path);
+			LittleFS.remove(path);
+			memmove(&segments[i], &segments[i + 1], (segmentCount - i - 1) * sizeof(HistorySegment));
+			segmentCount--;
+			continue;
+		}
+
+		uint8_t blockHeader[HISTORY_BLOCK_HEADER_SIZE];
+		if (segment.size >= HISTORY_HEADER_SIZE + HISTORY_BLOCK_OVERHEAD &&
+			file.read(blockHeader, sizeof(blockHeader)) == sizeof(blockHeader) &&
+			blockHeader[0] == HISTORY_BLOCK_MARKER) {
+			segment.firstTime = getU32(blockHeader + 4);
+		}
+		// An older segment that lost its footer is still readable, just without an index
+		uint32_t footerLength = getFooterLength(file, segment.size);
+		segment.dataSize = segment.size - footerLength;
+		segment.sealed = footerLength > 0 || i + 1 < segmentCount;
+		file.close();
+		i++;
+	}
+
+	if (segmentCount > 0) {
+		recoverNewestSegment(segments[segmentCount - 1]);
+	}
+}
+
+void initializeHistory() {
+	memset(&historyStats, 0, sizeof(historyStats));
+	resetBatch();
+	historyStartMillis = millis();
+
+	if (!HISTORY_ENABLED) {
+		REMOTE_LOG_INFO("History store disabled");
+		return;
+	}
+
+	FSInfo info;
+	if (!LittleFS.info(info)) {
+		REMOTE_LOG_ERROR("History: LittleFS not available, history disabled");
+		return;
+	}
+	flashBlockSize = info.blockSize;
+	flashPageSize = info.pageSize;
+	flashTotalBytes = info.totalBytes;
+
+	LittleFS.mkdir(HISTORY_DIR);
+	mountSegments();
+	enforceHistoryBudget();
+
+	historyMounted = true;
+	setAggregateClosedCallback(appendHistoryBucket);
+
+	REMOTE_LOG_INFO("History store mounted, segments/bytes:", segmentCount, "/", getStoredBytes());
+}
+
+bool releaseHistorySpace(size_t bytes) {
+	if (!historyMounted) return true;
+
+	flushHistory();
+	FSInfo info;
+	while (LittleFS.info(info) && info.totalBytes - info.usedBytes < bytes) {
+		if (segmentCount == 0) return false;
+		REMOTE_LOG_INFO("History: dropping oldest segment to free flash space");
+		deleteOldestSegment();
+	}
+	return true;
+}
+
+void getHistoryStats(HistoryStats& stats) {
+	stats = historyStats;
+	stats.mounted = historyMounted;
+	stats.segments = segmentCount;
+	stats.storedBytes = getStoredBytes();
+	stats.oldestTime = 0;
+	for (uint8_t i = 0; i < segmentCount; i++) {
+		if (segments[i].firstTime != 0) {
+			stats.oldestTime = segments[i].firstTime;
+			break;
+		}
+	}
+	if (stats.oldestTime == 0 && batchRecords > 0) stats.oldestTime = batchFirstTime;
+	stats.newestTime = lastRecordTime;
+	stats.pendingRecords = batchRecords;
+
+	stats.writeAmplificationX100 = stats.recordBytes > 0 ? (uint32_t)((uint64_t)stats.flashBytesWritten * 100 / stats.recordBytes) : 0;
+	uint32_t elapsed = (millis() - historyStartMillis) / 1000;
+	if (elapsed > 0) {
+		stats.flashBytesPerDay = (uint32_t)((uint64_t)stats.flashBytesWritten * 86400 / elapsed);
+		stats.flashErasesPerDay = (uint32_t)((uint64_t)stats.flashBlocksErased * 86400 / elapsed);
+	}
+	stats.flashBlockCount = flashBlockSize > 0 ? flashTotalBytes / flashBlockSize : 0;
+	// LittleFS spreads erases over the whole partition
+	if (stats.flashErasesPerDay > 0) {
+		stats.flashLifetimeYears = (uint32_t)((uint64_t)HISTORY_FLASH_ENDURANCE * stats.flashBlockCount / stats.flashErasesPerDay / 365);
+	}
+}
+
+// Offset of the last indexed block that starts at or before the given time
+static uint32_t seekSegment(uint8_t index, uint32_t time) {
+	const HistorySegment& segment = segments[index];
+	uint32_t offset = HISTORY_HEADER_SIZE;
+
+	if (!segment.sealed) {
+		for (uint8_t i = 0; i < activeIndexCount && activeIndex[i].time <= time; i++) {
+			offset = activeIndex[i].offset;
+		}
+		return offset;
+	}
+
+	uint32_t indexLength = segment.size - segment.dataSize;
+	if (indexLength <= HISTORY_FOOTER_SIZE) return offset;
+	indexLength -= HISTORY_FOOTER_SIZE;
+
+	File file = LittleFS.open(getSegmentPath(segment.sequence), "r");
+	if (!file) return offset;
+	uint8_t entry[HISTORY_INDEX_ENTRY_SIZE];
+	file.seek(segment.dataSize);
+	for (uint32_t i = 0; i < indexLength; i += HISTORY_INDEX_ENTRY_SIZE) {
+		if (file.read(entry, sizeof(entry)) != sizeof(entry) || getU32(entry) > time) break;
+		offset = getU32(entry + 4);
+	}
+	file.close();
+	return offset;
+}
+
+void openHistoryCursor(HistoryCursor& cursor, uint32_t from, uint32_t to) {
+	memset(&cursor, 0, sizeof(cursor));
+	cursor.from = from;
+	cursor.to = to;
+
+	// Start in the newest segment whose first record is not after 'from'
+	uint8_t start = 0;
+	for (uint8_t i = 0; i < segmentCount; i++) {
+		if (segments[i].firstTime != 0 && segments[i].firstTime <= from) start = i;
+	}
+	if (segmentCount > 0) {
+		cursor.sequence = segments[start].sequence;
+		cursor.offset = seekSegment(start, from);
+	}
+}
+
+static bool loadBlock(HistoryCursor& cursor, const HistorySegment& segment) {
+	File file = LittleFS.open(getSegmentPath(segment.sequence), "r");
+	if (!file) return false;
+
+	uint8_t blockHeader[HISTORY_BLOCK_HEADER_SIZE];
+	uint8_t trailer[2];
+	bool valid = false;
+	file.seek(cursor.offset);
+	if (file.read(blockHeader, sizeof(blockHeader)) == sizeof(blockHeader) && blockHeader[0] == HISTORY_BLOCK_MARKER) {
+		uint16_t length = getU16(blockHeader + 2);
+		if (length <= sizeof(cursor.block) && cursor.offset + HISTORY_BLOCK_OVERHEAD + length <= segment.dataSize &&
+			file.read(cursor.block, length) == length && file.read(trailer, sizeof(trailer)) == sizeof(trailer) &&
+			crc16Update(crc16Update(0, blockHeader, sizeof(blockHeader)), cursor.block, length) == getU16(trailer)) {
+			cursor.blockLength = length;
+			cursor.blockRecords = blockHeader[1];
+			cursor.blockTime = getU32(blockHeader + 4);
+			cursor.offset += HISTORY_BLOCK_OVERHEAD + length;
+			valid = true;
+		}
+	}
+	file.close();
+	return valid;
+}
+
+// Move to the next block: on flash first, then the batch still in RAM
+static bool nextBlock(HistoryCursor& cursor) {
+	cursor.blockLength = 0;
+	cursor.blockPosition = 0;
+	cursor.blockRecords = 0;
+	cursor.blockRecord = 0;
+
+	while (cursor.sequence != 0) {
+		// Segments may have been rotated out or added since the last call
+		uint8_t i = 0;
+		while (i < segmentCount && segments[i].sequence < cursor.sequence) i++;
+		if (i == segmentCount) break;
+		if (segments[i].sequence != cursor.sequence) {
+			cursor.sequence = segments[i].sequence;
+			cursor.offset = HISTORY_HEADER_SIZE;
+		}
+
+		const HistorySegment& segment = segments[i];
+		if (cursor.offset + HISTORY_BLOCK_OVERHEAD <= segment.dataSize) {
+			if (loadBlock(cursor, segment)) return true;
+			REMOTE_LOG_WARN("History: unreadable block, skipping rest of segment", getSegmentPath(segment.sequence));
+		}
+
+		if (i + 1 == segmentCount) break;
+		cursor.sequence = segments[i + 1].sequence;
+		cursor.offset = HISTORY_HEADER_SIZE;
+	}
+	cursor.sequence = 0;
+
+	if (!cursor.pendingRead && batchRecords > 0) {
+		cursor.pendingRead = true;
+		memcpy(cursor.block, batchBuffer, batchLength);
+		cursor.blockLength = batchLength;
+		cursor.blockRecords = batchRecords;
+		cursor.blockTime = batchFirstTime;
+		return true;
+	}
+	return false;
+}
+
+bool readHistoryRecord(HistoryCursor& cursor, HistoryRecord& record) {
+	while (!cursor.done) {
+		if (cursor.blockRecord >= cursor.blockRecords) {
+			if (!nextBlock(cursor) || cursor.blockTime > cursor.to) {
+				cursor.done = true;
+				break;
+			}
+		}
+
+		const uint8_t* p = cursor.block + cursor.blockPosition;
+		if (!decodeHistoryRecord(p, cursor.block + cursor.blockLength, cursor.blockRecord == 0, cursor.blockTime, record)) {
+			cursor.blockRecord = cursor.blockRecords;
+			continue;
+		}
+		cursor.blockPosition = p - cursor.block;
+		cursor.blockRecord++;
+
+		if (record.time < cursor.from || record.time <= cursor.lastTime) continue;
+		if (record.time > cursor.to) {
+			cursor.done = true;
+			break;
+		}
+		cursor.lastTime = record.time;
+		return true;
+	}
+	return false;
+}
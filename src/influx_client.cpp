@@ -0,0 +1,263 @@
+#include "influx_client.h"
+#include "p1_handler.h"
+#include "p1_values.h"
+#include "ntp_client.h"
+#include "custom_log.h"
+#include "string_builder.h"
+#include "stats.h"
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+
+#define INFLUX_UDP_LOCAL_PORT   8890    // source port of the datagrams
+#define INFLUX_HEADER_MAX       384     // POST request line and headers
+#define INFLUX_STATUS_LINE_MAX  16      // "HTTP/1.1 204" is all that is read of the response
+
+// Points go into one buffer while the other is being sent (HTTP) or waits for
+// the send of the first to finish
+struct InfluxBuffer {
+	char data[INFLUX_BUFFER_SIZE];
+	size_t length;
+	uint16_t points;
+	unsigned long firstPoint;           // millis() when the first point was added
+	bool sending;
+};
+
+enum InfluxPostState {
+	INFLUX_POST_IDLE,
+	INFLUX_POST_SENDING,                // request line, headers and body as the socket takes them
+	INFLUX_POST_WAITING                 // for the status line
+};
+
+static InfluxBuffer influxBuffers[2];
+static uint8_t filling = 0;             // the buffer points are added to; never sending
+
+static EthernetClient influxClient;
+static InfluxPostState postState = INFLUX_POST_IDLE;
+static InfluxBuffer* posting = nullptr;
+static FixedString<INFLUX_HEADER_MAX> postHeader;
+static size_t postOffset;               // bytes of header and body written
+static unsigned long postStarted;
+static char statusLine[INFLUX_STATUS_LINE_MAX];
+static size_t statusLength;
+static bool connectFailed = false;
+static unsigned long connectFailedAt = 0;
+
+static void resetBuffer(InfluxBuffer& buffer) {
+	buffer.length = 0;
+	buffer.points = 0;
+	buffer.sending = false;
+}
+
+// A buffer that was sent, or given up on
+static void bufferDone(InfluxBuffer& buffer, bool delivered) {
+	if (delivered) {
+		addStat(STAT_INFLUX_BATCHES);
+	} else {
+		addStat(STAT_INFLUX_ERRORS);
+		addStat(STAT_INFLUX_POINTS_DROPPED, buffer.points);
+	}
+	resetBuffer(buffer);
+}
+
+static void sendDatagram(InfluxBuffer& buffer) {
+	// A socket only for the send, like the NTP client, so UDP output costs no
+	// socket from the budget
+	EthernetUDP udp;
+	bool sent = false;
+	if (udp.begin(INFLUX_UDP_LOCAL_PORT)) {
+		if (udp.beginPacket(INFLUX_HOST, INFLUX_PORT) == 1) {
+			udp.write((const uint8_t*)buffer.data, buffer.length);
+			sent = udp.endPacket() == 1;
+		}
+		udp.stop();
+	}
+	if (sent) {
+		addStat(STAT_INFLUX_BYTES_SENT, buffer.length);
+	} else {
+		REMOTE_LOG_WARN("InfluxDB datagram not sent, points dropped:", buffer.points);
+	}
+	bufferDone(buffer, sent);
+}
+
+// Hand the filled buffer over for sending and continue in the other one;
+// false while that one is still being sent
+static bool flushInflux() {
+	InfluxBuffer& full = influxBuffers[filling];
+	if (full.length == 0) return true;
+	if (INFLUX_TRANSPORT == INFLUX_UDP) {
+		sendDatagram(full);
+		return true;
+	}
+	if (influxBuffers[filling ^ 1].sending) return false;
+	full.sending = true;
+	filling ^= 1;
+	return true;
+}
+
+// <measurement>,<tags> <field>=<value>,... <timestamp>\n; false when it does not fit
+static bool appendPoint(StringBuilder& line, const P1Reading& reading, uint64_t timestampNs) {
+	line.append(INFLUX_MEASUREMENT);
+	if (strlen(INFLUX_TAGS) > 0) line.append(',').append(INFLUX_TAGS);
+	char separator = ' ';
+	for (uint8_t v = 0; v < P1_VALUE_COUNT; v++) {
+		long value;
+		if (!readP1Value(reading, v, value)) continue;
+		line.append(separator).append(getP1ValueName(v)).append('=');
+		uint8_t decimals = getP1ValueDecimals(v);
+		if (decimals == 0) {
+			line.append(value).append('i');
+		} else {
+			line.appendFixedPoint(value, decimals);
+		}
+		separator = ',';
+	}
+	line.append(' ').append((unsigned long long)timestampNs).append('\n');
+	return separator != ' ' && !line.overflowed();
+}
+
+static void addPoint(const String& telegram, const P1Reading* reading) {
+	if (!reading) return;
+
+	// Without NTP time a point would get the server's time of the flush
+	uint64_t epochMs = getEpochMillis(millis());
+	if (epochMs == 0) {
+		addStat(STAT_INFLUX_POINTS_DROPPED);
+		return;
+	}
+	uint64_t timestampNs = epochMs * 1000000ULL;
+
+	for (int attempt = 0; attempt < 2; attempt++) {
+		InfluxBuffer& buffer = influxBuffers[filling];
+		StringBuilder line(buffer.data + buffer.length, sizeof(buffer.data) - buffer.length);
+		if (appendPoint(line, *reading, timestampNs)) {
+			if (buffer.points == 0) buffer.firstPoint = millis();
+			buffer.length += line.length();
+			buffer.points++;
+			addStat(STAT_INFLUX_POINTS);
+			return;
+		}
+		// Full: send what is there and try once more in an empty buffer
+		if (buffer.length == 0 || !flushInflux()) break;
+	}
+	addStat(STAT_INFLUX_POINTS_DROPPED);
+}
+
+static void finishPost(bool delivered) {
+	influxClient.stop();
+	bufferDone(*posting, delivered);
+	posting = nullptr;
+	postState = INFLUX_POST_IDLE;
+}
+
+static void startPost() {
+	for (int i = 0; i < 2; i++) {
+		if (influxBuffers[i].sending) posting = &influxBuffers[i];
+	}
+	if (!posting) return;
+
+	// A server that is down would otherwise block loop() for the connect
+	// timeout at every flush
+	if (connectFailed && millis() - connectFailedAt < INFLUX_RETRY_INTERVAL) {
+		finishPost(false);
+		return;
+	}
+	influxClient.setConnectionTimeout(INFLUX_CONNECT_TIMEOUT);
+	if (influxClient.connect(INFLUX_HOST, INFLUX_PORT) != 1) {
+		REMOTE_LOG_WARN("InfluxDB connect failed, retry after ms:", INFLUX_RETRY_INTERVAL);
+		connectFailed = true;
+		connectFailedAt = millis();
+		finishPost(false);
+		return;
+	}
+	connectFailed = false;
+
+	postHeader.clear();
+	postHeader.append("POST ").append(INFLUX_HTTP_PATH).append(" HTTP/1.1\r\n");
+	postHeader.append("Host: ").append(INFLUX_HOST).append(':').append(INFLUX_PORT).append("\r\n");
+	if (strlen(INFLUX_HTTP_AUTH) > 0) postHeader.append("Authorization: ").append(INFLUX_HTTP_AUTH).append("\r\n");
+	postHeader.append("Content-Type: text/plain; charset=utf-8\r\n");
+	postHeader.append("Content-Length: ").append(posting->length).append("\r\n");
+	postHeader.append("Connection: close\r\n\r\n");
+	postOffset = 0;
+	postStarted = millis();
+	postState = INFLUX_POST_SENDING;
+}
+
+// Header and body pieces as the socket has room, so a slow server never
+// blocks the loop
+static void continuePost() {
+	size_t total = postHeader.length() + posting->length;
+	while (postOffset < total) {
+		int room = influxClient.availableForWrite();
+		if (room <= 0) return;
+		const char* piece;
+		size_t length;
+		if (postOffset < postHeader.length()) {
+			piece = postHeader.c_str() + postOffset;
+			length = postHeader.length() - postOffset;
+		} else {
+			piece = posting->data + (postOffset - postHeader.length());
+			length = total - postOffset;
+		}
+		length = min(length, (size_t)room);
+		influxClient.write((const uint8_t*)piece, length);
+		postOffset += length;
+		addStat(STAT_INFLUX_BYTES_SENT, length);
+	}
+	statusLength = 0;
+	postState = INFLUX_POST_WAITING;
+}
+
+static void readPostResponse() {
+	while (influxClient.available() > 0) {
+		int c = influxClient.read();
+		if (c < 0) return;
+		if (c != '\n') {
+			if (statusLength < sizeof(statusLine) - 1) statusLine[statusLength++] = (char)c;
+			continue;
+		}
+		// "HTTP/1.1 204 No Content": the code starts at 9
+		statusLine[statusLength] = '\0';
+		int code = statusLength >= 12 ? atoi(statusLine + 9) : 0;
+		if (code < 200 || code > 299) {
+			REMOTE_LOG_WARN("InfluxDB write rejected, HTTP status:", code);
+		}
+		finishPost(code >= 200 && code <= 299);
+		return;
+	}
+	if (!influxClient.connected()) {
+		REMOTE_LOG_WARN("InfluxDB closed the connection without a response");
+		finishPost(false);
+	}
+}
+
+static void handlePost() {
+	if (postState == INFLUX_POST_IDLE) {
+		startPost();
+		if (postState == INFLUX_POST_IDLE) return;
+	}
+	if (postState == INFLUX_POST_SENDING) continuePost();
+	if (postState == INFLUX_POST_WAITING) readPostResponse();
+	if (postState != INFLUX_POST_IDLE && millis() - postStarted > INFLUX_RESPONSE_TIMEOUT) {
+		REMOTE_LOG_WARN("InfluxDB write timed out");
+		finishPost(false);
+	}
+}
+
+void initializeInflux() {
+	if (!INFLUX_ENABLED) return;
+	resetBuffer(influxBuffers[0]);
+	resetBuffer(influxBuffers[1]);
+	addP1TelegramCallback(addPoint, true);
+	REMOTE_LOG_INFO(INFLUX_TRANSPORT == INFLUX_UDP ? "InfluxDB line protocol over UDP to:" : "InfluxDB line protocol over HTTP to:", INFLUX_HOST ":" + String(INFLUX_PORT));
+}
+
+void handleInflux() {
+	if (!INFLUX_ENABLED) return;
+
+	InfluxBuffer& buffer = influxBuffers[filling];
+	if (buffer.points > 0 && millis() - buffer.firstPoint >= INFLUX_FLUSH_INTERVAL) {
+		flushInflux();
+	}
+	if (INFLUX_TRANSPORT == INFLUX_HTTP) handlePost();
+}
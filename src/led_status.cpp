@@ -1,6 +1,7 @@
 #include "led_status.h"
 #include "clients.h"
 #include "p1_handler.h"
+#include "stats.h"
 
 // NeoPixel LED setup
 Adafruit_NeoPixel statusLed(1, STATUS_LED_PIN, NEO_GRB + NEO_KHZ800);
@@ -51,7 +52,7 @@ void updateStatusLED() {
 
 	// P1 data activity: Brief brightness boost (not color change)
 	uint8_t activityBoost = 0;
-	if (now - lastP1DataReceived < 200) { // 200ms boost after P1 data
+	if (now - getStat(STAT_P1_LAST_TELEGRAM) < 200) { // 200ms boost after P1 data
 		activityBoost = 100; // Brightness boost
 	}
 
@@ -1,6 +1,10 @@
 #include "log_server.h"
 #include "custom_log.h"
 #include "ntp_client.h"
+#include "string_builder.h"
+#include "heap_telemetry.h"
+#include "stats.h"
+#include "web/websocket_handler.h"
 
 // Global variables
 EthernetServer logServer(LOG_SERVER_PORT);
@@ -8,10 +12,6 @@ EthernetClient logClients[MAX_LOG_CONNECTIONS];
 unsigned long logClientLastActivity[MAX_LOG_CONNECTIONS];
 bool logClientConnected[MAX_LOG_CONNECTIONS];
 
-// Statistics
-unsigned long totalLogMessages = 0;
-unsigned long totalLogBytesSent = 0;
-
 void initializeLogServer() {
 	// Initialize log client arrays
 	for (int i = 0; i < MAX_LOG_CONNECTIONS; i++) {
@@ -24,7 +24,20 @@ void initializeLogServer() {
 	REMOTE_LOG_INFO("Log server listening on port:", LOG_SERVER_PORT);
 }
 
+// Greeting sent to every new log client
+static void sendLogWelcome(EthernetClient& client) {
+	FixedString<LOG_MESSAGE_SIZE> welcomeMsg;
+	welcomeMsg.append("# Connected to P1 Bridge Log Server\r\n");
+	welcomeMsg.append("# Time: ");
+	printFormattedDateTime(welcomeMsg);
+	welcomeMsg.append(" (uptime: ").append(millis() / 1000).append("s)\r\n");
+	welcomeMsg.append("# NTP Status: ").append(isNTPTimeValid() ? "Synchronized" : "Not synced").append("\r\n");
+	welcomeMsg.append("# Log format: [TIMESTAMP] [LEVEL] MESSAGE\r\n");
+	client.write((const uint8_t*)welcomeMsg.c_str(), welcomeMsg.length());
+}
+
 void handleNewLogConnections() {
+	HEAP_TAG_SCOPE(HEAP_TAG_LOG);
 	EthernetClient newLogClient = logServer.accept();
 	if (newLogClient) {
 		// Find available slot
@@ -42,12 +55,7 @@ void handleNewLogConnections() {
 			logClientConnected[availableSlot] = true;
 			logClientLastActivity[availableSlot] = millis();
 
-			// Send welcome message
-			String welcomeMsg = "# Connected to P1 Bridge Log Server\r\n";
-			welcomeMsg += "# Time: " + getFormattedDateTime() + " (uptime: " + String(millis() / 1000) + "s)\r\n";
-			welcomeMsg += "# NTP Status: " + String(isNTPTimeValid() ? "Synchronized" : "Not synced") + "\r\n";
-			welcomeMsg += "# Log format: [TIMESTAMP] [LEVEL] MESSAGE\r\n";
-			logClients[availableSlot].print(welcomeMsg);
+			sendLogWelcome(logClients[availableSlot]);
 
 		} else {
 			// No available slots - kick oldest client
@@ -73,34 +81,39 @@ void handleNewLogConnections() {
 			logClientConnected[oldestSlot] = true;
 			logClientLastActivity[oldestSlot] = millis();
 
-			// Send welcome message
-			String welcomeMsg = "# Connected to P1 Bridge Log Server\r\n";
-			welcomeMsg += "# Time: " + getFormattedDateTime() + " (uptime: " + String(millis() / 1000) + "s)\r\n";
-			welcomeMsg += "# NTP Status: " + String(isNTPTimeValid() ? "Synchronized" : "Not synced") + "\r\n";
-			welcomeMsg += "# Log format: [TIMESTAMP] [LEVEL] MESSAGE\r\n";
-			logClients[oldestSlot].print(welcomeMsg);
+			sendLogWelcome(logClients[oldestSlot]);
 		}
 	}
 }
 
-void sendToAllLogClients(const String& logMessage) {
-	if (getConnectedLogClientCount() == 0) return; // No clients, skip processing
+void sendToAllLogClients(const char* logMessage) {
+	HEAP_TAG_SCOPE(HEAP_TAG_LOG);
+	if (getConnectedLogClientCount() == 0 && !hasWebSocketLogSubscribers()) return; // No clients, skip processing
 
 	// Format log message with timestamp
-	String timestamp = isNTPTimeValid() ? getFormattedDateTime() : ("+" + String(millis() / 1000) + "s");
-	String formattedMessage = "[" + timestamp + "] " + logMessage + "\r\n";
+	FixedString<LOG_MESSAGE_SIZE + 32> formattedMessage;
+	formattedMessage.append('[');
+	if (isNTPTimeValid()) {
+		printFormattedDateTime(formattedMessage);
+	} else {
+		formattedMessage.append('+').append(millis() / 1000).append('s');
+	}
+	formattedMessage.append("] ").append(logMessage);
+	sendWebSocketLog(formattedMessage.c_str(), formattedMessage.length());
+	formattedMessage.append("\r\n");
 
 	for (int i = 0; i < MAX_LOG_CONNECTIONS; i++) {
 		if (logClientConnected[i] && logClients[i].connected()) {
-			logClients[i].print(formattedMessage);
+			logClients[i].write((const uint8_t*)formattedMessage.c_str(), formattedMessage.length());
 			logClientLastActivity[i] = millis();
-			totalLogBytesSent += formattedMessage.length();
+			addStat(STAT_LOG_BYTES_SENT, formattedMessage.length());
 		}
 	}
-	totalLogMessages++;
+	addStat(STAT_LOG_MESSAGES);
 }
 
 void handleLogClientCommunication() {
+	HEAP_TAG_SCOPE(HEAP_TAG_LOG);
 	for (int i = 0; i < MAX_LOG_CONNECTIONS; i++) {
 		if (logClientConnected[i] && logClients[i].connected()) {
 			// Read any data from log clients (usually just keep-alive or commands)
@@ -123,6 +136,7 @@ void handleLogClientCommunication() {
 }
 
 void cleanupLogClients() {
+	HEAP_TAG_SCOPE(HEAP_TAG_LOG);
 	for (int i = 0; i < MAX_LOG_CONNECTIONS; i++) {
 		if (logClientConnected[i] && !logClients[i].connected()) {
 			logClientConnected[i] = false;
@@ -143,7 +157,7 @@ int getConnectedLogClientCount() {
 
 // Function to send log messages to remote clients
 void logToRemoteClients(const char* message) {
-	if (getConnectedLogClientCount() > 0) {
-		sendToAllLogClients(String(message));
+	if (getConnectedLogClientCount() > 0 || hasWebSocketLogSubscribers()) {
+		sendToAllLogClients(message);
 	}
 }
@@ -4,6 +4,9 @@
 #include "config.h"
 #include "clients.h"
 #include "p1_handler.h"
+#include "p1_aggregator.h"
+#include "history_store.h"
+#include "p1_capture.h"
 #include "led_status.h"
 #include "network_init.h"
 #include "diagnostics.h"
@@ -11,6 +14,11 @@
 #include "custom_log.h"
 #include "http_info.h"
 #include "ntp_client.h"
+#include "heap_telemetry.h"
+#include "stats.h"
+#include "mqtt_client.h"
+#include "influx_client.h"
+#include "modbus_server.h"
 
 void setup() {
 	// Initialize serial for debugging
@@ -26,6 +34,9 @@ void setup() {
 
 	REMOTE_LOG_INFO("P1 Serial-to-Network Bridge Starting...");
 
+	// Start heap/stack sampling first so the stack marks cover all of setup()
+	initializeHeapTelemetry();
+
 	// Initialize LittleFS for OTA support
 	if (!LittleFS.begin()) {
 		REMOTE_LOG_ERROR("LittleFS initialization failed - OTA updates may not work");
@@ -51,14 +62,34 @@ void setup() {
 	// Initialize NTP time synchronization
 	initializeNTP();
 
+	// Initialize telegram aggregation (min/max/avg history in RAM)
+	initializeAggregator();
+
+	// Initialize on-flash history of the 1-minute buckets
+	initializeHistory();
+
+	// Initialize raw serial capture/replay (idle until started over HTTP)
+	initializeP1Capture();
+
 	// Initialize P1 protocol handler
 	initializeP1();
 
+	// Initialize the MQTT publisher (connects from loop() when enabled)
+	initializeMQTT();
+
+	// Initialize InfluxDB line protocol output (when enabled)
+	initializeInflux();
+
+	// Initialize the Modbus TCP server (when enabled)
+	initializeModbus();
+
 	REMOTE_LOG_INFO("Bridge ready!");
 	setStatusLEDColor(0, 255, 0); // Green to indicate ready
 }
 
 void loop() {
+	unsigned long loopStart = micros();
+
 	// Maintain Ethernet connection
 	Ethernet.maintain();
 
@@ -88,9 +119,28 @@ void loop() {
 		// Clean up disconnected log clients
 		cleanupLogClients();
 
+		// Handle new Modbus TCP connections
+		handleNewModbusConnections();
+
 		// Handle HTTP info server requests (includes OTA endpoints)
 		handleHTTPInfoConnections();
 	}
+
+	// Advance open HTTP connections: read, respond, drain
+	handleHTTPInfoClients();
+
+	// Answer Modbus register reads (PLCs poll every 100 ms)
+	handleModbusClients();
+
+	// Push telegram events to /p1/stream subscribers
+	handleP1EventStreams();
+
+	// Push telegrams, readings and log lines to /ws clients
+	handleWebSocketClients();
+
+	// Continue history/capture downloads, one chunk per pass
+	handleHistoryStream();
+	handleCaptureDownload();
 	
 	// Handle NTP time updates
 	handleNTPUpdate();
@@ -98,6 +148,23 @@ void loop() {
 	// Always read P1 data from serial (high priority)
 	readP1Data();
 
+	// Feed a capture replay into the framer when one is running
+	handleP1Replay();
+
+	// Publish changed values to the MQTT broker
+	handleMQTT();
+
+	// Send collected InfluxDB points when a buffer is due
+	handleInflux();
+
+	// Periodic heap/stack sample
+	handleHeapTelemetry();
+
+	// Counter rates
+	handleStats();
+
+	recordLoopTime(micros() - loopStart);
+
 	// Small delay to prevent overwhelming the system
 	delay(1);
 }
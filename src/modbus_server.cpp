@@ -0,0 +1,215 @@
+#include "modbus_server.h"
+#include "p1_handler.h"
+#include "p1_values.h"
+#include "custom_log.h"
+#include "stats.h"
+#include <Ethernet.h>
+
+#define MODBUS_MBAP_SIZE        7       // transaction id, protocol id, length, unit id
+#define MODBUS_ADU_MAX          260     // MBAP and the largest PDU
+#define MODBUS_MAX_READ         125     // registers in one FC 3/4 response
+#define MODBUS_LAYOUT_VERSION   1
+#define MODBUS_NOT_AVAILABLE    0x80000000UL
+
+#define MODBUS_READ_HOLDING     0x03
+#define MODBUS_READ_INPUT       0x04
+#define MODBUS_ILLEGAL_FUNCTION 0x01
+#define MODBUS_ILLEGAL_ADDRESS  0x02
+#define MODBUS_ILLEGAL_VALUE    0x03
+
+struct ModbusConnection {
+	EthernetClient client;
+	bool connected;
+	unsigned long lastActivity;
+	uint8_t request[MODBUS_ADU_MAX];
+	uint16_t length;                    // bytes of the request received
+};
+
+static EthernetServer modbusServer(MODBUS_PORT);
+static ModbusConnection modbusConnections[MAX_MODBUS_CONNECTIONS];
+
+// The registers in wire order, so a read is one memcpy
+static uint8_t registerImage[MODBUS_REGISTER_COUNT * 2];
+static uint8_t response[MODBUS_MBAP_SIZE + 2 + MODBUS_MAX_READ * 2];
+static unsigned long readingTime = 0;
+static uint32_t readingCount = 0;
+
+static void putRegister(uint16_t reg, uint16_t value) {
+	registerImage[reg * 2] = value >> 8;
+	registerImage[reg * 2 + 1] = value & 0xFF;
+}
+
+static void putRegisterPair(uint16_t reg, uint32_t value) {
+	putRegister(reg, value >> 16);
+	putRegister(reg + 1, value & 0xFFFF);
+}
+
+static void updateRegisters(const String& telegram, const P1Reading* reading) {
+	if (!reading) return;
+	uint32_t present = 0;
+	for (uint8_t v = 0; v < P1_VALUE_COUNT; v++) {
+		long value;
+		if (readP1Value(*reading, v, value)) {
+			present |= 1UL << v;
+			putRegisterPair(MODBUS_VALUE_BASE + 2 * v, (uint32_t)value);
+		} else {
+			putRegisterPair(MODBUS_VALUE_BASE + 2 * v, MODBUS_NOT_AVAILABLE);
+		}
+	}
+	readingCount++;
+	readingTime = millis();
+	putRegisterPair(2, readingCount);
+	putRegisterPair(4, present);
+}
+
+static void closeConnection(ModbusConnection& connection) {
+	connection.client.stop();
+	connection.connected = false;
+}
+
+// Answer the complete request in the connection's buffer
+static void serveRequest(ModbusConnection& connection) {
+	const uint8_t* request = connection.request;
+	uint16_t pduLength = connection.length - MODBUS_MBAP_SIZE;
+	uint8_t function = request[MODBUS_MBAP_SIZE];
+	uint16_t start = 0;
+	uint16_t count = 0;
+
+	// Checked in the order of the specification: function, quantity, address
+	uint8_t exception = 0;
+	if (function != MODBUS_READ_HOLDING && function != MODBUS_READ_INPUT) {
+		exception = MODBUS_ILLEGAL_FUNCTION;
+	} else if (pduLength != 5) {
+		exception = MODBUS_ILLEGAL_VALUE;
+	} else {
+		start = (request[8] << 8) | request[9];
+		count = (request[10] << 8) | request[11];
+		if (count < 1 || count > MODBUS_MAX_READ) {
+			exception = MODBUS_ILLEGAL_VALUE;
+		} else if ((uint32_t)start + count > MODBUS_REGISTER_COUNT) {
+			exception = MODBUS_ILLEGAL_ADDRESS;
+		}
+	}
+
+	// Transaction id, protocol id and unit id are echoed
+	memcpy(response, request, 4);
+	response[6] = request[6];
+	uint16_t pduSize;
+	if (exception != 0) {
+		response[7] = function | 0x80;
+		response[8] = exception;
+		pduSize = 2;
+		addStat(STAT_MODBUS_EXCEPTIONS);
+	} else {
+		unsigned long age = readingCount > 0 ? (millis() - readingTime) / 1000 : 0xFFFF;
+		putRegister(1, min(age, 0xFFFFUL));
+		response[7] = function;
+		response[8] = count * 2;
+		memcpy(response + 9, registerImage + start * 2, count * 2);
+		pduSize = 2 + count * 2;
+	}
+	response[4] = (pduSize + 1) >> 8;
+	response[5] = (pduSize + 1) & 0xFF;
+	connection.client.write(response, MODBUS_MBAP_SIZE + pduSize);
+	addStat(STAT_MODBUS_REQUESTS);
+}
+
+// Read at most one request; true when it is complete. A header outside the
+// protocol means the framing is lost, and the connection is closed.
+static bool receiveRequest(ModbusConnection& connection) {
+	while (true) {
+		uint16_t needed = MODBUS_MBAP_SIZE;
+		if (connection.length >= MODBUS_MBAP_SIZE) {
+			const uint8_t* header = connection.request;
+			uint16_t length = (header[4] << 8) | header[5];
+			if (header[2] != 0 || header[3] != 0 || length < 2 || length > MODBUS_ADU_MAX - 6) {
+				REMOTE_LOG_DEBUG("Modbus framing error, closing client");
+				closeConnection(connection);
+				return false;
+			}
+			needed = 6 + length;
+			if (connection.length >= needed) return true;
+		}
+		int available = connection.client.available();
+		if (available <= 0) return false;
+		int got = connection.client.read(connection.request + connection.length, min(available, (int)(needed - connection.length)));
+		if (got <= 0) return false;
+		connection.length += got;
+		connection.lastActivity = millis();
+	}
+}
+
+void initializeModbus() {
+	if (!MODBUS_ENABLED) return;
+	for (int i = 0; i < MAX_MODBUS_CONNECTIONS; i++) {
+		modbusConnections[i].connected = false;
+	}
+	putRegister(0, MODBUS_LAYOUT_VERSION);
+	putRegister(1, 0xFFFF);
+	for (uint16_t reg = 2; reg < MODBUS_VALUE_BASE; reg++) putRegister(reg, 0);
+	for (uint8_t v = 0; v < P1_VALUE_COUNT; v++) putRegisterPair(MODBUS_VALUE_BASE + 2 * v, MODBUS_NOT_AVAILABLE);
+	addP1TelegramCallback(updateRegisters, true);
+	modbusServer.begin();
+	REMOTE_LOG_INFO("Modbus TCP server listening on port:", MODBUS_PORT);
+}
+
+void handleNewModbusConnections() {
+	if (!MODBUS_ENABLED) return;
+	EthernetClient newClient = modbusServer.accept();
+	if (!newClient) return;
+
+	// A PLC that reconnects finds its old connection still open: the oldest
+	// one makes room
+	int slot = 0;
+	for (int i = 0; i < MAX_MODBUS_CONNECTIONS; i++) {
+		if (!modbusConnections[i].connected) {
+			slot = i;
+			break;
+		}
+		if (modbusConnections[i].lastActivity < modbusConnections[slot].lastActivity) slot = i;
+	}
+	ModbusConnection& connection = modbusConnections[slot];
+	if (connection.connected) {
+		REMOTE_LOG_DEBUG("Modbus connections full, closing oldest in slot:", slot);
+		closeConnection(connection);
+	}
+	connection.client = newClient;
+	connection.connected = true;
+	connection.lastActivity = millis();
+	connection.length = 0;
+	REMOTE_LOG_DEBUG("Modbus client connected:", newClient.remoteIP());
+}
+
+void handleModbusClients() {
+	if (!MODBUS_ENABLED) return;
+	for (int i = 0; i < MAX_MODBUS_CONNECTIONS; i++) {
+		ModbusConnection& connection = modbusConnections[i];
+		if (!connection.connected) continue;
+
+		// A request is only taken while its response fits the socket, so a
+		// client that stops reading is never written to partially
+		for (int n = 0; n < MODBUS_REQUESTS_PER_PASS && connection.connected; n++) {
+			if (connection.client.availableForWrite() < (int)sizeof(response)) break;
+			if (!receiveRequest(connection)) break;
+			serveRequest(connection);
+			connection.length = 0;
+		}
+		if (!connection.connected) continue;
+
+		if (!connection.client.connected() && connection.client.available() <= 0) {
+			REMOTE_LOG_DEBUG("Modbus client disconnected from slot:", i);
+			closeConnection(connection);
+		} else if (millis() - connection.lastActivity > MODBUS_CLIENT_TIMEOUT) {
+			REMOTE_LOG_DEBUG("Modbus client timeout on slot:", i);
+			closeConnection(connection);
+		}
+	}
+}
+
+int getConnectedModbusClientCount() {
+	int count = 0;
+	for (int i = 0; i < MAX_MODBUS_CONNECTIONS; i++) {
+		if (modbusConnections[i].connected) count++;
+	}
+	return count;
+}
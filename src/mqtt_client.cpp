@@ -0,0 +1,376 @@
+#include "mqtt_client.h"
+#include "p1_handler.h"
+#include "p1_values.h"
+#include "custom_log.h"
+#include "string_builder.h"
+#include "varint.h"
+#include "stats.h"
+#include <Ethernet.h>
+
+#define MQTT_PACKET_CONNECT     0x10
+#define MQTT_PACKET_CONNACK     0x20
+#define MQTT_PACKET_PUBLISH     0x30
+#define MQTT_PACKET_PINGREQ     0xC0
+#define MQTT_PACKET_PINGRESP    0xD0
+
+#define MQTT_PUBLISH_RETAIN     0x01
+
+#define MQTT_CONNECT_CLEAN_SESSION  0x02
+#define MQTT_CONNECT_WILL           0x04
+#define MQTT_CONNECT_WILL_RETAIN    0x20
+#define MQTT_CONNECT_PASSWORD       0x40
+#define MQTT_CONNECT_USERNAME       0x80
+
+#define MQTT_TOPIC_MAX          64      // prefix, '/' and the longest name
+#define MQTT_PAYLOAD_MAX        16      // longest formatted value
+#define MQTT_RX_CHUNK           16      // bytes read from the socket at a time
+#define MQTT_HEADER_ROOM        5       // fixed header: type and up to 4 length bytes
+
+enum MQTTState {
+	MQTT_DISCONNECTED,      // waiting for the next connect attempt
+	MQTT_CONNECTING,        // CONNECT sent, waiting for CONNACK
+	MQTT_CONNECTED
+};
+
+enum MQTTReceiveState {
+	MQTT_RX_TYPE,
+	MQTT_RX_LENGTH,         // remaining length, 7 bits per byte
+	MQTT_RX_BODY
+};
+
+static_assert(P1_VALUE_COUNT <= 32, "published topics are tracked in a 32-bit mask");
+
+static EthernetClient mqttClient;
+static MQTTState mqttState = MQTT_DISCONNECTED;
+static unsigned long mqttStateSince = 0;        // millis() of the last state change
+static unsigned long retryDelay = 0;            // before the next connect attempt
+static unsigned long mqttBackoff = MQTT_BACKOFF_MIN;    // retryDelay after the next failure
+
+// Change tracking, per session: a topic is published again when its value
+// differs from the one in publishedValues
+static uint32_t publishedMask = 0;
+static long publishedValues[P1_VALUE_COUNT];
+static bool readingPending = false;
+static unsigned long batchWaitingSince = 0;     // a batch did not fit the socket since then, 0 if none
+
+// Outgoing packets, CONNECT or a batch of PUBLISH packets
+static uint8_t mqttBatch[MQTT_BATCH_SIZE];
+
+static unsigned long lastSent = 0;
+static bool pingOutstanding = false;
+static unsigned long pingSent = 0;
+
+static MQTTReceiveState rxState = MQTT_RX_TYPE;
+static uint8_t rxType;
+static uint32_t rxLength;
+static uint8_t rxShift;
+static uint32_t rxHave;
+static uint8_t rxBody[2];       // enough for CONNACK; longer bodies are skipped
+
+static void setMQTTState(MQTTState state) {
+	mqttState = state;
+	mqttStateSince = millis();
+}
+
+// Two-byte length followed by the bytes
+static size_t writeMQTTString(uint8_t* p, const char* text, size_t length) {
+	p[0] = (uint8_t)(length >> 8);
+	p[1] = (uint8_t)length;
+	memcpy(p + 2, text, length);
+	return 2 + length;
+}
+
+// A PUBLISH (QoS 0, retained) at p; returns its size, 0 when it does not fit
+static size_t buildPublish(uint8_t* p, size_t room, const char* topic, size_t topicLength, const char* payload, size_t payloadLength) {
+	uint32_t remaining = 2 + topicLength + payloadLength;
+	uint8_t lengthBytes[VARINT_MAX_SIZE];
+	uint8_t lengthSize = writeVarint(lengthBytes, remaining);   // MQTT's remaining length is LEB128
+	size_t total = 1 + lengthSize + remaining;
+	if (total > room) return 0;
+	*p++ = MQTT_PACKET_PUBLISH | MQTT_PUBLISH_RETAIN;
+	memcpy(p, lengthBytes, lengthSize);
+	p += lengthSize;
+	p += writeMQTTString(p, topic, topicLength);
+	memcpy(p, payload, payloadLength);
+	return total;
+}
+
+static size_t buildTopic(char* topic, const char* name) {
+	StringBuilder out(topic, MQTT_TOPIC_MAX);
+	out.append(MQTT_TOPIC_PREFIX).append('/').append(name);
+	return out.length();
+}
+
+static void sendMQTT(const uint8_t* data, size_t length) {
+	mqttClient.write(data, length);
+	lastSent = millis();
+	addStat(STAT_MQTT_BYTES_SENT, length);
+}
+
+// Wait MQTT_BACKOFF_MIN after the first failed attempt, twice as long after
+// each further one, up to MQTT_BACKOFF_MAX
+static void connectionFailed(const char* reason) {
+	mqttClient.stop();
+	retryDelay = mqttBackoff;
+	mqttBackoff = min((unsigned long)MQTT_BACKOFF_MAX, mqttBackoff * 2);
+	REMOTE_LOG_WARN("MQTT connect failed:", reason);
+	REMOTE_LOG_DEBUG("MQTT next attempt in ms:", retryDelay);
+	setMQTTState(MQTT_DISCONNECTED);
+}
+
+static void dropConnection(const char* reason) {
+	mqttClient.stop();
+	retryDelay = MQTT_BACKOFF_MIN;
+	REMOTE_LOG_WARN("MQTT disconnected:", reason);
+	setMQTTState(MQTT_DISCONNECTED);
+}
+
+static void startConnection() {
+	mqttClient.setConnectionTimeout(MQTT_CONNECT_TIMEOUT);
+	if (mqttClient.connect(MQTT_BROKER, MQTT_PORT) != 1) {
+		connectionFailed("no TCP connection to " MQTT_BROKER);
+		return;
+	}
+
+	// CONNECT: clean session, "offline" as the retained will on the status topic.
+	// The body goes after room for the fixed header, which is put in front once
+	// the body length is known.
+	char willTopic[MQTT_TOPIC_MAX];
+	size_t willTopicLength = buildTopic(willTopic, "status");
+	uint8_t flags = MQTT_CONNECT_CLEAN_SESSION | MQTT_CONNECT_WILL | MQTT_CONNECT_WILL_RETAIN;
+	if (strlen(MQTT_USERNAME) > 0) flags |= MQTT_CONNECT_USERNAME;
+	if (strlen(MQTT_PASSWORD) > 0) flags |= MQTT_CONNECT_PASSWORD;
+
+	uint8_t* body = mqttBatch + MQTT_HEADER_ROOM;
+	uint8_t* p = body;
+	p += writeMQTTString(p, "MQTT", 4);
+	*p++ = 4;                               // protocol level 3.1.1
+	*p++ = flags;
+	*p++ = (uint8_t)(MQTT_KEEPALIVE >> 8);
+	*p++ = (uint8_t)MQTT_KEEPALIVE;
+	p += writeMQTTString(p, MQTT_CLIENT_ID, strlen(MQTT_CLIENT_ID));
+	p += writeMQTTString(p, willTopic, willTopicLength);
+	p += writeMQTTString(p, "offline", 7);
+	if (flags & MQTT_CONNECT_USERNAME) p += writeMQTTString(p, MQTT_USERNAME, strlen(MQTT_USERNAME));
+	if (flags & MQTT_CONNECT_PASSWORD) p += writeMQTTString(p, MQTT_PASSWORD, strlen(MQTT_PASSWORD));
+
+	uint8_t header[MQTT_HEADER_ROOM];
+	header[0] = MQTT_PACKET_CONNECT;
+	size_t headerLength = 1 + writeVarint(header + 1, p - body);
+	uint8_t* packet = body - headerLength;
+	memcpy(packet, header, headerLength);
+
+	rxState = MQTT_RX_TYPE;
+	pingOutstanding = false;
+	sendMQTT(packet, p - packet);
+	setMQTTState(MQTT_CONNECTING);
+}
+
+static void sessionStarted() {
+	setMQTTState(MQTT_CONNECTED);
+	mqttBackoff = MQTT_BACKOFF_MIN;
+	addStat(STAT_MQTT_CONNECTS);
+	REMOTE_LOG_INFO("MQTT connected to broker:", MQTT_BROKER);
+
+	// The broker may have forgotten retained values (or this is a new one):
+	// publish everything again with the next batch
+	publishedMask = 0;
+	batchWaitingSince = 0;
+	readingPending = latestP1Reading.fields != 0;
+
+	char topic[MQTT_TOPIC_MAX];
+	size_t topicLength = buildTopic(topic, "status");
+	size_t length = buildPublish(mqttBatch, sizeof(mqttBatch), topic, topicLength, "online", 6);
+	sendMQTT(mqttBatch, length);
+	addStat(STAT_MQTT_PUBLISHES);
+	addStat(STAT_MQTT_WRITES);
+}
+
+static void packetReceived() {
+	switch (rxType & 0xF0) {
+		case MQTT_PACKET_CONNACK:
+			if (mqttState != MQTT_CONNECTING || rxLength != 2) {
+				dropConnection("unexpected CONNACK");
+			} else if (rxBody[1] != 0) {
+				// 1 protocol, 2 client id, 3 unavailable, 4 credentials, 5 not authorized
+				REMOTE_LOG_ERROR("MQTT broker refused the connection, code:", rxBody[1]);
+				connectionFailed("refused");
+			} else {
+				sessionStarted();
+			}
+			break;
+		case MQTT_PACKET_PINGRESP:
+			pingOutstanding = false;
+			break;
+		default:
+			// Nothing is subscribed, so nothing else is expected; ignored
+			break;
+	}
+}
+
+static void receiveMQTT() {
+	uint8_t chunk[MQTT_RX_CHUNK];
+	while (mqttState != MQTT_DISCONNECTED && mqttClient.available() > 0) {
+		int count = mqttClient.read(chunk, sizeof(chunk));
+		if (count <= 0) return;
+		for (int i = 0; i < count && mqttState != MQTT_DISCONNECTED; i++) {
+			uint8_t c = chunk[i];
+			switch (rxState) {
+				case MQTT_RX_TYPE:
+					rxType = c;
+					rxLength = 0;
+					rxShift = 0;
+					rxState = MQTT_RX_LENGTH;
+					break;
+				case MQTT_RX_LENGTH:
+					rxLength |= (uint32_t)(c & 0x7F) << rxShift;
+					rxShift += 7;
+					if (c & 0x80) {
+						if (rxShift >= 28) dropConnection("bad packet length");
+						break;
+					}
+					rxHave = 0;
+					rxState = MQTT_RX_BODY;
+					if (rxLength == 0) {
+						rxState = MQTT_RX_TYPE;
+						packetReceived();
+					}
+					break;
+				case MQTT_RX_BODY:
+					if (rxHave < sizeof(rxBody)) rxBody[rxHave] = c;
+					if (++rxHave == rxLength) {
+						rxState = MQTT_RX_TYPE;
+						packetReceived();
+					}
+					break;
+			}
+		}
+	}
+}
+
+static bool isTopicDue(uint8_t t, const P1Reading& reading, long& value) {
+	if (!readP1Value(reading, t, value)) return false;
+	return !(publishedMask & (1UL << t)) || publishedValues[t] != value;
+}
+
+// Write the changed topics of the latest reading, a batch per socket write,
+// as long as the socket has room for them
+static void publishChanges() {
+	const P1Reading& reading = latestP1Reading;
+	while (readingPending) {
+		size_t length = 0;
+		uint32_t batched = 0;
+		long batchedValues[P1_VALUE_COUNT];
+		bool complete = true;
+
+		for (uint8_t t = 0; t < P1_VALUE_COUNT; t++) {
+			long value;
+			if (!isTopicDue(t, reading, value)) continue;
+
+			char topic[MQTT_TOPIC_MAX];
+			size_t topicLength = buildTopic(topic, getP1ValueName(t));
+			FixedString<MQTT_PAYLOAD_MAX> payload;
+			payload.appendFixedPoint(value, getP1ValueDecimals(t));
+
+			size_t size = buildPublish(mqttBatch + length, sizeof(mqttBatch) - length, topic, topicLength, payload.c_str(), payload.length());
+			if (size == 0) {
+				complete = false;   // the rest goes in the next batch
+				break;
+			}
+			length += size;
+			batched |= 1UL << t;
+			batchedValues[t] = value;
+		}
+
+		if (length == 0) {
+			readingPending = false;
+			break;
+		}
+
+		// QoS 0 needs no bookkeeping once written, but a full socket must not
+		// block the loop: wait for room, reconnect if it never comes
+		if ((size_t)mqttClient.availableForWrite() < length) {
+			if (batchWaitingSince == 0) {
+				batchWaitingSince = millis();
+			} else if (millis() - batchWaitingSince > MQTT_STALL_TIMEOUT) {
+				dropConnection("broker is not reading");
+			}
+			return;
+		}
+		batchWaitingSince = 0;
+
+		sendMQTT(mqttBatch, length);
+		addStat(STAT_MQTT_WRITES);
+		for (uint8_t t = 0; t < P1_VALUE_COUNT; t++) {
+			if (!(batched & (1UL << t))) continue;
+			publishedValues[t] = batchedValues[t];
+			addStat(STAT_MQTT_PUBLISHES);
+		}
+		publishedMask |= batched;
+		if (complete) readingPending = false;
+	}
+}
+
+// Ping when nothing was sent for half the keepalive; drop the connection
+// when the answer does not come within the other half
+static void keepAlive() {
+	unsigned long now = millis();
+	if (pingOutstanding) {
+		if (now - pingSent > MQTT_KEEPALIVE * 1000UL / 2) dropConnection("no PINGRESP");
+		return;
+	}
+	if (now - lastSent < MQTT_KEEPALIVE * 1000UL / 2 || mqttClient.availableForWrite() < 2) return;
+	const uint8_t ping[2] = {MQTT_PACKET_PINGREQ, 0};
+	sendMQTT(ping, sizeof(ping));
+	pingOutstanding = true;
+	pingSent = now;
+}
+
+static void queueReading(const String& telegram, const P1Reading* reading) {
+	// Published from handleMQTT(); a reading that arrives before the previous
+	// one is out replaces it, so only the newest values are sent
+	if (reading) readingPending = true;
+}
+
+void initializeMQTT() {
+	if (!MQTT_ENABLED) return;
+	addP1TelegramCallback(queueReading, true);
+	REMOTE_LOG_INFO("MQTT publisher for broker:", MQTT_BROKER ":" + String(MQTT_PORT));
+}
+
+void handleMQTT() {
+	if (!MQTT_ENABLED) return;
+
+	switch (mqttState) {
+		case MQTT_DISCONNECTED:
+			if (millis() - mqttStateSince >= retryDelay) {
+				startConnection();
+			}
+			break;
+		case MQTT_CONNECTING:
+			if (!mqttClient.connected()) {
+				connectionFailed("closed by the broker");
+				break;
+			}
+			receiveMQTT();
+			if (mqttState == MQTT_CONNECTING && millis() - mqttStateSince > MQTT_CONNACK_TIMEOUT) {
+				connectionFailed("no CONNACK");
+			}
+			break;
+		case MQTT_CONNECTED:
+			if (!mqttClient.connected()) {
+				dropConnection("closed by the broker");
+				break;
+			}
+			receiveMQTT();
+			if (mqttState != MQTT_CONNECTED) break;
+			publishChanges();
+			if (mqttState != MQTT_CONNECTED) break;
+			keepAlive();
+			break;
+	}
+}
+
+bool isMQTTConnected() {
+	return mqttState == MQTT_CONNECTED;
+}
@@ -1,8 +1,10 @@
 #include "ntp_client.h"
 #include "custom_log.h"
+#include "string_builder.h"
+#include "heap_telemetry.h"
 
 // Global NTP variables (no permanent UDP socket)
-NTPTime ntpTime = {0, 0, false};
+NTPTime ntpTime = {0, 0, 0, false};
 unsigned long lastNTPUpdate = 0;
 
 void initializeNTP() {
@@ -20,6 +22,7 @@ void initializeNTP() {
 }
 
 bool updateNTPTime() {
+    HEAP_TAG_SCOPE(HEAP_TAG_NTP);
     if (!NTP_ENABLED) return false;
     
     // Create temporary UDP socket for this NTP request
@@ -49,7 +52,7 @@ bool updateNTPTime() {
     IPAddress ntpServerIP;
     // Use Google's public NTP server IP (time.google.com)
     ntpServerIP = IPAddress(216, 239, 35, 0);
-    REMOTE_LOG_DEBUG(("Using NTP server: " + ntpServerIP.toString()).c_str());
+    REMOTE_LOG_DEBUG("Using NTP server:", ntpServerIP);
     
     tempNtpUdp.beginPacket(ntpServerIP, 123); // NTP requests are to port 123
     tempNtpUdp.write(packetBuffer, NTP_PACKET_SIZE);
@@ -68,15 +71,19 @@ bool updateNTPTime() {
             unsigned long highWord = word(packetBuffer[40], packetBuffer[41]);
             unsigned long lowWord = word(packetBuffer[42], packetBuffer[43]);
             unsigned long secsSince1900 = highWord << 16 | lowWord;
+            // and the fraction of that second, in 1/2^32 s
+            uint32_t fraction = (uint32_t)packetBuffer[44] << 24 | (uint32_t)packetBuffer[45] << 16 | (uint32_t)packetBuffer[46] << 8 | packetBuffer[47];
             
             // Convert to Unix timestamp
             ntpTime.epoch = secsSince1900 - SEVENTY_YEARS;
+            ntpTime.fractionMs = (uint16_t)(((uint64_t)fraction * 1000) >> 32);
             ntpTime.lastUpdate = millis();
             ntpTime.valid = true;
             lastNTPUpdate = millis();
             
-            String timeStr = getFormattedDateTime(ntpTime.epoch);
-            REMOTE_LOG_INFO(("NTP time updated: " + timeStr).c_str());
+            FixedString<NTP_TIME_STRING_SIZE> timeStr;
+            printFormattedDateTime(timeStr, ntpTime.epoch);
+            REMOTE_LOG_INFO("NTP time updated:", timeStr.c_str());
             
             success = true;
             break;
@@ -104,13 +111,30 @@ unsigned long getCurrentEpoch() {
     return ntpTime.epoch + elapsed;
 }
 
-String getFormattedTime(unsigned long epoch) {
+uint64_t getEpochMillis(unsigned long at) {
+    if (!ntpTime.valid) {
+        return 0;
+    }
+
+    // at may be a little before the last update
+    long elapsed = (long)(at - ntpTime.lastUpdate);
+    return (uint64_t)((int64_t)ntpTime.epoch * 1000 + ntpTime.fractionMs + elapsed);
+}
+
+// Two-digit field with a leading zero
+static void printTwoDigits(Print& out, unsigned long value) {
+    if (value < 10) out.print('0');
+    out.print(value);
+}
+
+void printFormattedTime(Print& out, unsigned long epoch) {
     if (epoch == 0) {
         epoch = getCurrentEpoch();
     }
     
     if (epoch == 0) {
-        return "00:00:00";
+        out.print("00:00:00");
+        return;
     }
     
     // Apply timezone offset
@@ -120,24 +144,21 @@ String getFormattedTime(unsigned long epoch) {
     unsigned long minutes = (epoch % 3600) / 60;
     unsigned long seconds = epoch % 60;
     
-    String timeStr = "";
-    if (hours < 10) timeStr += "0";
-    timeStr += String(hours) + ":";
-    if (minutes < 10) timeStr += "0";
-    timeStr += String(minutes) + ":";
-    if (seconds < 10) timeStr += "0";
-    timeStr += String(seconds);
-    
-    return timeStr;
+    printTwoDigits(out, hours);
+    out.print(':');
+    printTwoDigits(out, minutes);
+    out.print(':');
+    printTwoDigits(out, seconds);
 }
 
-String getFormattedDateTime(unsigned long epoch) {
+void printFormattedDateTime(Print& out, unsigned long epoch) {
     if (epoch == 0) {
         epoch = getCurrentEpoch();
     }
     
     if (epoch == 0) {
-        return "0000-00-00 00:00:00";
+        out.print("0000-00-00 00:00:00");
+        return;
     }
     
     // Apply timezone offset
@@ -183,19 +204,29 @@ String getFormattedDateTime(unsigned long epoch) {
     unsigned long seconds = timeOfDay % 60;
     
     // Format as YYYY-MM-DD HH:MM:SS
-    String dateTime = String(years) + "-";
-    if (month < 10) dateTime += "0";
-    dateTime += String(month) + "-";
-    if (day < 10) dateTime += "0";
-    dateTime += String(day) + " ";
-    if (hours < 10) dateTime += "0";
-    dateTime += String(hours) + ":";
-    if (minutes < 10) dateTime += "0";
-    dateTime += String(minutes) + ":";
-    if (seconds < 10) dateTime += "0";
-    dateTime += String(seconds);
-    
-    return dateTime;
+    out.print(years);
+    out.print('-');
+    printTwoDigits(out, month);
+    out.print('-');
+    printTwoDigits(out, day);
+    out.print(' ');
+    printTwoDigits(out, hours);
+    out.print(':');
+    printTwoDigits(out, minutes);
+    out.print(':');
+    printTwoDigits(out, seconds);
+}
+
+String getFormattedTime(unsigned long epoch) {
+    FixedString<NTP_TIME_STRING_SIZE> timeStr;
+    printFormattedTime(timeStr, epoch);
+    return String(timeStr.c_str());
+}
+
+String getFormattedDateTime(unsigned long epoch) {
+    FixedString<NTP_TIME_STRING_SIZE> dateTime;
+    printFormattedDateTime(dateTime, epoch);
+    return String(dateTime.c_str());
 }
 
 bool isNTPTimeValid() {
@@ -203,6 +234,7 @@ bool isNTPTimeValid() {
 }
 
 void handleNTPUpdate() {
+    HEAP_TAG_SCOPE(HEAP_TAG_NTP);
     if (!NTP_ENABLED) return;
     
     // Update time every NTP_UPDATE_INTERVAL
@@ -0,0 +1,269 @@
+#include "p1_aggregator.h"
+#include "custom_log.h"
+
+// Fixed-size ring of closed buckets per resolution
+struct AggRing {
+	AggBucket* slots;
+	uint16_t capacity;
+	uint16_t head;      // next slot to write
+	uint16_t count;
+	uint32_t period;    // seconds
+};
+
+// Bucket being filled, plus the running sums needed for the average
+struct AggOpenBucket {
+	AggBucket bucket;
+	int64_t sums[AGG_CHANNEL_COUNT];
+	bool active;
+};
+
+static AggBucket minuteSlots[AGG_MINUTE_SLOTS];
+static AggBucket quarterHourSlots[AGG_QUARTER_HOUR_SLOTS];
+static AggBucket hourSlots[AGG_HOUR_SLOTS];
+
+static AggRing aggRings[AGG_RESOLUTION_COUNT] = {
+	{minuteSlots, AGG_MINUTE_SLOTS, 0, 0, 60},
+	{quarterHourSlots, AGG_QUARTER_HOUR_SLOTS, 0, 0, 15 * 60},
+	{hourSlots, AGG_HOUR_SLOTS, 0, 0, 60 * 60},
+};
+
+static AggOpenBucket aggOpen[AGG_RESOLUTION_COUNT];
+
+// Previous register values, used to turn absolute registers into deltas
+static uint32_t previousCounters[AGG_COUNTER_COUNT];
+static uint8_t previousCounterMask = 0;
+
+static AggBucketClosedCallback closedCallback = nullptr;
+
+static const char* const resolutionNames[AGG_RESOLUTION_COUNT] = {"minute", "quarter_hour", "hour"};
+
+static const char* const channelNames[AGG_CHANNEL_COUNT] = {
+	"power_delivered", "power_returned",
+	"voltage_l1", "voltage_l2", "voltage_l3",
+	"current_l1", "current_l2", "current_l3",
+	"power_l1", "power_l2", "power_l3"
+};
+
+static const char* const counterNames[AGG_COUNTER_COUNT] = {
+	"energy_delivered_t1", "energy_delivered_t2",
+	"energy_returned_t1", "energy_returned_t2",
+	"gas", "water"
+};
+
+void initializeAggregator() {
+	for (int r = 0; r < AGG_RESOLUTION_COUNT; r++) {
+		aggRings[r].head = 0;
+		aggRings[r].count = 0;
+		aggOpen[r].active = false;
+	}
+	previousCounterMask = 0;
+
+	REMOTE_LOG_INFO("Aggregator initialized, buckets (min/15min/hour):", AGG_MINUTE_SLOTS, "/", AGG_QUARTER_HOUR_SLOTS, "/", AGG_HOUR_SLOTS);
+}
+
+static bool readChannel(const P1Reading& reading, int channel, int32_t& value) {
+	switch (channel) {
+		case AGG_POWER_DELIVERED:
+			value = reading.powerDeliveredW;
+			return reading.fields & P1_FIELD_POWER_DELIVERED;
+		case AGG_POWER_RETURNED:
+			value = reading.powerReturnedW;
+			return reading.fields & P1_FIELD_POWER_RETURNED;
+		case AGG_VOLTAGE_L1:
+		case AGG_VOLTAGE_L2:
+		case AGG_VOLTAGE_L3: {
+			int phase = channel - AGG_VOLTAGE_L1;
+			value = reading.voltageDv[phase];
+			return reading.fields & (P1_FIELD_VOLTAGE_L1 << phase);
+		}
+		case AGG_CURRENT_L1:
+		case AGG_CURRENT_L2:
+		case AGG_CURRENT_L3: {
+			int phase = channel - AGG_CURRENT_L1;
+			value = reading.currentMa[phase];
+			return reading.fields & (P1_FIELD_CURRENT_L1 << phase);
+		}
+		case AGG_POWER_L1:
+		case AGG_POWER_L2:
+		case AGG_POWER_L3: {
+			int phase = channel - AGG_POWER_L1;
+			value = reading.phasePowerDeliveredW[phase] - reading.phasePowerReturnedW[phase];
+			return reading.fields & ((P1_FIELD_POWER_DELIVERED_L1 | P1_FIELD_POWER_RETURNED_L1) << phase);
+		}
+	}
+	return false;
+}
+
+void setAggregateClosedCallback(AggBucketClosedCallback callback) {
+	closedCallback = callback;
+}
+
+bool readAggregateCounter(const P1Reading& reading, AggCounterId counter, uint32_t& value) {
+	switch (counter) {
+		case AGG_ENERGY_DELIVERED_T1:
+			value = reading.energyDeliveredWh[0];
+			return reading.fields & P1_FIELD_ENERGY_DELIVERED_T1;
+		case AGG_ENERGY_DELIVERED_T2:
+			value = reading.energyDeliveredWh[1];
+			return reading.fields & P1_FIELD_ENERGY_DELIVERED_T2;
+		case AGG_ENERGY_RETURNED_T1:
+			value = reading.energyReturnedWh[0];
+			return reading.fields & P1_FIELD_ENERGY_RETURNED_T1;
+		case AGG_ENERGY_RETURNED_T2:
+			value = reading.energyReturnedWh[1];
+			return reading.fields & P1_FIELD_ENERGY_RETURNED_T2;
+		case AGG_GAS:
+			value = reading.gasDm3;
+			return reading.fields & P1_FIELD_GAS;
+		case AGG_WATER:
+			value = reading.waterDm3;
+			return reading.fields & P1_FIELD_WATER;
+		default:
+			break;
+	}
+	return false;
+}
+
+static void finalizeAverages(const AggOpenBucket& open, AggBucket& bucket) {
+	for (int c = 0; c < AGG_CHANNEL_COUNT; c++) {
+		if (open.bucket.channelMask & (1 << c)) {
+			bucket.channels[c].avg = (int32_t)(open.sums[c] / open.bucket.samples);
+		}
+	}
+}
+
+static void closeBucket(int resolution) {
+	AggRing& ring = aggRings[resolution];
+	AggOpenBucket& open = aggOpen[resolution];
+
+	AggBucket& slot = ring.slots[ring.head];
+	slot = open.bucket;
+	finalizeAverages(open, slot);
+
+	ring.head = (ring.head + 1) % ring.capacity;
+	if (ring.count < ring.capacity) ring.count++;
+	open.active = false;
+
+	if (closedCallback) {
+		closedCallback((AggResolution)resolution, slot);
+	}
+}
+
+static void openBucket(int resolution, uint32_t start, bool timeSynced) {
+	AggOpenBucket& open = aggOpen[resolution];
+	memset(&open.bucket, 0, sizeof(open.bucket));
+	memset(open.sums, 0, sizeof(open.sums));
+	open.bucket.start = start;
+	open.bucket.flags = timeSynced ? AGG_BUCKET_TIME_SYNCED : 0;
+	open.active = true;
+}
+
+void aggregateP1Reading(const P1Reading& reading, uint32_t timestamp, bool timeSynced) {
+	// Values are read once and applied to every resolution: O(1) per telegram
+	int32_t values[AGG_CHANNEL_COUNT];
+	uint16_t valueMask = 0;
+	for (int c = 0; c < AGG_CHANNEL_COUNT; c++) {
+		if (readChannel(reading, c, values[c])) valueMask |= (1 << c);
+	}
+
+	uint32_t counters[AGG_COUNTER_COUNT];
+	uint8_t counterMask = 0;
+	uint32_t deltas[AGG_COUNTER_COUNT];
+	uint8_t deltaMask = 0;
+	for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+		if (!readAggregateCounter(reading, (AggCounterId)c, counters[c])) continue;
+		counterMask |= (1 << c);
+		// A register that went backwards (meter swap) restarts the baseline
+		if ((previousCounterMask & (1 << c)) && counters[c] >= previousCounters[c]) {
+			deltas[c] = counters[c] - previousCounters[c];
+			deltaMask |= (1 << c);
+		}
+	}
+
+	for (int r = 0; r < AGG_RESOLUTION_COUNT; r++) {
+		AggOpenBucket& open = aggOpen[r];
+		uint32_t start = timestamp - (timestamp % aggRings[r].period);
+
+		if (open.active && open.bucket.start != start) {
+			closeBucket(r);
+		}
+		if (!open.active) {
+			openBucket(r, start, timeSynced);
+		}
+
+		AggBucket& bucket = open.bucket;
+		if (bucket.samples < 0xFFFF) bucket.samples++;
+
+		for (int c = 0; c < AGG_CHANNEL_COUNT; c++) {
+			if (!(valueMask & (1 << c))) continue;
+			AggChannel& channel = bucket.channels[c];
+			if (!(bucket.channelMask & (1 << c))) {
+				channel.min = channel.max = values[c];
+				bucket.channelMask |= (1 << c);
+			} else {
+				if (values[c] < channel.min) channel.min = values[c];
+				if (values[c] > channel.max) channel.max = values[c];
+			}
+			channel.last = values[c];
+			open.sums[c] += values[c];
+		}
+
+		for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+			if (!(deltaMask & (1 << c))) continue;
+			bucket.counters[c] += deltas[c];
+			bucket.counterMask |= (1 << c);
+		}
+	}
+
+	// Only now: a bucket closed above ended with the previous telegram, and
+	// its closed callback reads those registers
+	for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+		if (!(counterMask & (1 << c))) continue;
+		previousCounters[c] = counters[c];
+		previousCounterMask |= (1 << c);
+	}
+}
+
+bool getAggregateRegister(AggCounterId counter, uint32_t& value) {
+	if (counter >= AGG_COUNTER_COUNT || !(previousCounterMask & (1 << counter))) return false;
+	value = previousCounters[counter];
+	return true;
+}
+
+uint16_t getAggregateCount(AggResolution resolution) {
+	if (resolution >= AGG_RESOLUTION_COUNT) return 0;
+	return aggRings[resolution].count;
+}
+
+bool getAggregate(AggResolution resolution, uint16_t age, AggBucket& bucket) {
+	if (resolution >= AGG_RESOLUTION_COUNT) return false;
+	const AggRing& ring = aggRings[resolution];
+	if (age >= ring.count) return false;
+
+	uint16_t index = (ring.head + ring.capacity - 1 - age) % ring.capacity;
+	bucket = ring.slots[index];
+	return true;
+}
+
+bool getOpenAggregate(AggResolution resolution, AggBucket& bucket) {
+	if (resolution >= AGG_RESOLUTION_COUNT || !aggOpen[resolution].active) return false;
+	bucket = aggOpen[resolution].bucket;
+	finalizeAverages(aggOpen[resolution], bucket);
+	return true;
+}
+
+uint32_t getAggregatePeriod(AggResolution resolution) {
+	return resolution < AGG_RESOLUTION_COUNT ? aggRings[resolution].period : 0;
+}
+
+const char* getAggregateResolutionName(AggResolution resolution) {
+	return resolution < AGG_RESOLUTION_COUNT ? resolutionNames[resolution] : "unknown";
+}
+
+const char* getAggregateChannelName(AggChannelId channel) {
+	return channel < AGG_CHANNEL_COUNT ? channelNames[channel] : "unknown";
+}
+
+const char* getAggregateCounterName(AggCounterId counter) {
+	return counter < AGG_COUNTER_COUNT ? counterNames[counter] : "unknown";
+}
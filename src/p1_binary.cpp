@@ -0,0 +1,82 @@
+#include "p1_binary.h"
+
+#define P1_BINARY_KEYFRAME  'K'
+#define P1_BINARY_DELTA     'D'
+
+static_assert(P1_BINARY_FRAME_MAX - 2 <= 255, "the frame length is one byte");
+
+// Two digits of the DSMR timestamp; -1 when they are not digits
+static int timestampField(const char* timestamp, int offset) {
+	char tens = timestamp[offset];
+	char ones = timestamp[offset + 1];
+	if (tens < '0' || tens > '9' || ones < '0' || ones > '9') return -1;
+	return (tens - '0') * 10 + (ones - '0');
+}
+
+// YYMMDDhhmmssX as seconds since 2020-01-01 * 2, + 1 for summer time ('S')
+static bool readMeterTime(const P1Reading& reading, int32_t& result) {
+	static const uint16_t daysBeforeMonth[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+	if (!(reading.fields & P1_FIELD_TIMESTAMP)) return false;
+	int field[6];
+	for (int i = 0; i < 6; i++) {
+		field[i] = timestampField(reading.timestamp, i * 2);
+		if (field[i] < 0) return false;
+	}
+	int year = field[0];
+	int month = field[1];
+	if (year < 20 || month < 1 || month > 12) return false;
+	uint32_t days = (year - 20) * 365 + (year - 20 + 3) / 4 + daysBeforeMonth[month - 1] + field[2] - 1;
+	if (month > 2 && year % 4 == 0) days++;
+	uint32_t seconds = ((days * 24 + field[3]) * 60 + field[4]) * 60 + field[5];
+	result = (int32_t)(seconds * 2 + (reading.timestamp[12] == 'S' ? 1 : 0));
+	return true;
+}
+
+static uint8_t* putVarint(uint8_t* out, uint32_t value) {
+	while (value >= 0x80) {
+		*out++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = (uint8_t)value;
+	return out;
+}
+
+static uint32_t zigzag(int32_t value) {
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+void getP1BinaryItems(const P1Reading& reading, P1BinaryItems& items) {
+	items.present = 0;
+	for (uint8_t v = 0; v < P1_VALUE_COUNT; v++) {
+		long value;
+		if (readP1Value(reading, v, value)) {
+			items.present |= 1UL << v;
+			items.values[v] = (int32_t)value;
+		}
+	}
+	if (readMeterTime(reading, items.values[P1_BINARY_ITEM_TIME])) {
+		items.present |= 1UL << P1_BINARY_ITEM_TIME;
+	}
+}
+
+size_t encodeP1BinaryFrame(const P1BinaryItems& items, const P1BinaryItems* previous, uint8_t* out) {
+	bool delta = previous && previous->present == items.present;
+	uint32_t mask = items.present;
+	if (delta) {
+		mask = 0;
+		for (uint8_t i = 0; i < P1_BINARY_ITEM_COUNT; i++) {
+			if ((items.present & (1UL << i)) && items.values[i] != previous->values[i]) mask |= 1UL << i;
+		}
+	}
+
+	uint8_t* p = putVarint(out + 2, mask);
+	for (uint8_t i = 0; i < P1_BINARY_ITEM_COUNT; i++) {
+		if (!(mask & (1UL << i))) continue;
+		// Differences wrap like the values, so the decoder adds them back modulo 2^32
+		int32_t value = delta ? (int32_t)((uint32_t)items.values[i] - (uint32_t)previous->values[i]) : items.values[i];
+		p = putVarint(p, zigzag(value));
+	}
+	out[0] = delta ? P1_BINARY_DELTA : P1_BINARY_KEYFRAME;
+	out[1] = (uint8_t)(p - out - 2);
+	return p - out;
+}
@@ -0,0 +1,389 @@
+#include "p1_capture.h"
+#include "p1_handler.h"
+#include "ntp_client.h"
+#include "varint.h"
+#include "custom_log.h"
+#include "heap_telemetry.h"
+#include "stats.h"
+#include <LittleFS.h>
+
+#define P1_CAPTURE_MAGIC            0x50433150UL    // "P1CP"
+#define P1_CAPTURE_VERSION          1
+#define P1_CAPTURE_RECORD_OVERHEAD  (2 * VARINT_MAX_SIZE)
+#define P1_CAPTURE_FILE_BUFFER_SIZE 512
+#define P1_REPLAY_WINDOW_SIZE       512
+#define P1_CAPTURE_MAX_GAP_US       3600000000UL    // longer pauses are stored as one hour
+
+static_assert(P1_CAPTURE_CHUNK_SIZE + P1_CAPTURE_RECORD_OVERHEAD <= P1_REPLAY_WINDOW_SIZE, "replay window must hold a record");
+
+static P1CaptureMode captureMode = P1_CAPTURE_OFF;
+static uint32_t captureStartEpoch = 0;
+static uint32_t lastCaptureMicros = 0;
+static unsigned long lastCaptureMillis = 0;
+
+// RAM ring of records, oldest at ringTail
+static uint8_t ringBuffer[P1_CAPTURE_RAM_SIZE];
+static uint32_t ringTail = 0;
+static uint32_t ringUsed = 0;
+
+// File capture, appended in P1_CAPTURE_FILE_BUFFER_SIZE pieces
+static uint8_t fileBuffer[P1_CAPTURE_FILE_BUFFER_SIZE];
+static uint16_t fileBufferLength = 0;
+static uint32_t fileSize = 0;
+
+struct P1ReplayState {
+	bool active;
+	P1CaptureMode source;
+	P1ReplaySpeed speed;
+	uint16_t repeat;
+	P1CaptureReader reader;
+	uint8_t window[P1_REPLAY_WINDOW_SIZE];
+	uint16_t windowLength;
+	uint16_t windowPosition;
+	bool firstRecord;
+	uint64_t clockUs;           // replay time, advanced from micros()
+	uint64_t dueUs;             // replay time of the next record
+	uint32_t lastMicros;
+	uint32_t startMicros;
+	unsigned long telegramsAtStart;
+};
+
+static P1ReplayState replay;
+static P1CaptureStats captureStats;
+
+static const char* const modeNames[] = {"off", "ram", "file"};
+
+void initializeP1Capture() {
+	captureMode = P1_CAPTURE_OFF;
+	ringTail = 0;
+	ringUsed = 0;
+	replay.active = false;
+	memset(&captureStats, 0, sizeof(captureStats));
+
+	if (LittleFS.exists(P1_CAPTURE_FILE_PATH)) {
+		File file = LittleFS.open(P1_CAPTURE_FILE_PATH, "r");
+		if (file) {
+			fileSize = file.size();
+			file.close();
+		}
+	}
+}
+
+static void buildCaptureHeader(uint8_t* header, P1CaptureMode source) {
+	memset(header, 0, P1_CAPTURE_HEADER_SIZE);
+	uint32_t magic = P1_CAPTURE_MAGIC;
+	uint32_t baud = P1_BAUD_RATE;
+	for (int i = 0; i < 4; i++) {
+		header[i] = (magic >> (8 * i)) & 0xFF;
+		header[8 + i] = (baud >> (8 * i)) & 0xFF;
+		header[12 + i] = (captureStartEpoch >> (8 * i)) & 0xFF;
+	}
+	header[4] = P1_CAPTURE_VERSION;
+	header[5] = source;
+}
+
+static bool flushCaptureFile() {
+	if (fileBufferLength == 0) return true;
+
+	File file = LittleFS.open(P1_CAPTURE_FILE_PATH, "a");
+	size_t written = 0;
+	if (file) {
+		written = file.write(fileBuffer, fileBufferLength);
+		file.close();
+	}
+	fileSize += written;
+	bool ok = written == fileBufferLength;
+	if (!ok) {
+		captureStats.droppedBytes += fileBufferLength - written;
+	}
+	fileBufferLength = 0;
+	return ok;
+}
+
+bool startP1Capture(P1CaptureMode mode) {
+	if (mode == P1_CAPTURE_OFF || replay.active) return false;
+	stopP1Capture();
+
+	captureStartEpoch = isNTPTimeValid() ? getCurrentEpoch() : 0;
+	captureStats.capturedBytes = 0;
+	captureStats.capturedRecords = 0;
+	captureStats.droppedBytes = 0;
+
+	if (mode == P1_CAPTURE_RAM) {
+		ringTail = 0;
+		ringUsed = 0;
+	} else {
+		uint8_t header[P1_CAPTURE_HEADER_SIZE];
+		buildCaptureHeader(header, P1_CAPTURE_FILE);
+		File file = LittleFS.open(P1_CAPTURE_FILE_PATH, "w");
+		if (!file) {
+			REMOTE_LOG_ERROR("Capture: could not create", P1_CAPTURE_FILE_PATH);
+			return false;
+		}
+		fileSize = file.write(header, sizeof(header));
+		file.close();
+		fileBufferLength = 0;
+	}
+
+	lastCaptureMicros = micros();
+	lastCaptureMillis = millis();
+	captureMode = mode;
+	REMOTE_LOG_INFO("Capture: started, mode:", getP1CaptureModeName(mode));
+	return true;
+}
+
+void stopP1Capture() {
+	if (captureMode == P1_CAPTURE_OFF) return;
+	if (captureMode == P1_CAPTURE_FILE) {
+		flushCaptureFile();
+	}
+	REMOTE_LOG_INFO("Capture: stopped, bytes:", (unsigned long)captureStats.capturedBytes);
+	captureMode = P1_CAPTURE_OFF;
+}
+
+P1CaptureMode getP1CaptureMode() {
+	return captureMode;
+}
+
+// Read a varint that may wrap around the end of the ring
+static uint32_t readRingVarint(uint32_t& position) {
+	uint32_t value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		uint8_t byte = ringBuffer[position];
+		position = (position + 1) % P1_CAPTURE_RAM_SIZE;
+		value |= (uint32_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) break;
+	}
+	return value;
+}
+
+static void dropOldestRingRecord() {
+	uint32_t position = ringTail;
+	readRingVarint(position);
+	uint32_t length = readRingVarint(position);
+	position = (position + length) % P1_CAPTURE_RAM_SIZE;
+
+	uint32_t recordSize = (position + P1_CAPTURE_RAM_SIZE - ringTail) % P1_CAPTURE_RAM_SIZE;
+	ringTail = position;
+	ringUsed -= recordSize;
+	captureStats.droppedBytes += length;
+}
+
+static void writeRing(const uint8_t* data, size_t length) {
+	uint32_t head = (ringTail + ringUsed) % P1_CAPTURE_RAM_SIZE;
+	for (size_t i = 0; i < length; i++) {
+		ringBuffer[head] = data[i];
+		head = (head + 1) % P1_CAPTURE_RAM_SIZE;
+	}
+	ringUsed += length;
+}
+
+void captureP1Bytes(const uint8_t* data, size_t length) {
+	HEAP_TAG_SCOPE(HEAP_TAG_CAPTURE);
+	if (captureMode == P1_CAPTURE_OFF || length == 0) return;
+
+	uint32_t now = micros();
+	uint32_t delta = now - lastCaptureMicros;
+	// micros() wraps after ~71 minutes, so long pauses are measured with millis()
+	if (millis() - lastCaptureMillis >= P1_CAPTURE_MAX_GAP_US / 1000) {
+		delta = P1_CAPTURE_MAX_GAP_US;
+	}
+	lastCaptureMicros = now;
+	lastCaptureMillis = millis();
+
+	uint8_t recordHeader[P1_CAPTURE_RECORD_OVERHEAD];
+	uint8_t headerLength = writeVarint(recordHeader, delta);
+	headerLength += writeVarint(recordHeader + headerLength, length);
+	uint32_t recordSize = headerLength + length;
+
+	if (captureMode == P1_CAPTURE_RAM) {
+		if (recordSize > P1_CAPTURE_RAM_SIZE) return;
+		while (ringUsed + recordSize > P1_CAPTURE_RAM_SIZE) {
+			dropOldestRingRecord();
+		}
+		writeRing(recordHeader, headerLength);
+		writeRing(data, length);
+	} else {
+		if (fileSize + fileBufferLength + recordSize > P1_CAPTURE_FILE_MAX) {
+			REMOTE_LOG_INFO("Capture: file limit reached");
+			stopP1Capture();
+			return;
+		}
+		if (fileBufferLength + recordSize > sizeof(fileBuffer) && !flushCaptureFile()) {
+			REMOTE_LOG_ERROR("Capture: write failed, stopping");
+			stopP1Capture();
+			return;
+		}
+		memcpy(fileBuffer + fileBufferLength, recordHeader, headerLength);
+		memcpy(fileBuffer + fileBufferLength + headerLength, data, length);
+		fileBufferLength += recordSize;
+	}
+
+	captureStats.capturedBytes += length;
+	captureStats.capturedRecords++;
+}
+
+bool openP1CaptureReader(P1CaptureReader& reader, P1CaptureMode source) {
+	if (captureMode != P1_CAPTURE_OFF) return false;
+
+	reader.source = source;
+	reader.position = 0;
+	if (source == P1_CAPTURE_RAM) {
+		reader.size = P1_CAPTURE_HEADER_SIZE + ringUsed;
+		return ringUsed > 0;
+	}
+	if (source == P1_CAPTURE_FILE) {
+		reader.size = fileSize;
+		return fileSize > P1_CAPTURE_HEADER_SIZE;
+	}
+	return false;
+}
+
+size_t readP1Capture(P1CaptureReader& reader, uint8_t* buffer, size_t size) {
+	size = min(size, (size_t)(reader.size - reader.position));
+	if (size == 0) return 0;
+
+	if (reader.source == P1_CAPTURE_FILE) {
+		File file = LittleFS.open(P1_CAPTURE_FILE_PATH, "r");
+		if (!file) return 0;
+		file.seek(reader.position);
+		size = file.read(buffer, size);
+		file.close();
+		reader.position += size;
+		return size;
+	}
+
+	size_t length = 0;
+	if (reader.position < P1_CAPTURE_HEADER_SIZE) {
+		uint8_t header[P1_CAPTURE_HEADER_SIZE];
+		buildCaptureHeader(header, P1_CAPTURE_RAM);
+		length = min(size, (size_t)(P1_CAPTURE_HEADER_SIZE - reader.position));
+		memcpy(buffer, header + reader.position, length);
+	}
+	for (; length < size; length++) {
+		uint32_t offset = reader.position + length - P1_CAPTURE_HEADER_SIZE;
+		buffer[length] = ringBuffer[(ringTail + offset) % P1_CAPTURE_RAM_SIZE];
+	}
+	reader.position += length;
+	return length;
+}
+
+static bool rewindReplay() {
+	if (!openP1CaptureReader(replay.reader, replay.source)) return false;
+	replay.reader.position = P1_CAPTURE_HEADER_SIZE;
+	replay.windowLength = 0;
+	replay.windowPosition = 0;
+	replay.firstRecord = true;
+	return true;
+}
+
+bool startP1Replay(P1CaptureMode source, P1ReplaySpeed speed, uint16_t repeat) {
+	if (captureMode != P1_CAPTURE_OFF || replay.active) return false;
+
+	replay.source = source;
+	replay.speed = speed;
+	replay.repeat = repeat > 0 ? repeat : 1;
+	if (!rewindReplay()) return false;
+
+	replay.clockUs = 0;
+	replay.dueUs = 0;
+	replay.lastMicros = micros();
+	replay.startMicros = replay.lastMicros;
+	replay.telegramsAtStart = getStat(STAT_P1_TELEGRAMS);
+	replay.active = true;
+
+	captureStats.replaySpeed = speed;
+	captureStats.replayBytes = 0;
+	captureStats.replayTelegrams = 0;
+	captureStats.replayElapsedUs = 0;
+	captureStats.replayBusyUs = 0;
+
+	REMOTE_LOG_INFO("Capture: replay started, source:", getP1CaptureModeName(source));
+	return true;
+}
+
+void stopP1Replay() {
+	if (!replay.active) return;
+	replay.active = false;
+	captureStats.replayElapsedUs = micros() - replay.startMicros;
+	captureStats.replayTelegrams = getStat(STAT_P1_TELEGRAMS) - replay.telegramsAtStart;
+	REMOTE_LOG_INFO("Capture: replay finished, telegrams:", (unsigned long)captureStats.replayTelegrams);
+}
+
+bool isP1ReplayActive() {
+	return replay.active;
+}
+
+// Make the next record available in the window; false at the end of the capture
+static bool peekReplayRecord(uint32_t& delta, const uint8_t*& data, uint32_t& length) {
+	for (int attempt = 0; attempt < 2; attempt++) {
+		const uint8_t* p = replay.window + replay.windowPosition;
+		const uint8_t* end = replay.window + replay.windowLength;
+		if (readVarint(p, end, delta) && readVarint(p, end, length) && length <= (uint32_t)(end - p)) {
+			data = p;
+			return true;
+		}
+		// A record that still does not fit after a refill means a damaged capture
+		if (attempt > 0) break;
+
+		// Slide the unread bytes to the front and top the window up
+		uint16_t remaining = replay.windowLength - replay.windowPosition;
+		memmove(replay.window, replay.window + replay.windowPosition, remaining);
+		replay.windowPosition = 0;
+		replay.windowLength = remaining + readP1Capture(replay.reader, replay.window + remaining, sizeof(replay.window) - remaining);
+	}
+	return false;
+}
+
+void handleP1Replay() {
+	HEAP_TAG_SCOPE(HEAP_TAG_CAPTURE);
+	if (!replay.active) return;
+
+	uint32_t now = micros();
+	replay.clockUs += now - replay.lastMicros;
+	replay.lastMicros = now;
+	uint32_t sliceStart = now;
+
+	while (true) {
+		uint32_t delta;
+		uint32_t length;
+		const uint8_t* data;
+		if (!peekReplayRecord(delta, data, length)) {
+			if (--replay.repeat > 0 && rewindReplay()) continue;
+			stopP1Replay();
+			return;
+		}
+
+		if (replay.speed == P1_REPLAY_RECORDED) {
+			uint64_t due = replay.dueUs + (replay.firstRecord ? 0 : delta);
+			if (replay.clockUs < due) return;
+			replay.dueUs = due;
+		}
+		replay.firstRecord = false;
+
+		uint32_t busyStart = micros();
+		processP1Bytes(data, length);
+		captureStats.replayBusyUs += micros() - busyStart;
+		captureStats.replayBytes += length;
+		replay.windowPosition = (data - replay.window) + length;
+
+		// At full speed, hand the loop back regularly so the network keeps running
+		if (replay.speed == P1_REPLAY_MAX && micros() - sliceStart >= P1_REPLAY_SLICE_US) return;
+	}
+}
+
+void getP1CaptureStats(P1CaptureStats& stats) {
+	stats = captureStats;
+	stats.mode = captureMode;
+	stats.ramBytes = ringUsed;
+	stats.fileBytes = fileSize + fileBufferLength;
+	stats.replayActive = replay.active;
+	if (replay.active) {
+		stats.replayElapsedUs = micros() - replay.startMicros;
+		stats.replayTelegrams = getStat(STAT_P1_TELEGRAMS) - replay.telegramsAtStart;
+	}
+}
+
+const char* getP1CaptureModeName(P1CaptureMode mode) {
+	return mode <= P1_CAPTURE_FILE ? modeNames[mode] : "unknown";
+}
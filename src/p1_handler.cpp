@@ -1,15 +1,19 @@
 #include "p1_handler.h"
 #include "clients.h"
 #include "custom_log.h"
+#include "p1_aggregator.h"
+#include "ntp_client.h"
+#include "p1_capture.h"
+#include "crc16.h"
+#include "heap_telemetry.h"
+#include "stats.h"
 
 // P1 message buffer and state
 String p1Buffer = "";
 bool p1MessageComplete = false;
 
-// Statistics
-unsigned long totalP1Messages = 0;
-unsigned long totalBytesReceived = 0;
-unsigned long lastP1DataReceived = 0;
+// Latest decoded telegram
+P1Reading latestP1Reading;
 
 void initializeP1() {
 	// Initialize P1 data request pin (optional)
@@ -21,70 +25,216 @@ void initializeP1() {
 
 	// Initialize P1 serial port (pins are predefined for Serial1)
 	// ⚠️ WARNING: Ensure Pin 5 from P1 port uses level shifting (5V->3.3V)
+	// The FIFO is sized before begin(), which allocates it
+	Serial1.setFIFOSize(P1_SERIAL_FIFO_SIZE);
 	Serial1.begin(P1_BAUD_RATE, SERIAL_8N1);
+	p1Buffer.reserve(P1_BUFFER_SIZE + P1_CHECKSUM_LEN + 2);
 
 	REMOTE_LOG_INFO("P1 Serial initialized at 115200 baud");
 	REMOTE_LOG_WARN("⚠️ ENSURE P1 Pin 5 uses level shifting (5V->3.3V) to avoid damage!");
 }
 
-void readP1Data() {
-	while (Serial1.available()) {
-		char c = Serial1.read();
+// Byte-driven framer: '/' starts a telegram, '!' is followed by the
+// checksum characters. The telegram is complete at the last checksum
+// character, so a lost CR/LF does not hold it back; the CR/LF that follows is
+// skipped as inter-telegram filler. DSMR 2.2 has no checksum, its line ends
+// right after the '!'.
+enum P1FramerState {
+	P1_FRAMER_IDLE,
+	P1_FRAMER_BODY,
+	P1_FRAMER_CHECKSUM
+};
+
+static P1FramerState framerState = P1_FRAMER_IDLE;
+static int checksumChars = 0;
+static uint16_t checksumValue = 0;
+static unsigned int checksumStart = 0;      // bytes covered by the CRC, up to and including '!'
+static unsigned long lastP1ByteTime = 0;
+static P1FramerStats framerStats;
+static P1TelegramCallback telegramCallbacks[P1_TELEGRAM_CALLBACKS];
+static bool telegramCallbackLiveOnly[P1_TELEGRAM_CALLBACKS];
+static uint8_t telegramCallbackCount = 0;
+
+bool addP1TelegramCallback(P1TelegramCallback callback, bool liveOnly) {
+	if (telegramCallbackCount >= P1_TELEGRAM_CALLBACKS) {
+		REMOTE_LOG_ERROR("P1 telegram callbacks full, increase P1_TELEGRAM_CALLBACKS");
+		return false;
+	}
+	telegramCallbackLiveOnly[telegramCallbackCount] = liveOnly;
+	telegramCallbacks[telegramCallbackCount++] = callback;
+	return true;
+}
+
+static void notifyP1Telegram(const P1Reading* reading, bool replayed) {
+	for (uint8_t i = 0; i < telegramCallbackCount; i++) {
+		if (replayed && telegramCallbackLiveOnly[i]) continue;
+		telegramCallbacks[i](p1Buffer, reading);
+	}
+}
+
+void getP1FramerStats(P1FramerStats& stats) {
+	stats = framerStats;
+}
+
+static void handleP1Telegram() {
+	// Send complete P1 message to all connected clients
+	sendToAllClients(p1Buffer);
+	addStat(STAT_P1_TELEGRAMS);
+	addStat(STAT_P1_BYTES_RECEIVED, p1Buffer.length());
+	framerStats.telegrams++;
+
+	// Mark P1 data received for LED indication
+	setStat(STAT_P1_LAST_TELEGRAM, millis());
 
-		if (c == '/') {
-			// Start of new P1 message
+	REMOTE_LOG_DEBUG("P1 message #", getStat(STAT_P1_TELEGRAMS), " sent to clients (", p1Buffer.length(), " bytes)");
+
+	// Decode after forwarding so parsing never delays the raw stream. Replayed
+	// registers are old ones, and would corrupt the aggregates and history.
+	bool replayed = isP1ReplayActive();
+	P1Reading reading;
+	if (parseP1Telegram(p1Buffer.c_str(), p1Buffer.length(), reading)) {
+		latestP1Reading = reading;
+		if (!replayed) {
+			bool timeSynced = isNTPTimeValid();
+			aggregateP1Reading(reading, timeSynced ? getCurrentEpoch() : millis() / 1000, timeSynced);
+		}
+		notifyP1Telegram(&reading, replayed);
+	} else {
+		REMOTE_LOG_DEBUG("P1 message could not be decoded");
+		notifyP1Telegram(nullptr, replayed);
+	}
+}
+
+// Drop a partial telegram and wait for the next '/'
+static void abandonP1Telegram(const char* reason) {
+	framerStats.abandoned++;
+	framerStats.discardedBytes += p1Buffer.length();
+	REMOTE_LOG_DEBUG("P1 telegram abandoned:", reason);
+	p1Buffer = "";
+	framerState = P1_FRAMER_IDLE;
+}
+
+static void completeP1Telegram(bool hasChecksum) {
+	p1Buffer += "\r\n";
+	framerState = P1_FRAMER_IDLE;
+
+	if (hasChecksum && P1_VALIDATE_CRC) {
+		uint16_t crc = crc16Update(0, (const uint8_t*)p1Buffer.c_str(), checksumStart);
+		if (crc != checksumValue) {
+			framerStats.crcErrors++;
+			framerStats.discardedBytes += p1Buffer.length();
+			REMOTE_LOG_DEBUG("P1 telegram CRC mismatch, bytes dropped:", (unsigned long)p1Buffer.length());
+			p1Buffer = "";
+			return;
+		}
+	}
+	if (!hasChecksum) {
+		framerStats.unchecked++;
+	}
+
+	p1MessageComplete = true;
+	handleP1Telegram();
+	p1Buffer = "";
+	p1MessageComplete = false;
+}
+
+static int hexDigitValue(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+void processP1Bytes(const uint8_t* data, size_t length) {
+	HEAP_TAG_SCOPE(HEAP_TAG_P1);
+	if (length > 0) {
+		lastP1ByteTime = millis();
+	}
+
+	for (size_t i = 0; i < length; i++) {
+		char c = data[i];
+
+		if (c == P1_START_CHAR) {
+			// Start of new P1 message; a telegram still open lost its end
+			if (framerState != P1_FRAMER_IDLE) {
+				abandonP1Telegram("restarted before '!'");
+			}
 			p1Buffer = "/";
 			p1MessageComplete = false;
-		} else if (c == '!') {
-			// End marker, read the checksum
-			p1Buffer += c;
-			// Read the 4-character checksum
-			unsigned long timeout = millis() + 100;
-			int checksumChars = 0;
-			while (checksumChars < 4 && millis() < timeout) {
-				if (Serial1.available()) {
-					char checksumChar = Serial1.read();
-					p1Buffer += checksumChar;
-					checksumChars++;
+			framerState = P1_FRAMER_BODY;
+			continue;
+		}
+
+		switch (framerState) {
+			case P1_FRAMER_IDLE:
+				// CR/LF after the checksum is expected, anything else is noise
+				if (c != '\r' && c != '\n') {
+					framerStats.discardedBytes++;
 				}
-			}
+				break;
 
-			// Read final CR/LF
-			timeout = millis() + 50;
-			while (millis() < timeout && Serial1.available()) {
-				char endChar = Serial1.read();
-				if (endChar == '\r' || endChar == '\n') {
-					p1Buffer += endChar;
-					if (endChar == '\n') {
-						p1MessageComplete = true;
-						break;
+			case P1_FRAMER_BODY:
+				p1Buffer += c;
+				if (c == P1_END_CHAR) {
+					// End marker, the checksum follows
+					framerState = P1_FRAMER_CHECKSUM;
+					checksumChars = 0;
+					checksumValue = 0;
+					checksumStart = p1Buffer.length();
+				} else if (p1Buffer.length() > P1_BUFFER_SIZE) {
+					// Prevent buffer overflow
+					REMOTE_LOG_WARN("P1 buffer overflow, resetting");
+					abandonP1Telegram("buffer overflow");
+				}
+				break;
+
+			case P1_FRAMER_CHECKSUM: {
+				int digit = hexDigitValue(c);
+				if (digit >= 0) {
+					p1Buffer += c;
+					checksumValue = (checksumValue << 4) | digit;
+					if (++checksumChars == P1_CHECKSUM_LEN) {
+						completeP1Telegram(true);
 					}
+				} else if (checksumChars == 0 && (c == '\r' || c == '\n')) {
+					// DSMR 2.2: no checksum
+					completeP1Telegram(false);
+				} else {
+					abandonP1Telegram("bad checksum character");
 				}
+				break;
 			}
+		}
+	}
+}
+
+// A telegram arrives in well under a second; a longer pause means its
+// remainder was lost
+static void checkP1FrameTimeout() {
+	if (framerState != P1_FRAMER_IDLE && millis() - lastP1ByteTime > P1_FRAME_TIMEOUT) {
+		abandonP1Telegram("timeout");
+	}
+}
 
-			if (p1MessageComplete) {
-				// Send complete P1 message to all connected clients
-				sendToAllClients(p1Buffer);
-				totalP1Messages++;
-				totalBytesReceived += p1Buffer.length();
+void readP1Data() {
+	HEAP_TAG_SCOPE(HEAP_TAG_P1);
+	uint8_t chunk[P1_CAPTURE_CHUNK_SIZE];
+	while (Serial1.available()) {
+		size_t length = 0;
+		while (length < sizeof(chunk) && Serial1.available()) {
+			chunk[length++] = Serial1.read();
+		}
 
-				// Mark P1 data received for LED indication
-				lastP1DataReceived = millis();
+		captureP1Bytes(chunk, length);
 
-				REMOTE_LOG_DEBUG("P1 message #", totalP1Messages, " sent to clients (", p1Buffer.length(), " bytes)");
-				p1Buffer = "";
-				p1MessageComplete = false;
-			}
-		} else if (p1Buffer.length() > 0) {
-			// Add character to buffer if we're in a message
-			p1Buffer += c;
-
-			// Prevent buffer overflow
-			if (p1Buffer.length() > P1_BUFFER_SIZE) {
-				REMOTE_LOG_WARN("P1 buffer overflow, resetting");
-				p1Buffer = "";
-				p1MessageComplete = false;
-			}
+		// Live data is held back while a capture is being replayed into the framer
+		if (isP1ReplayActive()) {
+			continue;
 		}
+		processP1Bytes(chunk, length);
+	}
+
+	if (!isP1ReplayActive()) {
+		checkP1FrameTimeout();
 	}
 }
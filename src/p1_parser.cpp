@@ -0,0 +1,200 @@
+#include "p1_parser.h"
+#include <stddef.h>
+
+// M-Bus device types (0-n:24.1.0)
+#define MBUS_DEVICE_GAS     3
+#define MBUS_DEVICE_WATER   7
+#define MBUS_MAX_CHANNELS   4
+
+// OBIS code -> P1Reading member. All numeric members are 32 bits wide, so the
+// table only needs the byte offset and the number of decimals to keep.
+struct P1ObisMapping {
+	const char* obis;
+	uint32_t field;
+	uint16_t offset;
+	uint8_t decimals;
+};
+
+#define P1_OFFSET(member) ((uint16_t)offsetof(P1Reading, member))
+
+static const P1ObisMapping obisMappings[] = {
+	{"1-3:0.2.8",   P1_FIELD_VERSION,             P1_OFFSET(version),                 0},
+	{"0-0:96.1.4",  P1_FIELD_EMUCS_VERSION,       P1_OFFSET(emucsVersion),            0},
+	{"0-0:96.14.0", P1_FIELD_TARIFF,              P1_OFFSET(tariff),                  0},
+	{"1-0:1.8.1",   P1_FIELD_ENERGY_DELIVERED_T1, P1_OFFSET(energyDeliveredWh[0]),    3},
+	{"1-0:1.8.2",   P1_FIELD_ENERGY_DELIVERED_T2, P1_OFFSET(energyDeliveredWh[1]),    3},
+	{"1-0:2.8.1",   P1_FIELD_ENERGY_RETURNED_T1,  P1_OFFSET(energyReturnedWh[0]),     3},
+	{"1-0:2.8.2",   P1_FIELD_ENERGY_RETURNED_T2,  P1_OFFSET(energyReturnedWh[1]),     3},
+	{"1-0:1.7.0",   P1_FIELD_POWER_DELIVERED,     P1_OFFSET(powerDeliveredW),         3},
+	{"1-0:2.7.0",   P1_FIELD_POWER_RETURNED,      P1_OFFSET(powerReturnedW),          3},
+	{"0-0:96.7.21", P1_FIELD_POWER_FAILURES,      P1_OFFSET(powerFailures),           0},
+	{"0-0:96.7.9",  P1_FIELD_LONG_POWER_FAILURES, P1_OFFSET(longPowerFailures),       0},
+	{"1-0:32.7.0",  P1_FIELD_VOLTAGE_L1,          P1_OFFSET(voltageDv[0]),            1},
+	{"1-0:52.7.0",  P1_FIELD_VOLTAGE_L2,          P1_OFFSET(voltageDv[1]),            1},
+	{"1-0:72.7.0",  P1_FIELD_VOLTAGE_L3,          P1_OFFSET(voltageDv[2]),            1},
+	{"1-0:31.7.0",  P1_FIELD_CURRENT_L1,          P1_OFFSET(currentMa[0]),            3},
+	{"1-0:51.7.0",  P1_FIELD_CURRENT_L2,          P1_OFFSET(currentMa[1]),            3},
+	{"1-0:71.7.0",  P1_FIELD_CURRENT_L3,          P1_OFFSET(currentMa[2]),            3},
+	{"1-0:21.7.0",  P1_FIELD_POWER_DELIVERED_L1,  P1_OFFSET(phasePowerDeliveredW[0]), 3},
+	{"1-0:41.7.0",  P1_FIELD_POWER_DELIVERED_L2,  P1_OFFSET(phasePowerDeliveredW[1]), 3},
+	{"1-0:61.7.0",  P1_FIELD_POWER_DELIVERED_L3,  P1_OFFSET(phasePowerDeliveredW[2]), 3},
+	{"1-0:22.7.0",  P1_FIELD_POWER_RETURNED_L1,   P1_OFFSET(phasePowerReturnedW[0]),  3},
+	{"1-0:42.7.0",  P1_FIELD_POWER_RETURNED_L2,   P1_OFFSET(phasePowerReturnedW[1]),  3},
+	{"1-0:62.7.0",  P1_FIELD_POWER_RETURNED_L3,   P1_OFFSET(phasePowerReturnedW[2]),  3},
+};
+
+#define OBIS_MAPPING_COUNT (sizeof(obisMappings) / sizeof(obisMappings[0]))
+
+// Parse "012345.678" into an integer scaled by 10^decimals (extra digits are truncated)
+static bool parseFixedPoint(const char* p, const char* end, uint8_t decimals, int32_t& value) {
+	bool negative = false;
+	bool digits = false;
+	int64_t result = 0;
+
+	if (p < end && *p == '-') {
+		negative = true;
+		p++;
+	}
+	while (p < end && *p >= '0' && *p <= '9') {
+		result = result * 10 + (*p - '0');
+		digits = true;
+		p++;
+	}
+
+	uint8_t fraction = 0;
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (fraction < decimals) {
+				result = result * 10 + (*p - '0');
+				fraction++;
+			}
+			digits = true;
+			p++;
+		}
+	}
+	while (fraction < decimals) {
+		result *= 10;
+		fraction++;
+	}
+
+	if (!digits) return false;
+	value = (int32_t)(negative ? -result : result);
+	return true;
+}
+
+// Locate the n-th "(...)" group on a line, returning the span between the parentheses
+static bool findValueGroup(const char* line, const char* end, int index, const char*& valueStart, const char*& valueEnd) {
+	const char* p = line;
+	for (int i = 0; i <= index; i++) {
+		while (p < end && *p != '(') p++;
+		if (p >= end) return false;
+		valueStart = ++p;
+		while (p < end && *p != ')') p++;
+		if (p >= end) return false;
+		valueEnd = p++;
+	}
+	return true;
+}
+
+static bool obisEquals(const char* line, size_t keyLength, const char* obis) {
+	return strlen(obis) == keyLength && strncmp(line, obis, keyLength) == 0;
+}
+
+bool parseP1Telegram(const char* telegram, size_t length, P1Reading& reading) {
+	memset(&reading, 0, sizeof(reading));
+	if (length < 2 || telegram[0] != P1_START_CHAR) return false;
+
+	const char* end = telegram + length;
+	const char* line = telegram;
+
+	uint8_t mbusType[MBUS_MAX_CHANNELS + 1] = {0};
+	int32_t mbusValue[MBUS_MAX_CHANNELS + 1] = {0};
+	bool mbusHasValue[MBUS_MAX_CHANNELS + 1] = {false};
+	int pendingLegacyGasChannel = -1;
+
+	while (line < end && *line != P1_END_CHAR) {
+		const char* lineEnd = line;
+		while (lineEnd < end && *lineEnd != '\n') lineEnd++;
+
+		const char* open = line;
+		while (open < lineEnd && *open != '(') open++;
+		size_t keyLength = open - line;
+		const char* valueStart;
+		const char* valueEnd;
+
+		if (keyLength == 0 && pendingLegacyGasChannel > 0) {
+			// DSMR 2.2 puts the gas reading on the line after 0-n:24.3.0
+			int32_t value;
+			if (findValueGroup(line, lineEnd, 0, valueStart, valueEnd) &&
+				parseFixedPoint(valueStart, valueEnd, 3, value)) {
+				mbusValue[pendingLegacyGasChannel] = value;
+				mbusHasValue[pendingLegacyGasChannel] = true;
+				if (mbusType[pendingLegacyGasChannel] == 0) {
+					mbusType[pendingLegacyGasChannel] = MBUS_DEVICE_GAS;
+				}
+			}
+			pendingLegacyGasChannel = -1;
+		} else if (keyLength > 0 && open < lineEnd) {
+			pendingLegacyGasChannel = -1;
+
+			if (obisEquals(line, keyLength, "0-0:1.0.0")) {
+				if (findValueGroup(line, lineEnd, 0, valueStart, valueEnd)) {
+					size_t n = min((size_t)(valueEnd - valueStart), sizeof(reading.timestamp) - 1);
+					memcpy(reading.timestamp, valueStart, n);
+					reading.timestamp[n] = '\0';
+					reading.fields |= P1_FIELD_TIMESTAMP;
+				}
+			} else if (keyLength == 10 && strncmp(line, "0-", 2) == 0 && line[3] == ':' &&
+					   line[2] >= '1' && line[2] <= '0' + MBUS_MAX_CHANNELS) {
+				// M-Bus channel records: 0-n:24.1.0 (type), 0-n:24.2.1/24.2.3 (value), 0-n:24.3.0 (DSMR 2.2)
+				int channel = line[2] - '0';
+				int32_t value;
+				if (strncmp(line + 4, "24.1.0", 6) == 0) {
+					if (findValueGroup(line, lineEnd, 0, valueStart, valueEnd) &&
+						parseFixedPoint(valueStart, valueEnd, 0, value)) {
+						mbusType[channel] = (uint8_t)value;
+					}
+				} else if (strncmp(line + 4, "24.2.1", 6) == 0 || strncmp(line + 4, "24.2.3", 6) == 0) {
+					if (findValueGroup(line, lineEnd, 1, valueStart, valueEnd) &&
+						parseFixedPoint(valueStart, valueEnd, 3, value)) {
+						mbusValue[channel] = value;
+						mbusHasValue[channel] = true;
+					}
+				} else if (strncmp(line + 4, "24.3.0", 6) == 0) {
+					pendingLegacyGasChannel = channel;
+				}
+			} else {
+				for (size_t i = 0; i < OBIS_MAPPING_COUNT; i++) {
+					const P1ObisMapping& mapping = obisMappings[i];
+					if (!obisEquals(line, keyLength, mapping.obis)) continue;
+
+					int32_t value;
+					if (findValueGroup(line, lineEnd, 0, valueStart, valueEnd) &&
+						parseFixedPoint(valueStart, valueEnd, mapping.decimals, value)) {
+						int32_t* target = (int32_t*)((uint8_t*)&reading + mapping.offset);
+						*target = value;
+						reading.fields |= mapping.field;
+					}
+					break;
+				}
+			}
+		}
+
+		line = lineEnd + 1;
+	}
+
+	// Attribute M-Bus channels; an untyped channel with a reading is assumed to be gas
+	for (int channel = 1; channel <= MBUS_MAX_CHANNELS; channel++) {
+		if (!mbusHasValue[channel]) continue;
+		if (mbusType[channel] == MBUS_DEVICE_WATER && !(reading.fields & P1_FIELD_WATER)) {
+			reading.waterDm3 = (uint32_t)mbusValue[channel];
+			reading.fields |= P1_FIELD_WATER;
+		} else if ((mbusType[channel] == MBUS_DEVICE_GAS || mbusType[channel] == 0) && !(reading.fields & P1_FIELD_GAS)) {
+			reading.gasDm3 = (uint32_t)mbusValue[channel];
+			reading.fields |= P1_FIELD_GAS;
+		}
+	}
+
+	return reading.fields != 0;
+}
@@ -0,0 +1,67 @@
+#include "p1_values.h"
+
+// One entry per number in a P1Reading
+struct P1Value {
+	const char* name;                   // ending in the unit
+	uint32_t field;                     // P1_FIELD_* bit
+	uint8_t index;                      // tariff or phase
+	uint8_t decimals;                   // the unit is value / 10^decimals
+	long (*read)(const P1Reading& reading, uint8_t index);
+};
+
+static long readVersion(const P1Reading& r, uint8_t) { return r.version; }
+static long readTariff(const P1Reading& r, uint8_t) { return r.tariff; }
+static long readEnergyDelivered(const P1Reading& r, uint8_t i) { return r.energyDeliveredWh[i]; }
+static long readEnergyReturned(const P1Reading& r, uint8_t i) { return r.energyReturnedWh[i]; }
+static long readPowerDelivered(const P1Reading& r, uint8_t) { return r.powerDeliveredW; }
+static long readPowerReturned(const P1Reading& r, uint8_t) { return r.powerReturnedW; }
+static long readPowerFailures(const P1Reading& r, uint8_t) { return r.powerFailures; }
+static long readLongPowerFailures(const P1Reading& r, uint8_t) { return r.longPowerFailures; }
+static long readVoltage(const P1Reading& r, uint8_t i) { return r.voltageDv[i]; }
+static long readCurrent(const P1Reading& r, uint8_t i) { return r.currentMa[i]; }
+static long readPhaseDelivered(const P1Reading& r, uint8_t i) { return r.phasePowerDeliveredW[i]; }
+static long readPhaseReturned(const P1Reading& r, uint8_t i) { return r.phasePowerReturnedW[i]; }
+static long readGas(const P1Reading& r, uint8_t) { return r.gasDm3; }
+static long readWater(const P1Reading& r, uint8_t) { return r.waterDm3; }
+
+static const P1Value p1Values[P1_VALUE_COUNT] = {
+	{"dsmr_version", P1_FIELD_VERSION, 0, 0, readVersion},
+	{"tariff", P1_FIELD_TARIFF, 0, 0, readTariff},
+	{"energy_delivered_t1_kwh", P1_FIELD_ENERGY_DELIVERED_T1, 0, 3, readEnergyDelivered},
+	{"energy_delivered_t2_kwh", P1_FIELD_ENERGY_DELIVERED_T2, 1, 3, readEnergyDelivered},
+	{"energy_returned_t1_kwh", P1_FIELD_ENERGY_RETURNED_T1, 0, 3, readEnergyReturned},
+	{"energy_returned_t2_kwh", P1_FIELD_ENERGY_RETURNED_T2, 1, 3, readEnergyReturned},
+	{"power_delivered_w", P1_FIELD_POWER_DELIVERED, 0, 0, readPowerDelivered},
+	{"power_returned_w", P1_FIELD_POWER_RETURNED, 0, 0, readPowerReturned},
+	{"power_failures", P1_FIELD_POWER_FAILURES, 0, 0, readPowerFailures},
+	{"long_power_failures", P1_FIELD_LONG_POWER_FAILURES, 0, 0, readLongPowerFailures},
+	{"voltage_l1_v", P1_FIELD_VOLTAGE_L1, 0, 1, readVoltage},
+	{"voltage_l2_v", P1_FIELD_VOLTAGE_L2, 1, 1, readVoltage},
+	{"voltage_l3_v", P1_FIELD_VOLTAGE_L3, 2, 1, readVoltage},
+	{"current_l1_a", P1_FIELD_CURRENT_L1, 0, 3, readCurrent},
+	{"current_l2_a", P1_FIELD_CURRENT_L2, 1, 3, readCurrent},
+	{"current_l3_a", P1_FIELD_CURRENT_L3, 2, 3, readCurrent},
+	{"power_delivered_l1_w", P1_FIELD_POWER_DELIVERED_L1, 0, 0, readPhaseDelivered},
+	{"power_delivered_l2_w", P1_FIELD_POWER_DELIVERED_L2, 1, 0, readPhaseDelivered},
+	{"power_delivered_l3_w", P1_FIELD_POWER_DELIVERED_L3, 2, 0, readPhaseDelivered},
+	{"power_returned_l1_w", P1_FIELD_POWER_RETURNED_L1, 0, 0, readPhaseReturned},
+	{"power_returned_l2_w", P1_FIELD_POWER_RETURNED_L2, 1, 0, readPhaseReturned},
+	{"power_returned_l3_w", P1_FIELD_POWER_RETURNED_L3, 2, 0, readPhaseReturned},
+	{"gas_m3", P1_FIELD_GAS, 0, 3, readGas},
+	{"water_m3", P1_FIELD_WATER, 0, 3, readWater},
+};
+
+const char* getP1ValueName(uint8_t value) {
+	return p1Values[value].name;
+}
+
+uint8_t getP1ValueDecimals(uint8_t value) {
+	return p1Values[value].decimals;
+}
+
+bool readP1Value(const P1Reading& reading, uint8_t value, long& result) {
+	const P1Value& entry = p1Values[value];
+	if (!(reading.fields & entry.field)) return false;
+	result = entry.read(reading, entry.index);
+	return true;
+}
@@ -0,0 +1,101 @@
+#include "sha1.h"
+
+static inline uint32_t rotateLeft(uint32_t value, int bits) {
+	return (value << bits) | (value >> (32 - bits));
+}
+
+static void sha1Block(Sha1Context& context, const uint8_t* block) {
+	// 16-word rolling schedule instead of the full 80 words
+	uint32_t w[16];
+	for (int i = 0; i < 16; i++) {
+		w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+			   ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+	}
+
+	uint32_t a = context.state[0];
+	uint32_t b = context.state[1];
+	uint32_t c = context.state[2];
+	uint32_t d = context.state[3];
+	uint32_t e = context.state[4];
+	for (int i = 0; i < 80; i++) {
+		if (i >= 16) {
+			w[i & 15] = rotateLeft(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], 1);
+		}
+		uint32_t f;
+		uint32_t k;
+		if (i < 20) {
+			f = (b & c) | (~b & d);
+			k = 0x5A827999;
+		} else if (i < 40) {
+			f = b ^ c ^ d;
+			k = 0x6ED9EBA1;
+		} else if (i < 60) {
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8F1BBCDC;
+		} else {
+			f = b ^ c ^ d;
+			k = 0xCA62C1D6;
+		}
+		uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i & 15];
+		e = d;
+		d = c;
+		c = rotateLeft(b, 30);
+		b = a;
+		a = temp;
+	}
+
+	context.state[0] += a;
+	context.state[1] += b;
+	context.state[2] += c;
+	context.state[3] += d;
+	context.state[4] += e;
+}
+
+void sha1Init(Sha1Context& context) {
+	context.state[0] = 0x67452301;
+	context.state[1] = 0xEFCDAB89;
+	context.state[2] = 0x98BADCFE;
+	context.state[3] = 0x10325476;
+	context.state[4] = 0xC3D2E1F0;
+	context.length = 0;
+	context.used = 0;
+}
+
+void sha1Update(Sha1Context& context, const uint8_t* data, size_t length) {
+	context.length += length;
+	while (length > 0) {
+		size_t take = min(length, (size_t)(64 - context.used));
+		memcpy(context.block + context.used, data, take);
+		context.used += take;
+		data += take;
+		length -= take;
+		if (context.used == 64) {
+			sha1Block(context, context.block);
+			context.used = 0;
+		}
+	}
+}
+
+void sha1Final(Sha1Context& context, uint8_t digest[SHA1_DIGEST_SIZE]) {
+	uint64_t bits = context.length * 8;
+
+	// 0x80, zeros up to 56 bytes into a block, then the length in bits
+	uint8_t pad = 0x80;
+	sha1Update(context, &pad, 1);
+	pad = 0;
+	while (context.used != 56) {
+		sha1Update(context, &pad, 1);
+	}
+	uint8_t lengthBytes[8];
+	for (int i = 0; i < 8; i++) {
+		lengthBytes[i] = (uint8_t)(bits >> (56 - i * 8));
+	}
+	sha1Update(context, lengthBytes, 8);
+
+	for (int i = 0; i < 5; i++) {
+		digest[i * 4] = (uint8_t)(context.state[i] >> 24);
+		digest[i * 4 + 1] = (uint8_t)(context.state[i] >> 16);
+		digest[i * 4 + 2] = (uint8_t)(context.state[i] >> 8);
+		digest[i * 4 + 3] = (uint8_t)context.state[i];
+	}
+}
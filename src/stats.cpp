@@ -0,0 +1,85 @@
+#include "stats.h"
+
+static volatile uint32_t statCounters[2][STAT_COUNTER_COUNT];    // per core
+static volatile uint32_t statGauges[STAT_GAUGE_COUNT];
+
+// Rates are only touched by handleStats() and the readers on core 0
+static uint32_t rateLast[STAT_COUNTER_COUNT];           // counter at the last update
+static int64_t rateMilli[STAT_COUNTER_COUNT];           // per second, in thousandths
+static unsigned long lastRateUpdate = 0;
+static bool ratesStarted = false;
+
+static const char* const statNames[STAT_COUNTER_COUNT] = {
+	"p1_telegrams",
+	"p1_bytes_received",
+	"p1_bytes_sent",
+	"p1_binary_frames",
+	"log_messages",
+	"log_bytes_sent",
+	"http_requests",
+	"http_connections",
+	"ota_attempts",
+	"ota_updates",
+	"mqtt_connects",
+	"mqtt_publishes",
+	"mqtt_writes",
+	"mqtt_bytes_sent",
+	"influx_points",
+	"influx_points_dropped",
+	"influx_batches",
+	"influx_errors",
+	"influx_bytes_sent",
+	"modbus_requests",
+	"modbus_exceptions",
+};
+
+void addStat(StatCounter counter, uint32_t amount) {
+	volatile uint32_t& value = statCounters[rp2040.cpuid() & 1][counter];
+	value = value + amount;
+}
+
+void setStat(StatGauge gauge, uint32_t value) {
+	statGauges[gauge] = value;
+}
+
+uint32_t getStat(StatCounter counter) {
+	return statCounters[0][counter] + statCounters[1][counter];
+}
+
+uint32_t getStat(StatGauge gauge) {
+	return statGauges[gauge];
+}
+
+void getStatsSnapshot(StatsSnapshot& snapshot) {
+	for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+		snapshot.counters[i] = getStat((StatCounter)i);
+		snapshot.rates[i] = rateMilli[i] > 0 ? (uint32_t)rateMilli[i] : 0;
+	}
+	for (int i = 0; i < STAT_GAUGE_COUNT; i++) {
+		snapshot.gauges[i] = statGauges[i];
+	}
+}
+
+void handleStats() {
+	unsigned long now = millis();
+	unsigned long elapsed = now - lastRateUpdate;
+	if (ratesStarted && elapsed < STATS_RATE_INTERVAL) return;
+
+	for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+		uint32_t value = getStat((StatCounter)i);
+		if (ratesStarted) {
+			// rate += (sample - rate) * elapsed / window, in fixed point;
+			// the first window starts from 0 rather than a single sample
+			int64_t sample = (int64_t)(uint32_t)(value - rateLast[i]) * 1000000 / (int64_t)elapsed;
+			unsigned long weight = min(elapsed, (unsigned long)STATS_RATE_WINDOW);
+			rateMilli[i] += (sample - rateMilli[i]) * (int64_t)weight / STATS_RATE_WINDOW;
+		}
+		rateLast[i] = value;
+	}
+	lastRateUpdate = now;
+	ratesStarted = true;
+}
+
+const char* getStatName(StatCounter counter) {
+	return statNames[counter];
+}
@@ -0,0 +1,112 @@
+#include "string_builder.h"
+#include <stdarg.h>
+
+StringBuilder::StringBuilder(char* buffer, size_t capacity)
+	: data(buffer), size(capacity), used(0), overflow(false) {
+	data[0] = '\0';
+}
+
+void StringBuilder::clear() {
+	used = 0;
+	overflow = false;
+	data[0] = '\0';
+}
+
+size_t StringBuilder::write(uint8_t c) {
+	if (used + 1 >= size) {
+		overflow = true;
+		return 0;
+	}
+	data[used++] = (char)c;
+	data[used] = '\0';
+	return 1;
+}
+
+size_t StringBuilder::write(const uint8_t* buffer, size_t length) {
+	size_t room = size - 1 - used;
+	if (length > room) {
+		length = room;
+		overflow = true;
+	}
+	memcpy(data + used, buffer, length);
+	used += length;
+	data[used] = '\0';
+	return length;
+}
+
+StringBuilder& StringBuilder::append(const char* text, size_t length) {
+	write((const uint8_t*)text, length);
+	return *this;
+}
+
+StringBuilder& StringBuilder::appendf(const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	size_t room = size - used;
+	int n = vsnprintf(data + used, room, format, args);
+	va_end(args);
+	if (n < 0) {
+		data[used] = '\0';
+	} else if ((size_t)n >= room) {
+		used = size - 1;
+		overflow = true;
+	} else {
+		used += n;
+	}
+	return *this;
+}
+
+StringBuilder& StringBuilder::appendJSONEscaped(const char* text, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		char c = text[i];
+		switch (c) {
+			case '"':  append("\\\"", 2); break;
+			case '\\': append("\\\\", 2); break;
+			case '\n': append("\\n", 2); break;
+			case '\r': append("\\r", 2); break;
+			case '\t': append("\\t", 2); break;
+			default:
+				if ((uint8_t)c < 0x20) {
+					appendf("\\u%04x", (unsigned)(uint8_t)c);
+				} else {
+					write((uint8_t)c);
+				}
+				break;
+		}
+	}
+	return *this;
+}
+
+StringBuilder& StringBuilder::appendJSONEscaped(const char* text) {
+	return appendJSONEscaped(text, strlen(text));
+}
+
+StringBuilder& StringBuilder::appendHTMLEscaped(const char* text, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		switch (text[i]) {
+			case '&':  append("&amp;", 5); break;
+			case '<':  append("&lt;", 4); break;
+			case '>':  append("&gt;", 4); break;
+			case '"':  append("&quot;", 6); break;
+			case '\'': append("&#39;", 5); break;
+			default:   write((uint8_t)text[i]); break;
+		}
+	}
+	return *this;
+}
+
+StringBuilder& StringBuilder::appendFixedPoint(long value, uint8_t decimals) {
+	if (value < 0) {
+		write('-');
+		value = -value;
+	}
+	long scale = 1;
+	for (uint8_t i = 0; i < decimals; i++) {
+		scale *= 10;
+	}
+	print((unsigned long)(value / scale));
+	if (decimals > 0) {
+		appendf(".%0*lu", (int)decimals, (unsigned long)(value % scale));
+	}
+	return *this;
+}
@@ -0,0 +1,21 @@
+#include "varint.h"
+
+uint8_t writeVarint(uint8_t* p, uint32_t value) {
+	uint8_t length = 0;
+	while (value >= 0x80) {
+		p[length++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	p[length++] = value;
+	return length;
+}
+
+bool readVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 35 && p < end; shift += 7) {
+		uint8_t byte = *p++;
+		value |= (uint32_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	return false;
+}
@@ -0,0 +1,349 @@
+#include "web/api_web_handler.h"
+#include "web/http_server.h"
+#include "p1_aggregator.h"
+#include "p1_handler.h"
+#include "history_store.h"
+#include "ntp_client.h"
+#include "custom_log.h"
+#include "heap_telemetry.h"
+#include "stats.h"
+#include <Ethernet.h>
+
+// Longest bucket object: every channel and counter at their widest
+#define AGG_BUCKET_JSON_MAX (64 + AGG_CHANNEL_COUNT * 96 + AGG_COUNTER_COUNT * 40)
+
+static void appendAggregateBucketJSON(StringBuilder& json, const AggBucket& bucket) {
+	json.append("{\"start\":").append(bucket.start);
+	json.append(",\"synced\":").append((bucket.flags & AGG_BUCKET_TIME_SYNCED) ? "true" : "false");
+	json.append(",\"samples\":").append(bucket.samples);
+
+	for (int c = 0; c < AGG_CHANNEL_COUNT; c++) {
+		if (!(bucket.channelMask & (1 << c))) continue;
+		const AggChannel& channel = bucket.channels[c];
+		json.append(",\"").append(getAggregateChannelName((AggChannelId)c)).append("\":{");
+		json.append("\"min\":").append(channel.min);
+		json.append(",\"max\":").append(channel.max);
+		json.append(",\"avg\":").append(channel.avg);
+		json.append(",\"last\":").append(channel.last).append("}");
+	}
+
+	for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+		if (!(bucket.counterMask & (1 << c))) continue;
+		json.append(",\"").append(getAggregateCounterName((AggCounterId)c)).append("\":").append(bucket.counters[c]);
+	}
+
+	json.append("}");
+}
+
+// Three phase values as an array, null for phases the meter did not send
+static void appendPhaseJSON(StringBuilder& json, const char* name, const int32_t* values, uint32_t fields, uint32_t firstField) {
+	if (!(fields & (firstField | (firstField << 1) | (firstField << 2)))) return;
+	json.append(",\"").append(name).append("\":[");
+	for (int phase = 0; phase < 3; phase++) {
+		if (phase > 0) json.append(',');
+		if (fields & (firstField << phase)) {
+			json.append(values[phase]);
+		} else {
+			json.append("null");
+		}
+	}
+	json.append(']');
+}
+
+void appendP1ReadingJSON(StringBuilder& json, const P1Reading& reading) {
+	uint32_t fields = reading.fields;
+	json.append("{\"version\":").append(reading.version);
+	if (fields & P1_FIELD_EMUCS_VERSION) {
+		json.append(",\"emucs_version\":").append(reading.emucsVersion);
+	}
+	if (fields & P1_FIELD_TIMESTAMP) {
+		json.append(",\"timestamp\":\"").appendJSONEscaped(reading.timestamp).append('"');
+	}
+	if (fields & P1_FIELD_TARIFF) {
+		json.append(",\"tariff\":").append(reading.tariff);
+	}
+	if (fields & (P1_FIELD_ENERGY_DELIVERED_T1 | P1_FIELD_ENERGY_DELIVERED_T2)) {
+		json.append(",\"energy_delivered_wh\":[").append(reading.energyDeliveredWh[0]).append(',').append(reading.energyDeliveredWh[1]).append(']');
+	}
+	if (fields & (P1_FIELD_ENERGY_RETURNED_T1 | P1_FIELD_ENERGY_RETURNED_T2)) {
+		json.append(",\"energy_returned_wh\":[").append(reading.energyReturnedWh[0]).append(',').append(reading.energyReturnedWh[1]).append(']');
+	}
+	if (fields & P1_FIELD_POWER_DELIVERED) {
+		json.append(",\"power_delivered_w\":").append(reading.powerDeliveredW);
+	}
+	if (fields & P1_FIELD_POWER_RETURNED) {
+		json.append(",\"power_returned_w\":").append(reading.powerReturnedW);
+	}
+	if (fields & P1_FIELD_POWER_FAILURES) {
+		json.append(",\"power_failures\":").append(reading.powerFailures);
+	}
+	if (fields & P1_FIELD_LONG_POWER_FAILURES) {
+		json.append(",\"long_power_failures\":").append(reading.longPowerFailures);
+	}
+	appendPhaseJSON(json, "voltage_dv", reading.voltageDv, fields, P1_FIELD_VOLTAGE_L1);
+	appendPhaseJSON(json, "current_ma", reading.currentMa, fields, P1_FIELD_CURRENT_L1);
+	appendPhaseJSON(json, "power_delivered_phase_w", reading.phasePowerDeliveredW, fields, P1_FIELD_POWER_DELIVERED_L1);
+	appendPhaseJSON(json, "power_returned_phase_w", reading.phasePowerReturnedW, fields, P1_FIELD_POWER_RETURNED_L1);
+	if (fields & P1_FIELD_GAS) {
+		json.append(",\"gas_dm3\":").append(reading.gasDm3);
+	}
+	if (fields & P1_FIELD_WATER) {
+		json.append(",\"water_dm3\":").append(reading.waterDm3);
+	}
+	json.append('}');
+}
+
+// {"id":N,"received":epoch,"values":{...}} of the latest decoded telegram
+static char readingJSON[P1_READING_JSON_MAX + 64];
+static size_t readingJSONLength = 0;
+
+static void cacheReadingJSON(const String& telegram, const P1Reading* reading) {
+	if (!reading) return;   // keep the last good one; its id tells how old it is
+	StringBuilder json(readingJSON, sizeof(readingJSON));
+	json.append("{\"id\":").append(getStat(STAT_P1_TELEGRAMS));
+	if (isNTPTimeValid()) {
+		json.append(",\"received\":").append(getCurrentEpoch());
+	}
+	json.append(",\"values\":");
+	appendP1ReadingJSON(json, *reading);
+	json.append('}');
+	readingJSONLength = json.overflowed() ? 0 : json.length();
+}
+
+void initializeReadingAPI() {
+	addP1TelegramCallback(cacheReadingJSON);
+}
+
+void sendReadingJSON(EthernetClient& client) {
+	StringBuilder& json = beginHTTPPage();
+	if (readingJSONLength == 0) {
+		json.append("{\"error\":\"no telegram decoded yet\"}");
+		sendHTTPResponse(client, 503, "application/json", json);
+		return;
+	}
+	// Copied, so a telegram arriving while the response goes out cannot change it
+	json.append(readingJSON, readingJSONLength);
+	sendHTTPResponse(client, 200, "application/json", json);
+}
+
+static void flushPage(EthernetClient& client, StringBuilder& page) {
+	writeHTTPChunk(client, page.c_str(), page.length());
+	page.clear();
+}
+
+void sendAggregatesJSON(EthernetClient& client, const char* path) {
+	// ?resolution=minute|quarter_hour|hour (default minute)
+	const char* resolutionParam = getQueryParameter(path, "resolution");
+	AggResolution resolution = AGG_MINUTE;
+	for (int r = 0; r < AGG_RESOLUTION_COUNT; r++) {
+		if (strcmp(resolutionParam, getAggregateResolutionName((AggResolution)r)) == 0) {
+			resolution = (AggResolution)r;
+		}
+	}
+
+	sendHTTPHeaders(client, 200, "application/json", HTTP_LENGTH_CHUNKED);
+
+	// Buckets go out whenever the page buffer fills up, so the response never
+	// exists in RAM as a whole
+	StringBuilder& json = beginHTTPPage();
+	json.append("{\"resolution\":\"").append(getAggregateResolutionName(resolution)).append("\"");
+	json.append(",\"period\":").append(getAggregatePeriod(resolution));
+	json.append(",\"units\":{\"power\":\"W\",\"voltage\":\"dV\",\"current\":\"mA\",\"energy\":\"Wh\",\"volume\":\"dm3\"}");
+	AggBucket bucket;
+	if (getOpenAggregate(resolution, bucket)) {
+		json.append(",\"open\":");
+		appendAggregateBucketJSON(json, bucket);
+	}
+	json.append(",\"buckets\":[");
+
+	uint16_t count = getAggregateCount(resolution);
+	for (uint16_t age = 0; age < count; age++) {
+		if (!getAggregate(resolution, age, bucket)) break;
+		if (json.remaining() < AGG_BUCKET_JSON_MAX) {
+			flushPage(client, json);
+		}
+		if (age > 0) json.append(",");
+		appendAggregateBucketJSON(json, bucket);
+	}
+	json.append("]}");
+	flushPage(client, json);
+	endHTTPChunks(client);
+
+	REMOTE_LOG_DEBUG("API: Sent aggregates, buckets:", (int)count);
+}
+
+// Longest NDJSON line: time, power and every counter at their widest
+#define HISTORY_STREAM_LINE_MAX (48 + AGG_COUNTER_COUNT * 36)
+
+struct HistoryStream {
+	EthernetClient client;
+	HistoryCursor cursor;
+	bool active;
+	bool csv;
+	uint32_t step;
+	// Step being summed up
+	bool stepOpen;
+	uint32_t stepStart;
+	int64_t powerSum;
+	uint16_t powerSamples;
+	uint32_t counters[AGG_COUNTER_COUNT];
+	unsigned long lastProgress;
+	uint32_t lines;
+	char chunk[HISTORY_STREAM_CHUNK_SIZE];
+};
+
+static HistoryStream historyStream;
+
+static_assert(HISTORY_STREAM_CHUNK_SIZE >= 2 * HISTORY_STREAM_LINE_MAX, "history chunk must hold at least two lines");
+
+static size_t formatHistoryStep(char* out, size_t size) {
+	HistoryStream& stream = historyStream;
+	int length;
+	if (stream.csv) {
+		length = snprintf(out, size, "%lu,", (unsigned long)stream.stepStart);
+		if (stream.powerSamples > 0) {
+			length += snprintf(out + length, size - length, "%ld", (long)(stream.powerSum / stream.powerSamples));
+		}
+		for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+			length += snprintf(out + length, size - length, ",%lu", (unsigned long)stream.counters[c]);
+		}
+		length += snprintf(out + length, size - length, "\n");
+	} else {
+		length = snprintf(out, size, "{\"time\":%lu", (unsigned long)stream.stepStart);
+		if (stream.powerSamples > 0) {
+			length += snprintf(out + length, size - length, ",\"power\":%ld", (long)(stream.powerSum / stream.powerSamples));
+		}
+		for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+			length += snprintf(out + length, size - length, ",\"%s\":%lu", getAggregateCounterName((AggCounterId)c), (unsigned long)stream.counters[c]);
+		}
+		length += snprintf(out + length, size - length, "}\n");
+	}
+
+	stream.stepOpen = false;
+	stream.lines++;
+	return length;
+}
+
+static void finishHistoryStream(const char* reason) {
+	historyStream.client.stop();
+	historyStream.active = false;
+	FixedString<64> message;
+	message.append("API: History stream ").append(reason).append(", lines: ").append(historyStream.lines);
+	REMOTE_LOG_DEBUG(message.c_str());
+}
+
+bool isHistoryStreamActive() {
+	return historyStream.active;
+}
+
+bool startHistoryStream(EthernetClient& client, const char* path) {
+	HistoryStats stats;
+	getHistoryStats(stats);
+	if (!stats.mounted || historyStream.active) {
+		StringBuilder& message = beginHTTPPage();
+		message.append(stats.mounted ? "History download already in progress\n" : "History store not available\n");
+		sendHTTPResponse(client, 503, "text/plain", message);
+		return false;
+	}
+
+	// ?from=&to= in epoch seconds, step in seconds (multiple of a minute)
+	const char* fromParam = getQueryParameter(path, "from");
+	const char* toParam = getQueryParameter(path, "to");
+	const char* stepParam = getQueryParameter(path, "step");
+	uint32_t from = fromParam[0] ? strtoul(fromParam, nullptr, 10) : 0;
+	uint32_t to = toParam[0] ? strtoul(toParam, nullptr, 10) : 0xFFFFFFFFUL;
+	uint32_t step = stepParam[0] ? strtoul(stepParam, nullptr, 10) : 60;
+	if (from > to || step < 60) {
+		StringBuilder& message = beginHTTPPage();
+		message.append("Expected from <= to and step >= 60\n");
+		sendHTTPResponse(client, 400, "text/plain", message);
+		return false;
+	}
+
+	HistoryStream& stream = historyStream;
+	stream.client = client;
+	stream.csv = strcmp(getQueryParameter(path, "format"), "csv") == 0;
+	stream.step = step - step % 60;
+	stream.stepOpen = false;
+	stream.lines = 0;
+	stream.lastProgress = millis();
+	openHistoryCursor(stream.cursor, from, to);
+	stream.active = true;
+
+	sendHTTPHeaders(client, 200, stream.csv ? "text/csv" : "application/x-ndjson", HTTP_LENGTH_UNKNOWN);
+	if (stream.csv) {
+		FixedString<HISTORY_STREAM_LINE_MAX> header;
+		header.append("time,power");
+		for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+			header.append(",").append(getAggregateCounterName((AggCounterId)c));
+		}
+		header.append("\n");
+		client.write((const uint8_t*)header.c_str(), header.length());
+	}
+
+	FixedString<80> message;
+	message.append("API: History stream from ").append(from).append(" to ").append(to).append(" step ").append(stream.step);
+	REMOTE_LOG_DEBUG(message.c_str());
+	return true;
+}
+
+void handleHistoryStream() {
+	HEAP_TAG_SCOPE(HEAP_TAG_HISTORY);
+	HistoryStream& stream = historyStream;
+	if (!stream.active) return;
+
+	if (!stream.client.connected()) {
+		finishHistoryStream("closed by client");
+		return;
+	}
+	// Only write what the socket can take right away
+	if (stream.client.availableForWrite() < HISTORY_STREAM_CHUNK_SIZE) {
+		if (millis() - stream.lastProgress > HTTP_STREAM_TIMEOUT) {
+			finishHistoryStream("timed out");
+		}
+		return;
+	}
+
+	// A step line is only written when the step ends, so the records read are
+	// bounded too: the open step carries over to the next pass
+	size_t length = 0;
+	bool finished = false;
+	for (int records = 0; records < HISTORY_STREAM_RECORDS_PER_PASS && length + HISTORY_STREAM_LINE_MAX <= sizeof(stream.chunk); records++) {
+		HistoryRecord record;
+		if (!readHistoryRecord(stream.cursor, record)) {
+			if (stream.stepOpen) {
+				length += formatHistoryStep(stream.chunk + length, sizeof(stream.chunk) - length);
+			}
+			finished = true;
+			break;
+		}
+
+		uint32_t stepStart = record.time - record.time % stream.step;
+		if (stream.stepOpen && stepStart != stream.stepStart) {
+			length += formatHistoryStep(stream.chunk + length, sizeof(stream.chunk) - length);
+		}
+		if (!stream.stepOpen) {
+			stream.stepOpen = true;
+			stream.stepStart = stepStart;
+			stream.powerSum = 0;
+			stream.powerSamples = 0;
+			memset(stream.counters, 0, sizeof(stream.counters));
+		}
+
+		if (record.flags & HISTORY_RECORD_POWER) {
+			stream.powerSum += record.powerW;
+			stream.powerSamples++;
+		}
+		for (int c = 0; c < AGG_COUNTER_COUNT; c++) {
+			stream.counters[c] += record.counters[c];
+		}
+	}
+
+	if (length > 0) {
+		stream.client.write((const uint8_t*)stream.chunk, length);
+		stream.lastProgress = millis();
+	}
+	if (finished) {
+		finishHistoryStream("complete");
+	}
+}
@@ -0,0 +1,112 @@
+#include "web/capture_web_handler.h"
+#include "web/http_server.h"
+#include "p1_capture.h"
+#include "custom_log.h"
+#include "heap_telemetry.h"
+#include <Ethernet.h>
+
+#define CAPTURE_DOWNLOAD_CHUNK_SIZE 512
+
+struct CaptureDownload {
+	EthernetClient client;
+	P1CaptureReader reader;
+	bool active;
+	unsigned long lastProgress;
+};
+
+static CaptureDownload captureDownload;
+
+static P1CaptureMode parseCaptureSource(const char* path) {
+	const char* source = getQueryParameter(path, "source");
+	if (!source[0]) source = getQueryParameter(path, "mode");
+	return strcmp(source, "file") == 0 ? P1_CAPTURE_FILE : P1_CAPTURE_RAM;
+}
+
+static void appendCaptureStatus(StringBuilder& status) {
+	P1CaptureStats stats;
+	getP1CaptureStats(stats);
+
+	status.append("P1 Serial Capture\n");
+	status.append("Mode: ").append(getP1CaptureModeName(stats.mode)).append("\n");
+	status.append("Captured bytes: ").append(stats.capturedBytes).append(" in ").append(stats.capturedRecords).append(" reads\n");
+	status.append("Dropped bytes: ").append(stats.droppedBytes).append("\n");
+	status.append("RAM ring: ").append(stats.ramBytes).append(" / ").append(P1_CAPTURE_RAM_SIZE).append(" bytes\n");
+	status.append("File: ").append(stats.fileBytes).append(" / ").append(P1_CAPTURE_FILE_MAX).append(" bytes\n");
+	status.append("Replay: ").append(stats.replayActive ? "running" : "idle");
+	status.append(" (").append(stats.replaySpeed == P1_REPLAY_MAX ? "max" : "recorded").append(" speed)\n");
+	status.append("Replay bytes: ").append(stats.replayBytes).append(", telegrams: ").append(stats.replayTelegrams).append("\n");
+	status.append("Replay elapsed: ").append(stats.replayElapsedUs).append(" us, in pipeline: ").append(stats.replayBusyUs).append(" us\n");
+	if (stats.replayBusyUs > 0) {
+		uint64_t bytesPerSecond = (uint64_t)stats.replayBytes * 1000000 / stats.replayBusyUs;
+		uint64_t telegramsPerSecond = (uint64_t)stats.replayTelegrams * 1000000 / stats.replayBusyUs;
+		status.append("Pipeline throughput: ").append((unsigned long)bytesPerSecond).append(" bytes/s, ").append((unsigned long)telegramsPerSecond).append(" telegrams/s\n");
+	}
+}
+
+void handleCaptureRequest(EthernetClient& client, const char* path) {
+	bool ok = true;
+	if (matchHTTPPath(path, "/capture/start")) {
+		ok = startP1Capture(strcmp(getQueryParameter(path, "mode"), "file") == 0 ? P1_CAPTURE_FILE : P1_CAPTURE_RAM);
+	} else if (matchHTTPPath(path, "/capture/stop")) {
+		stopP1Capture();
+	} else if (matchHTTPPath(path, "/capture/replay")) {
+		P1ReplaySpeed speed = strcmp(getQueryParameter(path, "speed"), "max") == 0 ? P1_REPLAY_MAX : P1_REPLAY_RECORDED;
+		const char* repeat = getQueryParameter(path, "repeat");
+		ok = startP1Replay(parseCaptureSource(path), speed, repeat[0] ? atoi(repeat) : 1);
+	} else if (matchHTTPPath(path, "/capture/replay/stop")) {
+		stopP1Replay();
+	}
+
+	StringBuilder& status = beginHTTPPage();
+	if (!ok) {
+		status.append("Not possible now: stop the running capture/replay first, or there is nothing captured\n\n");
+	}
+	appendCaptureStatus(status);
+	sendHTTPResponse(client, ok ? 200 : 409, "text/plain", status);
+}
+
+bool startCaptureDownload(EthernetClient& client, const char* path) {
+	CaptureDownload& download = captureDownload;
+	if (download.active || !openP1CaptureReader(download.reader, parseCaptureSource(path))) {
+		StringBuilder& message = beginHTTPPage();
+		message.append("Nothing to download: capture still running, empty, or another download in progress\n");
+		sendHTTPResponse(client, 409, "text/plain", message);
+		return false;
+	}
+
+	sendHTTPHeaders(client, 200, "application/octet-stream", download.reader.size);
+	download.client = client;
+	download.active = true;
+	download.lastProgress = millis();
+	REMOTE_LOG_DEBUG("Capture: download started, bytes:", (unsigned long)download.reader.size);
+	return true;
+}
+
+bool isCaptureDownloadActive() {
+	return captureDownload.active;
+}
+
+void handleCaptureDownload() {
+	HEAP_TAG_SCOPE(HEAP_TAG_CAPTURE);
+	CaptureDownload& download = captureDownload;
+	if (!download.active) return;
+
+	bool finished = !download.client.connected();
+	if (!finished && download.client.availableForWrite() >= CAPTURE_DOWNLOAD_CHUNK_SIZE) {
+		uint8_t chunk[CAPTURE_DOWNLOAD_CHUNK_SIZE];
+		size_t length = readP1Capture(download.reader, chunk, sizeof(chunk));
+		if (length > 0) {
+			download.client.write(chunk, length);
+			download.lastProgress = millis();
+		}
+		finished = download.reader.position >= download.reader.size || length == 0;
+	} else if (millis() - download.lastProgress > HTTP_STREAM_TIMEOUT) {
+		finished = true;
+	}
+
+	if (finished) {
+		download.client.stop();
+		download.active = false;
+		REMOTE_LOG_DEBUG("Capture: download finished, bytes:", (unsigned long)download.reader.position);
+	}
+}
@@ -0,0 +1,220 @@
+#include "web/http_request.h"
+
+HTTPArena::HTTPArena(char* buffer, size_t capacity)
+	: data(buffer), size(capacity), top(0), highWater(0), failed(false) {
+}
+
+char* HTTPArena::allocate(size_t length) {
+	if (length > size - top) {
+		failed = true;
+		return nullptr;
+	}
+	char* block = data + top;
+	top += length;
+	if (top > highWater) highWater = top;
+	return block;
+}
+
+const char* HTTPArena::copy(const char* text, size_t length) {
+	char* block = allocate(length + 1);
+	if (!block) return nullptr;
+	memcpy(block, text, length);
+	block[length] = '\0';
+	return block;
+}
+
+void HTTPArena::reset() {
+	top = 0;
+	failed = false;
+}
+
+HTTPRequestParser::HTTPRequestParser(HTTPArena& requestArena) : arena(requestArena) {
+	reset();
+}
+
+void HTTPRequestParser::reset() {
+	memset(&parsed, 0, sizeof(parsed));
+	state = HTTP_PARSE_REQUEST_LINE;
+	error = 0;
+	lineLength = 0;
+	headerBytes = 0;
+	remaining = 0;
+	bodyBuffer = nullptr;
+}
+
+HTTPParseState HTTPRequestParser::fail(int status) {
+	error = status;
+	state = HTTP_PARSE_ERROR;
+	return state;
+}
+
+HTTPParseState HTTPRequestParser::feed(uint8_t c) {
+	switch (state) {
+		case HTTP_PARSE_COMPLETE:
+		case HTTP_PARSE_ERROR:
+			return state;
+
+		case HTTP_PARSE_BODY:
+			if (storeBody(c) == HTTP_PARSE_ERROR) return state;
+			if (--remaining == 0) state = HTTP_PARSE_COMPLETE;
+			return state;
+
+		case HTTP_PARSE_CHUNK_DATA:
+			if (storeBody(c) == HTTP_PARSE_ERROR) return state;
+			if (--remaining == 0) state = HTTP_PARSE_CHUNK_DATA_END;
+			return state;
+
+		default:
+			break;
+	}
+
+	// Everything else is line based
+	bool inHeaders = state == HTTP_PARSE_REQUEST_LINE || state == HTTP_PARSE_HEADER || state == HTTP_PARSE_TRAILER;
+	if (inHeaders && ++headerBytes > HTTP_REQUEST_HEADERS_MAX) {
+		return fail(431);
+	}
+	if (c == '\n') {
+		return endLine();
+	}
+	if (lineLength + 1 >= sizeof(line)) {
+		return fail(state == HTTP_PARSE_REQUEST_LINE ? 414 : inHeaders ? 431 : 400);
+	}
+	line[lineLength++] = (char)c;
+	return state;
+}
+
+HTTPParseState HTTPRequestParser::endLine() {
+	// Lines end in CRLF, but a bare LF is accepted too
+	while (lineLength > 0 && (line[lineLength - 1] == '\r' || line[lineLength - 1] == ' ' || line[lineLength - 1] == '\t')) {
+		lineLength--;
+	}
+	line[lineLength] = '\0';
+	bool empty = lineLength == 0;
+	lineLength = 0;
+
+	switch (state) {
+		case HTTP_PARSE_REQUEST_LINE:
+			// Empty lines before the request line are allowed
+			return empty ? state : parseRequestLine();
+		case HTTP_PARSE_HEADER:
+			return empty ? startBody() : parseHeader();
+		case HTTP_PARSE_CHUNK_SIZE:
+			return parseChunkSize();
+		case HTTP_PARSE_CHUNK_DATA_END:
+			if (!empty) return fail(400);
+			state = HTTP_PARSE_CHUNK_SIZE;
+			return state;
+		case HTTP_PARSE_TRAILER:
+			// Trailer fields are not used
+			if (empty) state = HTTP_PARSE_COMPLETE;
+			return state;
+		default:
+			return state;
+	}
+}
+
+// METHOD SP request-target [SP HTTP-version]
+HTTPParseState HTTPRequestParser::parseRequestLine() {
+	const char* target = strchr(line, ' ');
+	if (!target || target == line) return fail(400);
+	for (const char* p = line; p < target; p++) {
+		if (*p < 'A' || *p > 'Z') return fail(400);
+	}
+	target++;
+	if (*target != '/') return fail(400);
+
+	const char* version = strchr(target, ' ');
+	size_t targetLength = version ? (size_t)(version - target) : strlen(target);
+	if (version && strncmp(version + 1, "HTTP/", 5) != 0) return fail(400);
+	// HTTP/1.1 connections persist unless the client says otherwise
+	parsed.http11 = version && strcmp(version + 1, "HTTP/1.0") != 0;
+	parsed.keepAlive = parsed.http11;
+
+	parsed.method = arena.copy(line, target - 1 - line);
+	parsed.path = arena.copy(target, targetLength);
+	if (!parsed.method || !parsed.path) return fail(414);
+	state = HTTP_PARSE_HEADER;
+	return state;
+}
+
+HTTPParseState HTTPRequestParser::parseHeader() {
+	// Folded header lines are obsolete and not accepted
+	if (line[0] == ' ' || line[0] == '\t') return fail(400);
+	char* colon = strchr(line, ':');
+	if (!colon || colon == line) return fail(400);
+	*colon = '\0';
+	const char* value = colon + 1;
+	while (*value == ' ' || *value == '\t') value++;
+
+	if (strcasecmp(line, "Authorization") == 0) {
+		parsed.authorization = arena.copy(value, strlen(value));
+		if (!parsed.authorization) return fail(431);
+	} else if (strcasecmp(line, "If-None-Match") == 0) {
+		parsed.ifNoneMatch = arena.copy(value, strlen(value));
+		if (!parsed.ifNoneMatch) return fail(431);
+	} else if (strcasecmp(line, "Last-Event-ID") == 0) {
+		parsed.lastEventId = strtoul(value, nullptr, 10);
+	} else if (strcasecmp(line, "Upgrade") == 0) {
+		parsed.webSocketUpgrade = strcasecmp(value, "websocket") == 0;
+	} else if (strcasecmp(line, "Sec-WebSocket-Key") == 0) {
+		parsed.webSocketKey = arena.copy(value, strlen(value));
+		if (!parsed.webSocketKey) return fail(431);
+	} else if (strcasecmp(line, "Sec-WebSocket-Version") == 0) {
+		parsed.webSocketVersion13 = strcmp(value, "13") == 0;
+	} else if (strcasecmp(line, "Content-Length") == 0) {
+		if (!isdigit((unsigned char)value[0])) return fail(400);
+		char* end;
+		parsed.contentLength = strtoul(value, &end, 10);
+		if (*end != '\0') return fail(400);
+	} else if (strcasecmp(line, "Connection") == 0) {
+		if (strcasestr(value, "close")) {
+			parsed.keepAlive = false;
+		} else if (strcasestr(value, "keep-alive")) {
+			parsed.keepAlive = true;
+		}
+	} else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+		if (strcasecmp(value, "chunked") != 0) return fail(501);
+		parsed.chunked = true;
+	}
+	return state;
+}
+
+HTTPParseState HTTPRequestParser::parseChunkSize() {
+	// Hex size, optionally followed by ;extensions which are ignored
+	if (!isxdigit((unsigned char)line[0])) return fail(400);
+	char* end;
+	unsigned long size = strtoul(line, &end, 16);
+	if (*end != '\0' && *end != ';') return fail(400);
+	if (size > HTTP_REQUEST_BODY_MAX) return fail(413);
+	remaining = size;
+	state = size == 0 ? HTTP_PARSE_TRAILER : HTTP_PARSE_CHUNK_DATA;
+	return state;
+}
+
+HTTPParseState HTTPRequestParser::startBody() {
+	if (parsed.chunked) {
+		state = HTTP_PARSE_CHUNK_SIZE;
+	} else if (parsed.contentLength > 0) {
+		remaining = parsed.contentLength;
+		state = HTTP_PARSE_BODY;
+	} else {
+		state = HTTP_PARSE_COMPLETE;
+	}
+	return state;
+}
+
+HTTPParseState HTTPRequestParser::storeBody(uint8_t c) {
+	// The body buffer is taken from the arena with the first byte, so a
+	// caller can still hand a large body to its handler unread
+	if (!bodyBuffer) {
+		if (!parsed.chunked && parsed.contentLength > HTTP_REQUEST_BODY_MAX) return fail(413);
+		size_t size = parsed.chunked ? HTTP_REQUEST_BODY_MAX : parsed.contentLength;
+		bodyBuffer = arena.allocate(size + 1);
+		if (!bodyBuffer) return fail(413);
+		parsed.body = bodyBuffer;
+	}
+	if (parsed.bodyLength >= HTTP_REQUEST_BODY_MAX) return fail(413);
+	bodyBuffer[parsed.bodyLength++] = (char)c;
+	bodyBuffer[parsed.bodyLength] = '\0';
+	return state;
+}
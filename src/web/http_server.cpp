@@ -2,135 +2,402 @@
 #include "web/p1_web_handler.h"
 #include "web/logs_web_handler.h"
 #include "web/status_web_handler.h"
+#include "web/api_web_handler.h"
+#include "web/capture_web_handler.h"
+#include "web/websocket_handler.h"
+#include "web/metrics_web_handler.h"
+#include "clients.h"
+#include "log_server.h"
+#include "modbus_server.h"
 #include "ota_server.h"
 #include "custom_log.h"
 #include "ntp_client.h"
+#include "string_builder.h"
+#include "heap_telemetry.h"
+#include "stats.h"
 #include <Ethernet.h>
 #include <base64.h>
 
 // Global variables
 EthernetServer httpInfoServer(HTTP_INFO_PORT);
-unsigned long totalHTTPRequests = 0;
+
+enum HTTPConnectionState {
+	HTTP_CONN_FREE,
+	HTTP_CONN_READING,      // request arriving, parsed as bytes come in
+	HTTP_CONN_WRITING,      // response body going out as the socket takes it
+	HTTP_CONN_DRAINING      // response written, waiting for it to leave the socket
+};
+
+// Each connection moves through its states a step per loop() pass, so a slow
+// client only ever costs its own connection. Pages and JSON bodies are built
+// in the connection's own buffer and everything kept from the request lives
+// in its arena until the response has been written.
+struct HTTPConnection {
+	EthernetClient client;
+	HTTPConnectionState state;
+	unsigned long since;            // when the current state was entered, or last progress
+	FixedArena<HTTP_REQUEST_ARENA_SIZE> arena;
+	HTTPRequestParser parser;
+	char pageBuffer[HTTP_PAGE_BUFFER_SIZE];
+	StringBuilder page;
+	const uint8_t* body;            // response body left to the connection: the page or a web asset
+	size_t bodyLength;
+	size_t bodySent;                // bytes of body written so far
+	HTTPPageGenerator generator;    // response body produced part by part instead
+	uint16_t generatorPart;
+	bool keepAlive;                 // stays open after this response
+	bool headersSent;               // the response went through beginHTTPHeaders()
+	bool chunked;                   // the response body is sent with writeHTTPChunk()
+	uint16_t requests;              // requests served on this connection
+
+	HTTPConnection() : state(HTTP_CONN_FREE), since(0), parser(arena), page(pageBuffer, sizeof(pageBuffer)),
+		body(nullptr), bodyLength(0), bodySent(0), generator(nullptr), generatorPart(0), keepAlive(false), headersSent(false), chunked(false), requests(0) {}
+};
+
+static HTTPConnection httpConnections[MAX_HTTP_CONNECTIONS];
+static HTTPConnection* currentConnection = &httpConnections[0];    // the one being served
+static uint8_t nextHTTPConnection = 0;                              // round-robin start
+
+static void sendHTTPError(EthernetClient& client, int statusCode);
 
 void initializeHTTPInfoServer() {
 	if (HTTP_INFO_ENABLED) {
 		httpInfoServer.begin();
+		initializeP1EventStream();
+		initializeWebSockets();
+		initializeReadingAPI();
 		REMOTE_LOG_INFO("HTTP info server listening on port:", HTTP_INFO_PORT);
 	}
 }
 
-void handleHTTPInfoConnections() {
-	if (!HTTP_INFO_ENABLED) return;
+static void setConnectionState(HTTPConnection& connection, HTTPConnectionState state) {
+	connection.state = state;
+	connection.since = millis();
+}
+
+static void closeHTTPConnection(HTTPConnection& connection, const char* reason) {
+	connection.client.stop();
+	connection.arena.reset();
+	setConnectionState(connection, HTTP_CONN_FREE);
+	REMOTE_LOG_DEBUG("HTTP info client disconnected:", reason);
+}
+
+int getActiveHTTPConnectionCount() {
+	int active = 0;
+	for (int i = 0; i < MAX_HTTP_CONNECTIONS; i++) {
+		if (httpConnections[i].state != HTTP_CONN_FREE) active++;
+	}
+	return active;
+}
+
+// Sockets kept open by event streams and WebSockets after their request was answered
+static int getHTTPStreamCount() {
+	return getP1EventSubscriberCount() + getWebSocketClientCount();
+}
+
+// Beyond the one HTTP socket the budget guarantees, a connection is only
+// accepted while the P1, log and Modbus servers leave a socket unused. Background
+// downloads, event streams and WebSockets keep the socket of the connection they came from.
+// Publisher sockets are always counted, so a reconnect never finds them taken.
+static bool httpSocketAvailable() {
+	int used = (1 + getConnectedClientCount()) + (1 + getConnectedLogClientCount()) + PUBLISHER_SOCKETS;
+	if (MODBUS_ENABLED) used += 1 + getConnectedModbusClientCount();
+	used += getActiveHTTPConnectionCount() + (isHistoryStreamActive() ? 1 : 0) + (isCaptureDownloadActive() ? 1 : 0);
+	used += getHTTPStreamCount();
+	return used + 1 + W5500_RESERVED_SOCKETS <= W5500_SOCKETS;
+}
+
+bool httpStreamSocketAvailable() {
+	// Unlike a request, a stream does not give its socket back, so it may not
+	// borrow one from the P1, log or Modbus clients: with those servers full,
+	// this connection and the open streams must still fit
+	int used = (1 + MAX_CONNECTIONS) + (1 + MAX_LOG_CONNECTIONS) + PUBLISHER_SOCKETS + MODBUS_SOCKETS;
+	used += 1 + getHTTPStreamCount();
+	return used + W5500_RESERVED_SOCKETS <= W5500_SOCKETS;
+}
+
+// Wait for the next request on the same connection
+static void startHTTPRequest(HTTPConnection& connection) {
+	connection.arena.reset();
+	connection.parser.reset();
+	setConnectionState(connection, HTTP_CONN_READING);
+}
+
+static bool isIdleKeepAlive(const HTTPConnection& connection) {
+	return connection.state == HTTP_CONN_READING && connection.requests > 0 && connection.parser.idle();
+}
+
+static void acceptHTTPConnection() {
+	HTTPConnection* connection = nullptr;
+	HTTPConnection* idle = nullptr;
+	for (int i = 0; i < MAX_HTTP_CONNECTIONS && !connection; i++) {
+		if (httpConnections[i].state == HTTP_CONN_FREE) {
+			connection = &httpConnections[i];
+		} else if (!idle && isIdleKeepAlive(httpConnections[i])) {
+			idle = &httpConnections[i];
+		}
+	}
+	// Otherwise the browser waits in the W5500 until a connection frees up
+	if (connection ? !httpSocketAvailable() : !idle) return;
 
 	EthernetClient client = httpInfoServer.accept();
-	if (client) {
-		REMOTE_LOG_DEBUG("HTTP info client connected");
-		totalHTTPRequests++;
-		handleHTTPRequest(client);
-		client.stop();
-		REMOTE_LOG_DEBUG("HTTP info client disconnected");
-	}
-}
-
-void handleHTTPRequest(EthernetClient& client) {
-	String request = "";
-	String method = "";
-	String path = "";
-	bool isAuthorized = false;
-
-	// Read the HTTP request
-	unsigned long timeout = millis() + 5000; // 5 second timeout
-	while (client.connected() && millis() < timeout) {
-		if (client.available()) {
-			String line = client.readStringUntil('\n');
-			line.trim();
-
-			if (line.length() == 0) {
-				// End of headers
-				break;
-			}
+	if (!client) return;
+	if (!connection) {
+		// A new client beats one that is only keeping its connection open
+		closeHTTPConnection(*idle, "idle, slot needed");
+		connection = idle;
+	}
+	REMOTE_LOG_DEBUG("HTTP info client connected");
+	addStat(STAT_HTTP_CONNECTIONS);
+	connection->client = client;
+	connection->requests = 0;
+	startHTTPRequest(*connection);
+}
 
-			// Parse the first line which should contain the HTTP method and path
-			if (method.length() == 0 && (line.startsWith("GET ") || line.startsWith("POST ") || line.startsWith("HEAD ") || line.startsWith("PUT ") || line.startsWith("DELETE "))) {
-				// Parse the request line: METHOD path HTTP/1.1
-				int firstSpace = line.indexOf(' ');
-				int secondSpace = line.indexOf(' ', firstSpace + 1);
-
-				if (firstSpace > 0 && secondSpace > firstSpace) {
-					method = line.substring(0, firstSpace);
-					path = line.substring(firstSpace + 1, secondSpace);
-				} else if (firstSpace > 0) {
-					// Handle case where there might not be HTTP version
-					method = line.substring(0, firstSpace);
-					path = line.substring(firstSpace + 1);
-					// Remove any trailing whitespace or HTTP version info
-					int httpPos = path.indexOf(" HTTP/");
-					if (httpPos > 0) {
-						path = path.substring(0, httpPos);
-					}
-				}
-				
-				// Debug log the parsed line
-				REMOTE_LOG_DEBUG(("Parsed request line: " + line).c_str());
-				REMOTE_LOG_DEBUG(("Method: [" + method + "], Path: [" + path + "]").c_str());
-			}
+// Requests whose body goes to the handler as it arrives instead of into the arena
+static bool takesRawBody(const HTTPRequest& request) {
+	return strcmp(request.method, "POST") == 0 &&
+		(matchHTTPPath(request.path, "/upload") || matchHTTPPath(request.path, "/upload-firmware"));
+}
+
+// The response is out: keep the connection for the next request, or drain and close it
+static void endHTTPResponse(HTTPConnection& connection) {
+	if (connection.keepAlive && connection.headersSent) {
+		startHTTPRequest(connection);
+	} else {
+		setConnectionState(connection, HTTP_CONN_DRAINING);
+	}
+}
 
-			// Check for Authorization header (for OTA endpoints)
-			if (line.startsWith("Authorization: ")) {
-				REMOTE_LOG_DEBUG(("Auth header received: " + line).c_str());
-				if (verifyOTACredentials(line)) {
-					isAuthorized = true;
-					REMOTE_LOG_DEBUG("OTA credentials verified successfully");
-				} else {
-					REMOTE_LOG_DEBUG("OTA credentials verification failed");
-				}
+// Write the queued body, if the handler left one, then end the response
+static void finishHTTPResponse(HTTPConnection& connection) {
+	if (connection.body || connection.generator) {
+		connection.bodySent = 0;
+		setConnectionState(connection, HTTP_CONN_WRITING);
+	} else {
+		endHTTPResponse(connection);
+	}
+}
+
+static void readHTTPRequest(HTTPConnection& connection) {
+	HTTPRequestParser& parser = connection.parser;
+
+	// Parse what has arrived so far, without waiting for more
+	for (int budget = HTTP_PARSE_BUDGET; budget > 0; budget--) {
+		int c = connection.client.read();
+		if (c < 0) break;
+		parser.feed((uint8_t)c);
+		if (parser.complete() || parser.failed()) break;
+		if (parser.headersComplete() && takesRawBody(parser.request())) break;
+	}
+
+	connection.body = nullptr;
+	connection.generator = nullptr;
+	connection.headersSent = false;
+	connection.chunked = false;
+	connection.keepAlive = false;
+	if (parser.failed()) {
+		REMOTE_LOG_DEBUG("HTTP request rejected with status:", parser.errorStatus());
+		sendHTTPError(connection.client, parser.errorStatus());
+		finishHTTPResponse(connection);
+		return;
+	}
+
+	HTTPRequest& request = parser.request();
+	if (parser.complete() || (parser.headersComplete() && takesRawBody(request))) {
+		addStat(STAT_HTTP_REQUESTS);
+		connection.requests++;
+		connection.keepAlive = request.keepAlive && connection.requests < HTTP_KEEPALIVE_MAX_REQUESTS;
+		if (handleHTTPRequest(connection.client, request)) {
+			// A download owns the socket now and closes it when done
+			REMOTE_LOG_DEBUG("HTTP info client handed to a background download");
+			connection.client = EthernetClient();
+			connection.arena.reset();
+			setConnectionState(connection, HTTP_CONN_FREE);
+		} else {
+			finishHTTPResponse(connection);
+		}
+	} else if (!connection.client.connected()) {
+		closeHTTPConnection(connection, connection.parser.idle() ? "closed by client" : "closed before the request was complete");
+	} else if (isIdleKeepAlive(connection)) {
+		if (millis() - connection.since > HTTP_KEEPALIVE_TIMEOUT) {
+			closeHTTPConnection(connection, "keep-alive timeout");
+		}
+	} else if (millis() - connection.since > HTTP_REQUEST_TIMEOUT) {
+		sendHTTPError(connection.client, 408);
+		finishHTTPResponse(connection);
+	}
+}
+
+// Generate and send one part of a generated page; false once the page is complete
+static bool writeGeneratedPart(EthernetClient& client, HTTPPageGenerator generator, uint16_t& part) {
+	StringBuilder out(currentConnection->pageBuffer, HTTP_STREAM_CHUNK_SIZE + 1);
+	bool more = generator(out, part);
+	if (out.overflowed()) {
+		REMOTE_LOG_WARN("HTTP generated part cut off, part:", (int)part);
+	}
+	writeHTTPChunk(client, out.c_str(), out.length());
+	if (!more) {
+		endHTTPChunks(client);
+	}
+	return more;
+}
+
+static void writeHTTPResponse(HTTPConnection& connection) {
+	if (!connection.client.connected()) {
+		closeHTTPConnection(connection, "closed during the response");
+		return;
+	}
+
+	size_t room = (size_t)max(connection.client.availableForWrite(), 0);
+	if (connection.generator) {
+		// Only generate the next part once the socket can take all of it
+		if (room >= HTTP_STREAM_CHUNK_SIZE + 16) {
+			connection.since = millis();
+			if (!writeGeneratedPart(connection.client, connection.generator, connection.generatorPart)) {
+				connection.generator = nullptr;
+				endHTTPResponse(connection);
 			}
+		} else if (millis() - connection.since > HTTP_STREAM_TIMEOUT) {
+			closeHTTPConnection(connection, "response not taken");
 		}
+		return;
 	}
 
-	String logMsg = "HTTP Request: [" + method + "] [" + path + "]";
-	REMOTE_LOG_DEBUG(logMsg.c_str());
-	
-	// Debug: Check if method is empty
-	if (method.length() == 0) {
-		REMOTE_LOG_DEBUG("Warning: HTTP method is empty!");
-		method = "GET"; // Default to GET if parsing failed
-		if (path.length() == 0) {
-			path = "/"; // Default to root path
+	size_t left = connection.bodyLength - connection.bodySent;
+	if (room > 0) {
+		size_t length = min(left, room);
+		connection.client.write(connection.body + connection.bodySent, length);
+		connection.bodySent += length;
+		connection.since = millis();
+		if (connection.bodySent >= connection.bodyLength) {
+			endHTTPResponse(connection);
 		}
+	} else if (millis() - connection.since > HTTP_STREAM_TIMEOUT) {
+		closeHTTPConnection(connection, "response not taken");
 	}
+}
+
+static void drainHTTPConnection(HTTPConnection& connection) {
+	// Close once the peer has all of the response, so stop() neither cuts it
+	// off nor waits for a slow reader
+	for (int budget = HTTP_PARSE_BUDGET; budget > 0 && connection.client.read() >= 0; budget--) {
+		// Whatever else the client sends is dropped
+	}
+	if (!connection.client.connected()) {
+		closeHTTPConnection(connection, "closed by client");
+	} else if (connection.client.availableForWrite() >= W5500_SOCKET_TX_SIZE) {
+		closeHTTPConnection(connection, "done");
+	} else if (millis() - connection.since > HTTP_DRAIN_TIMEOUT) {
+		closeHTTPConnection(connection, "drain timeout");
+	}
+}
+
+void handleHTTPInfoConnections() {
+	HEAP_TAG_SCOPE(HEAP_TAG_HTTP);
+	if (!HTTP_INFO_ENABLED) return;
+	acceptHTTPConnection();
+}
+
+void handleHTTPInfoClients() {
+	HEAP_TAG_SCOPE(HEAP_TAG_HTTP);
+
+	// Round-robin, starting one further every pass
+	for (int i = 0; i < MAX_HTTP_CONNECTIONS; i++) {
+		HTTPConnection& connection = httpConnections[(nextHTTPConnection + i) % MAX_HTTP_CONNECTIONS];
+		currentConnection = &connection;
+		switch (connection.state) {
+			case HTTP_CONN_READING:
+				readHTTPRequest(connection);
+				break;
+			case HTTP_CONN_WRITING:
+				writeHTTPResponse(connection);
+				break;
+			case HTTP_CONN_DRAINING:
+				drainHTTPConnection(connection);
+				break;
+			default:
+				break;
+		}
+	}
+	nextHTTPConnection = (nextHTTPConnection + 1) % MAX_HTTP_CONNECTIONS;
+}
+
+bool handleHTTPRequest(EthernetClient& client, HTTPRequest& request) {
+	// Check for Authorization header (for OTA endpoints)
+	if (request.authorization) {
+		REMOTE_LOG_DEBUG("Auth header received:", request.authorization);
+		request.authorized = verifyOTACredentials(request.authorization);
+		if (request.authorized) {
+			REMOTE_LOG_DEBUG("OTA credentials verified successfully");
+		} else {
+			REMOTE_LOG_DEBUG("OTA credentials verification failed");
+		}
+	}
+	const char* method = request.method;
+	const char* path = request.path;
+	bool isAuthorized = request.authorized;
+
+	FixedString<LOG_MESSAGE_SIZE> logMsg;
+	logMsg.append("HTTP Request: [").append(method).append("] [").append(path).append("]");
+	REMOTE_LOG_DEBUG(logMsg.c_str());
 
 	// Route requests to appropriate handlers
-	if (method == "GET") {
-		if (path == "/" || path == "/info") {
+	if (strcmp(method, "GET") == 0) {
+		const WebAsset* asset = nullptr;
+		if (matchHTTPPath(path, "/") || matchHTTPPath(path, "/info")) {
 			sendInfoPage(client);
-		} else if (path == "/p1") {
-			sendP1DataPage(client);
-		} else if (path == "/p1/stream") {
-			sendP1DataStream(client);
-		} else if (path == "/logs") {
-			sendLogsPage(client);
-		} else if (path == "/logs/stream") {
+		} else if (matchHTTPPath(path, "/p1")) {
+			sendHTTPAsset(client, request, *findWebAsset("/p1.html"));
+		} else if (matchHTTPPath(path, "/p1/stream")) {
+			return startP1EventStream(client, request);
+		} else if (matchHTTPPath(path, "/ws")) {
+			return startWebSocket(client, request);
+		} else if (matchHTTPPath(path, "/logs")) {
+			sendHTTPAsset(client, request, *findWebAsset("/logs.html"));
+		} else if ((asset = findWebAsset(path)) != nullptr) {
+			sendHTTPAsset(client, request, *asset);
+		} else if (matchHTTPPath(path, "/logs/stream")) {
 			sendLogsDataStream(client);
-		} else if (path == "/ota" || path == "/upload") {
+		} else if (matchHTTPPath(path, "/ota") || matchHTTPPath(path, "/upload")) {
 			if (isAuthorized) {
 				// Generate OTA upload page
-				String uploadPage = generateOTAUploadPage();
+				StringBuilder& uploadPage = beginHTTPPage();
+				buildOTAUploadPage(uploadPage);
 				sendHTTPResponse(client, 200, "text/html", uploadPage);
 			} else {
 				sendUnauthorizedResponse(client, "OTA Access");
 			}
-		} else if (path == "/status") {
+		} else if (matchHTTPPath(path, "/status")) {
 			handleStatusPage(client);
+		} else if (matchHTTPPath(path, "/metrics")) {
+			sendMetrics(client);
+		} else if (matchHTTPPath(path, "/api/v1/reading")) {
+			sendReadingJSON(client);
+		} else if (matchHTTPPath(path, "/api/aggregates")) {
+			sendAggregatesJSON(client, path);
+		} else if (matchHTTPPath(path, "/api/history")) {
+			return startHistoryStream(client, path);
+		} else if (matchHTTPPath(path, "/capture/download")) {
+			return startCaptureDownload(client, path);
+		} else if (matchHTTPPath(path, "/capture")) {
+			handleCaptureRequest(client, path);
+		} else if (strncmp(path, "/capture/", 9) == 0) {
+			if (isAuthorized) {
+				handleCaptureRequest(client, path);
+			} else {
+				sendUnauthorizedResponse(client, "Serial Capture");
+			}
 		} else {
 			// 404 Not Found
-			String content = "<!DOCTYPE html><html><head><title>404 Not Found</title></head>";
-			content += "<body><h1>404 Not Found</h1><p>The requested resource was not found.</p>";
-			content += "<p><a href=\"/\">Return to main page</a></p></body></html>";
+			StringBuilder& content = beginHTTPPage();
+			content.append("<!DOCTYPE html><html><head><title>404 Not Found</title></head>");
+			content.append("<body><h1>404 Not Found</h1><p>The requested resource was not found.</p>");
+			content.append("<p><a href=\"/\">Return to main page</a></p></body></html>");
 			sendHTTPResponse(client, 404, "text/html", content);
 		}
-	} else if (method == "POST") {
-		if (path == "/upload" || path == "/upload-firmware") {
+	} else if (strcmp(method, "POST") == 0) {
+		if (matchHTTPPath(path, "/upload") || matchHTTPPath(path, "/upload-firmware")) {
 			// Handle OTA upload
 			if (isAuthorized) {
 				handleOTAUpload(client);
@@ -138,122 +405,260 @@ void handleHTTPRequest(EthernetClient& client) {
 				sendUnauthorizedResponse(client, "OTA Upload");
 			}
 		} else {
-			sendHTTPResponse(client, 404, "text/html", "Not Found");
+			sendHTTPResponse(client, 404, "text/html", beginHTTPPage().append("Not Found"));
 		}
 	} else {
 		// Handle unsupported methods or parsing errors - default to showing main page
-		REMOTE_LOG_DEBUG(("Unsupported method or parsing error. Method: [" + method + "], treating as GET /").c_str());
+		REMOTE_LOG_DEBUG("Unsupported method or parsing error, treating as GET /. Method:", method);
 		sendInfoPage(client);
 	}
+	return false;
 }
 
-void sendHTTPResponse(EthernetClient& client, int statusCode, const String& contentType, const String& content) {
-	// Send headers without Content-Length to avoid mismatch issues
-	String headers = "HTTP/1.1 " + String(statusCode) + " OK\r\n";
-	headers += "Content-Type: " + contentType + "\r\n";
-	headers += "Connection: close\r\n";
-	headers += "Server: P1-Bridge/1.0\r\n";
-	headers += "\r\n";
-	
-	client.print(headers);
-	client.flush(); // Ensure headers are sent
-	
-	// Send content in smaller chunks to avoid buffer issues
-	const int chunkSize = 512;
-	int contentLen = content.length();
-	for (int i = 0; i < contentLen; i += chunkSize) {
-		String chunk = content.substring(i, min(i + chunkSize, contentLen));
-		client.print(chunk);
-		client.flush();
-		delay(1); // Small delay to prevent overwhelming the W5500
-	}
-}
-
-void sendUnauthorizedResponse(EthernetClient& client, const String& realm) {
-	String headers = "HTTP/1.1 401 Unauthorized\r\n";
-	headers += "WWW-Authenticate: Basic realm=\"" + realm + "\"\r\n";
-	headers += "Content-Type: text/html\r\n";
-	headers += "Connection: close\r\n";
-	headers += "Server: P1-Bridge/1.0\r\n";
-	headers += "\r\n";
-	
-	String authPage = "<!DOCTYPE html><html><head><title>401 Unauthorized</title></head>";
-	authPage += "<body><h1>401 Unauthorized</h1><p>Authentication required for " + realm + " access.</p>";
-	authPage += "<p>Please use credentials: <strong>admin</strong> / <strong>update123</strong></p>";
-	authPage += "<p><a href='/'>Back to main page</a></p></body></html>";
-	
-	client.print(headers);
-	client.print(authPage);
-}
-
-String getHTTPHeaders(int statusCode, const String& contentType, int contentLength) {
-	String headers = "HTTP/1.1 " + String(statusCode);
-	
+StringBuilder& beginHTTPPage() {
+	currentConnection->page.clear();
+	return currentConnection->page;
+}
+
+static const char* getHTTPStatusText(int statusCode) {
 	switch (statusCode) {
-		case 200: headers += " OK"; break;
-		case 404: headers += " Not Found"; break;
-		case 401: headers += " Unauthorized"; break;
-		case 500: headers += " Internal Server Error"; break;
-		default: headers += " Unknown"; break;
-	}
-	
-	headers += "\r\n";
-	headers += "Content-Type: " + contentType + "\r\n";
-	headers += "Connection: close\r\n";
-	headers += "Server: P1-Bridge/1.0\r\n";
-	
-	if (contentLength > 0) {
-		headers += "Content-Length: " + String(contentLength) + "\r\n";
-	}
-	
-	headers += "\r\n";
-	return headers;
-}
-
-unsigned long getHTTPRequestCount() {
-	return totalHTTPRequests;
-}
-
-String generateOTAUploadPage() {
-	String uploadPage = "<!DOCTYPE html><html><head><title>P1 Bridge OTA Update</title>";
-	uploadPage += "<style>";
-	uploadPage += "body { font-family: Arial, sans-serif; max-width: 600px; margin: 50px auto; padding: 20px; background-color: #f5f5f5; }";
-	uploadPage += ".container { background: white; padding: 30px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }";
-	uploadPage += "h1 { color: #2c3e50; border-bottom: 2px solid #3498db; padding-bottom: 10px; }";
-	uploadPage += "input[type=file] { margin: 10px 0; padding: 10px; border: 1px solid #ddd; border-radius: 5px; width: 100%; }";
-	uploadPage += "input[type=submit] { background: #e74c3c; color: white; padding: 12px 30px; border: none; border-radius: 5px; cursor: pointer; font-size: 16px; margin-top: 10px; }";
-	uploadPage += "input[type=submit]:hover { background: #c0392b; }";
-	uploadPage += ".warning { background: #fff3cd; border: 1px solid #ffeaa7; padding: 15px; border-radius: 5px; margin: 15px 0; }";
-	uploadPage += ".info { background: #d1ecf1; border: 1px solid #bee5eb; padding: 15px; border-radius: 5px; margin: 15px 0; }";
-	uploadPage += ".back-link { display: inline-block; margin-top: 20px; padding: 8px 16px; background: #3498db; color: white; text-decoration: none; border-radius: 5px; }";
-	uploadPage += ".back-link:hover { background: #2980b9; }";
-	uploadPage += "</style></head><body>";
-	uploadPage += "<div class='container'>";
-	uploadPage += "<h1>P1 Bridge Firmware Update</h1>";
-	uploadPage += "<div class='warning'><strong>WARNING:</strong> Only upload firmware files (.bin) specifically built for this device. Uploading incorrect firmware may brick the device!</div>";
-	uploadPage += "<div class='info'>";
-	uploadPage += "<h3>File Format Requirements</h3>";
-	uploadPage += "<p><strong>Required:</strong> Upload the <code>firmware.bin</code> file (NOT .elf or .uf2)</p>";
-	uploadPage += "<p><strong>Location:</strong> <code>.pio/build/waveshare_rp2040_zero/firmware.bin</code></p>";
-	uploadPage += "<p><strong>Size:</strong> Typical size is 150-200 KB for this project</p>";
-	uploadPage += "<p><strong>Build:</strong> Use <code>platformio run</code> to generate firmware.bin</p>";
-	uploadPage += "</div>";
-	uploadPage += "<form method='POST' action='/upload-firmware' enctype='multipart/form-data'>";
-	uploadPage += "<p><strong>Select firmware.bin file:</strong></p>";
-	uploadPage += "<input type='file' name='firmware' accept='.bin' required>";
-	uploadPage += "<br><input type='submit' value='Upload Firmware'>";
-	uploadPage += "</form>";
-	uploadPage += "<div class='info'>";
-	uploadPage += "<h3>Current Device Status</h3>";
-	uploadPage += "<p><strong>Current Time:</strong> " + getFormattedDateTime() + "</p>";
-	uploadPage += "<p><strong>Uptime:</strong> " + String(millis() / 1000) + " seconds</p>";
-	uploadPage += "<p><strong>Flash Size:</strong> 2MB (RP2040)</p>";
-	uploadPage += "<p><strong>Max Upload:</strong> " + String(OTA_MAX_FILE_SIZE / 1024) + " KB</p>";
-	uploadPage += "<p><strong>Board:</strong> Waveshare RP2040 Zero</p>";
-	uploadPage += "<p><strong>Firmware:</strong> P1 Bridge with SSE support</p>";
-	uploadPage += "</div>";
-	uploadPage += "<a href='/status' class='back-link'>Check OTA Status</a> ";
-	uploadPage += "<a href='/' class='back-link'>Main Page</a>";
-	uploadPage += "</div></body></html>";
-	return uploadPage;
+		case 200: return "OK";
+		case 302: return "Found";
+		case 304: return "Not Modified";
+		case 400: return "Bad Request";
+		case 404: return "Not Found";
+		case 408: return "Request Timeout";
+		case 409: return "Conflict";
+		case 401: return "Unauthorized";
+		case 413: return "Content Too Large";
+		case 414: return "URI Too Long";
+		case 431: return "Request Header Fields Too Large";
+		case 500: return "Internal Server Error";
+		case 501: return "Not Implemented";
+		case 503: return "Service Unavailable";
+		default: return "Unknown";
+	}
+}
+
+static void sendHTTPError(EthernetClient& client, int statusCode) {
+	StringBuilder& content = beginHTTPPage();
+	content.append(statusCode).append(' ').append(getHTTPStatusText(statusCode)).append('\n');
+	sendHTTPResponse(client, statusCode, "text/plain", content);
+}
+
+void sendHTTPResponse(EthernetClient& client, int statusCode, const char* contentType, const StringBuilder& content) {
+	if (content.overflowed()) {
+		REMOTE_LOG_WARN("HTTP response cut off at bytes:", (unsigned long)content.length());
+	}
+
+	// The body is complete before anything is sent, so its length is exact
+	sendHTTPHeaders(client, statusCode, contentType, content.length());
+	if (&content == &currentConnection->page && currentConnection->state == HTTP_CONN_READING) {
+		// The connection writes the page as the socket takes it
+		currentConnection->body = (const uint8_t*)content.c_str();
+		currentConnection->bodyLength = content.length();
+		return;
+	}
+	client.write((const uint8_t*)content.c_str(), content.length());
+}
+
+void sendHTTPGenerated(EthernetClient& client, int statusCode, const char* contentType, HTTPPageGenerator generator) {
+	sendHTTPHeaders(client, statusCode, contentType, HTTP_LENGTH_CHUNKED);
+	if (currentConnection->state == HTTP_CONN_READING) {
+		currentConnection->generator = generator;
+		currentConnection->generatorPart = 0;
+		return;
+	}
+	uint16_t part = 0;
+	while (writeGeneratedPart(client, generator, part)) {
+	}
+}
+
+void sendHTTPAsset(EthernetClient& client, const HTTPRequest& request, const WebAsset& asset) {
+	// If-None-Match may list several tags, quoted and maybe weak
+	bool cached = request.ifNoneMatch && (strstr(request.ifNoneMatch, asset.etag) || strcmp(request.ifNoneMatch, "*") == 0);
+
+	// A 304 carries the length the 200 would have had, and no body
+	FixedString<384> headers;
+	beginHTTPHeaders(headers, cached ? 304 : 200, cached ? nullptr : asset.contentType, asset.length);
+	headers.append("ETag: \"").append(asset.etag).append("\"\r\n");
+	headers.append(asset.immutable ? "Cache-Control: public, max-age=31536000, immutable\r\n" : "Cache-Control: no-cache\r\n");
+	if (!cached) {
+		headers.append("Content-Encoding: gzip\r\n");
+	}
+	headers.append("\r\n");
+	client.write((const uint8_t*)headers.c_str(), headers.length());
+	if (cached) return;
+
+	if (currentConnection->state == HTTP_CONN_READING) {
+		// Written from flash as the socket takes it
+		currentConnection->body = asset.data;
+		currentConnection->bodyLength = asset.length;
+		return;
+	}
+	client.write(asset.data, asset.length);
+}
+
+void sendUnauthorizedResponse(EthernetClient& client, const char* realm) {
+	StringBuilder& authPage = beginHTTPPage();
+	authPage.append("<!DOCTYPE html><html><head><title>401 Unauthorized</title></head>");
+	authPage.append("<body><h1>401 Unauthorized</h1><p>Authentication required for ").append(realm).append(" access.</p>");
+	authPage.append("<p>Please use credentials: <strong>admin</strong> / <strong>update123</strong></p>");
+	authPage.append("<p><a href='/'>Back to main page</a></p></body></html>");
+
+	FixedString<256> headers;
+	beginHTTPHeaders(headers, 401, "text/html", authPage.length());
+	headers.append("WWW-Authenticate: Basic realm=\"").append(realm).append("\"\r\n");
+	headers.append("\r\n");
+	client.write((const uint8_t*)headers.c_str(), headers.length());
+	client.write((const uint8_t*)authPage.c_str(), authPage.length());
+}
+
+void beginHTTPHeaders(StringBuilder& headers, int statusCode, const char* contentType, unsigned long contentLength) {
+	HTTPConnection& connection = *currentConnection;
+	bool serving = connection.state == HTTP_CONN_READING;
+	if (contentLength == HTTP_LENGTH_CHUNKED && !(serving && connection.parser.request().http11)) {
+		// HTTP/1.0 clients get the body up to the close instead
+		contentLength = HTTP_LENGTH_UNKNOWN;
+	}
+	// Without a length the end of the body is the end of the connection
+	bool keepAlive = serving && connection.keepAlive && contentLength != HTTP_LENGTH_UNKNOWN;
+	if (serving) {
+		connection.headersSent = true;
+		connection.keepAlive = keepAlive;
+		connection.chunked = contentLength == HTTP_LENGTH_CHUNKED;
+	}
+
+	headers.append("HTTP/1.1 ").append(statusCode).append(' ').append(getHTTPStatusText(statusCode)).append("\r\n");
+	if (contentType) {
+		headers.append("Content-Type: ").append(contentType).append("\r\n");
+	}
+	if (keepAlive) {
+		headers.append("Connection: keep-alive\r\n");
+		headers.append("Keep-Alive: timeout=").append(HTTP_KEEPALIVE_TIMEOUT / 1000).append(", max=").append(HTTP_KEEPALIVE_MAX_REQUESTS - connection.requests).append("\r\n");
+	} else {
+		headers.append("Connection: close\r\n");
+	}
+	headers.append("Server: P1-Bridge/1.0\r\n");
+	if (contentLength == HTTP_LENGTH_CHUNKED) {
+		headers.append("Transfer-Encoding: chunked\r\n");
+	} else if (contentLength != HTTP_LENGTH_UNKNOWN) {
+		headers.append("Content-Length: ").append(contentLength).append("\r\n");
+	}
+}
+
+void sendHTTPHeaders(EthernetClient& client, int statusCode, const char* contentType, unsigned long contentLength) {
+	FixedString<256> headers;
+	beginHTTPHeaders(headers, statusCode, contentType, contentLength);
+	headers.append("\r\n");
+	client.write((const uint8_t*)headers.c_str(), headers.length());
+}
+
+void writeHTTPChunk(EthernetClient& client, const char* data, size_t length) {
+	if (length == 0) return;
+	if (currentConnection->chunked) {
+		FixedString<12> size;
+		size.appendf("%x\r\n", (unsigned)length);
+		client.write((const uint8_t*)size.c_str(), size.length());
+	}
+	client.write((const uint8_t*)data, length);
+	if (currentConnection->chunked) {
+		client.write((const uint8_t*)"\r\n", 2);
+	}
+}
+
+void endHTTPChunks(EthernetClient& client) {
+	if (currentConnection->chunked) {
+		client.write((const uint8_t*)"0\r\n\r\n", 5);
+	}
+}
+
+bool matchHTTPPath(const char* path, const char* route) {
+	size_t length = strlen(route);
+	return strncmp(path, route, length) == 0 && (path[length] == '\0' || path[length] == '?');
+}
+
+const WebAsset* findWebAsset(const char* path) {
+	for (size_t i = 0; i < webAssetCount; i++) {
+		if (matchHTTPPath(path, webAssets[i].path)) return &webAssets[i];
+	}
+	return nullptr;
+}
+
+const char* getWebAssetVersion(const char* path) {
+	const WebAsset* asset = findWebAsset(path);
+	return asset ? asset->etag : "";
+}
+
+// Return the value of a query string parameter ("/path?name=value&..."), empty if absent
+const char* getQueryParameter(const char* path, const char* name) {
+	const char* query = strchr(path, '?');
+	if (!query) return "";
+
+	size_t nameLength = strlen(name);
+	const char* pos = query + 1;
+	while (*pos) {
+		const char* end = strchr(pos, '&');
+		if (!end) end = pos + strlen(pos);
+		if (strncmp(pos, name, nameLength) == 0 && pos[nameLength] == '=') {
+			const char* value = currentConnection->arena.copy(pos + nameLength + 1, end - pos - nameLength - 1);
+			return value ? value : "";
+		}
+		if (!*end) break;
+		pos = end + 1;
+	}
+	return "";
+}
+
+size_t getHTTPArenaPeak() {
+	size_t peak = 0;
+	for (int i = 0; i < MAX_HTTP_CONNECTIONS; i++) {
+		peak = max(peak, httpConnections[i].arena.peak());
+	}
+	return peak;
+}
+
+void buildOTAUploadPage(StringBuilder& uploadPage) {
+	uploadPage.append("<!DOCTYPE html><html><head><title>P1 Bridge OTA Update</title>");
+	uploadPage.append("<style>");
+	uploadPage.append("body { font-family: Arial, sans-serif; max-width: 600px; margin: 50px auto; padding: 20px; background-color: #f5f5f5; }");
+	uploadPage.append(".container { background: white; padding: 30px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }");
+	uploadPage.append("h1 { color: #2c3e50; border-bottom: 2px solid #3498db; padding-bottom: 10px; }");
+	uploadPage.append("input[type=file] { margin: 10px 0; padding: 10px; border: 1px solid #ddd; border-radius: 5px; width: 100%; }");
+	uploadPage.append("input[type=submit] { background: #e74c3c; color: white; padding: 12px 30px; border: none; border-radius: 5px; cursor: pointer; font-size: 16px; margin-top: 10px; }");
+	uploadPage.append("input[type=submit]:hover { background: #c0392b; }");
+	uploadPage.append(".warning { background: #fff3cd; border: 1px solid #ffeaa7; padding: 15px; border-radius: 5px; margin: 15px 0; }");
+	uploadPage.append(".info { background: #d1ecf1; border: 1px solid #bee5eb; padding: 15px; border-radius: 5px; margin: 15px 0; }");
+	uploadPage.append(".back-link { display: inline-block; margin-top: 20px; padding: 8px 16px; background: #3498db; color: white; text-decoration: none; border-radius: 5px; }");
+	uploadPage.append(".back-link:hover { background: #2980b9; }");
+	uploadPage.append("</style></head><body>");
+	uploadPage.append("<div class='container'>");
+	uploadPage.append("<h1>P1 Bridge Firmware Update</h1>");
+	uploadPage.append("<div class='warning'><strong>WARNING:</strong> Only upload firmware files (.bin) specifically built for this device. Uploading incorrect firmware may brick the device!</div>");
+	uploadPage.append("<div class='info'>");
+	uploadPage.append("<h3>File Format Requirements</h3>");
+	uploadPage.append("<p><strong>Required:</strong> Upload the <code>firmware.bin</code> file (NOT .elf or .uf2)</p>");
+	uploadPage.append("<p><strong>Location:</strong> <code>.pio/build/waveshare_rp2040_zero/firmware.bin</code></p>");
+	uploadPage.append("<p><strong>Size:</strong> Typical size is 150-200 KB for this project</p>");
+	uploadPage.append("<p><strong>Build:</strong> Use <code>platformio run</code> to generate firmware.bin</p>");
+	uploadPage.append("</div>");
+	uploadPage.append("<form method='POST' action='/upload-firmware' enctype='multipart/form-data'>");
+	uploadPage.append("<p><strong>Select firmware.bin file:</strong></p>");
+	uploadPage.append("<input type='file' name='firmware' accept='.bin' required>");
+	uploadPage.append("<br><input type='submit' value='Upload Firmware'>");
+	uploadPage.append("</form>");
+	uploadPage.append("<div class='info'>");
+	uploadPage.append("<h3>Current Device Status</h3>");
+	uploadPage.append("<p><strong>Current Time:</strong> ");
+	printFormattedDateTime(uploadPage);
+	uploadPage.append("</p>");
+	uploadPage.append("<p><strong>Uptime:</strong> ").append(millis() / 1000).append(" seconds</p>");
+	uploadPage.append("<p><strong>Flash Size:</strong> 2MB (RP2040)</p>");
+	uploadPage.append("<p><strong>Max Upload:</strong> ").append(OTA_MAX_FILE_SIZE / 1024).append(" KB</p>");
+	uploadPage.append("<p><strong>Board:</strong> Waveshare RP2040 Zero</p>");
+	uploadPage.append("<p><strong>Firmware:</strong> P1 Bridge with SSE support</p>");
+	uploadPage.append("</div>");
+	uploadPage.append("<a href='/status' class='back-link'>Check OTA Status</a> ");
+	uploadPage.append("<a href='/' class='back-link'>Main Page</a>");
+	uploadPage.append("</div></body></html>");
 }
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "web/metrics_web_handler.h"
+#include "web/http_server.h"
+#include "web/p1_web_handler.h"
+#include "web/websocket_handler.h"
+#include "clients.h"
+#include "p1_handler.h"
+#include "log_server.h"
+#include "ota_server.h"
+#include "history_store.h"
+#include "heap_telemetry.h"
+#include "diagnostics.h"
+#include "stats.h"
+#include "mqtt_client.h"
+#include "modbus_server.h"
+#include "string_builder.h"
+
+// One metric family: its HELP/TYPE lines and a sample per label value. A
+// reader returns false to leave a sample out (a phase the meter does not
+// send, an empty client slot).
+struct MetricFamily {
+	const char* name;
+	const char* type;                               // "counter", "gauge" or "histogram"
+	const char* help;
+	const char* label;                              // nullptr for a single sample
+	uint8_t samples;                                // histograms: buckets, +Inf, _sum and _count
+	const char* (*labelValue)(uint8_t index);       // nullptr: the index itself
+	uint8_t decimals;                               // fixed-point value (histograms: _sum only)
+	bool (*read)(uint8_t index, int64_t& value);
+};
+
+// Longest sample line: name, one label and a 64-bit value
+#define METRIC_SAMPLE_MAX       96
+#define METRIC_HEADER_MAX       192
+
+// Figures that take more than a load to read, taken once per scrape
+static struct {
+	StatsSnapshot stats;
+	P1FramerStats framer;
+	HeapSample heap;
+	HeapTelemetryStats heapStats;
+	HistoryStats history;
+	LoopTimeStats loopTime;
+} scrape;
+
+static void takeScrapeSnapshot() {
+	getStatsSnapshot(scrape.stats);
+	getP1FramerStats(scrape.framer);
+	sampleHeapTelemetry(scrape.heap);
+	getHeapTelemetryStats(scrape.heapStats);
+	getHistoryStats(scrape.history);
+	getLoopTimeStats(scrape.loopTime);
+}
+
+// Label values
+static const char* phaseLabel(uint8_t index) {
+	static const char* const phases[] = {"l1", "l2", "l3"};
+	return phases[index];
+}
+
+static const char* tariffLabel(uint8_t index) {
+	return index == 0 ? "1" : "2";
+}
+
+static const char* statLabel(uint8_t index) {
+	return getStatName((StatCounter)index);
+}
+
+static const char* heapTagLabel(uint8_t index) {
+	return getHeapTagName((HeapTag)index);
+}
+
+static const char* loopBucketLabel(uint8_t index) {
+	static const char* const bounds[LOOP_TIME_BUCKET_COUNT + 1] = {"0.0001", "0.0005", "0.001", "0.005", "0.01", "0.05", "0.1", "+Inf"};
+	return bounds[index];
+}
+
+// Bridge
+static bool readUptime(uint8_t, int64_t& v) { v = millis() / 1000; return true; }
+static bool readTelegrams(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_P1_TELEGRAMS]; return true; }
+static bool readUnchecked(uint8_t, int64_t& v) { v = scrape.framer.unchecked; return true; }
+static bool readCRCErrors(uint8_t, int64_t& v) { v = scrape.framer.crcErrors; return true; }
+static bool readAbandoned(uint8_t, int64_t& v) { v = scrape.framer.abandoned; return true; }
+static bool readSerialBytes(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_P1_BYTES_RECEIVED]; return true; }
+static bool readDiscardedBytes(uint8_t, int64_t& v) { v = scrape.framer.discardedBytes; return true; }
+static bool readTelegramAge(uint8_t, int64_t& v) {
+	if (scrape.stats.gauges[STAT_P1_LAST_TELEGRAM] == 0) return false;
+	v = millis() - scrape.stats.gauges[STAT_P1_LAST_TELEGRAM];
+	return true;
+}
+
+// P1 clients
+static bool readClients(uint8_t, int64_t& v) { v = getConnectedClientCount(); return true; }
+static bool readSentBytes(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_P1_BYTES_SENT]; return true; }
+static bool readBinaryFrames(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_P1_BINARY_FRAMES]; return true; }
+static bool readClientIdle(uint8_t i, int64_t& v) {
+	if (!clientConnected[i]) return false;
+	v = millis() - clientLastActivity[i];
+	return true;
+}
+static bool readClientSentBytes(uint8_t i, int64_t& v) {
+	if (!clientConnected[i]) return false;
+	v = clientBytesSent[i];
+	return true;
+}
+
+// Log, HTTP, streams, OTA
+static bool readLogClients(uint8_t, int64_t& v) { v = getConnectedLogClientCount(); return true; }
+static bool readLogMessages(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_LOG_MESSAGES]; return true; }
+static bool readLogBytes(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_LOG_BYTES_SENT]; return true; }
+static bool readHTTPRequests(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_HTTP_REQUESTS]; return true; }
+static bool readHTTPConnections(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_HTTP_CONNECTIONS]; return true; }
+static bool readHTTPOpen(uint8_t, int64_t& v) { v = getActiveHTTPConnectionCount(); return true; }
+static bool readEventSubscribers(uint8_t, int64_t& v) { v = getP1EventSubscriberCount(); return true; }
+static bool readEventSkipped(uint8_t, int64_t& v) { v = getSkippedP1EventCount(); return true; }
+static bool readWebSockets(uint8_t, int64_t& v) { v = getWebSocketClientCount(); return true; }
+static bool readWebSocketSkipped(uint8_t, int64_t& v) { v = getSkippedWebSocketMessageCount(); return true; }
+static bool readOTARequests(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_OTA_ATTEMPTS]; return true; }
+static bool readOTAUpdates(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_OTA_UPDATES]; return true; }
+static bool readMQTTConnected(uint8_t, int64_t& v) { v = isMQTTConnected() ? 1 : 0; return MQTT_ENABLED; }
+static bool readMQTTConnects(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_MQTT_CONNECTS]; return MQTT_ENABLED; }
+static bool readMQTTPublishes(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_MQTT_PUBLISHES]; return MQTT_ENABLED; }
+static bool readMQTTWrites(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_MQTT_WRITES]; return MQTT_ENABLED; }
+static bool readMQTTBytes(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_MQTT_BYTES_SENT]; return MQTT_ENABLED; }
+static bool readInfluxPoints(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_INFLUX_POINTS]; return INFLUX_ENABLED; }
+static bool readInfluxDropped(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_INFLUX_POINTS_DROPPED]; return INFLUX_ENABLED; }
+static bool readInfluxBatches(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_INFLUX_BATCHES]; return INFLUX_ENABLED; }
+static bool readInfluxErrors(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_INFLUX_ERRORS]; return INFLUX_ENABLED; }
+static bool readInfluxBytes(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_INFLUX_BYTES_SENT]; return INFLUX_ENABLED; }
+static bool readModbusClients(uint8_t, int64_t& v) { v = getConnectedModbusClientCount(); return MODBUS_ENABLED; }
+static bool readModbusRequests(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_MODBUS_REQUESTS]; return MODBUS_ENABLED; }
+static bool readModbusExceptions(uint8_t, int64_t& v) { v = scrape.stats.counters[STAT_MODBUS_EXCEPTIONS]; return MODBUS_ENABLED; }
+static bool readRate(uint8_t i, int64_t& v) { v = scrape.stats.rates[i]; return true; }
+
+// loop()
+static bool readLoopTime(uint8_t i, int64_t& v) {
+	if (i < LOOP_TIME_BUCKET_COUNT) {
+		v = scrape.loopTime.buckets[i];
+	} else if (i == LOOP_TIME_BUCKET_COUNT + 1) {
+		v = (int64_t)scrape.loopTime.totalUs;
+	} else {
+		v = scrape.loopTime.passes;     // +Inf and _count
+	}
+	return true;
+}
+static bool readLoopMax(uint8_t, int64_t& v) { v = scrape.loopTime.maxUs; return true; }
+
+// Memory
+static bool readHeapSize(uint8_t, int64_t& v) { v = scrape.heapStats.totalHeap; return true; }
+static bool readHeapFree(uint8_t, int64_t& v) { v = scrape.heap.freeHeap; return true; }
+static bool readHeapFreeMin(uint8_t, int64_t& v) { v = scrape.heapStats.minFreeHeap; return true; }
+static bool readHeapLargest(uint8_t, int64_t& v) { v = scrape.heap.largestFreeBlock; return true; }
+static bool readHeapAllocations(uint8_t i, int64_t& v) {
+	HeapTagStats stats;
+	getHeapTagStats((HeapTag)i, stats);
+	v = stats.allocations;
+	return true;
+}
+static bool readHeapAllocatedBytes(uint8_t i, int64_t& v) {
+	HeapTagStats stats;
+	getHeapTagStats((HeapTag)i, stats);
+	v = stats.bytes;
+	return true;
+}
+static bool readStackUsed(uint8_t i, int64_t& v) {
+	if (scrape.heapStats.stackSize[i] == 0) return false;
+	v = scrape.heap.stackUsed[i];
+	return true;
+}
+
+// History
+static bool readHistorySegments(uint8_t, int64_t& v) { v = scrape.history.segments; return true; }
+static bool readHistoryBytes(uint8_t, int64_t& v) { v = scrape.history.storedBytes; return true; }
+static bool readHistoryRecords(uint8_t, int64_t& v) { v = scrape.history.recordsAppended; return true; }
+static bool readHistoryFlashBytes(uint8_t, int64_t& v) { v = scrape.history.flashBytesWritten; return true; }
+static bool readHistoryErrors(uint8_t, int64_t& v) { v = scrape.history.writeErrors; return true; }
+
+// Meter, from the latest decoded telegram
+static bool readMeter(uint32_t field, int64_t source, int64_t& v) {
+	if (!(latestP1Reading.fields & field)) return false;
+	v = source;
+	return true;
+}
+static bool readTariff(uint8_t, int64_t& v) { return readMeter(P1_FIELD_TARIFF, latestP1Reading.tariff, v); }
+static bool readEnergyDelivered(uint8_t i, int64_t& v) { return readMeter(P1_FIELD_ENERGY_DELIVERED_T1 << i, latestP1Reading.energyDeliveredWh[i], v); }
+static bool readEnergyReturned(uint8_t i, int64_t& v) { return readMeter(P1_FIELD_ENERGY_RETURNED_T1 << i, latestP1Reading.energyReturnedWh[i], v); }
+static bool readPowerDelivered(uint8_t, int64_t& v) { return readMeter(P1_FIELD_POWER_DELIVERED, latestP1Reading.powerDeliveredW, v); }
+static bool readPowerReturned(uint8_t, int64_t& v) { return readMeter(P1_FIELD_POWER_RETURNED, latestP1Reading.powerReturnedW, v); }
+static bool readVoltage(uint8_t i, int64_t& v) { return readMeter(P1_FIELD_VOLTAGE_L1 << i, latestP1Reading.voltageDv[i], v); }
+static bool readCurrent(uint8_t i, int64_t& v) { return readMeter(P1_FIELD_CURRENT_L1 << i, latestP1Reading.currentMa[i], v); }
+static bool readPhaseDelivered(uint8_t i, int64_t& v) { return readMeter(P1_FIELD_POWER_DELIVERED_L1 << i, latestP1Reading.phasePowerDeliveredW[i], v); }
+static bool readPhaseReturned(uint8_t i, int64_t& v) { return readMeter(P1_FIELD_POWER_RETURNED_L1 << i, latestP1Reading.phasePowerReturnedW[i], v); }
+static bool readPowerFailures(uint8_t, int64_t& v) { return readMeter(P1_FIELD_POWER_FAILURES, latestP1Reading.powerFailures, v); }
+static bool readLongPowerFailures(uint8_t, int64_t& v) { return readMeter(P1_FIELD_LONG_POWER_FAILURES, latestP1Reading.longPowerFailures, v); }
+static bool readGas(uint8_t, int64_t& v) { return readMeter(P1_FIELD_GAS, latestP1Reading.gasDm3, v); }
+static bool readWater(uint8_t, int64_t& v) { return readMeter(P1_FIELD_WATER, latestP1Reading.waterDm3, v); }
+
+static const MetricFamily metricFamilies[] = {
+	{"p1_uptime_seconds", "gauge", "Seconds since boot", nullptr, 1, nullptr, 0, readUptime},
+	{"p1_telegrams_total", "counter", "Telegrams passed on to clients", nullptr, 1, nullptr, 0, readTelegrams},
+	{"p1_telegrams_unchecked_total", "counter", "Telegrams passed on without a checksum (DSMR 2.2)", nullptr, 1, nullptr, 0, readUnchecked},
+	{"p1_crc_errors_total", "counter", "Telegrams dropped for a CRC mismatch", nullptr, 1, nullptr, 0, readCRCErrors},
+	{"p1_telegrams_abandoned_total", "counter", "Partial telegrams dropped", nullptr, 1, nullptr, 0, readAbandoned},
+	{"p1_serial_bytes_total", "counter", "Bytes read from the meter", nullptr, 1, nullptr, 0, readSerialBytes},
+	{"p1_serial_discarded_bytes_total", "counter", "Meter bytes outside a telegram or in a dropped one", nullptr, 1, nullptr, 0, readDiscardedBytes},
+	{"p1_last_telegram_age_seconds", "gauge", "Seconds since the last meter data", nullptr, 1, nullptr, 3, readTelegramAge},
+
+	{"p1_clients", "gauge", "Connected P1 TCP clients", nullptr, 1, nullptr, 0, readClients},
+	{"p1_sent_bytes_total", "counter", "Telegram and binary frame bytes written to P1 TCP clients", nullptr, 1, nullptr, 0, readSentBytes},
+	{"p1_binary_frames_total", "counter", "Binary frames written to P1 clients in binary mode", nullptr, 1, nullptr, 0, readBinaryFrames},
+	{"p1_client_idle_seconds", "gauge", "Seconds since a P1 client slot last had traffic", "slot", MAX_CONNECTIONS, nullptr, 3, readClientIdle},
+	{"p1_client_sent_bytes", "gauge", "Bytes written to the client in a P1 slot since it connected", "slot", MAX_CONNECTIONS, nullptr, 0, readClientSentBytes},
+
+	{"p1_log_clients", "gauge", "Connected log clients", nullptr, 1, nullptr, 0, readLogClients},
+	{"p1_log_messages_total", "counter", "Log lines sent", nullptr, 1, nullptr, 0, readLogMessages},
+	{"p1_log_sent_bytes_total", "counter", "Log bytes written to log clients", nullptr, 1, nullptr, 0, readLogBytes},
+	{"p1_http_requests_total", "counter", "HTTP requests", nullptr, 1, nullptr, 0, readHTTPRequests},
+	{"p1_http_connections_total", "counter", "HTTP connections accepted", nullptr, 1, nullptr, 0, readHTTPConnections},
+	{"p1_http_connections", "gauge", "Open HTTP connections", nullptr, 1, nullptr, 0, readHTTPOpen},
+	{"p1_event_stream_subscribers", "gauge", "Clients on /p1/stream", nullptr, 1, nullptr, 0, readEventSubscribers},
+	{"p1_event_stream_skipped_total", "counter", "Telegrams not rendered for /p1/stream because both buffers were busy", nullptr, 1, nullptr, 0, readEventSkipped},
+	{"p1_websocket_clients", "gauge", "Clients on /ws", nullptr, 1, nullptr, 0, readWebSockets},
+	{"p1_websocket_skipped_total", "counter", "Messages not rendered for /ws because both buffers were busy", nullptr, 1, nullptr, 0, readWebSocketSkipped},
+	{"p1_ota_requests_total", "counter", "OTA upload attempts", nullptr, 1, nullptr, 0, readOTARequests},
+	{"p1_ota_updates_total", "counter", "Successful OTA updates", nullptr, 1, nullptr, 0, readOTAUpdates},
+	{"p1_mqtt_connected", "gauge", "1 while the MQTT broker session is up", nullptr, 1, nullptr, 0, readMQTTConnected},
+	{"p1_mqtt_connects_total", "counter", "MQTT broker sessions established", nullptr, 1, nullptr, 0, readMQTTConnects},
+	{"p1_mqtt_publishes_total", "counter", "MQTT PUBLISH packets sent", nullptr, 1, nullptr, 0, readMQTTPublishes},
+	{"p1_mqtt_writes_total", "counter", "Socket writes carrying MQTT PUBLISH packets", nullptr, 1, nullptr, 0, readMQTTWrites},
+	{"p1_mqtt_sent_bytes_total", "counter", "Bytes written to the MQTT broker", nullptr, 1, nullptr, 0, readMQTTBytes},
+	{"p1_influx_points_total", "counter", "InfluxDB points buffered", nullptr, 1, nullptr, 0, readInfluxPoints},
+	{"p1_influx_points_dropped_total", "counter", "InfluxDB points not delivered", nullptr, 1, nullptr, 0, readInfluxDropped},
+	{"p1_influx_batches_total", "counter", "InfluxDB buffers delivered", nullptr, 1, nullptr, 0, readInfluxBatches},
+	{"p1_influx_errors_total", "counter", "InfluxDB buffers that could not be delivered", nullptr, 1, nullptr, 0, readInfluxErrors},
+	{"p1_influx_sent_bytes_total", "counter", "Line protocol bytes sent to InfluxDB", nullptr, 1, nullptr, 0, readInfluxBytes},
+	{"p1_modbus_clients", "gauge", "Connected Modbus TCP clients", nullptr, 1, nullptr, 0, readModbusClients},
+	{"p1_modbus_requests_total", "counter", "Modbus TCP requests answered", nullptr, 1, nullptr, 0, readModbusRequests},
+	{"p1_modbus_exceptions_total", "counter", "Modbus TCP requests answered with an exception", nullptr, 1, nullptr, 0, readModbusExceptions},
+
+	{"p1_rate_per_second", "gauge", "Counter rate, exponentially weighted moving average", "counter", STAT_COUNTER_COUNT, statLabel, 3, readRate},
+
+	{"p1_loop_duration_seconds", "histogram", "Work time of a loop() pass", "le", LOOP_TIME_BUCKET_COUNT + 3, loopBucketLabel, 6, readLoopTime},
+	{"p1_loop_duration_max_seconds", "gauge", "Slowest loop() pass since boot", nullptr, 1, nullptr, 6, readLoopMax},
+
+	{"p1_heap_size_bytes", "gauge", "Heap size", nullptr, 1, nullptr, 0, readHeapSize},
+	{"p1_heap_free_bytes", "gauge", "Free heap", nullptr, 1, nullptr, 0, readHeapFree},
+	{"p1_heap_free_min_bytes", "gauge", "Lowest free heap seen", nullptr, 1, nullptr, 0, readHeapFreeMin},
+	{"p1_heap_largest_free_block_bytes", "gauge", "Largest free heap block", nullptr, 1, nullptr, 0, readHeapLargest},
+	{"p1_heap_allocations_total", "counter", "Heap allocations per subsystem", "subsystem", HEAP_TAG_COUNT, heapTagLabel, 0, readHeapAllocations},
+	{"p1_heap_allocated_bytes_total", "counter", "Bytes requested from the heap per subsystem", "subsystem", HEAP_TAG_COUNT, heapTagLabel, 0, readHeapAllocatedBytes},
+	{"p1_stack_used_bytes", "gauge", "Stack high-water mark per core", "core", 2, nullptr, 0, readStackUsed},
+
+	{"p1_history_segments", "gauge", "History segment files", nullptr, 1, nullptr, 0, readHistorySegments},
+	{"p1_history_stored_bytes", "gauge", "Bytes in history segment files", nullptr, 1, nullptr, 0, readHistoryBytes},
+	{"p1_history_records_total", "counter", "Minute records appended to the history", nullptr, 1, nullptr, 0, readHistoryRecords},
+	{"p1_history_flash_written_bytes_total", "counter", "Estimated flash bytes programmed by the history", nullptr, 1, nullptr, 0, readHistoryFlashBytes},
+	{"p1_history_write_errors_total", "counter", "Failed history writes", nullptr, 1, nullptr, 0, readHistoryErrors},
+
+	{"p1_meter_tariff", "gauge", "Active tariff", nullptr, 1, nullptr, 0, readTariff},
+	{"p1_meter_energy_delivered_kwh_total", "counter", "Energy delivered to the client", "tariff", 2, tariffLabel, 3, readEnergyDelivered},
+	{"p1_meter_energy_returned_kwh_total", "counter", "Energy returned by the client", "tariff", 2, tariffLabel, 3, readEnergyReturned},
+	{"p1_meter_power_delivered_watts", "gauge", "Power delivered", nullptr, 1, nullptr, 0, readPowerDelivered},
+	{"p1_meter_power_returned_watts", "gauge", "Power returned", nullptr, 1, nullptr, 0, readPowerReturned},
+	{"p1_meter_voltage_volts", "gauge", "Voltage per phase", "phase", 3, phaseLabel, 1, readVoltage},
+	{"p1_meter_current_amperes", "gauge", "Current per phase", "phase", 3, phaseLabel, 3, readCurrent},
+	{"p1_meter_phase_power_delivered_watts", "gauge", "Power delivered per phase", "phase", 3, phaseLabel, 0, readPhaseDelivered},
+	{"p1_meter_phase_power_returned_watts", "gauge", "Power returned per phase", "phase", 3, phaseLabel, 0, readPhaseReturned},
+	{"p1_meter_power_failures_total", "counter", "Power failures counted by the meter", nullptr, 1, nullptr, 0, readPowerFailures},
+	{"p1_meter_long_power_failures_total", "counter", "Long power failures counted by the meter", nullptr, 1, nullptr, 0, readLongPowerFailures},
+	{"p1_meter_gas_cubic_meters", "gauge", "Gas meter reading", nullptr, 1, nullptr, 3, readGas},
+	{"p1_meter_water_cubic_meters", "gauge", "Water meter reading", nullptr, 1, nullptr, 3, readWater},
+};
+
+#define METRIC_FAMILY_COUNT (sizeof(metricFamilies) / sizeof(metricFamilies[0]))
+
+// value / 10^decimals for 64-bit values (appendFixedPoint takes a long);
+// decimals stays below 10
+static void appendMetricValue(StringBuilder& out, int64_t value, uint8_t decimals) {
+	if (value < 0) {
+		out.append('-');
+		value = -value;
+	}
+	uint64_t scale = 1;
+	for (uint8_t i = 0; i < decimals; i++) {
+		scale *= 10;
+	}
+	out.append((unsigned long long)((uint64_t)value / scale));
+	if (decimals > 0) {
+		out.appendf(".%0*lu", (int)decimals, (unsigned long)((uint64_t)value % scale));
+	}
+}
+
+static void appendMetricFamily(StringBuilder& out, const MetricFamily& family) {
+	bool histogram = strcmp(family.type, "histogram") == 0;
+	out.append("# HELP ").append(family.name).append(' ').append(family.help).append('\n');
+	out.append("# TYPE ").append(family.name).append(' ').append(family.type).append('\n');
+	for (uint8_t i = 0; i < family.samples; i++) {
+		int64_t value;
+		if (!family.read(i, value)) continue;
+		uint8_t decimals = family.decimals;
+		out.append(family.name);
+		if (histogram) {
+			// Buckets up to +Inf, then _sum and _count
+			if (i == family.samples - 2) {
+				out.append("_sum ");
+				appendMetricValue(out, value, decimals);
+				out.append('\n');
+				continue;
+			}
+			if (i == family.samples - 1) {
+				out.append("_count ").append((unsigned long long)value).append('\n');
+				continue;
+			}
+			out.append("_bucket");
+			decimals = 0;
+		}
+		if (family.label) {
+			out.append('{').append(family.label).append("=\"");
+			if (family.labelValue) {
+				out.append(family.labelValue(i));
+			} else {
+				out.append(i);
+			}
+			out.append("\"}");
+		}
+		out.append(' ');
+		appendMetricValue(out, value, decimals);
+		out.append('\n');
+	}
+}
+
+// Whole families per part, as many as surely fit
+static bool generateMetrics(StringBuilder& out, uint16_t& part) {
+	if (part == 0) {
+		takeScrapeSnapshot();
+	}
+	do {
+		appendMetricFamily(out, metricFamilies[part]);
+		part++;
+	} while (part < METRIC_FAMILY_COUNT &&
+			 out.remaining() >= METRIC_HEADER_MAX + (size_t)metricFamilies[part].samples * METRIC_SAMPLE_MAX);
+	return part < METRIC_FAMILY_COUNT;
+}
+
+void sendMetrics(EthernetClient& client) {
+	sendHTTPGenerated(client, 200, "text/plain; version=0.0.4; charset=utf-8", generateMetrics);
+}
@@ -2,234 +2,229 @@
 #include "custom_log.h"
 #include "config.h"
 #include "ntp_client.h"
+#include "web/http_server.h"
+#include "p1_handler.h"
+#include "heap_telemetry.h"
+#include "clients.h"
+#include "stats.h"
 #include <Ethernet.h>
 
-// Extern declarations for global variables used from main
-extern String p1Buffer;
-extern bool p1MessageComplete;
-extern unsigned long lastP1DataReceived;
-extern unsigned long totalP1Messages;
-extern unsigned long totalBytesReceived;
-extern unsigned long getConnectedClientCount();
-extern bool isNTPTimeValid();
-
-void sendP1DataPage(EthernetClient& client) {
-	String content = "<!DOCTYPE html><html><head>";
-	content += "<title>P1 Data Stream - P1 Serial Bridge</title>";
-	content += "<meta charset='UTF-8'>";
-	// Removed auto-refresh meta tag - now using SSE
-	content += "<style>";
-	content += "body { font-family: 'Courier New', monospace; background: #1a1a1a; color: #00ff00; margin: 20px; }";
-	content += ".container { max-width: 1000px; margin: 0 auto; background: #000; padding: 20px; border-radius: 8px; border: 1px solid #333; }";
-	content += "h1 { color: #00ff00; text-align: center; margin-bottom: 20px; }";
-	content += ".status { background: #333; padding: 10px; margin: 10px 0; border-radius: 5px; }";
-	content += ".data-stream { background: #111; padding: 15px; border: 1px solid #333; border-radius: 5px; font-size: 12px; white-space: pre-wrap; }";
-	content += ".nav-link { display: inline-block; background: #333; color: #00ff00; padding: 8px 15px; text-decoration: none; margin: 5px; border-radius: 5px; }";
-	content += ".nav-link:hover { background: #555; }";
-	content += ".info { color: #ffff00; margin: 10px 0; }";
-	content += ".connection-status { color: #00ff00; font-size: 11px; margin-left: 10px; }";
-	content += ".online { color: #00ff00; }";
-	content += ".offline { color: #ff0000; }";
-	content += "</style>";
-	content += "<script>";
-	content += "let refreshTimer;";
-	content += "let isConnecting = false;";
-	content += "function fetchP1Data() {";
-	content += "  if(isConnecting) return;";
-	content += "  isConnecting = true;";
-	content += "  document.getElementById('connection-status').innerHTML = 'Updating...';";
-	content += "  document.getElementById('connection-status').className = 'connection-status online';";
-	content += "  ";
-	content += "  const eventSource = new EventSource('/p1/stream');";
-	content += "  const timeout = setTimeout(() => {";
-	content += "    eventSource.close();";
-	content += "    isConnecting = false;";
-	content += "    scheduleNext();";
-	content += "  }, 3000);";
-	content += "  ";
-	content += "  eventSource.addEventListener('p1data', function(e) {";
-	content += "    try {";
-	content += "      const data = JSON.parse(e.data);";
-	content += "      updateP1Display(data);";
-	content += "    } catch(err) {";
-	content += "      console.error('Error parsing P1 data:', err);";
-	content += "    }";
-	content += "  });";
-	content += "  ";
-	content += "  eventSource.addEventListener('heartbeat', function(e) {";
-	content += "    const data = JSON.parse(e.data);";
-	content += "    document.getElementById('connection-status').innerHTML = 'Live - Last update: ' + data.timestamp;";
-	content += "    document.getElementById('connection-status').className = 'connection-status online';";
-	content += "    clearTimeout(timeout);";
-	content += "    eventSource.close();";
-	content += "    isConnecting = false;";
-	content += "    scheduleNext();";
-	content += "  });";
-	content += "  ";
-	content += "  eventSource.onerror = function(e) {";
-	content += "    clearTimeout(timeout);";
-	content += "    eventSource.close();";
-	content += "    isConnecting = false;";
-	content += "    document.getElementById('connection-status').innerHTML = 'Connection error - Retrying...';";
-	content += "    document.getElementById('connection-status').className = 'connection-status offline';";
-	content += "    scheduleNext();";
-	content += "  };";
-	content += "}";
-	content += "function scheduleNext() {";
-	content += "  // Removed automatic refresh - SSE is now manual/on-demand only";
-	content += "  // refreshTimer = setTimeout(fetchP1Data, 3000);";
-	content += "}";
-	content += "function updateP1Display(data) {";
-	content += "  if(data.content) document.getElementById('p1-data').innerHTML = data.content;";
-	content += "  if(data.status) document.getElementById('status-info').innerHTML = data.status;";
-	content += "}";
-	content += "function refreshData() { fetchP1Data(); }"; // Manual refresh function
-	content += "window.onload = fetchP1Data;";
-	content += "window.onbeforeunload = function() { clearTimeout(refreshTimer); };";
-	content += "</script></head><body>";
-	content += "<div class='container'>";
-	content += "<h1>P1 Smart Meter Data Stream</h1>";
-	content += "<div class='status' id='status-info'>";
-	content += "<strong>Status:</strong> " + String(getConnectedClientCount()) + " clients connected to TCP port " + String(SERVER_PORT);
-	content += " | <strong>Current Time:</strong> " + getFormattedDateTime();
-	content += " | <strong>Uptime:</strong> " + String(millis() / 1000) + "s";
-	content += "</div>";
-	content += "<div class='info'>Current P1 smart meter data <span id='connection-status' class='connection-status'>Connecting...</span></div>";
-	content += "<div style='margin: 10px 0;'><button onclick='refreshData()' style='background: #21262d; color: #58a6ff; border: 1px solid #30363d; padding: 8px 15px; border-radius: 5px; cursor: pointer;'>Refresh Data</button></div>";
-	content += "<div class='data-display' id='p1-data'>";
-	// Show recent P1 data from buffer without disrupting TCP clients
-	content += "=== P1 DATA DIAGNOSTICS ===\n";
-	content += "Current time: " + getFormattedDateTime() + " (" + (isNTPTimeValid() ? "NTP synced" : "no NTP") + ")\n";
-	content += "p1MessageComplete: " + String(p1MessageComplete ? "true" : "false") + "\n";
-	content += "p1Buffer.length(): " + String(p1Buffer.length()) + "\n";
-	content += "totalP1Messages: " + String(totalP1Messages) + "\n";
-	content += "totalBytesReceived: " + String(totalBytesReceived) + "\n";
-	if (lastP1DataReceived > 0) {
-		content += "lastP1DataReceived: " + String((millis() - lastP1DataReceived) / 1000) + " seconds ago\n";
-	} else {
-		content += "lastP1DataReceived: never\n";
+// /p1/stream subscribers stay connected and get an event per telegram. The
+// event is rendered once when the telegram arrives and written to every
+// subscriber from loop() as its socket takes it. Two events are kept so a
+// subscriber still writing the previous one does not hold up the others.
+struct P1Event {
+	char text[P1_EVENT_BUFFER_SIZE];
+	size_t length;
+	unsigned long id;               // telegram number (STAT_P1_TELEGRAMS)
+};
+
+struct P1EventSubscriber {
+	EthernetClient client;
+	bool active;
+	unsigned long lastId;           // last event written completely
+	int8_t event;                   // p1Events index being written, -1 between events
+	size_t offset;                  // bytes of that event written
+	unsigned long lastProgress;
+	unsigned long lastWrite;
+};
+
+static P1Event p1Events[2];
+static int8_t latestP1Event = -1;
+static P1EventSubscriber p1Subscribers[MAX_P1_EVENT_CLIENTS];
+static unsigned long skippedP1Events = 0;
+
+static bool isP1EventInUse(int8_t event) {
+	for (int i = 0; i < MAX_P1_EVENT_CLIENTS; i++) {
+		if (p1Subscribers[i].active && p1Subscribers[i].event == event) return true;
 	}
-	content += "Connected P1 clients: " + String(getConnectedClientCount()) + "\n";
-	content += "System uptime: " + String(millis() / 1000) + " seconds\n\n";
-	
-	if (p1MessageComplete && p1Buffer.length() > 0) {
-		content += "=== LATEST P1 MESSAGE ===\n";
-		content += p1Buffer;
-	} else if (p1Buffer.length() > 0) {
-		content += "=== PARTIAL P1 DATA (incomplete) ===\n";
-		content += p1Buffer;
-	} else {
-		content += "=== NO P1 DATA AVAILABLE ===\n";
-		content += "Check:\n";
-		content += "1. P1 meter is connected and powered\n";
-		content += "2. Serial connection (GPIO0/1 at 115200 baud)\n";
-		content += "3. Level shifting circuit (5V -> 3.3V)\n";
-		content += "4. P1 data request pin if used\n";
+	return false;
+}
+
+// Telegram callback: render the event into the buffer no subscriber is writing
+static void publishP1Event(const String& telegram, const P1Reading* reading) {
+	(void)reading;
+	int8_t target = latestP1Event == 0 ? 1 : 0;
+	if (isP1EventInUse(target)) {
+		// A slow subscriber still has the older one; nobody is writing the latest
+		// (or it would be in use as well), so it can be replaced
+		target = latestP1Event;
+		if (target < 0 || isP1EventInUse(target)) {
+			// Both buffers are being written; subscribers get the next telegram
+			skippedP1Events++;
+			return;
+		}
 	}
-	content += "</div>";
-	content += "<div style='text-align: center; margin-top: 20px;'>";
-	content += "<a href='/' class='nav-link'>Main Page</a>";
-	content += "<a href='/logs' class='nav-link'>View Logs</a>";
-	content += "<a href='/status' class='nav-link'>OTA Status</a>";
-	content += "</div>";
-	content += "<div style='text-align: center; margin-top: 15px; color: #666; font-size: 11px;'>";
-	content += "For direct TCP connection: <code style='color: #00ff00;'>telnet " + Ethernet.localIP().toString() + " " + String(SERVER_PORT) + "</code>";
-	content += "</div>";
-	content += "</div></body></html>";
-	
-	// Send response using HTTP server utility
-	extern void sendHTTPResponse(EthernetClient& client, int statusCode, const String& contentType, const String& content);
-	sendHTTPResponse(client, 200, "text/html", content);
+
+	P1Event& event = p1Events[target];
+	StringBuilder text(event.text, sizeof(event.text));
+	event.id = getStat(STAT_P1_TELEGRAMS);
+	text.append("id: ").append(event.id).append("\nevent: p1data\ndata: ");
+	buildCurrentP1DataJSON(text);
+	text.append("\n\n");
+	if (text.overflowed()) {
+		REMOTE_LOG_WARN("SSE: telegram event too large, bytes:", (unsigned long)telegram.length());
+		return;
+	}
+	event.length = text.length();
+	latestP1Event = target;
 }
 
-void sendP1DataStream(EthernetClient& client) {
-	// Send SSE headers
-	String headers = "HTTP/1.1 200 OK\r\n";
-	headers += "Content-Type: text/event-stream\r\n";
-	headers += "Cache-Control: no-cache\r\n";
-	headers += "Connection: keep-alive\r\n";
-	headers += "Access-Control-Allow-Origin: *\r\n";
-	headers += "\r\n";
-	client.print(headers);
-	
-	// Send initial data and close - non-blocking approach
-	String currentP1Data = getCurrentP1DataJSON();
-	client.print("event: p1data\n");
-	client.print("data: ");
-	client.print(currentP1Data);
-	client.print("\n\n");
-	
-	// Send heartbeat with current time
-	client.print("event: heartbeat\n");
-	client.print("data: {\"timestamp\":\"");
-	client.print(getFormattedDateTime());
-	client.print("\"}\n\n");
-	client.flush();
-	
-	// Note: We're NOT using a blocking while loop here
-	// Instead, we send current data and let the browser reconnect for updates
-	// This prevents blocking the main loop which reads P1 data
-	
-	REMOTE_LOG_DEBUG("SSE: Sent P1 data snapshot, closing connection to prevent blocking");
+void initializeP1EventStream() {
+	addP1TelegramCallback(publishP1Event);
+}
+
+bool startP1EventStream(EthernetClient& client, const HTTPRequest& request) {
+	P1EventSubscriber* subscriber = nullptr;
+	for (int i = 0; i < MAX_P1_EVENT_CLIENTS && !subscriber; i++) {
+		if (!p1Subscribers[i].active) subscriber = &p1Subscribers[i];
+	}
+	if (!subscriber || !httpStreamSocketAvailable()) {
+		// EventSource retries on its own
+		StringBuilder& message = beginHTTPPage();
+		message.append(subscriber ? "No socket left for a P1 event stream\n" : "Too many P1 event stream subscribers\n");
+		sendHTTPResponse(client, 503, "text/plain", message);
+		return false;
+	}
+
+	// The stream ends when either side closes
+	FixedString<384> headers;
+	beginHTTPHeaders(headers, 200, "text/event-stream", HTTP_LENGTH_UNKNOWN);
+	headers.append("Cache-Control: no-cache\r\n");
+	headers.append("Access-Control-Allow-Origin: *\r\n");
+	headers.append("\r\n");
+	headers.append("retry: 3000\n\n");
+	client.write((const uint8_t*)headers.c_str(), headers.length());
+
+	subscriber->client = client;
+	subscriber->active = true;
+	// A reconnecting browser that already has the latest telegram waits for
+	// the next one; anyone else gets the latest right away
+	subscriber->lastId = request.lastEventId;
+	subscriber->event = -1;
+	subscriber->offset = 0;
+	subscriber->lastProgress = millis();
+	subscriber->lastWrite = millis();
+	REMOTE_LOG_DEBUG("SSE: P1 subscriber connected, Last-Event-ID:", request.lastEventId);
+	return true;
+}
+
+static void closeP1Subscriber(P1EventSubscriber& subscriber, const char* reason) {
+	subscriber.client.stop();
+	subscriber.active = false;
+	subscriber.event = -1;
+	REMOTE_LOG_DEBUG("SSE: P1 subscriber disconnected:", reason);
 }
 
-String getCurrentP1DataJSON() {
-	String json = "{";
+static void writeP1Events(P1EventSubscriber& subscriber) {
+	if (!subscriber.client.connected()) {
+		closeP1Subscriber(subscriber, "closed by client");
+		return;
+	}
+	// Nothing comes from the browser after the request, but keep the socket clear
+	while (subscriber.client.read() >= 0) {
+	}
+
+	if (subscriber.event < 0 && latestP1Event >= 0 && p1Events[latestP1Event].id != subscriber.lastId) {
+		subscriber.event = latestP1Event;
+		subscriber.offset = 0;
+		subscriber.lastProgress = millis();
+	}
+
+	size_t room = (size_t)max(subscriber.client.availableForWrite(), 0);
+	if (subscriber.event >= 0) {
+		const P1Event& event = p1Events[subscriber.event];
+		size_t length = min(event.length - subscriber.offset, room);
+		if (length > 0) {
+			subscriber.client.write((const uint8_t*)event.text + subscriber.offset, length);
+			subscriber.offset += length;
+			subscriber.lastProgress = millis();
+			subscriber.lastWrite = millis();
+			if (subscriber.offset >= event.length) {
+				subscriber.lastId = event.id;
+				subscriber.event = -1;
+			}
+		} else if (millis() - subscriber.lastProgress > P1_EVENT_STALL_TIMEOUT) {
+			closeP1Subscriber(subscriber, "stalled");
+		}
+	} else if (millis() - subscriber.lastWrite > P1_EVENT_KEEPALIVE && room >= 2) {
+		// Comment line: keeps proxies from timing out and finds dead peers
+		subscriber.client.write((const uint8_t*)":\n", 2);
+		subscriber.lastWrite = millis();
+	}
+}
+
+void handleP1EventStreams() {
+	HEAP_TAG_SCOPE(HEAP_TAG_HTTP);
+	for (int i = 0; i < MAX_P1_EVENT_CLIENTS; i++) {
+		if (p1Subscribers[i].active) {
+			writeP1Events(p1Subscribers[i]);
+		}
+	}
+}
+
+uint8_t getP1EventSubscriberCount() {
+	uint8_t count = 0;
+	for (int i = 0; i < MAX_P1_EVENT_CLIENTS; i++) {
+		if (p1Subscribers[i].active) count++;
+	}
+	return count;
+}
+
+unsigned long getSkippedP1EventCount() {
+	return skippedP1Events;
+}
+
+void buildCurrentP1DataJSON(StringBuilder& json) {
+	json.append("{");
 	
 	// Build status information
-	json += "\"status\":\"";
-	json += "<strong>Status:</strong> " + String(getConnectedClientCount()) + " clients connected to TCP port " + String(SERVER_PORT);
-	json += " | <strong>Current Time:</strong> " + getFormattedDateTime();
-	json += " | <strong>Uptime:</strong> " + String(millis() / 1000) + "s";
-	json += "\",";
+	json.append("\"status\":\"");
+	json.append("<strong>Status:</strong> ").append(getConnectedClientCount()).append(" clients connected to TCP port ").append(SERVER_PORT);
+	json.append(" | <strong>Current Time:</strong> ");
+	printFormattedDateTime(json);
+	json.append(" | <strong>Uptime:</strong> ").append(millis() / 1000).append("s");
+	json.append("\",");
+	json.append("\"port\":").append(SERVER_PORT).append(",");
 	
-	// Build content with P1 data
-	json += "\"content\":\"";
-	String content = "=== P1 DATA DIAGNOSTICS ===\\n";
-	content += "Current time: " + getFormattedDateTime() + " (" + (isNTPTimeValid() ? "NTP synced" : "no NTP") + ")\\n";
-	content += "p1MessageComplete: " + String(p1MessageComplete ? "true" : "false") + "\\n";
-	content += "p1Buffer.length(): " + String(p1Buffer.length()) + "\\n";
-	content += "totalP1Messages: " + String(totalP1Messages) + "\\n";
-	content += "totalBytesReceived: " + String(totalBytesReceived) + "\\n";
-	if (lastP1DataReceived > 0) {
-		content += "lastP1DataReceived: " + String((millis() - lastP1DataReceived) / 1000) + " seconds ago\\n";
+	// Build content with P1 data; only the telegram itself needs JSON escaping
+	json.append("\"content\":\"");
+	StringBuilder& content = json;
+	content.append("=== P1 DATA DIAGNOSTICS ===\\n");
+	content.append("Current time: ");
+	printFormattedDateTime(content);
+	content.append(" (").append(isNTPTimeValid() ? "NTP synced" : "no NTP").append(")\\n");
+	content.append("p1MessageComplete: ").append(p1MessageComplete ? "true" : "false").append("\\n");
+	content.append("p1Buffer.length(): ").append(p1Buffer.length()).append("\\n");
+	StatsSnapshot stats;
+	getStatsSnapshot(stats);
+	content.append("P1 telegrams: ").append(stats.counters[STAT_P1_TELEGRAMS]).append(" (");
+	content.appendFixedPoint(stats.rates[STAT_P1_TELEGRAMS] * 60 / 100, 1).append("/min)\\n");
+	content.append("P1 bytes received: ").append(stats.counters[STAT_P1_BYTES_RECEIVED]).append(" (").append(stats.rates[STAT_P1_BYTES_RECEIVED] / 1000).append(" B/s)\\n");
+	if (stats.gauges[STAT_P1_LAST_TELEGRAM] > 0) {
+		content.append("Last telegram: ").append((millis() - stats.gauges[STAT_P1_LAST_TELEGRAM]) / 1000).append(" seconds ago\\n");
 	} else {
-		content += "lastP1DataReceived: never\\n";
+		content.append("Last telegram: never\\n");
 	}
-	content += "Connected P1 clients: " + String(getConnectedClientCount()) + "\\n";
-	content += "System uptime: " + String(millis() / 1000) + " seconds\\n\\n";
+	content.append("Connected P1 clients: ").append(getConnectedClientCount()).append("\\n");
+	content.append("System uptime: ").append(millis() / 1000).append(" seconds\\n\\n");
 	
 	if (p1MessageComplete && p1Buffer.length() > 0) {
-		content += "=== LATEST P1 MESSAGE ===\\n";
+		content.append("=== LATEST P1 MESSAGE ===\\n");
 		// Escape the P1 data for JSON
-		String escapedP1Data = p1Buffer;
-		escapedP1Data.replace("\\", "\\\\");
-		escapedP1Data.replace("\"", "\\\"");
-		escapedP1Data.replace("\r", "\\r");
-		escapedP1Data.replace("\n", "\\n");
-		content += escapedP1Data;
+		content.appendJSONEscaped(p1Buffer.c_str(), p1Buffer.length());
 	} else if (p1Buffer.length() > 0) {
-		content += "=== PARTIAL P1 DATA (incomplete) ===\\n";
-		String escapedP1Data = p1Buffer;
-		escapedP1Data.replace("\\", "\\\\");
-		escapedP1Data.replace("\"", "\\\"");
-		escapedP1Data.replace("\r", "\\r");
-		escapedP1Data.replace("\n", "\\n");
-		content += escapedP1Data;
+		content.append("=== PARTIAL P1 DATA (incomplete) ===\\n");
+		content.appendJSONEscaped(p1Buffer.c_str(), p1Buffer.length());
 	} else {
-		content += "=== NO P1 DATA AVAILABLE ===\\n";
-		content += "Check:\\n";
-		content += "1. P1 meter is connected and powered\\n";
-		content += "2. Serial connection (GPIO0/1 at 115200 baud)\\n";
-		content += "3. Level shifting circuit (5V -> 3.3V)\\n";
-		content += "4. P1 data request pin if used\\n";
+		content.append("=== NO P1 DATA AVAILABLE ===\\n");
+		content.append("Check:\\n");
+		content.append("1. P1 meter is connected and powered\\n");
+		content.append("2. Serial connection (GPIO0/1 at 115200 baud)\\n");
+		content.append("3. Level shifting circuit (5V -> 3.3V)\\n");
+		content.append("4. P1 data request pin if used\\n");
 	}
+	json.append("\"");
 	
-	// Escape content for JSON
-	content.replace("\"", "\\\"");
-	json += content;
-	json += "\"";
-	
-	json += "}";
-	return json;
+	json.append("}");
 }
\ No newline at end of file
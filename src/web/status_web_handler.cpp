@@ -3,136 +3,220 @@
 #include "custom_log.h"
 #include "config.h"
 #include "ntp_client.h"
+#include "history_store.h"
+#include "heap_telemetry.h"
+#include "web/http_server.h"
+#include "web/p1_web_handler.h"
+#include "web/websocket_handler.h"
+#include "stats.h"
+#include "mqtt_client.h"
+#include "modbus_server.h"
 #include <Ethernet.h>
 
-// Extern declarations for global variables used from main
-extern unsigned long totalHTTPRequests;
-extern bool isNTPTimeValid();
-
 void sendInfoPage(EthernetClient& client) {
-	String content = getDeviceInfoHTML();
-	// Send response using HTTP server utility
-	extern void sendHTTPResponse(EthernetClient& client, int statusCode, const String& contentType, const String& content);
-	sendHTTPResponse(client, 200, "text/html", content);
+	sendHTTPGenerated(client, 200, "text/html", generateDeviceInfoHTML);
 }
 
 void handleStatusPage(EthernetClient& client) {
 	// Handle OTA status directly - simplified for debugging
-	String status = "OTA Status: Ready\nUptime: " + String(millis() / 1000) + " seconds\nFirmware: P1 Bridge v1.0";
-	extern void sendHTTPResponse(EthernetClient& client, int statusCode, const String& contentType, const String& content);
+	StringBuilder& status = beginHTTPPage();
+	status.append("OTA Status: Ready\nUptime: ").append(millis() / 1000).append(" seconds\nFirmware: P1 Bridge v1.0");
+	status.append("\n\n");
+	appendHeapTelemetryText(status);
+	StatsSnapshot stats;
+	getStatsSnapshot(stats);
+	status.append("\nCounters (rate per second, averaged over ~").append(STATS_RATE_WINDOW / 1000).append("s):\n");
+	for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+		status.append("  ").append(getStatName((StatCounter)i)).append(": ").append(stats.counters[i]).append(" (");
+		status.appendFixedPoint(stats.rates[i], 3).append("/s)\n");
+	}
+	status.append("\n");
+	status.append("P1 event stream: ").append(getP1EventSubscriberCount()).append(" of ").append(MAX_P1_EVENT_CLIENTS).append(" subscribers, ").append(getSkippedP1EventCount()).append(" telegrams skipped\n");
+	status.append("WebSocket: ").append(getWebSocketClientCount()).append(" of ").append(MAX_WEBSOCKET_CLIENTS).append(" clients, ").append(getSkippedWebSocketMessageCount()).append(" messages skipped\n");
+	if (MQTT_ENABLED) {
+		status.append("MQTT: ").append(isMQTTConnected() ? "connected to " : "not connected to ").append(MQTT_BROKER).append(':').append(MQTT_PORT).append("\n");
+	}
+	if (INFLUX_ENABLED) {
+		status.append("InfluxDB: ").append(INFLUX_TRANSPORT == INFLUX_UDP ? "UDP" : "HTTP").append(" to ").append(INFLUX_HOST).append(':').append(INFLUX_PORT).append(", flush every ").append(INFLUX_FLUSH_INTERVAL / 1000).append("s or ").append(INFLUX_BUFFER_SIZE).append(" bytes\n");
+	}
+	if (MODBUS_ENABLED) {
+		status.append("Modbus TCP: ").append(getConnectedModbusClientCount()).append(" of ").append(MAX_MODBUS_CONNECTIONS).append(" clients on port ").append(MODBUS_PORT).append("\n");
+	}
+	status.append("HTTP request arena: peak ").append(getHTTPArenaPeak()).append(" of ").append(HTTP_REQUEST_ARENA_SIZE).append(" bytes\n");
 	sendHTTPResponse(client, 200, "text/plain", status);
 }
 
-void sendRedirect(EthernetClient& client, const String& location) {
-	String headers = "HTTP/1.1 302 Found\r\n";
-	headers += "Location: " + location + "\r\n";
-	headers += "Connection: close\r\n";
-	headers += "\r\n";
-	client.print(headers);
+// Stack use of one core as "used/size bytes"
+static void appendStackUse(StringBuilder& out, uint16_t used, uint16_t size) {
+	if (size == 0) {
+		out.append("n/a");
+	} else {
+		out.append(used).append('/').append(size).append(" bytes");
+	}
 }
 
-String getDeviceInfoHTML() {
-	String html = "<!DOCTYPE html>\n";
-	html += "<html lang=\"en\">\n";
-	html += "<head>\n";
-	html += "    <meta charset=\"UTF-8\">\n";
-	html += "    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n";
-	html += "    <title>" + String(HTTP_INFO_TITLE) + "</title>\n";
-	html += "    <style>\n";
-	html += "        body { font-family: Arial, sans-serif; margin: 40px; background-color: #f5f5f5; }\n";
-	html += "        .container { max-width: 800px; margin: 0 auto; background-color: white; padding: 30px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }\n";
-	html += "        h1 { color: #2c3e50; border-bottom: 2px solid #3498db; padding-bottom: 10px; }\n";
-	html += "        h2 { color: #34495e; margin-top: 30px; }\n";
-	html += "        .info-grid { display: grid; grid-template-columns: 1fr 1fr; gap: 20px; margin: 20px 0; }\n";
-	html += "        .info-card { background-color: #ecf0f1; padding: 15px; border-radius: 5px; }\n";
-	html += "        .info-label { font-weight: bold; color: #2c3e50; }\n";
-	html += "        .services { margin: 20px 0; }\n";
-	html += "        .service-link { display: inline-block; margin: 10px; padding: 12px 20px; background-color: #3498db; color: white; text-decoration: none; border-radius: 5px; transition: background-color 0.3s; }\n";
-	html += "        .service-link:hover { background-color: #2980b9; }\n";
-	html += "        .service-link.upload { background-color: #e74c3c; }\n";
-	html += "        .service-link.upload:hover { background-color: #c0392b; }\n";
-	html += "        .service-link.logs { background-color: #f39c12; }\n";
-	html += "        .service-link.logs:hover { background-color: #d68910; }\n";
-	html += "        .footer { margin-top: 30px; text-align: center; color: #7f8c8d; font-size: 0.9em; }\n";
-	html += "    </style>\n";
-	html += "</head>\n";
-	html += "<body>\n";
-	html += "    <div class=\"container\">\n";
-	html += "        <h1>" + String(HTTP_INFO_TITLE) + "</h1>\n";
+void appendHeapTelemetryText(StringBuilder& out) {
+	HeapSample now;
+	sampleHeapTelemetry(now);
+	HeapTelemetryStats stats;
+	getHeapTelemetryStats(stats);
 
-	// Device Information
-	html += "        <h2>Device Information</h2>\n";
-	html += "        <div class=\"info-grid\">\n";
-	html += "            <div class=\"info-card\">\n";
-	html += "                <div class=\"info-label\">IP Address:</div>\n";
-	html += "                <div>" + Ethernet.localIP().toString() + "</div>\n";
-	html += "            </div>\n";
-	html += "            <div class=\"info-card\">\n";
-	html += "                <div class=\"info-label\">MAC Address:</div>\n";
-	html += "                <div>";
-	byte mac[6];
-	Ethernet.MACAddress(mac);
-	for (int i = 0; i < 6; i++) {
-		if (i > 0) html += ":";
-		if (mac[i] < 16) html += "0";
-		html += String(mac[i], HEX);
+	out.append("Memory\n");
+	out.append("Free heap: ").append(now.freeHeap).append(" of ").append(stats.totalHeap).append(" bytes, lowest ").append(stats.minFreeHeap).append("\n");
+	out.append("Largest free block: ").append(now.largestFreeBlock).append(" bytes, lowest ").append(stats.minLargestFreeBlock).append("\n");
+	out.append("Stack core 0: ");
+	appendStackUse(out, now.stackUsed[0], stats.stackSize[0]);
+	out.append(", core 1: ");
+	appendStackUse(out, now.stackUsed[1], stats.stackSize[1]);
+	out.append("\n");
+	out.append("Allocations: ").append(now.allocations).append(" (").append(now.allocationsPerMinute).append("/min)\n");
+	for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+		HeapTagStats tag;
+		getHeapTagStats((HeapTag)t, tag);
+		out.appendf("  %-8s %10lu allocs %12lu bytes\n", getHeapTagName((HeapTag)t), (unsigned long)tag.allocations, (unsigned long)tag.bytes);
 	}
-	html += "</div>\n";
-	html += "            </div>\n";
-	html += "            <div class=\"info-card\">\n";
-	html += "                <div class=\"info-label\">Current Time:</div>\n";
-	html += "                <div>" + getFormattedDateTime() + " " + (isNTPTimeValid() ? "(NTP)" : "(no sync)") + "</div>\n";
-	html += "            </div>\n";
-	html += "            <div class=\"info-card\">\n";
-	html += "                <div class=\"info-label\">Uptime:</div>\n";
-	html += "                <div>" + String(millis() / 1000) + " seconds</div>\n";
-	html += "            </div>\n";
-	html += "            <div class=\"info-card\">\n";
-	html += "                <div class=\"info-label\">Firmware:</div>\n";
-	html += "                <div>P1 Bridge v1.0</div>\n";
-	html += "            </div>\n";
-	html += "        </div>\n";
 
-	// Services
-	html += "        <h2>Available Services</h2>\n";
-	html += "        <div class=\"services\">\n";
-	html += "            <a href=\"/p1\" class=\"service-link\">P1 Data Stream (Port " + String(SERVER_PORT) + ")</a>\n";
-	html += "            <a href=\"/logs\" class=\"service-link logs\">Remote Logging (Port " + String(LOG_SERVER_PORT) + ")</a>\n";
-	if (OTA_ENABLED) {
-		html += "            <a href=\"/ota\" class=\"service-link upload\">Firmware Update</a>\n";
-		html += "            <a href=\"/status\" class=\"service-link\">OTA Status</a>\n";
+	out.append("\nSamples every ").append(HEAP_SAMPLE_INTERVAL / 1000).append(" s, newest first\n");
+	out.append("  uptime(s)   free  largest  stack0  stack1  allocs/min\n");
+	HeapSample sample;
+	for (uint16_t age = 0; getHeapSample(age, sample); age++) {
+		out.appendf("%11lu %6lu %8lu %7u %7u %11lu\n", (unsigned long)sample.uptime, (unsigned long)sample.freeHeap,
+					(unsigned long)sample.largestFreeBlock, (unsigned)sample.stackUsed[0], (unsigned)sample.stackUsed[1],
+					(unsigned long)sample.allocationsPerMinute);
 	}
-	html += "        </div>\n";
+}
 
-	// Service Descriptions
-	html += "        <h2>Service Descriptions</h2>\n";
-	html += "        <div class=\"info-card\">\n";
-	html += "            <p><strong>P1 Data Stream:</strong> Connect to port " + String(SERVER_PORT) + " with a TCP client to receive real-time P1 smart meter data.</p>\n";
-	html += "            <p><strong>Remote Logging:</strong> Connect to port " + String(LOG_SERVER_PORT) + " to monitor system logs and debugging information.</p>\n";
-	if (OTA_ENABLED) {
-		html += "            <p><strong>Firmware Update:</strong> Access the OTA (Over-The-Air) firmware update interface at /ota. Authentication required.</p>\n";
-		html += "            <p><strong>OTA Status:</strong> View OTA update statistics and current status at /status without authentication.</p>\n";
-	}
-	html += "        </div>\n";
+void sendRedirect(EthernetClient& client, const char* location) {
+	FixedString<320> headers;
+	beginHTTPHeaders(headers, 302, nullptr, 0);
+	headers.append("Location: ").append(location).append("\r\n");
+	headers.append("\r\n");
+	client.write((const uint8_t*)headers.c_str(), headers.length());
+}
 
-	// Connection Information
-	html += "        <h2>Connection Information</h2>\n";
-	html += "        <div class=\"info-card\">\n";
-	html += "            <p><strong>TCP Connections:</strong></p>\n";
-	html += "            <ul>\n";
-	html += "                <li>P1 Data: <code>telnet " + Ethernet.localIP().toString() + " " + String(SERVER_PORT) + "</code></li>\n";
-	html += "                <li>Logs: <code>telnet " + Ethernet.localIP().toString() + " " + String(LOG_SERVER_PORT) + "</code></li>\n";
-	html += "            </ul>\n";
-	html += "            <p><strong>W5500 Socket Usage:</strong> P1:" + String(MAX_CONNECTIONS) + " + Log:" + String(MAX_LOG_CONNECTIONS) + " + HTTP/OTA:1 + NTP:0 + DHCP:1 = 7/8 sockets</p>\n";
-	html += "        </div>\n";
+bool generateDeviceInfoHTML(StringBuilder& html, uint16_t& part) {
+	// A part per section, each well below HTTP_STREAM_CHUNK_SIZE
+	switch (part++) {
+		case 0: {
+			html.append("<!DOCTYPE html>\n");
+			html.append("<html lang=\"en\">\n");
+			html.append("<head>\n");
+			html.append("    <meta charset=\"UTF-8\">\n");
+			html.append("    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n");
+			html.append("    <title>").append(HTTP_INFO_TITLE).append("</title>\n");
+			html.append("    <link rel=\"stylesheet\" href=\"/assets/main.css?v=").append(getWebAssetVersion("/assets/main.css")).append("\">\n");
+			html.append("</head>\n");
+			html.append("<body>\n");
+			html.append("    <div class=\"container\">\n");
+			html.append("        <h1>").append(HTTP_INFO_TITLE).append("</h1>\n");
+			return true;
+		}
+		case 1: {
+			// Device Information
+			html.append("        <h2>Device Information</h2>\n");
+			html.append("        <div class=\"info-grid\">\n");
+			html.append("            <div class=\"info-card\">\n");
+			html.append("                <div class=\"info-label\">IP Address:</div>\n");
+			html.append("                <div>").append(Ethernet.localIP()).append("</div>\n");
+			html.append("            </div>\n");
+			html.append("            <div class=\"info-card\">\n");
+			html.append("                <div class=\"info-label\">MAC Address:</div>\n");
+			html.append("                <div>");
+			byte mac[6];
+			Ethernet.MACAddress(mac);
+			for (int i = 0; i < 6; i++) {
+				if (i > 0) html.append(':');
+				html.appendf("%02x", mac[i]);
+			}
+			html.append("</div>\n");
+			html.append("            </div>\n");
+			html.append("            <div class=\"info-card\">\n");
+			html.append("                <div class=\"info-label\">Current Time:</div>\n");
+			html.append("                <div>");
+			printFormattedDateTime(html);
+			html.append(" ").append(isNTPTimeValid() ? "(NTP)" : "(no sync)").append("</div>\n");
+			html.append("            </div>\n");
+			html.append("            <div class=\"info-card\">\n");
+			html.append("                <div class=\"info-label\">Uptime:</div>\n");
+			html.append("                <div>").append(millis() / 1000).append(" seconds</div>\n");
+			html.append("            </div>\n");
+			html.append("            <div class=\"info-card\">\n");
+			html.append("                <div class=\"info-label\">Firmware:</div>\n");
+			html.append("                <div>P1 Bridge v1.0</div>\n");
+			html.append("            </div>\n");
+			return true;
+		}
+		case 2: {
+			HistoryStats history;
+			getHistoryStats(history);
+			html.append("            <div class=\"info-card\">\n");
+			html.append("                <div class=\"info-label\">History:</div>\n");
+			html.append("                <div>").append(history.recordsAppended).append(" records, ").append(history.storedBytes / 1024).append(" KB in ").append(history.segments).append(" segments</div>\n");
+			html.append("                <div>Flash: ").append(history.flashBytesPerDay / 1024).append(" KB/day, ").append(history.flashErasesPerDay).append(" erases/day, write amplification ").appendFixedPoint(history.writeAmplificationX100 / 10, 1).append("x</div>\n");
+			html.append("            </div>\n");
+			HeapSample memory;
+			getHeapSample(0, memory);
+			HeapTelemetryStats memoryStats;
+			getHeapTelemetryStats(memoryStats);
+			html.append("            <div class=\"info-card\">\n");
+			html.append("                <div class=\"info-label\">Memory:</div>\n");
+			html.append("                <div>").append(memory.freeHeap / 1024).append(" KB free of ").append(memoryStats.totalHeap / 1024).append(" KB, largest block ").append(memory.largestFreeBlock / 1024).append(" KB</div>\n");
+			html.append("                <div>Lowest: ").append(memoryStats.minFreeHeap / 1024).append(" KB free, ").append(memoryStats.minLargestFreeBlock / 1024).append(" KB block, ").append(memory.allocationsPerMinute).append(" allocs/min (<a href=\"/status\">details</a>)</div>\n");
+			html.append("            </div>\n");
+			html.append("        </div>\n");
+			return true;
+		}
+		case 3: {
+			// Services
+			html.append("        <h2>Available Services</h2>\n");
+			html.append("        <div class=\"services\">\n");
+			html.append("            <a href=\"/p1\" class=\"service-link\">P1 Data Stream (Port ").append(SERVER_PORT).append(")</a>\n");
+			html.append("            <a href=\"/logs\" class=\"service-link logs\">Remote Logging (Port ").append(LOG_SERVER_PORT).append(")</a>\n");
+			if (OTA_ENABLED) {
+				html.append("            <a href=\"/ota\" class=\"service-link upload\">Firmware Update</a>\n");
+				html.append("            <a href=\"/status\" class=\"service-link\">OTA Status</a>\n");
+			}
+			html.append("        </div>\n");
 
-	// Footer
-	html += "        <div class=\"footer\">\n";
-	html += "            <p>P1 Serial-to-Network Bridge | " + getFormattedDateTime() + " | Uptime: " + String(millis() / 1000) + "s | Requests: " + String(totalHTTPRequests) + "</p>\n";
-	html += "        </div>\n";
-	html += "    </div>\n";
-	html += "</body>\n";
-	html += "</html>\n";
+			// Service Descriptions
+			html.append("        <h2>Service Descriptions</h2>\n");
+			html.append("        <div class=\"info-card\">\n");
+			html.append("            <p><strong>P1 Data Stream:</strong> Connect to port ").append(SERVER_PORT).append(" with a TCP client to receive real-time P1 smart meter data.</p>\n");
+			html.append("            <p><strong>Remote Logging:</strong> Connect to port ").append(LOG_SERVER_PORT).append(" to monitor system logs and debugging information.</p>\n");
+			if (OTA_ENABLED) {
+				html.append("            <p><strong>Firmware Update:</strong> Access the OTA (Over-The-Air) firmware update interface at /ota. Authentication required.</p>\n");
+				html.append("            <p><strong>OTA Status:</strong> View OTA update statistics and current status at /status without authentication.</p>\n");
+			}
+			html.append("        </div>\n");
+			return true;
+		}
+		default: {
+			// Connection Information
+			html.append("        <h2>Connection Information</h2>\n");
+			html.append("        <div class=\"info-card\">\n");
+			html.append("            <p><strong>TCP Connections:</strong></p>\n");
+			html.append("            <ul>\n");
+			html.append("                <li>P1 Data: <code>telnet ").append(Ethernet.localIP()).append(" ").append(SERVER_PORT).append("</code></li>\n");
+			html.append("                <li>Logs: <code>telnet ").append(Ethernet.localIP()).append(" ").append(LOG_SERVER_PORT).append("</code></li>\n");
+			if (MODBUS_ENABLED) html.append("                <li>Modbus TCP: <code>").append(Ethernet.localIP()).append(":").append(MODBUS_PORT).append("</code> (function codes 3/4)</li>\n");
+			html.append("            </ul>\n");
+			html.append("            <p><strong>W5500 Socket Usage:</strong> P1:").append(MAX_CONNECTIONS).append(" + Log:").append(MAX_LOG_CONNECTIONS).append(" + HTTP/OTA:1");
+			if (MQTT_ENABLED) html.append(" + MQTT:1");
+			if (INFLUX_ENABLED && INFLUX_TRANSPORT == INFLUX_HTTP) html.append(" + InfluxDB:1");
+			if (MODBUS_ENABLED) html.append(" + Modbus:").append(MODBUS_SOCKETS);
+			html.append(" + NTP:0 + DHCP:1 = 7/8 sockets</p>\n");
+			html.append("        </div>\n");
 
-	return html;
-}
\ No newline at end of file
+			// Footer
+			html.append("        <div class=\"footer\">\n");
+			html.append("            <p>P1 Serial-to-Network Bridge | ");
+			printFormattedDateTime(html);
+			html.append(" | Uptime: ").append(millis() / 1000).append("s | Requests: ").append(getStat(STAT_HTTP_REQUESTS)).append("</p>\n");
+			html.append("        </div>\n");
+			html.append("    </div>\n");
+			html.append("</body>\n");
+			html.append("</html>\n");
+			return false;
+		}
+	}
+}
@@ -0,0 +1,217 @@
+// Generated by scripts/build_web_assets.py from web/, do not edit.
+// Rebuilt before every PlatformIO build when a file in web/ changes.
+
+#include "web/web_assets.h"
+
+// /assets/main.css: 1144 bytes, 486 gzipped
+static const uint8_t webAsset0[] = {
+	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7d, 0x53, 0xd9, 0x6e, 0xdb, 0x30,
+	0x10, 0x7c, 0xef, 0x57, 0x10, 0xc8, 0x4b, 0x0b, 0x84, 0x86, 0x2e, 0x37, 0x3a, 0x9e, 0xfa, 0x29,
+	0x14, 0x0f, 0x89, 0x30, 0xc5, 0x15, 0x48, 0x3a, 0x56, 0x1a, 0xf4, 0xdf, 0xbb, 0x94, 0x2c, 0xdb,
+	0xb1, 0xe5, 0x80, 0x90, 0x00, 0x1e, 0x33, 0x9c, 0x9d, 0x1d, 0xb6, 0x20, 0x3e, 0xc8, 0x27, 0x51,
+	0x60, 0x03, 0x55, 0x6c, 0xd0, 0xe6, 0xa3, 0x26, 0x7f, 0x9c, 0x66, 0xe6, 0x95, 0x78, 0x66, 0x3d,
+	0xf5, 0xd2, 0x69, 0xd5, 0x90, 0x81, 0xb9, 0x4e, 0xdb, 0x9a, 0x14, 0xc9, 0x38, 0x35, 0xa4, 0x65,
+	0xfc, 0xd0, 0x39, 0x38, 0x5a, 0x41, 0x39, 0x18, 0x70, 0x35, 0x79, 0x51, 0xfb, 0x38, 0x1a, 0xf2,
+	0xef, 0xc7, 0x8e, 0x23, 0x17, 0xd3, 0x56, 0x3a, 0xe4, 0x1d, 0xd8, 0x44, 0x4f, 0x5a, 0x84, 0xbe,
+	0x26, 0x65, 0x32, 0x63, 0x57, 0xa6, 0x84, 0xb0, 0x63, 0x80, 0x2d, 0xae, 0x53, 0xaf, 0x83, 0x6c,
+	0xc8, 0xc8, 0x84, 0xd0, 0xb6, 0xab, 0x49, 0xbe, 0xdc, 0x09, 0x4e, 0x48, 0x47, 0x1d, 0x13, 0xfa,
+	0xe8, 0x6b, 0x92, 0x9e, 0x17, 0x27, 0xea, 0x7b, 0x26, 0xe0, 0x14, 0x09, 0xb3, 0x71, 0x9a, 0xd7,
+	0x89, 0xeb, 0x5a, 0xf6, 0x33, 0x79, 0x9d, 0xc7, 0x2e, 0xfd, 0x15, 0x55, 0xf5, 0x29, 0xaa, 0x59,
+	0xc5, 0x66, 0x3c, 0x97, 0xfb, 0xe4, 0xc2, 0xd9, 0x42, 0x08, 0x30, 0xd4, 0x33, 0xde, 0x83, 0xd1,
+	0x82, 0xbc, 0xe4, 0x45, 0x55, 0x8a, 0xf6, 0x22, 0xe2, 0x72, 0x64, 0xb9, 0x16, 0xe9, 0xb2, 0x1b,
+	0xba, 0xbc, 0x28, 0xaa, 0xbd, 0x5c, 0x4b, 0xa3, 0x01, 0xc6, 0x55, 0x34, 0xba, 0xa1, 0xad, 0x02,
+	0xda, 0x39, 0x24, 0xfd, 0x24, 0x42, 0xfb, 0xd1, 0x30, 0x74, 0x38, 0xce, 0x9b, 0xf9, 0x4f, 0x83,
+	0x1c, 0x70, 0x2d, 0xc8, 0x58, 0xfd, 0x71, 0xb0, 0xb1, 0x34, 0xe5, 0xe2, 0x87, 0xfb, 0x0c, 0x89,
+	0xb2, 0x2f, 0xae, 0xc5, 0x19, 0x49, 0xae, 0xc4, 0x9c, 0xb9, 0x48, 0xbc, 0xd1, 0x10, 0xc9, 0x55,
+	0xa2, 0xd2, 0x1b, 0x1b, 0xd3, 0xfd, 0x86, 0x8d, 0xfb, 0x5b, 0x95, 0x86, 0xb5, 0xd2, 0xac, 0x61,
+	0x38, 0x49, 0xdd, 0xf5, 0xa1, 0x46, 0x80, 0x41, 0xa9, 0xf7, 0xce, 0x21, 0x04, 0x93, 0xf1, 0xae,
+	0xb9, 0xf4, 0x73, 0x97, 0x1f, 0xd4, 0x9d, 0x77, 0xa9, 0xd1, 0xf6, 0x70, 0x5b, 0xb9, 0xb6, 0xb8,
+	0x22, 0x69, 0x6b, 0x80, 0x1f, 0xae, 0x65, 0x2d, 0xb6, 0x5e, 0xa5, 0xc6, 0x4e, 0x64, 0xcf, 0xa2,
+	0xb6, 0xf6, 0xe6, 0x6b, 0x5c, 0x82, 0x9c, 0x02, 0x15, 0x92, 0x83, 0x63, 0x41, 0x03, 0x72, 0x5a,
+	0xb0, 0x72, 0xbb, 0xde, 0xe0, 0x30, 0xd9, 0x7a, 0x39, 0x75, 0xcf, 0x4f, 0x92, 0x5d, 0xee, 0x1f,
+	0x2a, 0xa8, 0x7b, 0x78, 0x9f, 0xf3, 0xbc, 0x21, 0x27, 0xab, 0xca, 0xa4, 0xad, 0x1e, 0x20, 0xbb,
+	0xe3, 0x68, 0x80, 0x3d, 0x6b, 0xce, 0x5b, 0xc1, 0x73, 0xfe, 0x0c, 0xf3, 0xdd, 0x6d, 0x3c, 0xc9,
+	0xab, 0xac, 0x7d, 0x44, 0x1a, 0xe8, 0xfc, 0x36, 0x42, 0xe5, 0x15, 0x4f, 0xb3, 0x6d, 0xc4, 0x77,
+	0x37, 0x89, 0xdf, 0x65, 0x95, 0x2e, 0xcd, 0x54, 0x00, 0xe1, 0xfc, 0x9c, 0xef, 0x13, 0x3e, 0xdb,
+	0xce, 0x8c, 0xee, 0xd0, 0x4b, 0x2e, 0x2d, 0x1e, 0xbb, 0x86, 0xe5, 0x4d, 0x95, 0xbc, 0xc4, 0xf0,
+	0xcc, 0x79, 0xf2, 0xfa, 0xaf, 0xc4, 0x47, 0xba, 0xab, 0xe4, 0x10, 0x39, 0xff, 0x03, 0xf1, 0x36,
+	0x18, 0x4a, 0x78, 0x04, 0x00, 0x00,
+};
+
+// /logs.html: 3534 bytes, 1346 gzipped
+static const uint8_t webAsset1[] = {
+	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x57, 0x4b, 0x73, 0xdb, 0x36,
+	0x10, 0xbe, 0xeb, 0x57, 0x6c, 0x95, 0x83, 0xa4, 0x49, 0x28, 0x89, 0x72, 0xec, 0x28, 0x7a, 0x75,
+	0x1a, 0xdb, 0x99, 0xb6, 0xe3, 0x24, 0x9e, 0xd8, 0x39, 0xf4, 0x08, 0x91, 0x4b, 0x09, 0x63, 0x8a,
+	0xe0, 0x80, 0xa0, 0x65, 0x37, 0xe3, 0xff, 0xde, 0x5d, 0x80, 0x94, 0x28, 0x8a, 0x76, 0x92, 0x99,
+	0x9e, 0x48, 0x02, 0xfb, 0xf8, 0xf6, 0xdb, 0xc5, 0x62, 0x39, 0xfb, 0xed, 0xe2, 0xcb, 0xf9, 0xed,
+	0x3f, 0xd7, 0x97, 0xb0, 0x36, 0x9b, 0x78, 0xd1, 0x9a, 0x95, 0x0f, 0x14, 0x21, 0x3d, 0x8c, 0x34,
+	0x31, 0x2e, 0x2e, 0x70, 0x99, 0xaf, 0xe0, 0x4a, 0xad, 0x32, 0xf0, 0xe0, 0xda, 0x87, 0x1b, 0xd4,
+	0x52, 0xc4, 0xf0, 0x41, 0xcb, 0x70, 0x85, 0xb3, 0x81, 0x13, 0x6a, 0xcd, 0x36, 0x68, 0x04, 0x04,
+	0x6b, 0xa1, 0x33, 0x34, 0xf3, 0xf6, 0xb7, 0xdb, 0x8f, 0xde, 0xb8, 0x4d, 0xcb, 0x99, 0x79, 0xe4,
+	0xed, 0xa5, 0x0a, 0x1f, 0xe1, 0x3b, 0x44, 0x2a, 0x31, 0x5e, 0x24, 0x36, 0x32, 0x7e, 0x9c, 0x40,
+	0xe7, 0x5c, 0xe5, 0x5a, 0xa2, 0x86, 0xcf, 0xb8, 0xed, 0xbc, 0x81, 0x8d, 0x4a, 0x54, 0x96, 0x8a,
+	0x00, 0xa7, 0xb0, 0x14, 0xc1, 0xdd, 0x4a, 0xab, 0x3c, 0x09, 0x27, 0xf0, 0x6a, 0x18, 0xfa, 0xbe,
+	0xff, 0x6e, 0x0a, 0x81, 0x8a, 0x95, 0xa6, 0xef, 0xe0, 0x7d, 0xe8, 0x87, 0xef, 0xa7, 0xb0, 0x11,
+	0x7a, 0x25, 0x93, 0x09, 0x8c, 0x86, 0xe9, 0xc3, 0x14, 0x9e, 0x5a, 0xfd, 0x80, 0x8c, 0x0b, 0x99,
+	0x90, 0xc1, 0xef, 0xb4, 0xf9, 0xe0, 0x6d, 0x65, 0x68, 0xd6, 0x13, 0xf0, 0x47, 0x43, 0x2b, 0x51,
+	0xca, 0x0f, 0x41, 0xe4, 0x46, 0xd5, 0x9c, 0xf8, 0x67, 0xfe, 0x72, 0x34, 0x9a, 0x42, 0x2a, 0xc2,
+	0x50, 0x26, 0xab, 0xd2, 0xea, 0x52, 0xe9, 0x10, 0xb5, 0xa7, 0x45, 0x28, 0xf3, 0x6c, 0x02, 0xe3,
+	0xfd, 0x1a, 0xd9, 0x4d, 0x1f, 0x20, 0x53, 0xb1, 0x0c, 0xe1, 0xd5, 0xc9, 0xf0, 0xe4, 0xec, 0x24,
+	0x64, 0x10, 0x6b, 0x9f, 0x9c, 0x97, 0x48, 0x4f, 0xc7, 0xe2, 0x2c, 0x8a, 0xa6, 0x60, 0xf0, 0xc1,
+	0x78, 0x22, 0x96, 0x2b, 0xf2, 0x1e, 0x60, 0x62, 0x50, 0x97, 0x68, 0xbc, 0xa5, 0x32, 0x46, 0x6d,
+	0x2a, 0x41, 0x64, 0x46, 0x98, 0x3c, 0x23, 0x23, 0x07, 0xf0, 0x46, 0xfe, 0xe8, 0x6c, 0x14, 0x56,
+	0xe0, 0xf9, 0x07, 0x21, 0xf1, 0x17, 0x0c, 0x8f, 0xe0, 0x9e, 0xfe, 0x10, 0x6e, 0x3f, 0x56, 0x2b,
+	0x2f, 0x33, 0x1a, 0xc5, 0xa6, 0xee, 0xb2, 0xa4, 0x7d, 0xef, 0xf2, 0x47, 0xe6, 0x9a, 0xbc, 0xdb,
+	0x84, 0x67, 0xf2, 0x5f, 0x24, 0x0d, 0xdf, 0x41, 0x7e, 0xf0, 0xd6, 0x28, 0x57, 0x6b, 0x43, 0x12,
+	0x2e, 0x31, 0xea, 0x1e, 0x75, 0x14, 0xab, 0xad, 0x47, 0x35, 0xe1, 0x52, 0xb3, 0x5d, 0x4b, 0x83,
+	0x9e, 0x2d, 0x86, 0x09, 0xa4, 0x1a, 0xbd, 0xad, 0x16, 0xa9, 0xc5, 0x9b, 0x88, 0x7b, 0x2f, 0x96,
+	0xc9, 0x1d, 0xa1, 0x0d, 0x65, 0x96, 0xc6, 0x82, 0x74, 0x64, 0x42, 0x2b, 0xe8, 0x2d, 0x63, 0x15,
+	0xdc, 0x4d, 0x9b, 0x79, 0xab, 0x67, 0x64, 0x17, 0x14, 0x65, 0xb4, 0x08, 0xcc, 0x26, 0x29, 0xc4,
+	0x40, 0x69, 0x61, 0xa4, 0x22, 0x52, 0x13, 0x95, 0xe0, 0x9e, 0xe2, 0xd3, 0x86, 0x72, 0xf8, 0x09,
+	0x7e, 0x4b, 0xbc, 0x93, 0x35, 0x47, 0x59, 0xe7, 0xb8, 0x22, 0x28, 0x93, 0x48, 0x55, 0x4a, 0x27,
+	0x1a, 0x8e, 0xc7, 0x27, 0x78, 0x9c, 0x61, 0x57, 0xe6, 0x09, 0x06, 0x8c, 0xd1, 0xdb, 0x15, 0x4b,
+	0x3d, 0xbe, 0x06, 0xda, 0x6d, 0xb9, 0xc5, 0x18, 0x99, 0xb2, 0x78, 0xc8, 0x94, 0xb2, 0xcc, 0x55,
+	0xf4, 0x47, 0xa1, 0x78, 0xfb, 0x16, 0xdd, 0x5e, 0x14, 0xd5, 0x36, 0xa3, 0xf1, 0xa9, 0xff, 0xf6,
+	0x3d, 0x6f, 0x2e, 0x73, 0xaa, 0xda, 0xe4, 0xb9, 0x22, 0xad, 0x83, 0x79, 0x81, 0xa1, 0x86, 0x3c,
+	0x34, 0x71, 0x1c, 0xe4, 0x3a, 0x63, 0x93, 0xa9, 0x92, 0xee, 0xf4, 0x3c, 0xb5, 0x66, 0x83, 0xa2,
+	0xb3, 0xcc, 0xb2, 0x40, 0xcb, 0xd4, 0x2c, 0x5a, 0x31, 0x1a, 0x90, 0xd9, 0x79, 0xc1, 0x4e, 0xb2,
+	0x82, 0x39, 0x44, 0x22, 0xce, 0x70, 0xda, 0x8a, 0xf2, 0xc4, 0xf2, 0x05, 0xd4, 0x9a, 0xce, 0x77,
+	0xec, 0xdd, 0x58, 0xf2, 0xba, 0x9c, 0xf7, 0x37, 0xe0, 0x98, 0xe8, 0xc1, 0xf7, 0x16, 0x10, 0xfe,
+	0x24, 0x33, 0x50, 0x70, 0x3b, 0x87, 0x50, 0x05, 0xf9, 0x86, 0x4e, 0x6d, 0x7f, 0x85, 0xe6, 0x32,
+	0x46, 0x7e, 0xfd, 0xf0, 0xf8, 0x57, 0xd8, 0xed, 0x1c, 0x25, 0xa2, 0xd3, 0x9b, 0x92, 0xba, 0x7b,
+	0xa7, 0x84, 0x52, 0x27, 0xfa, 0xf3, 0xf6, 0xd3, 0x15, 0x99, 0x60, 0x1f, 0x95, 0xad, 0x20, 0x16,
+	0x59, 0xf6, 0x59, 0x6c, 0x90, 0xb6, 0x8e, 0xad, 0x40, 0x07, 0x5e, 0x43, 0xb7, 0x48, 0xcd, 0xef,
+	0xd0, 0x71, 0x6f, 0x1d, 0xa0, 0x86, 0x59, 0xe4, 0x84, 0xfd, 0x3c, 0xed, 0xa3, 0x8a, 0xd0, 0x04,
+	0x6b, 0xee, 0xcf, 0x17, 0xc2, 0x88, 0xae, 0x8b, 0x41, 0x46, 0xd0, 0xad, 0x92, 0xd1, 0x03, 0x8d,
+	0x26, 0xd7, 0x09, 0xa3, 0xa8, 0x91, 0x64, 0x74, 0x8e, 0x16, 0x5c, 0x03, 0x39, 0x9d, 0x6f, 0x69,
+	0x28, 0x58, 0xae, 0xdf, 0xef, 0x53, 0x8b, 0x66, 0x51, 0xf2, 0xbd, 0xe3, 0x08, 0xef, 0x89, 0x8c,
+	0x1b, 0xea, 0xe2, 0x01, 0x87, 0x92, 0xe0, 0x16, 0x2e, 0xf7, 0x2b, 0xdd, 0xce, 0x80, 0xba, 0x4b,
+	0x36, 0x70, 0xed, 0xc5, 0x71, 0xe3, 0xd4, 0x8c, 0xdc, 0xa0, 0xca, 0x0d, 0xa9, 0x90, 0xcf, 0x5b,
+	0xf7, 0xd1, 0x25, 0xe0, 0xf3, 0x85, 0xc5, 0x0e, 0x55, 0xbb, 0x44, 0x96, 0xca, 0xb0, 0x6b, 0xb5,
+	0xe1, 0x99, 0xfc, 0x02, 0x3c, 0xbd, 0x81, 0x93, 0xe1, 0x70, 0xe8, 0xb0, 0x55, 0xb5, 0xa9, 0xbe,
+	0x2c, 0xa4, 0x2b, 0x99, 0x19, 0xa4, 0x84, 0x74, 0x3b, 0x8c, 0x89, 0x62, 0x12, 0x14, 0x4e, 0xc9,
+	0x60, 0xb7, 0x48, 0x3c, 0x50, 0x80, 0x8f, 0xc5, 0x1b, 0x40, 0xce, 0xa1, 0xa3, 0xe5, 0xd5, 0x75,
+	0x9a, 0xee, 0xdf, 0x37, 0x5f, 0x3e, 0xf7, 0x53, 0xbe, 0xe1, 0xba, 0xd8, 0x67, 0x1b, 0xbd, 0x02,
+	0xd6, 0x13, 0x04, 0x82, 0x72, 0x00, 0x5d, 0xd4, 0xba, 0xb7, 0x33, 0xc0, 0xc1, 0xaa, 0x18, 0xfb,
+	0xb4, 0xa8, 0xc8, 0xf1, 0x25, 0x3f, 0x80, 0xd5, 0x19, 0x3c, 0xc3, 0x00, 0xb6, 0x31, 0x21, 0x20,
+	0xac, 0x56, 0x58, 0xe2, 0x60, 0x7e, 0x26, 0x0c, 0xba, 0xa2, 0xb5, 0x59, 0xa2, 0x30, 0x8d, 0x71,
+	0x38, 0x9e, 0xd9, 0x3c, 0xb1, 0x74, 0x0c, 0xdb, 0xf9, 0x6a, 0x4c, 0xf8, 0x95, 0xbc, 0x47, 0xba,
+	0xe7, 0xaf, 0x04, 0xe9, 0x3b, 0x06, 0x26, 0xb6, 0x20, 0x59, 0xaf, 0xcf, 0x89, 0xa3, 0x22, 0xdd,
+	0xa4, 0xbb, 0x52, 0xb0, 0xce, 0x62, 0xc2, 0x52, 0xa6, 0xb1, 0xc8, 0x6d, 0xb1, 0xf5, 0xeb, 0x89,
+	0x3c, 0x8e, 0x9d, 0xda, 0xb0, 0x65, 0x6e, 0xde, 0x14, 0xe7, 0xff, 0xe8, 0xfa, 0x19, 0x42, 0xf6,
+	0x2b, 0xe0, 0x70, 0x78, 0xf0, 0x15, 0xa9, 0x4e, 0x76, 0x87, 0xc2, 0x1a, 0xb0, 0xb6, 0x9f, 0x0e,
+	0x8e, 0xe5, 0x71, 0xfd, 0x58, 0xee, 0x77, 0xc7, 0xd3, 0x32, 0xca, 0x33, 0x0b, 0xe1, 0xec, 0x3d,
+	0xdf, 0x65, 0xb8, 0x50, 0x3c, 0x5b, 0xb0, 0xbd, 0x83, 0x9e, 0x52, 0x55, 0x9f, 0x56, 0x4d, 0xba,
+	0x2e, 0xf2, 0x82, 0x45, 0x27, 0xe0, 0xf1, 0x8d, 0xd3, 0x64, 0xd3, 0x6d, 0x1f, 0x98, 0x4c, 0x95,
+	0x7e, 0x09, 0xa2, 0xc1, 0x38, 0x41, 0x43, 0xb6, 0xb8, 0xcf, 0x9d, 0x3b, 0x48, 0xdc, 0xda, 0xdc,
+	0xba, 0x2d, 0x1f, 0xba, 0x9b, 0xed, 0xb5, 0xda, 0x5f, 0xab, 0xcc, 0x24, 0xdc, 0xfa, 0x5e, 0xd3,
+	0xfa, 0xae, 0xb0, 0xd8, 0x01, 0x93, 0xb7, 0x95, 0x49, 0xa8, 0xb6, 0x7c, 0x2f, 0x29, 0x11, 0x72,
+	0x72, 0xaa, 0xad, 0x6d, 0xca, 0x4d, 0xbf, 0x68, 0xf6, 0xb3, 0x41, 0x31, 0xa3, 0xf2, 0x60, 0x49,
+	0x8f, 0x50, 0xde, 0x83, 0x6d, 0xab, 0xf3, 0xf6, 0x6e, 0x0c, 0xe4, 0xf1, 0x73, 0xed, 0x2f, 0x6e,
+	0x1e, 0xe9, 0xcc, 0x6c, 0x60, 0x3f, 0xc6, 0x92, 0xae, 0x7f, 0xa8, 0xe2, 0x42, 0x6e, 0x83, 0x0c,
+	0xcb, 0x77, 0xcb, 0x4e, 0x7b, 0x41, 0xe3, 0xab, 0x56, 0xc9, 0x6a, 0xe1, 0x8a, 0x61, 0xc2, 0x97,
+	0x8e, 0xfd, 0x06, 0xc6, 0xe7, 0x2a, 0x60, 0x36, 0x20, 0x43, 0x87, 0xe6, 0x9c, 0xee, 0x57, 0xe4,
+	0x59, 0x8f, 0x0f, 0x3a, 0xd0, 0x93, 0x06, 0xdd, 0x0c, 0x66, 0x34, 0xd2, 0x24, 0xd6, 0xcb, 0x51,
+	0xd7, 0x6f, 0x57, 0xe0, 0xd7, 0x76, 0x16, 0xfb, 0x7a, 0xb5, 0xfe, 0xd8, 0xc8, 0xa2, 0xea, 0xd6,
+	0xde, 0x84, 0xf3, 0x76, 0x6d, 0x56, 0x20, 0xf4, 0xc5, 0x3d, 0xad, 0x92, 0x20, 0x96, 0xc1, 0xdd,
+	0xbc, 0x5d, 0xbb, 0x29, 0x18, 0x63, 0xa4, 0x31, 0x5b, 0x17, 0xb4, 0x38, 0xf1, 0x45, 0x43, 0x44,
+	0xfb, 0x31, 0xd1, 0x91, 0xb4, 0x2b, 0xca, 0x76, 0x13, 0x90, 0x17, 0xe6, 0x5d, 0xa3, 0xd2, 0x62,
+	0xd8, 0xe5, 0xec, 0x08, 0x58, 0x6b, 0x8c, 0xe6, 0xed, 0xc1, 0x2e, 0xfa, 0x72, 0x5e, 0x6a, 0x2f,
+	0x3e, 0x51, 0x0e, 0xe1, 0x5a, 0xf0, 0x2f, 0x86, 0xa8, 0x8a, 0xa6, 0x7e, 0x83, 0x30, 0xfd, 0x96,
+	0x70, 0x48, 0x35, 0xd1, 0x1a, 0xb3, 0x7b, 0xf1, 0x2f, 0xb7, 0x7f, 0x80, 0x4b, 0xa9, 0xd3, 0xf8,
+	0xf5, 0x10, 0xdc, 0xac, 0x52, 0x4e, 0x3a, 0x67, 0xf8, 0xee, 0x6c, 0xec, 0x1f, 0x8f, 0x5d, 0x14,
+	0xe3, 0x47, 0xea, 0x18, 0xa1, 0xd4, 0x94, 0x3e, 0xb8, 0x3d, 0xbf, 0x86, 0x7d, 0x76, 0x27, 0x30,
+	0x0b, 0x54, 0x88, 0xa5, 0xc3, 0xda, 0xd0, 0xe4, 0x68, 0x76, 0x07, 0x88, 0x39, 0x66, 0xd1, 0x3d,
+	0xd0, 0xf2, 0x51, 0x14, 0xff, 0xc0, 0xfd, 0xb6, 0xfd, 0x07, 0x76, 0x97, 0x5b, 0x8c, 0xce, 0x0d,
+	0x00, 0x00,
+};
+
+// /p1.html: 2933 bytes, 1225 gzipped
+static const uint8_t webAsset2[] = {
+	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x56, 0x5b, 0x6f, 0xea, 0x46,
+	0x10, 0x7e, 0xe7, 0x57, 0x4c, 0xc9, 0x03, 0xa0, 0x13, 0x03, 0x6e, 0x94, 0xe8, 0x08, 0x08, 0x55,
+	0x0f, 0xc9, 0xd1, 0x49, 0x45, 0x2e, 0x52, 0xd2, 0x4a, 0x7d, 0xdc, 0x78, 0xc7, 0xb0, 0x8a, 0xd9,
+	0xb5, 0xd6, 0x4b, 0x08, 0x8d, 0xf2, 0xdf, 0x3b, 0xb3, 0x6b, 0x83, 0xb9, 0x34, 0x6d, 0xe5, 0x07,
+	0xdb, 0xbb, 0xb3, 0x33, 0xdf, 0x7c, 0x73, 0xdb, 0xd1, 0x4f, 0x57, 0xf7, 0x93, 0xa7, 0x3f, 0x1f,
+	0xae, 0x61, 0xee, 0x16, 0xd9, 0xb8, 0x31, 0xaa, 0x5e, 0x28, 0x24, 0xbd, 0x9c, 0x72, 0x19, 0x8e,
+	0x1f, 0x62, 0xb8, 0x12, 0x4e, 0xc0, 0xa3, 0xb3, 0x28, 0x16, 0x10, 0x01, 0x2d, 0x3c, 0xa2, 0x55,
+	0x22, 0x83, 0x6f, 0x56, 0xc9, 0x19, 0x8e, 0x7a, 0x41, 0xb0, 0x31, 0x5a, 0x20, 0xc9, 0x25, 0x73,
+	0x61, 0x0b, 0x74, 0x97, 0xcd, 0xdf, 0x9f, 0xbe, 0x47, 0x5f, 0x9b, 0xb4, 0x5c, 0xb8, 0x35, 0x6f,
+	0x3f, 0x1b, 0xb9, 0x86, 0x77, 0x48, 0x8d, 0x76, 0x51, 0x2a, 0x16, 0x2a, 0x5b, 0x0f, 0xa0, 0x35,
+	0x31, 0x4b, 0xab, 0xd0, 0xc2, 0x1d, 0xae, 0x5a, 0xa7, 0xb0, 0x30, 0xda, 0x14, 0xb9, 0x48, 0x70,
+	0x08, 0xcf, 0x22, 0x79, 0x99, 0x59, 0xb3, 0xd4, 0x72, 0x00, 0x27, 0xb1, 0xe0, 0x67, 0x08, 0x89,
+	0xc9, 0x8c, 0xa5, 0xff, 0x7e, 0x3f, 0x4d, 0xfb, 0xfd, 0x21, 0x2c, 0x84, 0x9d, 0x29, 0x3d, 0x80,
+	0x9f, 0xfb, 0xf9, 0xdb, 0x10, 0x3e, 0x1a, 0xdd, 0x84, 0x94, 0x0b, 0xa5, 0x49, 0xe1, 0x3b, 0x6d,
+	0xbe, 0x45, 0x2b, 0x25, 0xdd, 0x7c, 0x00, 0x71, 0xbf, 0xef, 0x25, 0x2a, 0xf9, 0x3e, 0x88, 0xa5,
+	0x33, 0x7b, 0x46, 0xfa, 0xac, 0x31, 0x17, 0x52, 0x2a, 0x3d, 0xab, 0x54, 0x3e, 0x1b, 0x2b, 0xd1,
+	0x46, 0x56, 0x48, 0xb5, 0x2c, 0x06, 0xf0, 0x75, 0xbb, 0x46, 0x4a, 0xf3, 0x37, 0x28, 0x4c, 0xa6,
+	0x24, 0x9c, 0x9c, 0x9d, 0x9d, 0xb1, 0xf9, 0x79, 0x4c, 0x66, 0xf7, 0x31, 0x3a, 0x7c, 0x73, 0x91,
+	0xc8, 0xd4, 0x8c, 0xec, 0x26, 0xa8, 0x1d, 0xda, 0x0a, 0x47, 0xf4, 0x6c, 0x9c, 0x33, 0x8b, 0x1a,
+	0xfc, 0xc2, 0x09, 0xb7, 0x2c, 0x48, 0xc9, 0x0e, 0x30, 0xaf, 0x7d, 0x03, 0x2c, 0xde, 0xf1, 0x84,
+	0xff, 0xa0, 0x7f, 0x00, 0xf4, 0xbc, 0x54, 0x28, 0x29, 0x72, 0x91, 0x54, 0x45, 0x9e, 0x09, 0xe6,
+	0x7e, 0x35, 0x57, 0x0e, 0x23, 0xcf, 0xf0, 0x00, 0x72, 0x8b, 0xd1, 0xca, 0x8a, 0xdc, 0x0b, 0x6a,
+	0xf1, 0x1a, 0x65, 0x4a, 0xbf, 0x90, 0x50, 0x29, 0x3e, 0x00, 0xa5, 0x69, 0x05, 0xa3, 0xe7, 0xcc,
+	0x24, 0x2f, 0xc3, 0x23, 0x90, 0xf6, 0x3d, 0xdd, 0x40, 0x24, 0x9a, 0x20, 0xf6, 0x10, 0xbc, 0xf3,
+	0x12, 0x13, 0x63, 0x85, 0x53, 0x86, 0xf0, 0x6a, 0xa3, 0x71, 0x8b, 0xfe, 0xfc, 0x08, 0xc7, 0x15,
+	0xf4, 0x0a, 0xd1, 0x60, 0x6e, 0x5e, 0x7d, 0x3c, 0x77, 0x00, 0x9c, 0x9f, 0x9f, 0x7b, 0x29, 0xa5,
+	0x53, 0x53, 0x23, 0x3d, 0x4d, 0x77, 0x13, 0xa3, 0xa2, 0x27, 0xa4, 0x86, 0xc6, 0x84, 0x51, 0x44,
+	0x1b, 0x9a, 0xf7, 0x3d, 0xf0, 0xb9, 0x59, 0xa8, 0xbf, 0x88, 0x9d, 0x38, 0xde, 0xd2, 0x1c, 0x65,
+	0x98, 0xba, 0x8a, 0x79, 0x52, 0x65, 0x3c, 0x31, 0x47, 0xce, 0xf3, 0x5e, 0x9a, 0xee, 0x6d, 0xf2,
+	0x56, 0xd8, 0x1c, 0xf5, 0xca, 0x52, 0x18, 0x15, 0x89, 0x55, 0xb9, 0x1b, 0x37, 0x7a, 0x3d, 0xb8,
+	0x27, 0xe1, 0xcc, 0xe8, 0x19, 0x39, 0xfb, 0x8a, 0x12, 0x0a, 0x5f, 0x66, 0x03, 0x10, 0x1a, 0xf0,
+	0x95, 0xd2, 0x05, 0x72, 0x72, 0xde, 0x61, 0x86, 0x33, 0x2b, 0x16, 0xa7, 0xb4, 0x2c, 0xe1, 0x9a,
+	0xd7, 0x1f, 0xa9, 0x70, 0x12, 0x04, 0x8b, 0xa5, 0x5f, 0x05, 0xeb, 0x7a, 0x5e, 0x83, 0x72, 0x05,
+	0x66, 0x29, 0xb4, 0x0b, 0xd4, 0x1c, 0x0c, 0x98, 0x8a, 0xc2, 0x45, 0xfe, 0x44, 0x74, 0x73, 0xd5,
+	0x01, 0x95, 0x82, 0x9b, 0x23, 0x6c, 0xc9, 0x00, 0x69, 0x4d, 0x5e, 0x34, 0xd2, 0xa5, 0x0e, 0xbf,
+	0x54, 0xba, 0x93, 0xcd, 0xe6, 0xa3, 0x27, 0xaa, 0xcd, 0x51, 0x3c, 0x85, 0xe0, 0x75, 0x07, 0xde,
+	0x1b, 0xc0, 0xe7, 0x0b, 0x07, 0x25, 0x8f, 0x97, 0x20, 0x4d, 0xb2, 0x5c, 0x90, 0x89, 0xee, 0x0c,
+	0xdd, 0x75, 0x86, 0xfc, 0xf9, 0x6d, 0x7d, 0x23, 0xdb, 0xad, 0x03, 0xd2, 0x5b, 0x9d, 0x21, 0x1d,
+	0x0f, 0xdf, 0x14, 0x3c, 0xaa, 0xd4, 0x1f, 0x4f, 0xb7, 0x53, 0x52, 0xc1, 0x36, 0x6a, 0x5b, 0x49,
+	0x26, 0x8a, 0xe2, 0x4e, 0x2c, 0x90, 0xb6, 0x0e, 0xb5, 0x40, 0x0b, 0xbe, 0x40, 0xbb, 0x0c, 0xc3,
+	0x2f, 0xd0, 0x0a, 0x5f, 0x2d, 0xa0, 0x86, 0x52, 0xf2, 0xcf, 0x76, 0x3e, 0xb6, 0x5e, 0x2d, 0x73,
+	0xaa, 0x04, 0x7c, 0x88, 0xaf, 0x42, 0x6e, 0xb7, 0xb9, 0x2e, 0x82, 0x27, 0x44, 0x88, 0xff, 0xf3,
+	0xad, 0x83, 0x70, 0x77, 0xfe, 0xd9, 0x99, 0x3c, 0x8e, 0x58, 0xb2, 0xd5, 0xd9, 0x01, 0x5e, 0x3f,
+	0x3c, 0xac, 0x2b, 0x0c, 0x50, 0x3f, 0xd1, 0x17, 0x04, 0x22, 0x4e, 0xe1, 0x63, 0x3a, 0xc3, 0xf6,
+	0x8e, 0xca, 0xdc, 0xd8, 0xcf, 0x00, 0x52, 0x9a, 0x68, 0x74, 0xa4, 0x8b, 0xc9, 0x9c, 0x04, 0x48,
+	0xcc, 0x5f, 0x58, 0xf7, 0xa4, 0x51, 0x2d, 0xfb, 0x4a, 0xec, 0xce, 0x4d, 0xe1, 0x34, 0xf3, 0xfb,
+	0x85, 0xd6, 0x79, 0x67, 0x63, 0x60, 0x87, 0xb8, 0x92, 0xfa, 0x87, 0x38, 0xb4, 0xff, 0x76, 0x3d,
+	0xfc, 0x58, 0xcb, 0xc3, 0x4b, 0xd0, 0xb8, 0xaa, 0x67, 0x66, 0xbb, 0xd5, 0xcb, 0xe3, 0x5e, 0xc8,
+	0xe6, 0x10, 0xf4, 0x9a, 0x38, 0x55, 0x90, 0xc9, 0x51, 0xd3, 0xa9, 0xca, 0x50, 0xa9, 0x18, 0x8e,
+	0xe6, 0x5f, 0x6b, 0x4a, 0xa5, 0x41, 0x93, 0x67, 0x25, 0x94, 0xe3, 0x9c, 0x4e, 0x8d, 0xf5, 0x59,
+	0xac, 0xc9, 0xcd, 0x4d, 0x6d, 0xd0, 0xf8, 0x70, 0x76, 0x89, 0xde, 0xd4, 0xc7, 0xbe, 0x3d, 0xea,
+	0x4c, 0x1e, 0xdb, 0x54, 0x15, 0x44, 0x0a, 0x5a, 0x0e, 0xa6, 0x8f, 0xe5, 0xe9, 0x16, 0x01, 0x56,
+	0x10, 0x9c, 0x5d, 0x97, 0x5f, 0x70, 0x90, 0x38, 0xbf, 0x3d, 0xde, 0xdf, 0x75, 0x73, 0x9e, 0x70,
+	0x6d, 0xf4, 0xdd, 0xb5, 0xe3, 0x0d, 0xfe, 0x1b, 0xf2, 0x0a, 0x24, 0x9c, 0x30, 0xd5, 0xd8, 0xa5,
+	0xec, 0x76, 0x1e, 0xd0, 0x8d, 0xf4, 0x01, 0x10, 0x21, 0x3a, 0xcc, 0x21, 0x0d, 0x5b, 0x6c, 0x53,
+	0x08, 0xcd, 0x94, 0x42, 0x95, 0xe1, 0x93, 0x5a, 0x20, 0x71, 0x4f, 0x6e, 0xb7, 0x3b, 0x35, 0x0f,
+	0xc9, 0x47, 0xa0, 0x48, 0x26, 0x73, 0x68, 0xa3, 0xb5, 0x9d, 0x0d, 0x5e, 0x8e, 0x8c, 0xc9, 0xb0,
+	0x4b, 0x8b, 0x86, 0xbc, 0xbc, 0xe6, 0x17, 0x30, 0x5e, 0xe6, 0x8d, 0x26, 0x37, 0x43, 0x1e, 0x90,
+	0xd7, 0x7c, 0xa8, 0xd4, 0xc3, 0x7c, 0x1d, 0x09, 0x90, 0xd7, 0xf0, 0x9f, 0x23, 0xb4, 0x5d, 0xa1,
+	0x14, 0xa3, 0xdc, 0x88, 0xb6, 0x9d, 0x89, 0x2c, 0x77, 0xbb, 0x5d, 0x66, 0x5a, 0x64, 0xc5, 0x26,
+	0x3e, 0x1f, 0x8d, 0x95, 0xd2, 0xd2, 0xac, 0xb8, 0x99, 0x1a, 0x21, 0xc9, 0xd0, 0x5e, 0xaa, 0x0d,
+	0xb9, 0x5d, 0x96, 0x6d, 0x72, 0xd4, 0x2b, 0xaf, 0x24, 0x7c, 0x87, 0xa0, 0x97, 0x54, 0xaf, 0xe0,
+	0x3b, 0xc4, 0x65, 0x73, 0x33, 0xf1, 0xf9, 0xa6, 0x31, 0x8f, 0xf9, 0xba, 0xf2, 0x48, 0x5d, 0xdb,
+	0xc1, 0x2d, 0xd2, 0xa8, 0xad, 0x5f, 0x5d, 0x48, 0x49, 0xbc, 0x7b, 0x36, 0x54, 0x58, 0x13, 0x94,
+	0xac, 0xbe, 0x7d, 0x31, 0x36, 0xc7, 0x74, 0x65, 0xb1, 0xd4, 0x92, 0xc7, 0xc1, 0xbb, 0x01, 0xf7,
+	0x6d, 0xff, 0x0f, 0x0c, 0x35, 0xf8, 0x33, 0xea, 0x91, 0xa2, 0x5d, 0x75, 0xe1, 0xec, 0x64, 0x69,
+	0x2d, 0xd7, 0x1d, 0x01, 0x29, 0x3c, 0x90, 0x85, 0x07, 0xc2, 0xc4, 0xc3, 0x88, 0x46, 0xaf, 0xf6,
+	0xe6, 0x0e, 0x5a, 0x5a, 0xb3, 0xe6, 0xd0, 0xde, 0xce, 0x78, 0x52, 0x27, 0x92, 0xc0, 0x90, 0x92,
+	0xf1, 0x11, 0xfb, 0xf5, 0x61, 0x1f, 0x9c, 0x2a, 0x3b, 0x56, 0x73, 0x47, 0xda, 0xcf, 0xa0, 0xcb,
+	0xe6, 0x27, 0xf7, 0x12, 0x67, 0xf2, 0xf2, 0x52, 0xc2, 0xa4, 0x0a, 0x98, 0x5b, 0x4c, 0x2f, 0x9b,
+	0xbd, 0x0d, 0xc4, 0x6a, 0x34, 0x37, 0xc7, 0xb7, 0x44, 0x3d, 0x3c, 0x08, 0xbe, 0x04, 0x8a, 0xba,
+	0x68, 0x66, 0x66, 0xc5, 0x11, 0xf1, 0x3f, 0x14, 0x25, 0xf8, 0x94, 0xf6, 0xf6, 0xc4, 0xf7, 0x28,
+	0xd8, 0x1e, 0xb8, 0x7f, 0xfa, 0x15, 0x42, 0x10, 0xc2, 0x89, 0xff, 0xef, 0x46, 0xb8, 0x87, 0x54,
+	0xb3, 0xf8, 0xe2, 0xe2, 0xe2, 0x70, 0xca, 0x93, 0x93, 0xdf, 0x29, 0xd5, 0xa5, 0xa2, 0x94, 0x75,
+	0xf0, 0x34, 0x79, 0xa8, 0x8d, 0xc7, 0x01, 0x8c, 0x12, 0x23, 0xb1, 0xb2, 0xb6, 0x37, 0xf0, 0x03,
+	0xcb, 0xa1, 0xbd, 0x32, 0xc9, 0x2c, 0xba, 0x45, 0x59, 0xbd, 0xca, 0xa4, 0xed, 0x85, 0xdb, 0xf5,
+	0xdf, 0x3a, 0x40, 0x67, 0x7b, 0x75, 0x0b, 0x00, 0x00,
+};
+
+const WebAsset webAssets[] = {
+	{"/assets/main.css", "text/css", "99b303bd97a768d9", true, webAsset0, sizeof(webAsset0), 1144},
+	{"/logs.html", "text/html", "0bb0c9b1116fff32", false, webAsset1, sizeof(webAsset1), 3534},
+	{"/p1.html", "text/html", "34979e4f6bb1efea", false, webAsset2, sizeof(webAsset2), 2933},
+};
+
+const size_t webAssetCount = sizeof(webAssets) / sizeof(webAssets[0]);
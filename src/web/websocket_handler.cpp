@@ -0,0 +1,542 @@
+#include "web/websocket_handler.h"
+#include "web/http_server.h"
+#include "web/api_web_handler.h"
+#include "p1_handler.h"
+#include "custom_log.h"
+#include "heap_telemetry.h"
+#include "stats.h"
+#include "sha1.h"
+
+#define WS_OPCODE_CONTINUATION  0x0
+#define WS_OPCODE_TEXT          0x1
+#define WS_OPCODE_BINARY        0x2
+#define WS_OPCODE_CLOSE         0x8
+#define WS_OPCODE_PING          0x9
+#define WS_OPCODE_PONG          0xA
+
+#define WS_CLOSE_NORMAL         1000
+#define WS_CLOSE_PROTOCOL_ERROR 1002
+#define WS_CLOSE_UNSUPPORTED    1003
+#define WS_CLOSE_TOO_BIG        1009
+
+#define WS_TOPIC_TELEGRAM       0x01
+#define WS_TOPIC_READING        0x02
+#define WS_TOPIC_LOG            0x04
+
+#define WS_HEADER_ROOM          4       // header of a server frame up to 65535 bytes
+#define WS_CONTROL_MAX          125     // largest control frame payload
+#define WS_REPLY_MAX            160     // command answers and control frames
+
+static const char* const webSocketTopicNames[] = {"telegram", "reading", "log"};
+#define WS_TOPIC_COUNT (sizeof(webSocketTopicNames) / sizeof(webSocketTopicNames[0]))
+
+// A message every subscriber gets, framed once when the telegram arrives and
+// written to each client as its socket takes it. Like the SSE events, two are
+// kept so a client still writing the older one does not hold up the others.
+struct WebSocketBroadcast {
+	uint8_t* data[2];
+	size_t capacity;
+	size_t start[2];                // the frame header sits right before the payload
+	size_t length[2];
+	unsigned long id[2];            // telegram number
+	int8_t latest;
+	uint8_t topic;
+	unsigned long skipped;
+};
+
+enum WebSocketReceiveState {
+	WS_RX_HEADER,                   // FIN/opcode and mask/length bytes
+	WS_RX_LENGTH,                   // 16 or 64 bit extended length
+	WS_RX_MASK,
+	WS_RX_PAYLOAD
+};
+
+struct WebSocketClient {
+	EthernetClient client;
+	bool active;
+	bool closing;                   // a close frame is queued; stop once it is out
+	uint8_t topics;
+
+	// Receiving: frames are parsed a byte at a time and unmasked in place
+	WebSocketReceiveState rxState;
+	uint8_t rxBytes[8];
+	uint8_t rxHave;
+	uint8_t rxNeeded;
+	uint8_t rxOpcode;
+	bool rxFinal;
+	uint8_t mask[4];
+	uint64_t rxLength;
+	uint64_t rxReceived;
+	uint8_t messageOpcode;          // text or binary, while continuation frames arrive
+	char message[WEBSOCKET_MESSAGE_MAX + 1];
+	size_t messageLength;
+	uint8_t control[WS_CONTROL_MAX];
+
+	// Sending: a broadcast being written, or a reply of this client's own
+	WebSocketBroadcast* sending;
+	int8_t sendSlot;
+	size_t sendOffset;
+	uint8_t reply[WS_REPLY_MAX];
+	size_t replyLength;
+	unsigned long lastId[2];        // per broadcast: last one written completely
+
+	unsigned long lastProgress;
+	unsigned long lastReceived;
+	unsigned long pingSent;
+	bool pingOutstanding;
+};
+
+static uint8_t telegramFrames[2][WS_HEADER_ROOM + P1_BUFFER_SIZE];
+static uint8_t readingFrames[2][WS_HEADER_ROOM + 32 + P1_READING_JSON_MAX];
+static WebSocketBroadcast webSocketBroadcasts[2] = {
+	{{telegramFrames[0], telegramFrames[1]}, sizeof(telegramFrames[0]), {0, 0}, {0, 0}, {0, 0}, -1, WS_TOPIC_TELEGRAM, 0},
+	{{readingFrames[0], readingFrames[1]}, sizeof(readingFrames[0]), {0, 0}, {0, 0}, {0, 0}, -1, WS_TOPIC_READING, 0},
+};
+#define WS_BROADCAST_COUNT 2
+
+static WebSocketClient webSocketClients[MAX_WEBSOCKET_CLIENTS];
+static bool sendingWebSocketLog = false;
+
+// Frame header for a server frame (never masked) of length bytes; returns its size
+static size_t buildFrameHeader(uint8_t* header, uint8_t opcode, size_t length) {
+	header[0] = 0x80 | opcode;
+	if (length < 126) {
+		header[1] = (uint8_t)length;
+		return 2;
+	}
+	header[1] = 126;
+	header[2] = (uint8_t)(length >> 8);
+	header[3] = (uint8_t)length;
+	return 4;
+}
+
+// Put the header in front of a payload written at data + WS_HEADER_ROOM
+static size_t frameInPlace(uint8_t* data, uint8_t opcode, size_t payloadLength) {
+	uint8_t header[WS_HEADER_ROOM];
+	size_t headerLength = buildFrameHeader(header, opcode, payloadLength);
+	size_t start = WS_HEADER_ROOM - headerLength;
+	memcpy(data + start, header, headerLength);
+	return start;
+}
+
+static bool isBroadcastSlotInUse(const WebSocketBroadcast* broadcast, int8_t slot) {
+	for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
+		const WebSocketClient& ws = webSocketClients[i];
+		if (ws.active && ws.sending == broadcast && ws.sendSlot == slot) return true;
+	}
+	return false;
+}
+
+// The buffer to render the next message in, -1 when both are being written
+static int8_t claimBroadcastSlot(WebSocketBroadcast& broadcast) {
+	int8_t slot = broadcast.latest == 0 ? 1 : 0;
+	if (isBroadcastSlotInUse(&broadcast, slot)) {
+		slot = broadcast.latest;
+		if (slot < 0 || isBroadcastSlotInUse(&broadcast, slot)) {
+			broadcast.skipped++;
+			return -1;
+		}
+	}
+	return slot;
+}
+
+static void publishWebSocketTelegram(const String& telegram, const P1Reading* reading) {
+	unsigned long id = getStat(STAT_P1_TELEGRAMS);
+	WebSocketBroadcast& raw = webSocketBroadcasts[0];
+	int8_t slot = claimBroadcastSlot(raw);
+	if (slot >= 0 && telegram.length() <= raw.capacity - WS_HEADER_ROOM) {
+		memcpy(raw.data[slot] + WS_HEADER_ROOM, telegram.c_str(), telegram.length());
+		raw.start[slot] = frameInPlace(raw.data[slot], WS_OPCODE_TEXT, telegram.length());
+		raw.length[slot] = WS_HEADER_ROOM - raw.start[slot] + telegram.length();
+		raw.id[slot] = id;
+		raw.latest = slot;
+	}
+
+	if (!reading) return;
+	WebSocketBroadcast& decoded = webSocketBroadcasts[1];
+	slot = claimBroadcastSlot(decoded);
+	if (slot < 0) return;
+	StringBuilder json((char*)decoded.data[slot] + WS_HEADER_ROOM, decoded.capacity - WS_HEADER_ROOM);
+	json.append("{\"type\":\"reading\",\"id\":").append(id).append(",\"values\":");
+	appendP1ReadingJSON(json, *reading);
+	json.append('}');
+	if (json.overflowed()) return;
+	decoded.start[slot] = frameInPlace(decoded.data[slot], WS_OPCODE_TEXT, json.length());
+	decoded.length[slot] = WS_HEADER_ROOM - decoded.start[slot] + json.length();
+	decoded.id[slot] = id;
+	decoded.latest = slot;
+}
+
+void initializeWebSockets() {
+	addP1TelegramCallback(publishWebSocketTelegram);
+}
+
+// Queue a frame of this client's own; the caller makes sure none is queued
+static void queueReply(WebSocketClient& ws, uint8_t opcode, const uint8_t* payload, size_t length) {
+	size_t headerLength = buildFrameHeader(ws.reply, opcode, length);
+	// A ping has no payload and passes nullptr, which memcpy must not get
+	if (length > 0) memcpy(ws.reply + headerLength, payload, length);
+	ws.replyLength = headerLength + length;
+}
+
+static void queueClose(WebSocketClient& ws, uint16_t code) {
+	uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};
+	queueReply(ws, WS_OPCODE_CLOSE, payload, sizeof(payload));
+	ws.closing = true;
+}
+
+static void queueTopics(WebSocketClient& ws) {
+	FixedString<WS_REPLY_MAX - WS_HEADER_ROOM> json;
+	json.append("{\"type\":\"topics\",\"topics\":[");
+	bool first = true;
+	for (size_t t = 0; t < WS_TOPIC_COUNT; t++) {
+		if (!(ws.topics & (1 << t))) continue;
+		if (!first) json.append(',');
+		json.append('"').append(webSocketTopicNames[t]).append('"');
+		first = false;
+	}
+	json.append("]}");
+	queueReply(ws, WS_OPCODE_TEXT, (const uint8_t*)json.c_str(), json.length());
+}
+
+// Topic bits named in a "reading,log" or "reading log" list
+static uint8_t parseTopics(const char* list) {
+	uint8_t topics = 0;
+	while (*list) {
+		while (*list == ' ' || *list == ',') list++;
+		size_t length = strcspn(list, " ,");
+		for (size_t t = 0; t < WS_TOPIC_COUNT && length > 0; t++) {
+			if (strlen(webSocketTopicNames[t]) == length && strncmp(list, webSocketTopicNames[t], length) == 0) {
+				topics |= 1 << t;
+			}
+		}
+		list += length;
+	}
+	return topics;
+}
+
+static void handleCommand(WebSocketClient& ws) {
+	const char* command = ws.message;
+	if (strncmp(command, "subscribe ", 10) == 0) {
+		ws.topics |= parseTopics(command + 10);
+	} else if (strncmp(command, "unsubscribe ", 12) == 0) {
+		ws.topics &= ~parseTopics(command + 12);
+	} else if (strcmp(command, "topics") != 0) {
+		static const char error[] = "{\"type\":\"error\",\"message\":\"expected subscribe, unsubscribe or topics\"}";
+		queueReply(ws, WS_OPCODE_TEXT, (const uint8_t*)error, sizeof(error) - 1);
+		return;
+	}
+	queueTopics(ws);
+}
+
+// The frame in rx is complete
+static void handleFrame(WebSocketClient& ws) {
+	switch (ws.rxOpcode) {
+		case WS_OPCODE_PING:
+			queueReply(ws, WS_OPCODE_PONG, ws.control, (size_t)ws.rxLength);
+			break;
+		case WS_OPCODE_PONG:
+			ws.pingOutstanding = false;
+			break;
+		case WS_OPCODE_CLOSE:
+			// Echo the status code, then close
+			if (ws.rxLength >= 2) {
+				queueReply(ws, WS_OPCODE_CLOSE, ws.control, 2);
+				ws.closing = true;
+			} else {
+				queueClose(ws, WS_CLOSE_NORMAL);
+			}
+			break;
+		default:
+			if (!ws.rxFinal) break;
+			ws.message[ws.messageLength] = '\0';
+			if (ws.messageOpcode == WS_OPCODE_TEXT) {
+				handleCommand(ws);
+			} else {
+				queueClose(ws, WS_CLOSE_UNSUPPORTED);
+			}
+			ws.messageLength = 0;
+			break;
+	}
+}
+
+// Frame header complete: check it and see what comes next
+static void startFrame(WebSocketClient& ws) {
+	uint8_t opcode = ws.rxOpcode;
+	bool control = opcode >= WS_OPCODE_CLOSE;
+	if (control) {
+		if (!ws.rxFinal || ws.rxLength > WS_CONTROL_MAX || opcode > WS_OPCODE_PONG) {
+			queueClose(ws, WS_CLOSE_PROTOCOL_ERROR);
+			return;
+		}
+	} else if (opcode == WS_OPCODE_CONTINUATION) {
+		if (ws.messageOpcode == 0) {
+			queueClose(ws, WS_CLOSE_PROTOCOL_ERROR);
+			return;
+		}
+	} else if (opcode == WS_OPCODE_TEXT || opcode == WS_OPCODE_BINARY) {
+		ws.messageOpcode = opcode;
+		ws.messageLength = 0;
+	} else {
+		queueClose(ws, WS_CLOSE_PROTOCOL_ERROR);
+		return;
+	}
+	if (!control && ws.messageLength + ws.rxLength > WEBSOCKET_MESSAGE_MAX) {
+		queueClose(ws, WS_CLOSE_TOO_BIG);
+		return;
+	}
+
+	ws.rxReceived = 0;
+	ws.rxHave = 0;
+	ws.rxNeeded = 4;
+	ws.rxState = WS_RX_MASK;
+}
+
+static void receiveByte(WebSocketClient& ws, uint8_t b) {
+	switch (ws.rxState) {
+		case WS_RX_HEADER:
+			ws.rxBytes[ws.rxHave++] = b;
+			if (ws.rxHave < 2) return;
+			ws.rxFinal = (ws.rxBytes[0] & 0x80) != 0;
+			ws.rxOpcode = ws.rxBytes[0] & 0x0F;
+			if ((ws.rxBytes[0] & 0x70) || !(ws.rxBytes[1] & 0x80)) {
+				// Reserved bits without an extension, or an unmasked client frame
+				queueClose(ws, WS_CLOSE_PROTOCOL_ERROR);
+				return;
+			}
+			ws.rxLength = ws.rxBytes[1] & 0x7F;
+			ws.rxHave = 0;
+			if (ws.rxLength >= 126) {
+				ws.rxNeeded = ws.rxLength == 126 ? 2 : 8;
+				ws.rxState = WS_RX_LENGTH;
+			} else {
+				startFrame(ws);
+			}
+			return;
+		case WS_RX_LENGTH:
+			ws.rxBytes[ws.rxHave++] = b;
+			if (ws.rxHave < ws.rxNeeded) return;
+			ws.rxLength = 0;
+			for (uint8_t i = 0; i < ws.rxNeeded; i++) {
+				ws.rxLength = (ws.rxLength << 8) | ws.rxBytes[i];
+			}
+			startFrame(ws);
+			return;
+		case WS_RX_MASK:
+			ws.mask[ws.rxHave++] = b;
+			if (ws.rxHave < 4) return;
+			ws.rxState = WS_RX_PAYLOAD;
+			break;
+		case WS_RX_PAYLOAD: {
+			uint8_t value = b ^ ws.mask[ws.rxReceived & 3];
+			if (ws.rxOpcode >= WS_OPCODE_CLOSE) {
+				ws.control[ws.rxReceived] = value;
+			} else {
+				ws.message[ws.messageLength++] = (char)value;
+			}
+			ws.rxReceived++;
+			break;
+		}
+	}
+
+	if (ws.rxState == WS_RX_PAYLOAD && ws.rxReceived == ws.rxLength) {
+		handleFrame(ws);
+		ws.rxState = WS_RX_HEADER;
+		ws.rxHave = 0;
+	}
+}
+
+static void receiveFrames(WebSocketClient& ws) {
+	// Stop at a queued reply; the rest waits in the socket until it is out
+	for (int budget = HTTP_PARSE_BUDGET; budget > 0 && ws.replyLength == 0 && !ws.closing; budget--) {
+		int c = ws.client.read();
+		if (c < 0) break;
+		ws.lastReceived = millis();
+		receiveByte(ws, (uint8_t)c);
+	}
+}
+
+bool startWebSocket(EthernetClient& client, const HTTPRequest& request) {
+	if (!request.webSocketUpgrade || !request.webSocketKey || !request.webSocketVersion13) {
+		StringBuilder& message = beginHTTPPage();
+		message.append("Expected a WebSocket upgrade (Sec-WebSocket-Version: 13)\n");
+		sendHTTPResponse(client, 400, "text/plain", message);
+		return false;
+	}
+	WebSocketClient* ws = nullptr;
+	for (int i = 0; i < MAX_WEBSOCKET_CLIENTS && !ws; i++) {
+		if (!webSocketClients[i].active) ws = &webSocketClients[i];
+	}
+	if (!ws || !httpStreamSocketAvailable()) {
+		StringBuilder& message = beginHTTPPage();
+		message.append(ws ? "No socket left for a WebSocket\n" : "Too many WebSocket clients\n");
+		sendHTTPResponse(client, 503, "text/plain", message);
+		return false;
+	}
+
+	// Sec-WebSocket-Accept: base64(SHA-1(key + GUID))
+	static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+	static const char base64Digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	Sha1Context sha1;
+	uint8_t digest[SHA1_DIGEST_SIZE];
+	sha1Init(sha1);
+	sha1Update(sha1, (const uint8_t*)request.webSocketKey, strlen(request.webSocketKey));
+	sha1Update(sha1, (const uint8_t*)guid, sizeof(guid) - 1);
+	sha1Final(sha1, digest);
+
+	FixedString<192> headers;
+	headers.append("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ");
+	for (int i = 0; i < SHA1_DIGEST_SIZE; i += 3) {
+		uint32_t group = (uint32_t)digest[i] << 16 | (i + 1 < SHA1_DIGEST_SIZE ? digest[i + 1] << 8 : 0) | (i + 2 < SHA1_DIGEST_SIZE ? digest[i + 2] : 0);
+		headers.append(base64Digits[(group >> 18) & 63]).append(base64Digits[(group >> 12) & 63]);
+		headers.append(i + 1 < SHA1_DIGEST_SIZE ? base64Digits[(group >> 6) & 63] : '=');
+		headers.append(i + 2 < SHA1_DIGEST_SIZE ? base64Digits[group & 63] : '=');
+	}
+	headers.append("\r\n\r\n");
+	client.write((const uint8_t*)headers.c_str(), headers.length());
+
+	const char* subscribe = getQueryParameter(request.path, "subscribe");
+	ws->client = client;
+	ws->active = true;
+	ws->closing = false;
+	ws->topics = subscribe[0] ? parseTopics(subscribe) : WS_TOPIC_READING;
+	ws->rxState = WS_RX_HEADER;
+	ws->rxHave = 0;
+	ws->messageOpcode = 0;
+	ws->messageLength = 0;
+	ws->sending = nullptr;
+	ws->replyLength = 0;
+	ws->lastId[0] = 0;
+	ws->lastId[1] = 0;
+	ws->lastProgress = millis();
+	ws->lastReceived = millis();
+	ws->pingOutstanding = false;
+	queueTopics(*ws);
+	REMOTE_LOG_DEBUG("WebSocket client connected");
+	return true;
+}
+
+static void closeWebSocket(WebSocketClient& ws, const char* reason) {
+	ws.client.stop();
+	ws.active = false;
+	ws.sending = nullptr;
+	REMOTE_LOG_DEBUG("WebSocket client disconnected:", reason);
+}
+
+// Write what the socket takes of the broadcast being sent
+static void continueBroadcast(WebSocketClient& ws, size_t room) {
+	WebSocketBroadcast& broadcast = *ws.sending;
+	int8_t slot = ws.sendSlot;
+	size_t length = min(broadcast.length[slot] - ws.sendOffset, room);
+	if (length == 0) return;
+	ws.client.write(broadcast.data[slot] + broadcast.start[slot] + ws.sendOffset, length);
+	ws.sendOffset += length;
+	ws.lastProgress = millis();
+	if (ws.sendOffset >= broadcast.length[slot]) {
+		ws.lastId[&broadcast - webSocketBroadcasts] = broadcast.id[slot];
+		ws.sending = nullptr;
+	}
+}
+
+static void serviceWebSocket(WebSocketClient& ws) {
+	if (!ws.client.connected()) {
+		closeWebSocket(ws, "closed by client");
+		return;
+	}
+	receiveFrames(ws);
+
+	size_t room = (size_t)max(ws.client.availableForWrite(), 0);
+	if (!ws.sending && ws.replyLength > 0) {
+		// Replies go out whole, between broadcasts
+		if (room >= ws.replyLength) {
+			ws.client.write(ws.reply, ws.replyLength);
+			room -= ws.replyLength;
+			ws.replyLength = 0;
+			ws.lastProgress = millis();
+			if (ws.closing) {
+				closeWebSocket(ws, "closed");
+				return;
+			}
+		}
+	}
+	if (!ws.sending && ws.replyLength == 0 && !ws.closing) {
+		for (int b = 0; b < WS_BROADCAST_COUNT && !ws.sending; b++) {
+			WebSocketBroadcast& broadcast = webSocketBroadcasts[b];
+			if ((ws.topics & broadcast.topic) && broadcast.latest >= 0 && broadcast.id[broadcast.latest] != ws.lastId[b]) {
+				ws.sending = &broadcast;
+				ws.sendSlot = broadcast.latest;
+				ws.sendOffset = 0;
+				ws.lastProgress = millis();
+			}
+		}
+	}
+	if (ws.sending) {
+		continueBroadcast(ws, room);
+	}
+
+	unsigned long now = millis();
+	if ((ws.sending || ws.replyLength > 0) && now - ws.lastProgress > WEBSOCKET_STALL_TIMEOUT) {
+		closeWebSocket(ws, "stalled");
+	} else if (ws.pingOutstanding && now - ws.pingSent > WEBSOCKET_PONG_TIMEOUT) {
+		closeWebSocket(ws, "no pong");
+	} else if (!ws.pingOutstanding && !ws.sending && ws.replyLength == 0 && now - ws.lastReceived > WEBSOCKET_PING_INTERVAL) {
+		queueReply(ws, WS_OPCODE_PING, nullptr, 0);
+		ws.pingOutstanding = true;
+		ws.pingSent = now;
+	}
+}
+
+void handleWebSocketClients() {
+	HEAP_TAG_SCOPE(HEAP_TAG_HTTP);
+	for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
+		if (webSocketClients[i].active) {
+			serviceWebSocket(webSocketClients[i]);
+		}
+	}
+}
+
+uint8_t getWebSocketClientCount() {
+	uint8_t count = 0;
+	for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
+		if (webSocketClients[i].active) count++;
+	}
+	return count;
+}
+
+unsigned long getSkippedWebSocketMessageCount() {
+	return webSocketBroadcasts[0].skipped + webSocketBroadcasts[1].skipped;
+}
+
+bool hasWebSocketLogSubscribers() {
+	for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
+		if (webSocketClients[i].active && (webSocketClients[i].topics & WS_TOPIC_LOG)) return true;
+	}
+	return false;
+}
+
+void sendWebSocketLog(const char* line, size_t length) {
+	// Nothing in here may log, or it would come back here
+	if (sendingWebSocketLog || !hasWebSocketLogSubscribers()) return;
+	sendingWebSocketLog = true;
+
+	uint8_t frame[WS_HEADER_ROOM + 2 * LOG_MESSAGE_SIZE + 64];
+	StringBuilder json((char*)frame + WS_HEADER_ROOM, sizeof(frame) - WS_HEADER_ROOM);
+	json.append("{\"type\":\"log\",\"line\":\"").appendJSONEscaped(line, length).append("\"}");
+	if (json.overflowed()) {
+		sendingWebSocketLog = false;
+		return;
+	}
+	size_t start = frameInPlace(frame, WS_OPCODE_TEXT, json.length());
+	size_t frameLength = WS_HEADER_ROOM - start + json.length();
+
+	// Only between other messages and when the socket takes the whole line;
+	// otherwise the line is dropped for that client, like for a full log socket
+	for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
+		WebSocketClient& ws = webSocketClients[i];
+		if (!ws.active || ws.closing || !(ws.topics & WS_TOPIC_LOG) || ws.sending || ws.replyLength > 0) continue;
+		if ((size_t)max(ws.client.availableForWrite(), 0) >= frameLength) {
+			ws.client.write(frame + start, frameLength);
+		}
+	}
+	sendingWebSocketLog = false;
+}